@@ -1,6 +1,7 @@
 #include "app.h"
 
 #include "app_config.h"
+#include "benchmark.h"
 #include "command_queues.h"
 #include "common.h"
 #include "components/light.h"
@@ -9,38 +10,95 @@
 #include "core/buffer.h"
 #include "core/image.h"
 #include "core/shared_queue.h"
+#include "core/trace.h"
+#include "core/yuv_convert.h"
 #include "display.h"
 #include "ecs/coordinator.h"
+#include "frame_sink.h"
 #include "input.h"
 #include "loaders.h"
 #include "rtsp_client.h"
 #include "systems/render_system/camera.h"
+#include "systems/render_system/model_data.h"
 #include "systems/render_system/render_system.h"
 #include "systems/render_system/scene.h"
+#include "systems/world_system/scene_snapshot.h"
 #include "systems/world_system/world_system.h"
 #include "utils/slogger.h"
+#include <asio/post.hpp>
+#include <algorithm>
 #include <asio_noexcept.h>
+#include <chrono>
 #include <glm/vec3.hpp>
 #include <map>
-#include <tinygltf/tiny_gltf.h>
+#include <thread>
 
 using namespace render_system;
 
-static constexpr int renderWidth = 1440;
-static constexpr int renderHeight = 1080;
-
 namespace app {
-App::App(int, char **)
-    : threadPool(NUM_THREADS), commandServer(8003, 4), display("App"), input(display), gui(input),
-      appUi(), coordinator(ecs::Coordinator::getInstance()),
+struct App::SessionView {
+  Camera camera;
+  std::unique_ptr<ViewTarget> target;
+  // remote key state of the session, moves camera
+  std::map<Input::Key, bool> keys;
+};
+
+template <typename GetKey> static void moveCamera(Camera &camera, GetKey getKey, float dt) {
+  bool keyW = getKey(Input::Key::W);
+  bool keyA = getKey(Input::Key::A);
+  bool keyD = getKey(Input::Key::D);
+  bool keyS = getKey(Input::Key::S);
+
+  if (keyW && keyA) {
+    camera.processMovement(CameraMovement::STRAFE_LEFT, dt);
+  } else if (keyW && keyD) {
+    camera.processMovement(CameraMovement::STRAFE_RIGHT, dt);
+  } else if (keyW) {
+    camera.processMovement(CameraMovement::FORWARD, dt);
+  } else if (keyA) {
+    camera.processMovement(CameraMovement::LEFT, dt);
+  } else if (keyD) {
+    camera.processMovement(CameraMovement::RIGHT, dt);
+  } else if (keyS) {
+    camera.processMovement(CameraMovement::BACKWARD, dt);
+  }
+
+  camera.update();
+}
+
+App::App(int argc, char **argv)
+    : config(AppConfig::getInstance().parseArgs(argc, argv)), threadPool(NUM_THREADS),
+      scheduler([&threadPool = threadPool](std::function<void()> task) {
+        asio::post(threadPool, std::move(task));
+      }),
+      commandServer(config.getCommandPort(), 4, true),
+      sessionManager(config.getRenderWidth(), config.getRenderHeight(), FrameSink::Type::ENCODER,
+                     false),
+      display("App", config.isHeadless() ? Display::Backend::HEADLESS : Display::Backend::WINDOW,
+              glm::ivec2(config.getRenderWidth(), config.getRenderHeight())),
+      input(display), gui(input), appUi(), coordinator(ecs::Coordinator::getInstance()),
       worldSystem(new world_system::WorldSystem()),
-      renderSystem(createRenderSystem(renderWidth, renderHeight)),
+      renderSystem(createRenderSystem(config.getRenderWidth(), config.getRenderHeight())),
       camera(new Camera(glm::vec3(0.0f, 10.0f, 0.0f))), testLight1(nullptr), testLight2(nullptr) {
   DEBUG_SLOG("App constructed.");
   //  input.setCursorStatus(INPUT_CURSOR_DISABLED);
 
+  // stream threads convert frames to YUV with the pool's help, one band each
+  sessionManager.setConvertExecutor(
+      [&threadPool = threadPool](std::function<void()> task) {
+        asio::post(threadPool, std::move(task));
+      },
+      NUM_THREADS + 1);
   renderSystem->setCamera(camera);
   renderSystem->updateProjectionMatrix(display.getAspectRatio());
+  // frames are read back while the next frame renders
+  renderSystem->setReadbackMode(FrameBuffer::ReadbackMode::ASYNC_PBO);
+  // render nodes have no monitor, frames only go to the sessions
+  renderSystem->setHeadless(display.isHeadless());
+  scheduleSystems();
+  // entity changes reach the ui once per frame
+  coordinator.eventManager.setDispatchMode<event::EntityChanged>(
+      ecs::EventManager::DispatchMode::QUEUED);
 
   // load skybox
   Image skybox;
@@ -48,25 +106,23 @@ App::App(int, char **)
 
   renderSystem->setSkyBox(&skybox);
 
-  // load model
-  tinygltf::Model model;
-  Loaders::loadModel(model, "resources/meshes/sphere.gltf");
-  tinygltf::Model helmet;
-  Loaders::loadModel(helmet, "resources/meshes/DamagedHelmet.gltf");
-  tinygltf::Model lantern;
-  Loaders::loadModel(lantern, "resources/meshes/lantern.gltf");
-  tinygltf::Model flightHelmet;
-  Loaders::loadModel(flightHelmet, "resources/meshes/FlightHelmet.gltf");
-  tinygltf::Model gun;
-  Loaders::loadModel(gun, "resources/meshes/gun.gltf");
-  tinygltf::Model sniper;
-  Loaders::loadModel(sniper, "resources/meshes/sniper.gltf");
-
-  ModelRegisterReturn helmetModel = renderSystem->registerGltfModel(helmet);
-  ModelRegisterReturn flightHelmetModel = renderSystem->registerGltfModel(flightHelmet);
-  ModelRegisterReturn lanternModel = renderSystem->registerGltfModel(lantern);
-  ModelRegisterReturn gunModel = renderSystem->registerGltfModel(gun);
-  ModelRegisterReturn sniperModel = renderSystem->registerGltfModel(sniper);
+  // load models, from their model cache after the first run
+  auto loadStart = std::chrono::steady_clock::now();
+  auto registerModel = [this](const char *fileName) {
+    ModelData model;
+    Buffer storage;
+    Loaders::loadModel(model, storage, fileName);
+    return renderSystem->registerModel(model);
+  };
+  ModelRegisterReturn helmetModel = registerModel("resources/meshes/DamagedHelmet.gltf");
+  ModelRegisterReturn flightHelmetModel = registerModel("resources/meshes/FlightHelmet.gltf");
+  ModelRegisterReturn lanternModel = registerModel("resources/meshes/lantern.gltf");
+  ModelRegisterReturn gunModel = registerModel("resources/meshes/gun.gltf");
+  ModelRegisterReturn sniperModel = registerModel("resources/meshes/sniper.gltf");
+  SLOG("Models loaded in",
+       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart)
+           .count(),
+       "ms");
 
   nameToMeshes.emplace("damaged_helmet", appUi.addLoadedMeshes(helmetModel).front());
   nameToMeshes.emplace("lantern_model", appUi.addLoadedMeshes(lanternModel).front());
@@ -96,6 +152,19 @@ App::App(int, char **)
       }
     }
   });
+  // F5 saves the current scene, F9 restores it without rebuilding from glTF
+  input.addKeyCallback(Input::Key::F5, [this](const Input::KeyEvent &event) {
+    if (event.action == Input::Action::PRESS) saveScene(SCENE_SNAPSHOT_FILE);
+  });
+  input.addKeyCallback(Input::Key::F9, [this](const Input::KeyEvent &event) {
+    if (event.action == Input::Action::PRESS) loadScene(SCENE_SNAPSHOT_FILE);
+  });
+  // F12 writes the trace zones recorded so far
+  if (trace::isEnabled()) {
+    input.addKeyCallback(Input::Key::F12, [](const Input::KeyEvent &event) {
+      if (event.action == Input::Action::PRESS) trace::writeChromeTrace(TRACE_FILE);
+    });
+  }
   input.addKeyCallback(Input::Key::Q, [&input = input](const Input::KeyEvent &event) {
     if (event.action == Input::Action::PRESS) {
       DEBUG_SLOG("KEY PRESSED: ", toUnderlying<Input::Key>(event.key));
@@ -122,6 +191,7 @@ App::App(int, char **)
   appUi.setDiffuseConvMap(diffuseConv.first, diffuseConv.second);
   appUi.setSpecularConvMap(specularConv.first, specularConv.second);
   appUi.setEnvMap(envMap.first, envMap.second);
+  appUi.setFrameTimer(&renderSystem->getFrameTimer());
   // https://stackoverflow.com/questions/38543155/opengl-render-face-of-cube-map-to-a-quad
 
   auto err = glGetError();
@@ -138,8 +208,9 @@ void App::renderSphere() {
   float height = 10.0f;
   float spacing = 2.5f;
 
-  tinygltf::Model model;
-  Loaders::loadModel(model, "resources/meshes/sphere.gltf");
+  ModelData sphere;
+  Buffer sphereStorage;
+  Loaders::loadModel(sphere, sphereStorage, "resources/meshes/sphere.gltf");
 
   for (int i = 0; i < nrRow; ++i) {
     float metallic = i / (float)nrRow;
@@ -151,7 +222,7 @@ void App::renderSphere() {
           glm::vec3(0.0f, 0.0f, 0.0f), metallic, roughness, 1.0f);
 
       // Add world objects
-      ModelRegisterReturn regScene = renderSystem->registerGltfModel(model);
+      ModelRegisterReturn regScene = renderSystem->registerModel(sphere);
       PrimitiveId primId = regScene.primIdToMatId.front().begin()->first;
 
       component::Model model = {regScene.meshIds.front(), {{primId, matId}}};
@@ -226,33 +297,129 @@ void App::renderLantern() {
       component::Light(glm::vec3(0.737f, 0.341f, 0.125f), 300.0f, 300.0f, LightType::POINT_LIGHT));
 }
 
+void App::animateLights(float time) {
+  if (testLight1 != nullptr) {
+    glm::vec3 lightPosition = glm::vec3(10 * cos(time), 10, 10 * sin(time));
+    testLight1->getTransform().position(lightPosition);
+  }
+
+  if (testLight2 != nullptr) {
+    glm::vec3 lightPosition = glm::vec3(16 * sin(time), 10, 16 * cos(time) - 10);
+    testLight2->getTransform().position(lightPosition);
+  }
+}
+
+bool App::saveScene(const char *fileName) {
+  Buffer snapshot = world_system::scene_snapshot::save(*worldSystem);
+  bool saved = Loaders::writeBinaryFile(snapshot, fileName);
+  if (saved) SLOG("Saved scene snapshot:", fileName, snapshot.getSize(), "bytes");
+  return saved;
+}
+
+bool App::loadScene(const char *fileName) {
+  Buffer snapshot;
+  world_system::scene_snapshot::Scene scene;
+  // the current world is kept if the snapshot is invalid
+  if (!Loaders::loadBinaryFile(snapshot, fileName) || !snapshot.isValid() ||
+      !world_system::scene_snapshot::parse(snapshot, scene))
+    return false;
+  worldSystem->clearWorld();
+  testLight1 = nullptr;
+  testLight2 = nullptr;
+  world_system::scene_snapshot::apply(*worldSystem, scene);
+  return true;
+}
+
 void App::processInput(float dt) {
-  bool keyW = input.getKey(Input::Key::W);
-  bool keyA = input.getKey(Input::Key::A);
-  bool keyD = input.getKey(Input::Key::D);
-  bool keyS = input.getKey(Input::Key::S);
+  TRACE_ZONE("App::processInput");
+  processRemoteInput();
+  moveCamera(
+      *camera, [this](Input::Key key) { return input.getKey(key) || remoteKeys[key]; }, dt);
+  for (auto &entry : sessionViews) {
+    SessionView &view = *entry.second;
+    moveCamera(view.camera, [&view](Input::Key key) { return view.keys[key]; }, dt);
+  }
+}
 
-  if (keyW && keyA) {
-    camera->processMovement(CameraMovement::STRAFE_LEFT, dt);
-  } else if (keyW && keyD) {
-    camera->processMovement(CameraMovement::STRAFE_RIGHT, dt);
-  } else if (keyW) {
-    camera->processMovement(CameraMovement::FORWARD, dt);
-  } else if (keyA) {
-    camera->processMovement(CameraMovement::LEFT, dt);
-  } else if (keyD) {
-    camera->processMovement(CameraMovement::RIGHT, dt);
-  } else if (keyS) {
-    camera->processMovement(CameraMovement::BACKWARD, dt);
+void App::processRemoteInput() {
+  using command_protocol::InputKind;
+  CommandDto::InputEvent remote;
+  while (commandServer.tryPopInputQueue(remote)) {
+    const auto &event = remote.event;
+    // sessions with their own camera only move that one
+    auto view = sessionViews.find(remote.sessionId);
+    Camera &target = view != sessionViews.end() ? view->second->camera : *camera;
+    auto &keys = view != sessionViews.end() ? view->second->keys : remoteKeys;
+    switch (event.kind) {
+    case InputKind::KEY:
+      keys[static_cast<Input::Key>(event.code)] =
+          static_cast<Input::Action>(event.action) != Input::Action::RELEASE;
+      break;
+    case InputKind::CURSOR:
+      target.processRotation(event.x, event.y);
+      break;
+    case InputKind::BUTTON:
+      // no remote button bindings yet
+      break;
+    }
+    // latency is measured when the next frame is streamed
+    sessionManager.onInput(remote.sessionId, remote.receiveTime);
+  }
+}
+
+void App::updateSessions() {
+  TRACE_ZONE("App::updateSessions");
+  CommandDto::RTSPConnection connection;
+  // static scenes are mostly identical frames, only the keep alive ones are encoded
+  SessionConfig sessionConfig;
+  sessionConfig.skipUnchanged = true;
+  while (commandServer.tryPopConnectionQueue(connection)) {
+    const SessionId id = connection.sessionId;
+    if (!connection.connect) {
+      sessionManager.disconnect(id);
+      sessionViews.erase(id);
+      continue;
+    }
+    // own cameras start where the main camera is
+    sessionConfig.view = MAIN_VIEW;
+    if (connection.ownCamera && !sessionViews.count(id)) {
+      sessionViews.emplace(id, std::unique_ptr<SessionView>(new SessionView{
+                                   *camera, renderSystem->createViewTarget(), {}}));
+      sessionConfig.view = id;
+    }
+    if (!sessionManager.connect(id, connection.toRtspEndpoint(), sessionConfig) &&
+        sessionConfig.view != MAIN_VIEW)
+      sessionViews.erase(id);
+  }
+}
+
+void App::renderSessionViews() {
+  TRACE_ZONE("App::renderSessionViews");
+  for (ViewId view : sessionManager.getActiveViews()) {
+    auto it = sessionViews.find(view);
+    if (it == sessionViews.end()) continue;
+    auto img = renderSystem->renderView(it->second->camera, *it->second->target);
+    if (img) sessionManager.pushFrame(view, {img, FrameClock::now()});
   }
+}
 
-  camera->update();
+void App::scheduleSystems() {
+  using component::Light, component::Model, component::Transform;
+  // WorldObject callbacks can move any object or change its light
+  scheduler.addSystem("world", ecs::SystemAccess().write<Transform, Light>(),
+                      [this](float dt) { worldSystem->update(dt); });
+  scheduler.addSystem("input", ecs::SystemAccess().mainThread(),
+                      [this](float dt) { processInput(dt); });
+  scheduler.addSystem("lights", ecs::SystemAccess().read<Transform, Light>(),
+                      [this](float) { renderSystem->gatherLights(); });
+  scheduler.addSystem("drawables", ecs::SystemAccess().read<Transform, Model>(),
+                      [this](float) { renderSystem->gatherDrawables(); });
 }
 
 void App::run() {
   DEBUG_SLOG("App running.");
   SLOG("Starting command server.");
-  //  commandServer.start();
+  commandServer.start();
   //  SLOG("Waiting for clients to connect...");
   //  CommandDto::RTSPConnection connectionDto =
   //  commandServer.popConnectionQueue();
@@ -262,12 +429,10 @@ void App::run() {
 }
 
 void App::runRenderLoop(std::string_view renderOutput) {
+  TRACE_THREAD_NAME("render");
   display.showWindow();
-  //  FrameQueue frameQueue;
-  // create & start rtspClient
-  //  RtspClient rtspClient(display.getWidth(), display.getHeight(), frameQueue,
-  //                        renderOutput, true);
-  //  assert(rtspClient.start());
+  // local session, remote ones connect through the command server
+  //  sessionManager.connect(FrameSink::CONFIG_OUTPUT, std::string(renderOutput));
 
   int envMap = 0;
   input.addKeyCallback(Input::Key::H, [&envMap, &renderSystem = renderSystem,
@@ -305,28 +470,23 @@ void App::runRenderLoop(std::string_view renderOutput) {
   float ltf, lt, ct, dt = 0.0f;
   int frameCnt = 0;
   ltf = lt = ct = display.getTime(); // time in seconds
+  auto nextFrame = std::chrono::steady_clock::now();
   while (!display.shouldClose()) {
+    TRACE_ZONE("App::frame");
     // calculate delta time
     ct = display.getTime();
     dt = ct - lt;
     lt = display.getTime();
 
-    gui.newFrame(dt, input, display);
-    appUi.show();
-
-    // rotate light
-
-    if (testLight1 != nullptr) {
-      glm::vec3 lightPosition =
-          glm::vec3(10 * cos(display.getTime()), 10, 10 * sin(display.getTime()));
-      testLight1->getTransform().position(lightPosition);
+    coordinator.dispatchEvents();
+    if (!display.isHeadless()) {
+      TRACE_ZONE("App::gui");
+      gui.newFrame(dt, input, display);
+      appUi.show();
     }
 
-    if (testLight2 != nullptr) {
-      glm::vec3 lightPosition =
-          glm::vec3(16 * sin(display.getTime()), 10, 16 * cos(display.getTime()) - 10);
-      testLight2->getTransform().position(lightPosition);
-    }
+    // rotate light
+    animateLights(display.getTime());
 
     // calculate FPS
     if (ct - ltf >= 1) {
@@ -337,29 +497,167 @@ void App::runRenderLoop(std::string_view renderOutput) {
       frameCnt++;
     }
 
-    processInput(dt);
-    worldSystem->update(dt);
+    scheduler.run(dt);
     auto img = renderSystem->update(dt);
+    updateSessions();
+    if (img && sessionManager.hasSessions())
+      sessionManager.pushFrame(MAIN_VIEW, {img, FrameClock::now()});
 
     // ui state update
+    appUi.setStateChanges(renderSystem->getUnsortedStateChanges(),
+                          renderSystem->getStateChanges());
     AppUi::EditorState editorState = appUi.getEditorState();
     renderSystem->setGridPlaneConfig(editorState.gridPlaneState.scale,
                                      editorState.gridPlaneState.showPlane);
     appUi.setCoordinateSpaceState({camera->getViewMatrix(), renderSystem->getProjectionMatrix(),
-                                   glm::vec4(0.0f, 0.0f, renderWidth, renderHeight),
+                                   glm::vec4(0.0f, 0.0f, config.getRenderWidth(),
+                                             config.getRenderHeight()),
                                    camera->position});
+    // after the ui read the main frame's render stats
+    renderSessionViews();
 
     auto err = glGetError();
     if (err != GL_NO_ERROR) CSLOG("OpenGL ERROR:", err);
     display.update();
     input.update();
     if (appUi.getShouldClose()) display.setShouldClose(true);
+
+    // headless frames aren't paced by vsync, render at the stream rate & idle
+    // without sessions instead of spinning
+    if (display.isHeadless()) {
+      int fps = sessionManager.hasSessions() ? HEADLESS_FPS : HEADLESS_IDLE_FPS;
+      auto now = std::chrono::steady_clock::now();
+      // a late frame starts the next one now instead of catching up
+      nextFrame = std::max(nextFrame + std::chrono::microseconds(1000000 / fps), now);
+      std::this_thread::sleep_until(nextFrame);
+    }
   }
+  if (trace::isEnabled() && trace::writeChromeTrace(TRACE_FILE))
+    CSLOG("Trace written to", TRACE_FILE);
   CSLOG("Closing renderer..");
 } // namespace app
 
+benchmark::Report App::runBenchmark(const benchmark::Config &benchConfig) {
+  using benchmark::CameraKey;
+  using Clock = std::chrono::steady_clock;
+  assert(display.isHeadless() && "Benchmark needs a headless display.");
+  struct BenchScene {
+    const char *name;
+    void (App::*load)();
+    std::vector<CameraKey> path;
+  };
+  // paths start & end at the same pose, frames of any length cover the scene
+  const BenchScene scenes[] = {
+      {"spheres",
+       &App::renderSphere,
+       {{glm::vec3(0.0f, 10.0f, 14.0f), glm::vec3(5.0f, 0.0f, 0.0f)},
+        {glm::vec3(-12.0f, 14.0f, 4.0f), glm::vec3(15.0f, 45.0f, 0.0f)},
+        {glm::vec3(0.0f, 10.0f, -2.0f), glm::vec3(0.0f, 0.0f, 0.0f)},
+        {glm::vec3(12.0f, 6.0f, 4.0f), glm::vec3(-10.0f, -45.0f, 0.0f)},
+        {glm::vec3(0.0f, 10.0f, 14.0f), glm::vec3(5.0f, 0.0f, 0.0f)}}},
+      {"helmets",
+       &App::renderHelments,
+       {{glm::vec3(4.0f, 6.0f, 6.0f), glm::vec3(5.0f, 0.0f, 0.0f)},
+        {glm::vec3(-8.0f, 7.0f, 0.0f), glm::vec3(10.0f, 40.0f, 0.0f)},
+        {glm::vec3(4.0f, 5.0f, -3.0f), glm::vec3(0.0f, 0.0f, 0.0f)},
+        {glm::vec3(16.0f, 7.0f, 0.0f), glm::vec3(10.0f, -40.0f, 0.0f)},
+        {glm::vec3(4.0f, 6.0f, 6.0f), glm::vec3(5.0f, 0.0f, 0.0f)}}},
+      {"lantern",
+       &App::renderLantern,
+       {{glm::vec3(0.0f, 8.0f, 10.0f), glm::vec3(10.0f, 0.0f, 0.0f)},
+        {glm::vec3(-10.0f, 8.0f, 0.0f), glm::vec3(10.0f, 90.0f, 0.0f)},
+        {glm::vec3(0.0f, 8.0f, -10.0f), glm::vec3(10.0f, 180.0f, 0.0f)},
+        {glm::vec3(10.0f, 8.0f, 0.0f), glm::vec3(10.0f, 270.0f, 0.0f)},
+        {glm::vec3(0.0f, 8.0f, 10.0f), glm::vec3(10.0f, 360.0f, 0.0f)}}},
+  };
+
+  benchmark::Report report = {reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                              config.getRenderWidth(), config.getRenderHeight(), "yuv", {}};
+  // frames go to a sink like a session's, or are only converted to YUV
+  std::unique_ptr<FrameSink> sink;
+  Buffer yuvFrame;
+  yuv::Planes planes;
+  if (!benchConfig.encodeOutput.empty()) {
+    sink = FrameSink::create(FrameSink::Type::ENCODER);
+    if (!sink->open({report.width, report.height, int(1.0f / benchConfig.timestep + 0.5f),
+                     benchConfig.encodeOutput})) {
+      CSLOG("Failed to open frame sink", sink->getName(), benchConfig.encodeOutput);
+      return report;
+    }
+    report.encoder = sink->getName();
+  } else {
+    yuvFrame = Buffer(yuv::getFrameSize(yuv::Format::I420, report.width, report.height));
+    planes = yuv::makePlanes(yuvFrame.data(), yuv::Format::I420, report.width, report.height);
+  }
+  auto toMs = [](Clock::duration duration) {
+    return std::chrono::duration<float, std::milli>(duration).count();
+  };
+  const uint readbackPass = toUnderlying(RenderPass::READBACK);
+
+  for (const BenchScene &scene : scenes) {
+    const std::vector<std::string> &names = benchConfig.scenes;
+    if (!names.empty() && std::find(names.begin(), names.end(), scene.name) == names.end())
+      continue;
+    SLOG("Benchmarking", scene.name, benchConfig.frames, "frames");
+    (this->*scene.load)();
+    benchmark::SceneResult result(scene.name, benchConfig.frames);
+    for (int frame = -benchConfig.warmupFrames; frame < benchConfig.frames; ++frame) {
+      TRACE_ZONE("App::benchmarkFrame");
+      // time & camera only depend on the frame, not on how long frames take
+      int step = std::max(frame, 0);
+      float time = step * benchConfig.timestep;
+      CameraKey pose = benchmark::samplePath(
+          scene.path, benchConfig.frames > 1 ? step / float(benchConfig.frames - 1) : 0.0f);
+      camera->position = pose.position;
+      camera->rotation = pose.rotation;
+      animateLights(time);
+      // GPU stats cover the same frames as the others
+      if (frame == 0) renderSystem->setFrameTimingWindow(std::max(benchConfig.frames, 1));
+
+      coordinator.dispatchEvents();
+      auto frameStart = Clock::now();
+      scheduler.run(benchConfig.timestep);
+      auto img = renderSystem->update(benchConfig.timestep);
+      auto frameEnd = Clock::now();
+      if (img) {
+        if (sink) {
+          if (!sink->write(*img)) CSLOG("Failed to write frame to", sink->getName());
+        } else {
+          yuv::convert(*img, yuv::Format::I420, planes, true);
+        }
+      }
+      auto encodeEnd = Clock::now();
+      if (frame < 0) continue;
+
+      result.frameMs.add(toMs(frameEnd - frameStart));
+      result.readbackMs.add(renderSystem->getFrameTimer().getCpuStats(readbackPass).getLast());
+      if (img)
+        result.encodeMs.add(toMs(encodeEnd - frameEnd));
+      else
+        ++result.missedFrames;
+      result.drawCalls.add(renderSystem->getDrawCallCount());
+      result.unsortedStateChanges = renderSystem->getUnsortedStateChanges();
+      result.stateChanges = renderSystem->getStateChanges();
+    }
+    const FrameTimer &frameTimer = renderSystem->getFrameTimer();
+    result.gpuFrameMs = frameTimer.getGpuFrameStats();
+    result.gpuReadbackMs = frameTimer.getGpuStats(readbackPass);
+    report.scenes.push_back(std::move(result));
+  }
+  if (sink) sink->close();
+  renderSystem->setFrameTimingWindow(TimingStats::DEFAULT_WINDOW);
+  worldSystem->clearWorld();
+  testLight1 = nullptr;
+  testLight2 = nullptr;
+  return report;
+}
+
 App::~App() {
   DEBUG_SLOG("App destroyed.");
+  // stops the stream threads & drops queued frames, they hold readback slots
+  sessionManager.disconnectAll();
+  // view targets are GL objects
+  sessionViews.clear();
   delete renderSystem;
   delete camera;
   delete worldSystem;
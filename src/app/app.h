@@ -1,11 +1,14 @@
 #pragma once
 
+#include "app_config.h"
 #include "app_ui.h"
 #include "command_server.h"
 #include "core/shared_queue.h"
 #include "display.h"
+#include "ecs/scheduler.h"
 #include "gui_manager.h"
 #include "input.h"
+#include "session_manager.h"
 #include "types.h"
 #include <asio/thread_pool.hpp>
 #include <map>
@@ -22,6 +25,10 @@ class WorldSystem;
 class WorldObject;
 } // namespace world_system
 namespace app {
+namespace benchmark {
+struct Config;
+struct Report;
+} // namespace benchmark
 
 /**
  * Represents the renderer application, handels and manages WINDOW(Context), ECS
@@ -30,21 +37,45 @@ namespace app {
 class App : NonCopyable {
 public:
   static constexpr uint NUM_THREADS = 2;
+  // headless frame rate, there is no vsync to pace the loop, see runRenderLoop
+  static constexpr int HEADLESS_FPS = SessionConfig().maxFps;
+  // headless frame rate without sessions, only commands & the world are updated
+  static constexpr int HEADLESS_IDLE_FPS = 10;
+  static constexpr const char *SCENE_SNAPSHOT_FILE = "scene.snapshot";
+  // written on F12 & on exit when built with TRACE_ENABLED, see core/trace.h
+  static constexpr const char *TRACE_FILE = "trace.json";
   // lazy init instance
   App(int argc, char **argv);
   ~App();
 
   void run();
   void runRenderLoop(std::string_view renderOutpu);
+  /**
+   * @brief runBenchmark - renders each built-in scene along its camera path,
+   * see benchmark.h. Expects a headless display.
+   */
+  benchmark::Report runBenchmark(const benchmark::Config &benchConfig);
 
   void renderSphere();
   void renderHelments();
   void renderLantern();
   void renderTank();
+  // scene snapshot, see world_system::scene_snapshot
+  bool saveScene(const char *fileName);
+  bool loadScene(const char *fileName);
 
 private:
+  // camera & target of a session with its own camera, see updateSessions
+  struct SessionView;
+
+  // command line options, parsed before the other members are constructed
+  AppConfig &config;
   asio::thread_pool threadPool;
+  // runs ecs systems each frame, independent systems run on threadPool
+  ecs::Scheduler scheduler;
   CommandServer commandServer;
+  // streams to the clients connected through commandServer
+  SessionManager sessionManager;
   Display display;
   Input input;
   GuiManager gui;
@@ -56,8 +87,21 @@ private:
   std::map<std::string, GPUMeshMetaData> nameToMeshes;
   world_system::WorldObject *testLight1;
   world_system::WorldObject *testLight2;
+  // key state of remote clients watching the main camera, see processRemoteInput
+  std::map<Input::Key, bool> remoteKeys;
+  // sessions with their own camera, keyed by their view ie session id
+  std::map<ViewId, std::unique_ptr<SessionView>> sessionViews;
 
+  // moves the test lights of the built-in scenes, time in seconds
+  void animateLights(float time);
   void processInput(float dt);
+  // applies input received by the command server since the last frame
+  void processRemoteInput();
+  // applies pending connect/disconnect requests of the command server
+  void updateSessions();
+  // renders & streams the views of sessions with their own camera
+  void renderSessionViews();
+  void scheduleSystems();
   render_system::RenderSystem *createRenderSystem(int width, int height);
 };
 } // namespace app
@@ -1,8 +1,40 @@
 #include "app_config.h"
+#include <cstdio>
+#include <cstring>
 
 namespace app {
 
-AppConfig::AppConfig() {}
+AppConfig::AppConfig()
+    : headless(false), renderWidth(DEFAULT_RENDER_WIDTH), renderHeight(DEFAULT_RENDER_HEIGHT),
+      commandPort(DEFAULT_COMMAND_PORT) {}
 AppConfig::~AppConfig() {}
 
+AppConfig &AppConfig::parseArgs(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (std::strcmp(arg, "--headless") == 0) {
+      headless = true;
+    } else if (std::strcmp(arg, "--size") == 0 && value) {
+      int width = 0;
+      int height = 0;
+      if (std::sscanf(value, "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+        renderWidth = width;
+        renderHeight = height;
+      } else {
+        SLOG("Invalid --size:", value);
+      }
+      ++i;
+    } else if (std::strcmp(arg, "--port") == 0 && value) {
+      int port = std::atoi(value);
+      if (port > 0 && port <= 0xFFFF)
+        commandPort = port;
+      else
+        SLOG("Invalid --port:", value);
+      ++i;
+    }
+  }
+  return *this;
+}
+
 } // namespace app
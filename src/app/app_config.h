@@ -13,12 +13,36 @@ namespace app {
  */
 class AppConfig : NonCopyable {
 public:
+  static constexpr int DEFAULT_RENDER_WIDTH = 1440;
+  static constexpr int DEFAULT_RENDER_HEIGHT = 1080;
+  static constexpr u16 DEFAULT_COMMAND_PORT = 8003;
+
   static AppConfig &getInstance() {
     static AppConfig instance;
     return instance;
   }
 
+  /**
+   * @brief parseArgs - reads the command line options, unknown ones are ignored
+   *   --headless            no window, renders offscreen through EGL
+   *   --size <W>x<H>        render resolution
+   *   --port <PORT>         command server port, one per renderer instance
+   * @return this config
+   */
+  AppConfig &parseArgs(int argc, char **argv);
+
+  // getters
+  [[nodiscard]] bool isHeadless() const { return headless; }
+  [[nodiscard]] int getRenderWidth() const { return renderWidth; }
+  [[nodiscard]] int getRenderHeight() const { return renderHeight; }
+  [[nodiscard]] u16 getCommandPort() const { return commandPort; }
+
 private:
+  bool headless;
+  int renderWidth;
+  int renderHeight;
+  u16 commandPort;
+
   AppConfig();
   ~AppConfig();
 };
@@ -38,7 +38,7 @@ static uint globalWindowsFlags = ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags
 
 namespace app {
 AppUi::AppUi()
-    : io(ImGui::GetIO()), entities(),
+    : io(ImGui::GetIO()), frameTimer(nullptr), entities(),
       projectionMat(), editorState{{40.0f, true}}, gizmoState{false, false, GizmoMode::TRANSLATION,
                                                               glm::vec3(0.0f), glm::vec2(0.0f)},
       shouldClose(false) {
@@ -495,10 +495,55 @@ void AppUi::showStatsWindow(bool *pclose) {
     avg = std::accumulate(fpsHistory.begin(), fpsHistory.end(), 0.0f) / (float)HISTORY_SIZE;
     ImGui::PlotLines("FPS", fpsHistory.data(), HISTORY_SIZE, 0,
                      ("avg: " + std::to_string(avg)).c_str(), 0.0f, 60.0f, ImVec2(0, 80.0f));
+    if (frameTimer) showPassTimings();
   }
   ImGui::End();
 }
 
+void AppUi::showPassTimings() {
+  if (!ImGui::CollapsingHeader("Render Passes (ms)", ImGuiTreeNodeFlags_DefaultOpen)) return;
+  auto row = [](const char *name, const TimingStats &cpu, const TimingStats &gpu) {
+    ImGui::Text("%s", name);
+    ImGui::NextColumn();
+    for (const TimingStats *stats : {&cpu, &gpu}) {
+      ImGui::Text("%.3f", stats->getAverage());
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", stats->getPercentile(50));
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", stats->getPercentile(95));
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", stats->getPercentile(99));
+      ImGui::NextColumn();
+    }
+  };
+  ImGui::Columns(9, "Render Passes");
+  ImGui::Separator();
+  for (const char *header :
+       {"pass", "cpu avg", "cpu p50", "cpu p95", "cpu p99", "gpu avg", "gpu p50", "gpu p95",
+        "gpu p99"}) {
+    ImGui::Text("%s", header);
+    ImGui::NextColumn();
+  }
+  ImGui::Separator();
+  for (uint pass = 0; pass < frameTimer->getPassCount(); ++pass)
+    row(render_system::getRenderPassName(render_system::RenderPass(pass)),
+        frameTimer->getCpuStats(pass), frameTimer->getGpuStats(pass));
+  ImGui::Separator();
+  row("frame", frameTimer->getCpuFrameStats(), frameTimer->getGpuFrameStats());
+  ImGui::Columns(1);
+  ImGui::Separator();
+
+  const TimingStats &gpuFrame = frameTimer->getGpuFrameStats();
+  std::string overlay = "p95: " + std::to_string(gpuFrame.getPercentile(95));
+  ImGui::PlotLines("GPU Frame", gpuFrame.getSamples().data(), gpuFrame.getWindow(),
+                   gpuFrame.getOffset(), overlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80.0f));
+  ImGui::Text("GPU timings dropped: %zu", frameTimer->getDroppedCount());
+  ImGui::Text("Mesh binds (program/material/vao): %u/%u/%u, unsorted %u/%u/%u",
+              stateChanges.programs, stateChanges.materials, stateChanges.vaos,
+              unsortedStateChanges.programs, unsortedStateChanges.materials,
+              unsortedStateChanges.vaos);
+}
+
 void AppUi::showEntityWinow(bool *pclose) {
   ImGui::Begin("Entity Window", pclose, globalWindowsFlags);
   ImGui::AlignTextToFramePadding();
@@ -806,4 +851,9 @@ void AppUi::receive(const event::EntityChanged &event) {
   }
 }
 
+void AppUi::receive(ecs::Span<const event::EntityChanged> events) {
+  for (const event::EntityChanged &event : events)
+    receive(event);
+}
+
 } // namespace app
@@ -55,6 +55,10 @@ private:
   ImGuiIO &io;
   std::array<float, HISTORY_SIZE> dtHistory;
   std::array<float, HISTORY_SIZE> fpsHistory;
+  // per pass timings of the render system, shown in the stats window
+  const render_system::FrameTimer *frameTimer;
+  render_system::RenderStateChanges unsortedStateChanges;
+  render_system::RenderStateChanges stateChanges;
   std::vector<GPUMeshMetaData> loadedMeshes;
 
   /* Gizmo mode */
@@ -115,6 +119,7 @@ private:
   /* dockable Windows */
   void showRenderSystemWindow(bool *pclose);
   void showStatsWindow(bool *pclose);
+  void showPassTimings();
   void showEntityWinow(bool *pclose);
   void showSettingsWindow(bool *pclose);
 
@@ -141,9 +146,17 @@ public:
   void setSpecularConvMap(uint id, uint target);
   void setBrdfLUT(uint id, uint target);
   void setCoordinateSpaceState(const CoordinateSpaceState &state);
+  void setFrameTimer(const render_system::FrameTimer *timer) { frameTimer = timer; }
+  // mesh pass binds of the last frame, without & with render queue sorting
+  void setStateChanges(const render_system::RenderStateChanges &unsorted,
+                       const render_system::RenderStateChanges &sorted) {
+    unsortedStateChanges = unsorted;
+    stateChanges = sorted;
+  }
   std::vector<GPUMeshMetaData> addLoadedMeshes(const render_system::ModelRegisterReturn &data);
 
   /* Receive Events */
   void receive(const event::EntityChanged &event);
+  void receive(ecs::Span<const event::EntityChanged> events);
 };
 } // namespace app
@@ -0,0 +1,126 @@
+#include "benchmark.h"
+#include "utils/slogger.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace app::benchmark {
+
+namespace {
+// control characters never appear in scene names or GL strings
+void writeString(std::ostream &out, const std::string &value) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') out << '\\';
+    out << c;
+  }
+  out << '"';
+}
+
+void writeTiming(std::ostream &out, const TimingStats &stats) {
+  out << "{\"mean\": " << stats.getAverage() << ", \"p50\": " << stats.getPercentile(50.0f)
+      << ", \"p99\": " << stats.getPercentile(99.0f) << ", \"max\": " << stats.getMax()
+      << ", \"samples\": " << stats.getCount() << "}";
+}
+
+void writeStateChanges(std::ostream &out, const render_system::RenderStateChanges &changes) {
+  out << "{\"programs\": " << changes.programs << ", \"materials\": " << changes.materials
+      << ", \"vaos\": " << changes.vaos << "}";
+}
+
+bool parseInt(const char *value, int min, int &result) {
+  char *end = nullptr;
+  long parsed = std::strtol(value, &end, 10);
+  if (end == value || *end != '\0' || parsed < min || parsed > 1 << 24) return false;
+  result = int(parsed);
+  return true;
+}
+} // namespace
+
+CameraKey samplePath(const std::vector<CameraKey> &path, float t) {
+  assert(!path.empty() && "Camera path without keys.");
+  if (path.size() == 1) return path.front();
+  float position = std::clamp(t, 0.0f, 1.0f) * (path.size() - 1);
+  size_t key = std::min(size_t(position), path.size() - 2);
+  float blend = position - key;
+  const CameraKey &a = path[key];
+  const CameraKey &b = path[key + 1];
+  return {a.position + (b.position - a.position) * blend,
+          a.rotation + (b.rotation - a.rotation) * blend};
+}
+
+bool Config::parseArgs(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    bool valid = true;
+    if (std::strcmp(arg, "--frames") == 0 && value) {
+      valid = parseInt(value, 1, frames);
+    } else if (std::strcmp(arg, "--warmup") == 0 && value) {
+      valid = parseInt(value, 0, warmupFrames);
+    } else if (std::strcmp(arg, "--timestep") == 0 && value) {
+      timestep = std::strtof(value, nullptr);
+      valid = timestep > 0.0f;
+    } else if (std::strcmp(arg, "--output") == 0 && value) {
+      output = value;
+    } else if (std::strcmp(arg, "--encode") == 0 && value) {
+      encodeOutput = value;
+    } else if (std::strcmp(arg, "--scene") == 0 && value) {
+      scenes.emplace_back(value);
+    } else {
+      continue;
+    }
+    if (!valid) {
+      SLOG("Invalid", arg, value);
+      return false;
+    }
+    ++i;
+  }
+  return true;
+}
+
+bool writeJson(std::ostream &out, const Config &config, const Report &report) {
+  out << std::fixed << std::setprecision(3);
+  out << "{\n  \"renderer\": ";
+  writeString(out, report.renderer);
+  out << ",\n  \"width\": " << report.width << ",\n  \"height\": " << report.height
+      << ",\n  \"frames\": " << config.frames << ",\n  \"warmup_frames\": " << config.warmupFrames
+      << ",\n  \"timestep\": " << std::setprecision(6) << config.timestep
+      << std::setprecision(3) << ",\n  \"encoder\": ";
+  writeString(out, report.encoder);
+  out << ",\n  \"scenes\": [";
+  for (size_t i = 0; i < report.scenes.size(); ++i) {
+    const SceneResult &scene = report.scenes[i];
+    out << (i ? ",\n" : "\n") << "    {\"name\": ";
+    writeString(out, scene.name);
+    out << ", \"frames\": " << scene.frames << ", \"missed_frames\": " << scene.missedFrames;
+    out << ",\n     \"frame_ms\": ";
+    writeTiming(out, scene.frameMs);
+    out << ",\n     \"gpu_frame_ms\": ";
+    writeTiming(out, scene.gpuFrameMs);
+    out << ",\n     \"readback_ms\": ";
+    writeTiming(out, scene.readbackMs);
+    out << ",\n     \"gpu_readback_ms\": ";
+    writeTiming(out, scene.gpuReadbackMs);
+    out << ",\n     \"encode_ms\": ";
+    writeTiming(out, scene.encodeMs);
+    out << ",\n     \"draw_calls\": {\"mean\": " << scene.drawCalls.getAverage()
+        << ", \"max\": " << scene.drawCalls.getMax() << "}";
+    out << ",\n     \"state_changes\": {\"unsorted\": ";
+    writeStateChanges(out, scene.unsortedStateChanges);
+    out << ", \"sorted\": ";
+    writeStateChanges(out, scene.stateChanges);
+    out << "}}";
+  }
+  out << "\n  ]\n}\n";
+  return out.good();
+}
+
+bool writeJson(const char *fileName, const Config &config, const Report &report) {
+  std::ofstream file(fileName);
+  return file.is_open() && writeJson(file, config, report);
+}
+} // namespace app::benchmark
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core/timing_stats.h"
+#include "systems/render_system/render_queue.h"
+#include "types.h"
+#include <glm/vec3.hpp>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Deterministic renderer benchmark, see App::runBenchmark & renderer-bench.
+ *
+ * Each built-in scene is rendered headless for a fixed number of frames with a
+ * fixed timestep while the camera flies a scripted path, so two runs render
+ * the same frames and only their cost differs.
+ */
+namespace app::benchmark {
+
+// camera pose, rotation is pitch, yaw, roll in degrees like Camera
+struct CameraKey {
+  glm::vec3 position;
+  glm::vec3 rotation;
+};
+
+/**
+ * @brief samplePath - pose at t of a path through keys spaced evenly in time,
+ * linear between keys
+ * @param t - 0 first key, 1 last key, clamped
+ */
+CameraKey samplePath(const std::vector<CameraKey> &path, float t);
+
+struct Config {
+  static constexpr int DEFAULT_FRAMES = 600;
+  static constexpr int DEFAULT_WARMUP_FRAMES = 30;
+  static constexpr float DEFAULT_TIMESTEP = 1.0f / 60.0f;
+  static constexpr const char *DEFAULT_OUTPUT = "renderer_bench.json";
+
+  int frames = DEFAULT_FRAMES;
+  // rendered before each scene's measured frames, not reported
+  int warmupFrames = DEFAULT_WARMUP_FRAMES;
+  float timestep = DEFAULT_TIMESTEP;
+  // json report
+  std::string output = DEFAULT_OUTPUT;
+  // frames are encoded to this file by a FrameSink, empty only converts them to YUV
+  std::string encodeOutput;
+  // scenes to run, all if empty
+  std::vector<std::string> scenes;
+
+  /**
+   * @brief parseArgs - reads the benchmark options, others are left to AppConfig
+   *   --frames <N>          measured frames per scene
+   *   --warmup <N>          unmeasured frames per scene
+   *   --timestep <S>        seconds per frame
+   *   --output <FILE>       json report
+   *   --encode <FILE>       encode frames to FILE instead of YUV conversion only
+   *   --scene <NAME>        run NAME only, can be repeated
+   * @return false on an invalid value
+   */
+  bool parseArgs(int argc, char **argv);
+};
+
+struct SceneResult {
+  std::string name;
+  int frames = 0;
+  // CPU time of scheduler.run & RenderSystem::update, wall clock
+  TimingStats frameMs;
+  // FrameTimer GPU frame time, frames whose queries were ready in time
+  TimingStats gpuFrameMs;
+  // CPU time of the readback pass
+  TimingStats readbackMs;
+  // FrameTimer GPU time of the readback pass
+  TimingStats gpuReadbackMs;
+  // FrameSink::write or YUV conversion of each read back frame
+  TimingStats encodeMs;
+  TimingStats drawCalls;
+  // mesh pass binds of the last frame, in ECS order & sorted by the render queue
+  render_system::RenderStateChanges unsortedStateChanges;
+  render_system::RenderStateChanges stateChanges;
+  // frames the async readback had not finished yet
+  int missedFrames = 0;
+
+  explicit SceneResult(std::string name, int frames)
+      : name(std::move(name)), frames(frames), frameMs(frames), readbackMs(frames),
+        encodeMs(frames), drawCalls(frames) {}
+};
+
+struct Report {
+  std::string renderer; // GL_RENDERER
+  int width;
+  int height;
+  // "yuv" or the name of the FrameSink
+  std::string encoder;
+  std::vector<SceneResult> scenes;
+};
+
+/**
+ * @brief writeJson - timings are {"mean", "p50", "p99", "max", "samples"} in ms
+ * @return false if the report can't be written
+ */
+bool writeJson(std::ostream &out, const Config &config, const Report &report);
+bool writeJson(const char *fileName, const Config &config, const Report &report);
+} // namespace app::benchmark
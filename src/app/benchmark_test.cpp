@@ -0,0 +1,87 @@
+#include "benchmark.h"
+#include "third_party/catch.hpp"
+#include <sstream>
+
+namespace benchmark_test {
+using namespace app::benchmark;
+
+TEST_CASE("Camera path sampling", "[BENCHMARK]") {
+  std::vector<CameraKey> path = {{glm::vec3(0.0f), glm::vec3(0.0f)},
+                                 {glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(0.0f, 90.0f, 0.0f)},
+                                 {glm::vec3(10.0f, 20.0f, 0.0f), glm::vec3(0.0f, 180.0f, 0.0f)}};
+
+  SECTION("Keys") {
+    REQUIRE(samplePath(path, 0.0f).position == path[0].position);
+    REQUIRE(samplePath(path, 0.5f).position == path[1].position);
+    REQUIRE(samplePath(path, 1.0f).position == path[2].position);
+    REQUIRE(samplePath(path, 1.0f).rotation == path[2].rotation);
+  }
+  SECTION("Between keys") {
+    CameraKey key = samplePath(path, 0.25f);
+    REQUIRE(key.position.x == Approx(5.0f));
+    REQUIRE(key.rotation.y == Approx(45.0f));
+    key = samplePath(path, 0.75f);
+    REQUIRE(key.position.y == Approx(10.0f));
+    REQUIRE(key.rotation.y == Approx(135.0f));
+  }
+  SECTION("Clamped") {
+    REQUIRE(samplePath(path, -1.0f).position == path[0].position);
+    REQUIRE(samplePath(path, 2.0f).position == path[2].position);
+  }
+  SECTION("Single key") { REQUIRE(samplePath({path[1]}, 0.5f).position == path[1].position); }
+}
+
+TEST_CASE("Benchmark options", "[BENCHMARK]") {
+  Config config;
+  SECTION("Defaults") {
+    char *argv[] = {const_cast<char *>("bench")};
+    REQUIRE(config.parseArgs(1, argv));
+    REQUIRE(config.frames == Config::DEFAULT_FRAMES);
+    REQUIRE(config.scenes.empty());
+    REQUIRE(config.encodeOutput.empty());
+  }
+  SECTION("Values, app options are skipped") {
+    const char *args[] = {"bench",  "--size",  "640x480", "--frames", "120", "--scene",
+                          "lantern", "--scene", "spheres", "--output", "out.json"};
+    REQUIRE(config.parseArgs(11, const_cast<char **>(args)));
+    REQUIRE(config.frames == 120);
+    REQUIRE(config.scenes == std::vector<std::string>{"lantern", "spheres"});
+    REQUIRE(config.output == "out.json");
+  }
+  SECTION("Invalid") {
+    const char *args[] = {"bench", "--frames", "0"};
+    REQUIRE_FALSE(config.parseArgs(3, const_cast<char **>(args)));
+  }
+}
+
+TEST_CASE("Benchmark json report", "[BENCHMARK]") {
+  Config config;
+  config.frames = 4;
+  Report report = {"llvmpipe \"test\"", 640, 480, "yuv", {}};
+  SceneResult scene("spheres", config.frames);
+  for (float ms : {1.0f, 2.0f, 3.0f, 10.0f}) {
+    scene.frameMs.add(ms);
+    scene.drawCalls.add(50.0f);
+  }
+  scene.missedFrames = 1;
+  scene.unsortedStateChanges = {40, 49, 49};
+  scene.stateChanges = {2, 49, 3};
+  report.scenes.push_back(scene);
+
+  std::ostringstream out;
+  REQUIRE(writeJson(out, config, report));
+  std::string json = out.str();
+  REQUIRE(json.find("\"renderer\": \"llvmpipe \\\"test\\\"\"") != std::string::npos);
+  REQUIRE(json.find("\"name\": \"spheres\", \"frames\": 4, \"missed_frames\": 1") !=
+          std::string::npos);
+  REQUIRE(json.find("\"frame_ms\": {\"mean\": 4.000, \"p50\": 2.000, \"p99\": 10.000, "
+                    "\"max\": 10.000, \"samples\": 4}") != std::string::npos);
+  REQUIRE(json.find("\"draw_calls\": {\"mean\": 50.000, \"max\": 50.000}") !=
+          std::string::npos);
+  REQUIRE(json.find("\"state_changes\": {\"unsorted\": {\"programs\": 40, \"materials\": 49, "
+                    "\"vaos\": 49}, \"sorted\": {\"programs\": 2, \"materials\": 49, "
+                    "\"vaos\": 3}}}") != std::string::npos);
+  REQUIRE(json.front() == '{');
+  REQUIRE(json.find_last_not_of('\n') == json.rfind('}'));
+}
+} // namespace benchmark_test
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "core/buffer.h"
+#include "types.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+/**
+ * Wire format of the command server, all values in network byte order.
+ *
+ * | u16 bodySize | u8 messageType | u8 clientId | u8 state | body |
+ *
+ * The length prefix lets a connection read whatever is available and split it
+ * into messages without knowing the message types. Messages are decoded in
+ * place, a MessageView points into the receive buffer.
+ *
+ * The server assigns each connection its session, clientId only pairs udp
+ * input datagrams with the connection of the same host that sent a CONNECT
+ * with that id.
+ */
+namespace command_protocol {
+constexpr size_t HEADER_SIZE = 5;
+constexpr size_t MAX_BODY_SIZE = 240;
+constexpr size_t MAX_MESSAGE_SIZE = HEADER_SIZE + MAX_BODY_SIZE;
+// returned by decode for a corrupt header
+constexpr size_t INVALID_MESSAGE = ~size_t(0);
+
+/**
+ * RTSPCOMMAND - state is RTSPState, CONNECT body is RTSPConnectBody
+ * INPUTCOMMAND - batch of InputEvents, also accepted as udp datagrams
+ * PING - echoed back as PONG with the same body, ie to measure latency
+ */
+enum class MessageType : u8 { RTSPCOMMAND = 0x01, INPUTCOMMAND = 0x02, PING = 0x03, PONG = 0x04 };
+enum class RTSPState : u8 { CONNECT = 0x01, DISCONNECT = 0x02 };
+
+inline u16 readU16(const uchar *data) { return u16(data[0] << 8 | data[1]); }
+inline u32 readU32(const uchar *data) {
+  return u32(data[0]) << 24 | u32(data[1]) << 16 | u32(data[2]) << 8 | data[3];
+}
+inline u64 readU64(const uchar *data) { return u64(readU32(data)) << 32 | readU32(data + 4); }
+inline void writeU16(uchar *data, u16 value) {
+  data[0] = uchar(value >> 8);
+  data[1] = uchar(value);
+}
+inline void writeU32(uchar *data, u32 value) {
+  writeU16(data, u16(value >> 16));
+  writeU16(data + 2, u16(value));
+}
+inline void writeU64(uchar *data, u64 value) {
+  writeU32(data, u32(value >> 32));
+  writeU32(data + 4, u32(value));
+}
+// IEEE-754 bits
+inline float readF32(const uchar *data) {
+  u32 bits = readU32(data);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+inline void writeF32(uchar *data, float value) {
+  u32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  writeU32(data, bits);
+}
+
+// a message in a receive buffer, valid until the buffer is compacted
+struct MessageView {
+  MessageType type;
+  u8 clientId;
+  u8 state;
+  u16 bodySize;
+  const uchar *body;
+
+  size_t getSize() const { return HEADER_SIZE + bodySize; }
+};
+
+/**
+ * | u32 ip | u16 port | u8 flags |
+ * flags is optional, bodies without it watch the shared main view
+ * OWN_CAMERA - the session gets its own camera, moved by its input
+ */
+struct RTSPConnectBody {
+  enum Flags : u8 { OWN_CAMERA = 0x01 };
+  static constexpr size_t MIN_SIZE = 6;
+  static constexpr size_t size = 7;
+  u32 ip;
+  u16 port;
+  u8 flags;
+
+  // false if message body is too short
+  static bool decode(const MessageView &message, RTSPConnectBody &body) {
+    if (message.bodySize < MIN_SIZE) return false;
+    body.ip = readU32(message.body);
+    body.port = readU16(message.body + 4);
+    body.flags = message.bodySize > MIN_SIZE ? message.body[6] : 0;
+    return true;
+  }
+  void encode(uchar *out) const {
+    writeU32(out, ip);
+    writeU16(out + 4, port);
+    out[6] = flags;
+  }
+};
+
+/**
+ * | u8 kind | u8 action | s16 code | f32 x | f32 y |
+ * KEY - code is Input::Key, action Input::Action
+ * CURSOR - x, y is the cursor delta, clamped to MAX_CURSOR_DELTA
+ * BUTTON - code is Input::MouseButton, action Input::Action
+ * Events with non finite x or y are rejected, they would corrupt the camera.
+ */
+enum class InputKind : u8 { KEY = 0x01, CURSOR = 0x02, BUTTON = 0x03 };
+struct InputEvent {
+  static constexpr size_t size = 12;
+  static constexpr size_t MAX_BATCH = MAX_BODY_SIZE / size;
+  static constexpr float MAX_CURSOR_DELTA = 4096.0f;
+  InputKind kind;
+  u8 action;
+  s16 code;
+  float x;
+  float y;
+
+  static size_t getCount(const MessageView &message) { return message.bodySize / size; }
+  // false if x or y is not finite, event must be dropped
+  static bool decode(const uchar *data, InputEvent &event) {
+    event.kind = static_cast<InputKind>(data[0]);
+    event.action = data[1];
+    event.code = static_cast<s16>(readU16(data + 2));
+    event.x = readF32(data + 4);
+    event.y = readF32(data + 8);
+    if (!std::isfinite(event.x) || !std::isfinite(event.y)) return false;
+    event.x = std::clamp(event.x, -MAX_CURSOR_DELTA, MAX_CURSOR_DELTA);
+    event.y = std::clamp(event.y, -MAX_CURSOR_DELTA, MAX_CURSOR_DELTA);
+    return true;
+  }
+  void encode(uchar *out) const {
+    out[0] = static_cast<u8>(kind);
+    out[1] = action;
+    writeU16(out + 2, static_cast<u16>(code));
+    writeF32(out + 4, x);
+    writeF32(out + 8, y);
+  }
+};
+
+/**
+ * @brief decode - the first message of data
+ * @return size of the message, 0 if data doesn't hold a whole message yet,
+ * INVALID_MESSAGE if the body is too large
+ */
+inline size_t decode(const uchar *data, size_t size, MessageView &message) {
+  if (size < HEADER_SIZE) return 0;
+  u16 bodySize = readU16(data);
+  if (bodySize > MAX_BODY_SIZE) return INVALID_MESSAGE;
+  if (size < HEADER_SIZE + bodySize) return 0;
+  message.bodySize = bodySize;
+  message.type = static_cast<MessageType>(data[2]);
+  message.clientId = data[3];
+  message.state = data[4];
+  message.body = data + HEADER_SIZE;
+  return message.getSize();
+}
+
+/**
+ * @brief encode - writes a message to out, which must have room for
+ * HEADER_SIZE + bodySize bytes
+ * @return size of the message
+ */
+inline size_t encode(uchar *out, MessageType type, u8 clientId, u8 state,
+                     const uchar *body = nullptr, u16 bodySize = 0) {
+  assert(bodySize <= MAX_BODY_SIZE && "Message body too large.");
+  writeU16(out, bodySize);
+  out[2] = static_cast<u8>(type);
+  out[3] = clientId;
+  out[4] = state;
+  if (bodySize) std::memcpy(out + HEADER_SIZE, body, bodySize);
+  return HEADER_SIZE + bodySize;
+}
+
+/**
+ * @brief The ReceiveBuffer class
+ * Per connection receive buffer, reused for every read. Sockets read into the
+ * free tail, complete messages are taken from the front as views without
+ * copying. Only the trailing partial message is moved to the front when the
+ * tail is too small for another message, so views never wrap.
+ */
+class ReceiveBuffer : NonCopyable {
+public:
+  explicit ReceiveBuffer(size_t capacity) : buffer(capacity), begin(0), end(0), corrupt(false) {
+    assert(capacity >= 2 * MAX_MESSAGE_SIZE && "Receive buffer too small.");
+  }
+
+  uchar *getWritePtr() { return buffer.data() + end; }
+  size_t getWritable() const { return buffer.getSize() - end; }
+  // bytes read into getWritePtr
+  void commit(size_t bytes) {
+    assert(bytes <= getWritable() && "Receive buffer overflow.");
+    end += bytes;
+  }
+
+  // false if there is no complete message, or the stream is corrupt
+  bool next(MessageView &message) {
+    if (corrupt) return false;
+    size_t size = decode(buffer.data() + begin, end - begin, message);
+    if (size == INVALID_MESSAGE) corrupt = true;
+    if (size == 0 || corrupt) return false;
+    begin += size;
+    return true;
+  }
+
+  // invalidates views, call after handling the messages of a read
+  void compact() {
+    if (begin == end) {
+      begin = end = 0;
+    } else if (getWritable() < MAX_MESSAGE_SIZE) {
+      std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+      end -= begin;
+      begin = 0;
+    }
+  }
+
+  // stream can't be split into messages anymore, connection must be closed
+  bool isCorrupt() const { return corrupt; }
+  size_t getPendingSize() const { return end - begin; }
+
+private:
+  Buffer buffer;
+  size_t begin; // first unread byte
+  size_t end;   // end of received data
+  bool corrupt;
+};
+} // namespace command_protocol
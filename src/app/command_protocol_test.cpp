@@ -0,0 +1,151 @@
+#include "command_protocol.h"
+#include "third_party/catch.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace command_protocol_test {
+using namespace command_protocol;
+
+std::vector<uchar> makeStream(int pings) {
+  std::vector<uchar> stream;
+  uchar message[MAX_MESSAGE_SIZE];
+  uchar body[RTSPConnectBody::size];
+  RTSPConnectBody{0x7F000001, 8554, RTSPConnectBody::OWN_CAMERA}.encode(body);
+  size_t size = encode(message, MessageType::RTSPCOMMAND, 3, u8(RTSPState::CONNECT), body,
+                       sizeof(body));
+  stream.insert(stream.end(), message, message + size);
+  for (int i = 0; i < pings; ++i) {
+    uchar timestamp[8];
+    writeU64(timestamp, u64(i) << 40 | i);
+    size = encode(message, MessageType::PING, 3, 0, timestamp, sizeof(timestamp));
+    stream.insert(stream.end(), message, message + size);
+  }
+  size = encode(message, MessageType::RTSPCOMMAND, 3, u8(RTSPState::DISCONNECT));
+  stream.insert(stream.end(), message, message + size);
+  return stream;
+}
+
+// feeds stream in reads of chunkSize, like a socket would
+std::vector<MessageView> receive(ReceiveBuffer &receiveBuffer, const std::vector<uchar> &stream,
+                                 size_t chunkSize, std::vector<u64> &pings) {
+  std::vector<MessageView> messages;
+  for (size_t offset = 0; offset < stream.size();) {
+    size_t size = std::min({chunkSize, stream.size() - offset, receiveBuffer.getWritable()});
+    std::memcpy(receiveBuffer.getWritePtr(), stream.data() + offset, size);
+    receiveBuffer.commit(size);
+    offset += size;
+    MessageView message;
+    while (receiveBuffer.next(message)) {
+      // views are only valid until compact
+      if (message.type == MessageType::PING) pings.push_back(readU64(message.body));
+      messages.push_back(message);
+    }
+    receiveBuffer.compact();
+  }
+  return messages;
+}
+
+TEST_CASE("Command protocol splits reads into messages.", "[COMMAND_PROTOCOL]") {
+  auto stream = makeStream(500);
+  for (size_t chunkSize : {size_t(1), size_t(7), size_t(4096), stream.size()}) {
+    ReceiveBuffer receiveBuffer(1024);
+    std::vector<u64> pings;
+    auto messages = receive(receiveBuffer, stream, chunkSize, pings);
+    REQUIRE(messages.size() == 502);
+    REQUIRE(messages.front().type == MessageType::RTSPCOMMAND);
+    REQUIRE(messages.back().type == MessageType::RTSPCOMMAND);
+    REQUIRE(messages.back().state == u8(RTSPState::DISCONNECT));
+    REQUIRE(messages.back().bodySize == 0);
+    REQUIRE(pings.size() == 500);
+    for (size_t i = 0; i < pings.size(); ++i)
+      REQUIRE(pings[i] == (u64(i) << 40 | i));
+    REQUIRE(receiveBuffer.getPendingSize() == 0);
+    REQUIRE_FALSE(receiveBuffer.isCorrupt());
+  }
+}
+
+TEST_CASE("Command protocol decodes in place.", "[COMMAND_PROTOCOL]") {
+  auto stream = makeStream(0);
+  MessageView message;
+  REQUIRE(decode(stream.data(), HEADER_SIZE, message) == 0);
+  REQUIRE(decode(stream.data(), stream.size(), message) == HEADER_SIZE + RTSPConnectBody::size);
+  REQUIRE(message.body == stream.data() + HEADER_SIZE);
+  REQUIRE(message.clientId == 3);
+  RTSPConnectBody body;
+  REQUIRE(RTSPConnectBody::decode(message, body));
+  REQUIRE(body.ip == 0x7F000001);
+  REQUIRE(body.port == 8554);
+  REQUIRE(body.flags == RTSPConnectBody::OWN_CAMERA);
+
+  // flags are optional
+  uchar withoutFlags[MAX_MESSAGE_SIZE];
+  size_t withoutFlagsSize = encode(withoutFlags, MessageType::RTSPCOMMAND, 3,
+                                   u8(RTSPState::CONNECT), message.body, RTSPConnectBody::MIN_SIZE);
+  REQUIRE(decode(withoutFlags, withoutFlagsSize, message) == withoutFlagsSize);
+  REQUIRE(RTSPConnectBody::decode(message, body));
+  REQUIRE(body.port == 8554);
+  REQUIRE(body.flags == 0);
+
+  // disconnect has no body
+  decode(stream.data(), stream.size(), message);
+  size_t size = decode(stream.data() + message.getSize(), HEADER_SIZE, message);
+  REQUIRE(size == HEADER_SIZE);
+  REQUIRE_FALSE(RTSPConnectBody::decode(message, body));
+}
+
+TEST_CASE("Command protocol encodes input batches.", "[COMMAND_PROTOCOL]") {
+  std::vector<InputEvent> events = {{InputKind::KEY, 1, 87, 0.0f, 0.0f},
+                                    {InputKind::CURSOR, 0, 0, -3.5f, 1e-3f},
+                                    {InputKind::BUTTON, 0, 1, 0.0f, 0.0f},
+                                    {InputKind::KEY, 0, -1, 0.0f, 0.0f}};
+  uchar body[InputEvent::size * 4];
+  for (size_t i = 0; i < events.size(); ++i)
+    events[i].encode(body + i * InputEvent::size);
+  uchar data[MAX_MESSAGE_SIZE];
+  size_t size = encode(data, MessageType::INPUTCOMMAND, 9, 0, body, sizeof(body));
+
+  MessageView message;
+  REQUIRE(decode(data, size, message) == size);
+  REQUIRE(InputEvent::getCount(message) == events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    InputEvent event;
+    REQUIRE(InputEvent::decode(message.body + i * InputEvent::size, event));
+    REQUIRE(event.kind == events[i].kind);
+    REQUIRE(event.action == events[i].action);
+    REQUIRE(event.code == events[i].code);
+    // bit exact
+    REQUIRE(std::memcmp(&event.x, &events[i].x, sizeof(float)) == 0);
+    REQUIRE(std::memcmp(&event.y, &events[i].y, sizeof(float)) == 0);
+  }
+}
+
+TEST_CASE("Command protocol rejects non finite cursor deltas.", "[COMMAND_PROTOCOL]") {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float inf = std::numeric_limits<float>::infinity();
+  uchar data[InputEvent::size];
+  InputEvent event;
+  for (float value : {nan, inf, -inf}) {
+    InputEvent{InputKind::CURSOR, 0, 0, value, 1.0f}.encode(data);
+    REQUIRE_FALSE(InputEvent::decode(data, event));
+    InputEvent{InputKind::CURSOR, 0, 0, 1.0f, value}.encode(data);
+    REQUIRE_FALSE(InputEvent::decode(data, event));
+  }
+
+  // huge deltas are clamped
+  InputEvent{InputKind::CURSOR, 0, 0, 1e30f, -1e30f}.encode(data);
+  REQUIRE(InputEvent::decode(data, event));
+  REQUIRE(event.x == InputEvent::MAX_CURSOR_DELTA);
+  REQUIRE(event.y == -InputEvent::MAX_CURSOR_DELTA);
+}
+
+TEST_CASE("Command protocol rejects oversized messages.", "[COMMAND_PROTOCOL]") {
+  ReceiveBuffer receiveBuffer(1024);
+  uchar header[HEADER_SIZE] = {0xFF, 0xFF, u8(MessageType::PING), 0, 0};
+  std::memcpy(receiveBuffer.getWritePtr(), header, sizeof(header));
+  receiveBuffer.commit(sizeof(header));
+  MessageView message;
+  REQUIRE_FALSE(receiveBuffer.next(message));
+  REQUIRE(receiveBuffer.isCorrupt());
+}
+} // namespace command_protocol_test
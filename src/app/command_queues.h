@@ -1,23 +1,45 @@
 #pragma once
 
+#include "command_protocol.h"
+#include "core/ring_buffer.h"
 #include "core/shared_queue.h"
 #include "types.h"
+#include <chrono>
 #include <string>
 
 namespace CommandDto {
+// plain values, the server doesn't allocate while decoding
 struct RTSPConnection {
-  std::string ip;
+  u32 ip; // ipv4, host byte order
   u16 port;
+  // assigned by the server per connection, never the id a client sends
+  u32 sessionId;
+  bool connect; // false - disconnect request, ip & port are not set
+  bool ownCamera; // session watches its own camera instead of the main one
 
-  RTSPConnection(std::string ip, u16 port) : ip(ip), port(port) {}
-  RTSPConnection() : ip(""), port(0) {}
+  RTSPConnection(u32 ip, u16 port, u32 sessionId = 0, bool connect = true,
+                 bool ownCamera = false)
+      : ip(ip), port(port), sessionId(sessionId), connect(connect), ownCamera(ownCamera) {}
+  RTSPConnection() : ip(0), port(0), sessionId(0), connect(true), ownCamera(false) {}
 
   std::string toRtspEndpoint() const {
-    return "rtsp://" + ip + ":" + std::to_string(port) + "/renderstream";
+    return "rtsp://" + std::to_string(ip >> 24) + "." + std::to_string((ip >> 16) & 0xFF) + "." +
+           std::to_string((ip >> 8) & 0xFF) + "." + std::to_string(ip & 0xFF) + ":" +
+           std::to_string(port) + "/renderstream";
   }
 };
+
+struct InputEvent {
+  u32 sessionId; // of the connection it arrived on
+  command_protocol::InputEvent event;
+  // when the server decoded it, start of the input to photon latency
+  std::chrono::steady_clock::time_point receiveTime;
+};
 } // namespace CommandDto
 
 struct CommandQueues {
+  static constexpr size_t INPUT_QUEUE_SIZE = 1024;
   SharedQueue<CommandDto::RTSPConnection> connectionQueue;
+  // io threads push, render thread pops without locking
+  RingBuffer<CommandDto::InputEvent> inputQueue{INPUT_QUEUE_SIZE, OverflowPolicy::DROP_NEWEST};
 };
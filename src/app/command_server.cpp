@@ -1,175 +1,217 @@
 #include "command_server.h"
-#include "core/serializer.h"
+#include "command_protocol.h"
+#include "core/trace.h"
 #include "utils/slogger.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 
 using namespace asio;
 using namespace asio::ip;
 
 namespace app {
-// connection receiving buffer size
-namespace ReceiveBufferSize {
-// static constexpr uint MIN_BUFFER_SIZE = 8;
-// static constexpr uint MAX_BUFFER_SIZE = 15;
-static constexpr uint MAX_BODY_SIZE = 12;
-static constexpr uint HEADER_SIZE = 3;
-} // namespace ReceiveBufferSize
-
-// connection message header
-struct MessageHeader {
-  enum class Type : u8 { RTSPCOMMAND = 0x01, INPUTCOMMAND = 0x02 };
-
-  u8 messageType;
-  u8 clientId;
-  u8 state;
-};
+using namespace command_protocol;
+// many messages fit in one read
+static constexpr size_t RECEIVE_BUFFER_SIZE = 16 * 1024;
+static constexpr size_t MAX_DATAGRAM_SIZE = 1472; // single ethernet frame
 
-// conection message body types (depends on header)
-enum class RTSPHeaderState : u8 { CONNECT = 0x01, DISCONNECT = 0x02 };
-namespace MessageBody {
-struct RTSPConnectBody {
-  static constexpr size_t size = 6;
-  u32 ip;
-  u16 port;
-};
-}; // namespace MessageBody
+// stamped on arrival, same for tcp & udp
+static void pushInputEvents(const MessageView &message, u32 sessionId,
+                            CommandQueues &commandQueues) {
+  const auto receiveTime = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < InputEvent::getCount(message); ++i) {
+    CommandDto::InputEvent input = {sessionId, {}, receiveTime};
+    if (!InputEvent::decode(message.body + i * InputEvent::size, input.event)) continue;
+    // full, dropped & counted by the queue
+    commandQueues.inputQueue.pushBack(input);
+  }
+}
 
 class CommandServer::Connection
     : public std::enable_shared_from_this<Connection> {
 public:
-  Connection(io_service &ios, CommandQueues &commandQueues)
-      : commandQueues(commandQueues), sock(ios), strand(ios),
-        headerBuf(ReceiveBufferSize::HEADER_SIZE),
-        bodyBuf(ReceiveBufferSize::MAX_BODY_SIZE) {
-    headerBuf.clear();
-    bodyBuf.clear();
-  }
+  Connection(io_service &ios, CommandQueues &commandQueues, u32 sessionId)
+      : commandQueues(commandQueues), sessionId(sessionId), sock(ios), strand(ios),
+        receiveBuffer(RECEIVE_BUFFER_SIZE), sendBuffer(RECEIVE_BUFFER_SIZE),
+        sendSize(0), clientId(-1) {}
   ~Connection() { DEBUG_SLOG("Connection destoryed."); }
 
   std::shared_ptr<Connection> getPtr() { return shared_from_this(); }
 
   tcp::socket &getSocket() { return sock; }
+  u32 getSessionId() const { return sessionId; }
+  // set by handleAccept, only read on the server strand
+  const address &getRemoteAddress() const { return remoteAddress; }
+  void setRemoteAddress(const address &remote) { remoteAddress = remote; }
+  // true if datagrams from sender with this client id belong to the connection
+  bool ownsDatagram(const address &sender, u8 datagramClientId) const {
+    return sender == remoteAddress && clientId.load() == datagramClientId;
+  }
 
-  void start() { readHeader(); }
+  void start() { readSome(); }
 
   void close() {
-    asio::bind_executor(strand,
-                        [t = shared_from_this()]() { t->sock.close(); });
+    asio::post(strand, [t = shared_from_this()]() {
+      error_code ec;
+      t->sock.close(ec);
+    });
   }
 
 private:
   CommandQueues &commandQueues;
+  const u32 sessionId;
+  address remoteAddress;
   tcp::socket sock;
   io_context::strand strand;
-  Serializer &serializer = Serializer::getInstance();
-  Buffer headerBuf;
-  Buffer bodyBuf;
+  ReceiveBuffer receiveBuffer;
+  // replies to the messages of one read, never larger than the read
+  Buffer sendBuffer;
+  size_t sendSize;
+  // id the client picked for its messages, -1 until the first CONNECT
+  std::atomic<int> clientId;
 
-  void readHeader() {
-    async_read(
-        sock, buffer(headerBuf.data(), headerBuf.getSize()),
+  void readSome() {
+    sock.async_read_some(
+        buffer(receiveBuffer.getWritePtr(), receiveBuffer.getWritable()),
         asio::bind_executor(
-            strand, std::bind(&Connection::handleReadHeader, shared_from_this(),
+            strand, std::bind(&Connection::handleRead, shared_from_this(),
                               std::placeholders::_1, std::placeholders::_2)));
   }
 
-  void readBody(const MessageHeader &messageHeader) {
-    // process header
-    const auto messageType =
-        static_cast<MessageHeader::Type>(messageHeader.messageType);
-    size_t bodySize = ReceiveBufferSize::MAX_BODY_SIZE;
-    switch (messageType) {
-    case MessageHeader::Type::RTSPCOMMAND: {
-      const auto commandState =
-          static_cast<RTSPHeaderState>(messageHeader.state);
-      if (commandState == RTSPHeaderState::CONNECT) {
-        bodySize = MessageBody::RTSPConnectBody::size;
-      } else {
-        bodySize = 0;
-        // TODO: server command queue
-      }
-    } break;
-
-    default:
-      // invalid messageType
-      CSLOG("Invalid messageType", messageHeader.messageType, "received.");
-      bodySize = 0;
-    }
-    if (bodySize)
-      async_read(
-          sock, buffer(bodyBuf.data(), bodySize),
-          asio::bind_executor(
-              strand, std::bind(&Connection::handleReadBody, shared_from_this(),
-                                std::placeholders::_1, std::placeholders::_2,
-                                bodySize, messageType)));
-  }
-
-  void handleReadHeader(const error_code &ec, const size_t bytesTransferred) {
+  void handleRead(const error_code &ec, const size_t bytesTransferred) {
+    TRACE_ZONE("Connection::handleRead");
     if (ec == error::eof || ec == error::connection_reset) {
       CSLOG("Client disconnected.");
+      closed();
+      return;
     } else if (ec) {
       CSLOG("Connection Error: ", ec.message());
-    } else if (bytesTransferred != ReceiveBufferSize::HEADER_SIZE) {
-      CSLOG("Insufficient header data received from client.",
-            sock.remote_endpoint().address().to_string());
-    } else {
-      MessageHeader messageHeader;
-      serializer.unPack(headerBuf, 0, messageHeader.messageType,
-                        messageHeader.clientId, messageHeader.state);
-      headerBuf.clear();
-      readBody(messageHeader);
+      closed();
+      return;
+    }
+    receiveBuffer.commit(bytesTransferred);
+    // every complete message of this read, views point into receiveBuffer
+    MessageView message;
+    while (receiveBuffer.next(message))
+      handleMessage(message);
+    if (receiveBuffer.isCorrupt()) {
+      CSLOG("Invalid message size received, closing connection.");
+      error_code closeEc;
+      sock.close(closeEc);
+      closed();
+      return;
     }
+    receiveBuffer.compact();
+    if (sendSize)
+      writeReplies();
+    else
+      readSome();
   }
 
-  void handleReadBody(const error_code &ec, const size_t bytesTransferred,
-                      size_t bodySize, MessageHeader::Type messageHeaderType) {
-    if (ec == error::eof || ec == error::connection_reset) {
-      CSLOG("Client disconnected.");
-    } else if (ec) {
+  void writeReplies() {
+    async_write(
+        sock, buffer(sendBuffer.data(), sendSize),
+        asio::bind_executor(
+            strand, std::bind(&Connection::handleWrite, shared_from_this(),
+                              std::placeholders::_1)));
+  }
+
+  void handleWrite(const error_code &ec) {
+    TRACE_ZONE("Connection::handleWrite");
+    if (ec) {
       CSLOG("Connection Error: ", ec.message());
-    } else if (bytesTransferred != bodySize) {
-      CSLOG("Insufficient header data received from client.",
-            sock.remote_endpoint().address().to_string());
-    } else {
-      switch (messageHeaderType) {
-      case MessageHeader::Type::RTSPCOMMAND:
-        handleRTSPConnectionRequest();
-        break;
-
-      case MessageHeader::Type::INPUTCOMMAND:
-        // TODO
-        break;
-      }
-      bodyBuf.clear();
-      readHeader();
+      closed();
+      return;
+    }
+    sendSize = 0;
+    readSome();
+  }
+
+  void handleMessage(const MessageView &message) {
+    switch (message.type) {
+    case MessageType::RTSPCOMMAND:
+      handleRTSPCommand(message);
+      break;
+
+    case MessageType::INPUTCOMMAND:
+      pushInputEvents(message, sessionId, commandQueues);
+      break;
+
+    case MessageType::PING:
+      assert(sendSize + message.getSize() <= sendBuffer.getSize() &&
+             "Reply buffer overflow.");
+      sendSize += encode(sendBuffer.data() + sendSize, MessageType::PONG,
+                         message.clientId, message.state, message.body,
+                         message.bodySize);
+      break;
+
+    default:
+      CSLOG("Invalid messageType", u32(message.type), "received.");
     }
   }
 
-  void handleRTSPConnectionRequest() {
-    MessageBody::RTSPConnectBody rtspConnectionBody;
-    serializer.unPack(bodyBuf, 0, rtspConnectionBody.ip,
-                      rtspConnectionBody.port);
-    const auto ipv4 = asio::ip::address_v4(rtspConnectionBody.ip);
+  void handleRTSPCommand(const MessageView &message) {
+    const auto state = static_cast<RTSPState>(message.state);
+    if (state == RTSPState::DISCONNECT) {
+      commandQueues.connectionQueue.pushBack(
+          CommandDto::RTSPConnection(0, 0, sessionId, false));
+      return;
+    }
+    RTSPConnectBody body;
+    if (state != RTSPState::CONNECT || !RTSPConnectBody::decode(message, body)) {
+      CSLOG("Invalid RTSP command received.");
+      return;
+    }
     // connection request
+    clientId = message.clientId;
     commandQueues.connectionQueue.pushBack(
-        CommandDto::RTSPConnection(ipv4.to_string(), rtspConnectionBody.port));
+        CommandDto::RTSPConnection(body.ip, body.port, sessionId, true,
+                                   body.flags & RTSPConnectBody::OWN_CAMERA));
   }
-}; // namespace app
 
-CommandServer::CommandServer(uint port, uint threadPoolSize)
+  // the session streams until the app sees a disconnect, harmless if it
+  // never connected
+  void closed() {
+    commandQueues.connectionQueue.pushBack(
+        CommandDto::RTSPConnection(0, 0, sessionId, false));
+  }
+};
+
+CommandServer::CommandServer(uint port, uint threadPoolSize, bool udpInput)
     : commandQueues(), ios(), acceptor(ios, tcp::endpoint(tcp::v4(), port)),
-      work(make_work_guard(ios)) {
+      strand(ios), udpSocket(ios), datagram(MAX_DATAGRAM_SIZE), work(make_work_guard(ios)),
+      nextSessionId(1) {
+  if (udpInput) {
+    error_code ec;
+    udpSocket.open(udp::v4(), ec);
+    if (!ec) udpSocket.bind(udp::endpoint(udp::v4(), port), ec);
+    if (ec)
+      CSLOG("Failed to open udp input on port", port, ec.message());
+    else
+      receiveDatagram();
+  }
   for (uint i = 0; i < threadPoolSize; ++i) {
-    threads.push_back(std::thread([&ios = ios]() { ios.run(); }));
+    threads.push_back(std::thread([&ios = ios]() {
+      TRACE_THREAD_NAME("command io");
+      ios.run();
+    }));
   }
 }
 
 CommandServer::~CommandServer() {
   work.reset();
-  for (uint i = 0; i < connections.size(); ++i) {
-    auto connection = connections[i].lock();
-    if (connection)
-      connection->close();
-  }
+  // pending accept would keep the threads running, connections is only
+  // touched on the strand since handleAccept adds to it
+  asio::post(strand, [this]() {
+    error_code ec;
+    acceptor.close(ec);
+    udpSocket.close(ec);
+    for (uint i = 0; i < connections.size(); ++i) {
+      auto connection = connections[i].lock();
+      if (connection)
+        connection->close();
+    }
+  });
   for (uint i = 0; i < threads.size(); ++i) {
     threads[i].join();
   }
@@ -177,19 +219,63 @@ CommandServer::~CommandServer() {
 
 void CommandServer::start() {
   auto connection =
-      std::make_shared<CommandServer::Connection>(ios, commandQueues);
-  acceptor.async_accept(connection->getSocket(),
-                        std::bind(&CommandServer::handleAccept, this,
-                                  connection, std::placeholders::_1));
+      std::make_shared<CommandServer::Connection>(ios, commandQueues, nextSessionId++);
+  acceptor.async_accept(
+      connection->getSocket(),
+      asio::bind_executor(strand, std::bind(&CommandServer::handleAccept, this,
+                                            connection, std::placeholders::_1)));
 }
 
 void CommandServer::handleAccept(std::shared_ptr<Connection> connection,
                                  const error_code &ec) {
+  TRACE_ZONE("CommandServer::handleAccept");
   if (!ec) {
     DEBUG_SLOG("A new client connected.");
+    error_code remoteEc;
+    connection->setRemoteAddress(connection->getSocket().remote_endpoint(remoteEc).address());
     connection->start();
+    // closed connections are gone once their handlers finished
+    connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                     [](const auto &weak) { return weak.expired(); }),
+                      connections.end());
     connections.push_back(connection);
   }
-  start();
+  if (acceptor.is_open()) start();
+}
+
+void CommandServer::receiveDatagram() {
+  udpSocket.async_receive_from(
+      buffer(datagram.data(), datagram.size()), udpSender,
+      asio::bind_executor(strand, std::bind(&CommandServer::handleDatagram, this,
+                                            std::placeholders::_1, std::placeholders::_2)));
+}
+
+void CommandServer::handleDatagram(const error_code &ec, size_t bytesTransferred) {
+  TRACE_ZONE("CommandServer::handleDatagram");
+  if (ec == error::operation_aborted || !udpSocket.is_open()) return;
+  // each datagram holds whole messages, lost ones are not resent
+  MessageView message;
+  for (size_t offset = 0; !ec && offset < bytesTransferred;) {
+    size_t size = decode(datagram.data() + offset, bytesTransferred - offset, message);
+    if (size == 0 || size == INVALID_MESSAGE) {
+      CSLOG("Invalid datagram received.");
+      break;
+    }
+    if (message.type == MessageType::INPUTCOMMAND) {
+      // datagrams carry no session, they belong to the connection of the same
+      // host that connected with the same client id, others are dropped
+      std::shared_ptr<Connection> owner;
+      for (uint i = 0; i < connections.size() && !owner; ++i) {
+        owner = connections[i].lock();
+        if (owner && !owner->ownsDatagram(udpSender.address(), message.clientId)) owner.reset();
+      }
+      if (owner)
+        pushInputEvents(message, owner->getSessionId(), commandQueues);
+      else
+        CSLOG("Input datagram without a connection received.");
+    }
+    offset += size;
+  }
+  receiveDatagram();
 }
 } // namespace app
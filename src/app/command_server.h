@@ -10,7 +10,8 @@ class CommandServer {
   class Connection;
 
 public:
-  CommandServer(uint port, uint threadPoolSize);
+  // udpInput - INPUTCOMMAND datagrams are also accepted on port
+  CommandServer(uint port, uint threadPoolSize, bool udpInput = false);
   ~CommandServer();
 
   void start();
@@ -20,14 +21,33 @@ public:
     commandQueues.connectionQueue.popGetFront(dto, discard);
     return dto;
   }
+  // never blocks, false if there is no pending connect/disconnect request
+  bool tryPopConnectionQueue(CommandDto::RTSPConnection &dto) {
+    return commandQueues.connectionQueue.tryPopFront(dto);
+  }
+  // never blocks, remote input in arrival order
+  bool tryPopInputQueue(CommandDto::InputEvent &event) {
+    return commandQueues.inputQueue.tryPopFront(event);
+  }
+  // input events dropped because the render loop didn't keep up
+  size_t getDroppedInputCount() const { return commandQueues.inputQueue.getDroppedCount(); }
 
 private:
   CommandQueues commandQueues;
   asio::io_service ios;
   asio::ip::tcp::acceptor acceptor;
+  // accept, udp receive & close run on it, sockets aren't thread safe
+  asio::io_context::strand strand;
+  asio::ip::udp::socket udpSocket;
+  asio::ip::udp::endpoint udpSender;
+  std::vector<uchar> datagram;
   asio::executor_work_guard<asio::io_context::executor_type> work;
   std::vector<std::thread> threads;
   std::vector<std::weak_ptr<Connection>> connections;
+  // session ids are assigned here, clients can't pick or reuse another's
+  u32 nextSessionId;
   void handleAccept(std::shared_ptr<Connection> connection, const asio::error_code &ec);
+  void receiveDatagram();
+  void handleDatagram(const asio::error_code &ec, size_t bytesTransferred);
 };
 } // namespace app
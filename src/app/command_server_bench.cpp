@@ -0,0 +1,130 @@
+#include "command_protocol.h"
+#include "command_server.h"
+#include "third_party/asio_noexcept.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Load generator for the command server. Each client connects, keeps up to
+ * window PINGs in flight and measures the round trip of every PONG, so the
+ * server parses many messages per read.
+ * Starts a local server unless host & port are given.
+ *
+ * usage: command-server-bench [clients] [messages] [window] [host port]
+ */
+namespace command_server_bench {
+using namespace command_protocol;
+using Clock = std::chrono::steady_clock;
+
+constexpr u16 LOCAL_PORT = 8004;
+
+u64 now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+      .count();
+}
+
+// round trip times in ns, empty if the connection failed
+std::vector<u64> runClient(const asio::ip::tcp::endpoint &endpoint, u8 clientId, int messages,
+                           int window) {
+  asio::io_service ios;
+  asio::ip::tcp::socket sock(ios);
+  asio::error_code ec;
+  sock.connect(endpoint, ec);
+  if (ec) {
+    printf("client %u failed to connect: %s\n", clientId, ec.message().c_str());
+    return {};
+  }
+  sock.set_option(asio::ip::tcp::no_delay(true), ec);
+
+  std::vector<u64> roundTrips;
+  roundTrips.reserve(messages);
+  std::vector<uchar> sendBuffer(size_t(window) * MAX_MESSAGE_SIZE);
+  ReceiveBuffer receiveBuffer(64 * 1024);
+  int sent = 0;
+  while (int(roundTrips.size()) < messages) {
+    // top up the window in one write
+    size_t sendSize = 0;
+    for (; sent < messages && sent - int(roundTrips.size()) < window; ++sent) {
+      uchar timestamp[8];
+      writeU64(timestamp, now());
+      sendSize += encode(sendBuffer.data() + sendSize, MessageType::PING, clientId, 0, timestamp,
+                         sizeof(timestamp));
+    }
+    if (sendSize && asio::write(sock, asio::buffer(sendBuffer.data(), sendSize), ec) != sendSize)
+      break;
+    size_t received = sock.read_some(
+        asio::buffer(receiveBuffer.getWritePtr(), receiveBuffer.getWritable()), ec);
+    if (ec) break;
+    receiveBuffer.commit(received);
+    MessageView message;
+    u64 time = now();
+    while (receiveBuffer.next(message)) {
+      if (message.type == MessageType::PONG && message.bodySize == 8)
+        roundTrips.push_back(time - readU64(message.body));
+    }
+    if (receiveBuffer.isCorrupt()) break;
+    receiveBuffer.compact();
+  }
+  if (int(roundTrips.size()) < messages)
+    printf("client %u stopped after %zu messages: %s\n", clientId, roundTrips.size(),
+           ec.message().c_str());
+  sock.close(ec);
+  return roundTrips;
+}
+
+void run(const asio::ip::tcp::endpoint &endpoint, int clients, int messages, int window) {
+  std::vector<std::vector<u64>> results(clients);
+  std::vector<std::thread> threads;
+  auto start = Clock::now();
+  for (int i = 0; i < clients; ++i)
+    threads.emplace_back([&, i]() { results[i] = runClient(endpoint, u8(i), messages, window); });
+  for (auto &thread : threads)
+    thread.join();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<u64> roundTrips;
+  for (auto &result : results)
+    roundTrips.insert(roundTrips.end(), result.begin(), result.end());
+  if (roundTrips.empty()) return;
+  std::sort(roundTrips.begin(), roundTrips.end());
+  auto percentileUs = [&roundTrips](double p) {
+    return roundTrips[std::min(roundTrips.size() - 1, size_t(p * roundTrips.size()))] / 1000.0;
+  };
+  printf("%8d %8d %12zu %14.0f %10.1f %10.1f %10.1f\n", clients, window, roundTrips.size(),
+         roundTrips.size() / seconds, percentileUs(0.5), percentileUs(0.99),
+         roundTrips.back() / 1000.0);
+}
+} // namespace command_server_bench
+
+int main(int argc, char **argv) {
+  using namespace command_server_bench;
+  int clients = argc > 1 ? atoi(argv[1]) : 4;
+  int messages = argc > 2 ? atoi(argv[2]) : 200000;
+  int window = argc > 3 ? atoi(argv[3]) : 64;
+
+  std::unique_ptr<app::CommandServer> server;
+  asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), LOCAL_PORT);
+  if (argc > 5) {
+    endpoint = asio::ip::tcp::endpoint(asio::ip::make_address_v4(argv[4]), u16(atoi(argv[5])));
+  } else {
+    server = std::make_unique<app::CommandServer>(LOCAL_PORT, 4);
+    server->start();
+  }
+
+  printf("%d messages per client\n", messages);
+  printf("%8s %8s %12s %14s %10s %10s %10s\n", "clients", "window", "messages", "messages/s",
+         "p50(us)", "p99(us)", "max(us)");
+  if (argc > 3) {
+    run(endpoint, clients, messages, window);
+  } else {
+    // latency without pipelining, then throughput
+    run(endpoint, 1, messages / 10, 1);
+    run(endpoint, clients, messages, window);
+  }
+  return 0;
+}
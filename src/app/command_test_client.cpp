@@ -1,5 +1,4 @@
-#include "core/buffer.h"
-#include "core/serializer.h"
+#include "command_protocol.h"
 #include "types.h"
 #include <third_party/asio_noexcept.h>
 #include <third_party/catch.hpp>
@@ -10,25 +9,23 @@ using namespace asio::ip;
 class CommandClient {
 private:
   static constexpr u16 PORT = 8003;
-  Serializer &serializer;
   io_service ios;
   tcp::endpoint ep;
   tcp::socket sock;
 
 public:
   CommandClient()
-      : serializer(Serializer::getInstance()), ios(), ep(address_v4(), PORT),
-        sock(ios, ep.protocol()) {}
+      : ios(), ep(address_v4(), PORT), sock(ios, ep.protocol()) {}
   void connect() { sock.connect(ep); }
 
   bool sendRTSPConnectRequest(u32 ip, u16 port) {
-    Buffer buf(9);
-    error_code ec;
-    u8 messageType = 1;
-    u8 clientId = 1;
-    u8 state = 1;
-    serializer.pack(buf, 0, messageType, clientId, state, ip, port);
-    return asio::write(sock, asio::buffer(buf.data(), buf.getSize())) == 9;
+    using namespace command_protocol;
+    uchar body[RTSPConnectBody::size];
+    RTSPConnectBody{ip, port, 0}.encode(body);
+    uchar message[MAX_MESSAGE_SIZE];
+    size_t size = encode(message, MessageType::RTSPCOMMAND, 1, u8(RTSPState::CONNECT), body,
+                         sizeof(body));
+    return asio::write(sock, asio::buffer(message, size)) == size;
   }
 
   void join() { ios.run(); }
@@ -1,14 +1,40 @@
 #include "display.h"
 #define GLFW_INCLUDE_NONE
 #include "common.h"
+#include "core/trace.h"
 #include "failure_code.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 #include <GLFW/glfw3.h>
+#include <cstring>
 #include <glad/glad.h>
 
 namespace app {
 
-Display::Display(std::string_view title) : title(title), displaySize(0, 0), fboSize(0, 0) {
+namespace {
+bool hasExtension(const char *extensions, const char *extension) {
+  if (!extensions) return false;
+  size_t length = std::strlen(extension);
+  for (const char *it = std::strstr(extensions, extension); it;
+       it = std::strstr(it + length, extension)) {
+    if ((it == extensions || it[-1] == ' ') && (it[length] == ' ' || it[length] == '\0'))
+      return true;
+  }
+  return false;
+}
+} // namespace
+
+Display::Display(std::string_view title, Backend backend, glm::ivec2 size)
+    : title(title), backend(backend), displaySize(size), fboSize(size), window(nullptr),
+      eglDisplay(EGL_NO_DISPLAY), eglContext(EGL_NO_CONTEXT), eglSurface(EGL_NO_SURFACE),
+      closeRequested(false), startTime(std::chrono::steady_clock::now()) {
+  if (backend == Backend::HEADLESS)
+    createHeadlessContext();
+  else
+    createWindow();
+}
 
+void Display::createWindow() {
   glfwSetErrorCallback(
       [](int error, const char *description) { SLOG("[GLFW_CALLBACK]", error, description); });
   // init glfw
@@ -63,7 +89,81 @@ Display::Display(std::string_view title) : title(title), displaySize(0, 0), fboS
   glfwGetFramebufferSize(window, &fboSize.x, &fboSize.y);
 }
 
+void Display::createHeadlessContext() {
+  assert(displaySize.x > 0 && displaySize.y > 0 && "Headless display needs a size.");
+  // surfaceless platform needs neither a window system nor a GPU (llvmpipe)
+  EGLDisplay display = EGL_NO_DISPLAY;
+  auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+      eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (getPlatformDisplay && hasExtension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS),
+                                         "EGL_MESA_platform_surfaceless"))
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  EGLint major = 0;
+  EGLint minor = 0;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor) ||
+      !eglBindAPI(EGL_OPENGL_API)) {
+    SLOG("[EGL] init failed:", eglGetError());
+    assert(false && "Failed to init EGL.");
+    exit(FailureCode::EGL_INIT_FAILURE);
+  }
+  eglDisplay = display;
+  DEBUG_SLOG("[EGL]", major, minor, eglQueryString(display, EGL_VENDOR));
+
+  const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                     EGL_OPENGL_BIT,   EGL_RED_SIZE,     8,
+                                     EGL_GREEN_SIZE,   8,                EGL_BLUE_SIZE,
+                                     8,                EGL_ALPHA_SIZE,   8,
+                                     EGL_DEPTH_SIZE,   24,               EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint configCount = 0;
+  if (eglChooseConfig(display, configAttributes, &config, 1, &configCount) && configCount == 1) {
+    for (int minorVersion : {MINOR_VERSION, HEADLESS_FALLBACK_MINOR_VERSION}) {
+      const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                          MAJOR_VERSION,
+                                          EGL_CONTEXT_MINOR_VERSION,
+                                          minorVersion,
+                                          EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                          EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                          EGL_NONE};
+      eglContext = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+      if (eglContext != EGL_NO_CONTEXT) break;
+    }
+  }
+  if (eglContext != EGL_NO_CONTEXT &&
+      !hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+    // the default framebuffer is never drawn to, the pbuffer only makes the context current
+    const EGLint surfaceAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    eglSurface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+  }
+  if (eglContext == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(display, eglSurface, eglSurface, eglContext)) {
+    SLOG("[EGL] context creation failed:", eglGetError());
+    assert(false && "Failed to create EGL context.");
+    exit(FailureCode::EGL_CREATE_CONTEXT_FAILURE);
+  }
+
+  if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+    assert(false && "Failed to init glad.");
+    exit(FailureCode::GLAD_INIT_FALUIRE);
+  }
+  // 4.5 contexts load the SPIR-V shaders through ARB_gl_spirv
+  if (!glSpecializeShader)
+    glad_glSpecializeShader =
+        (PFNGLSPECIALIZESHADERPROC)eglGetProcAddress("glSpecializeShaderARB");
+  SLOG("[EGL] OpenGL", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+  glViewport(0, 0, displaySize.x, displaySize.y);
+}
+
 Display::~Display() {
+  if (isHeadless()) {
+    eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (eglSurface != EGL_NO_SURFACE) eglDestroySurface(eglDisplay, eglSurface);
+    eglDestroyContext(eglDisplay, eglContext);
+    eglTerminate(eglDisplay);
+    DEBUG_SLOG("Display destoryed.");
+    return;
+  }
   // destory crusors
   for (auto &cursor : mouseCursors) {
     glfwDestroyCursor(cursor.second);
@@ -76,18 +176,41 @@ Display::~Display() {
 }
 
 void Display::update() {
+  if (isHeadless()) return;
+  TRACE_ZONE("Display::update");
   glfwSwapBuffers(window);
   glfwPollEvents();
 }
 
-void Display::setShouldClose(bool close) { glfwSetWindowShouldClose(window, close); }
-void Display::setSwapInterval(int value) { glfwSwapInterval(value); }
-void Display::setCursorShape(CursorShape shape) { glfwSetCursor(window, mouseCursors[shape]); }
+void Display::setShouldClose(bool close) {
+  if (isHeadless())
+    closeRequested = close;
+  else
+    glfwSetWindowShouldClose(window, close);
+}
+void Display::setSwapInterval(int value) {
+  if (!isHeadless()) glfwSwapInterval(value);
+}
+void Display::setCursorShape(CursorShape shape) {
+  if (!isHeadless()) glfwSetCursor(window, mouseCursors[shape]);
+}
 
-float Display::getTime() const { return (float)glfwGetTime(); }
-bool Display::shouldClose() const { return glfwWindowShouldClose(window); }
-bool Display::isFocused() const { return glfwGetWindowAttrib(window, GLFW_FOCUSED); }
+float Display::getTime() const {
+  if (isHeadless())
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+  return (float)glfwGetTime();
+}
+bool Display::shouldClose() const {
+  return isHeadless() ? closeRequested : glfwWindowShouldClose(window);
+}
+bool Display::isFocused() const {
+  return !isHeadless() && glfwGetWindowAttrib(window, GLFW_FOCUSED);
+}
 
-void Display::hideWindow() { glfwHideWindow(window); }
-void Display::showWindow() { glfwShowWindow(window); }
+void Display::hideWindow() {
+  if (!isHeadless()) glfwHideWindow(window);
+}
+void Display::showWindow() {
+  if (!isHeadless()) glfwShowWindow(window);
+}
 } // namespace app
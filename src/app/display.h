@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <glm/glm.hpp>
 #include <map>
 #include <string>
@@ -8,25 +9,52 @@ class GLFWwindow;
 class GLFWcursor;
 namespace app {
 
+/**
+ * @brief The Display class
+ *
+ * Owns the GL context and, for the WINDOW backend, the window it's shown in.
+ *
+ * HEADLESS has no window and needs no X server: the context is created through
+ * EGL (surfaceless if supported, a pbuffer otherwise, both work with Mesa
+ * llvmpipe), rendering goes to FrameBuffer targets only. Swaps, events &
+ * cursors are no-ops and it closes only through setShouldClose.
+ */
 class Display {
 public:
   enum class CursorShape { ARROW, IBEAM, CROSSHAIR, HAND, HRESIZE, VRESIZE };
+  enum class Backend { WINDOW, HEADLESS };
 
 private:
   static constexpr int MAJOR_VERSION = 4;
   static constexpr int MINOR_VERSION = 6;
+  // llvmpipe has 4.5 + ARB_gl_spirv
+  static constexpr int HEADLESS_FALLBACK_MINOR_VERSION = 5;
   static constexpr int CURSOR_SHAPE_COUNT = 6;
 
   std::string title;
+  Backend backend;
   glm::ivec2 displaySize;
   glm::ivec2 fboSize;
   GLFWwindow *window;
   std::map<CursorShape, GLFWcursor *> mouseCursors;
+  // HEADLESS, EGLDisplay, EGLContext & EGLSurface (EGL_NO_SURFACE if surfaceless)
+  void *eglDisplay;
+  void *eglContext;
+  void *eglSurface;
+  bool closeRequested;
+  std::chrono::steady_clock::time_point startTime;
 
   friend class Input;
 
+  void createWindow();
+  void createHeadlessContext();
+
 public:
-  Display(std::string_view title);
+  /**
+   * @param size - HEADLESS display size, WINDOW uses the primary monitor's
+   */
+  Display(std::string_view title, Backend backend = Backend::WINDOW,
+          glm::ivec2 size = glm::ivec2(0, 0));
   ~Display();
 
   // swap buffer & poll events
@@ -46,6 +74,7 @@ public:
   [[nodiscard]] float getTime() const;
   [[nodiscard]] bool shouldClose() const;
   [[nodiscard]] bool isFocused() const;
+  [[nodiscard]] bool isHeadless() const { return backend == Backend::HEADLESS; }
 
   void hideWindow();
   void showWindow();
@@ -0,0 +1,296 @@
+#include "encoder_frame_sink.h"
+#include "core/image.h"
+#include "core/ring_buffer.h"
+#include "utils/slogger.h"
+#include <cassert>
+#include <thread>
+#include <vector>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+}
+
+namespace app {
+
+/**
+ * One muxer (file or rtsp server) fed by the encoder. Packets are reference
+ * counted clones, so fanning out doesn't copy the bitstream. The muxer is
+ * connected & written on the output's thread, a slow or stalled connection
+ * only fills its own queue.
+ */
+class EncoderFrameSink::Output {
+public:
+  Output(const std::string &url, const AVCodecContext *codecContext)
+      : url(url), codecParameters(avcodec_parameters_alloc()),
+        timeBase(codecContext->time_base), formatContext(nullptr), stream(nullptr),
+        packets(OUTPUT_QUEUE_SIZE, OverflowPolicy::DROP_NEWEST), waitKeyFrame(true),
+        discard(false), failed(false), sent(0), dropped(0) {
+    avcodec_parameters_from_context(codecParameters, codecContext);
+    thread = std::thread([this]() { run(); });
+  }
+  ~Output() { close(false); }
+
+  /**
+   * @brief push - called from the encoder thread, never blocks
+   * @return false if the output needs a key frame to continue
+   */
+  bool push(const AVPacket *packet) {
+    if (waitKeyFrame) {
+      if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+        ++dropped;
+        return false;
+      }
+      waitKeyFrame = false;
+    }
+    std::shared_ptr<AVPacket> clone(av_packet_clone(packet),
+                                    [](AVPacket *packet) { av_packet_free(&packet); });
+    if (!clone || !packets.pushBack(clone)) {
+      // later packets reference the dropped one, restart from a key frame
+      waitKeyFrame = true;
+      ++dropped;
+      return false;
+    }
+    return true;
+  }
+
+  // flush - send queued packets & write the trailer, otherwise they are dropped
+  void close(bool flush) {
+    discard = !flush;
+    packets.close();
+    if (thread.joinable()) {
+      thread.join();
+      SLOG("Encoder output", url, "packets", sent, "dropped", dropped + packets.size());
+    }
+    avcodec_parameters_free(&codecParameters);
+  }
+
+  bool hasFailed() const { return failed; }
+
+private:
+  const std::string url;
+  AVCodecParameters *codecParameters;
+  const AVRational timeBase; // of the encoder
+  AVFormatContext *formatContext;
+  AVStream *stream;
+  RingBuffer<std::shared_ptr<AVPacket>> packets;
+  bool waitKeyFrame; // encoder thread only
+  std::atomic<bool> discard; // set by close on the caller's thread
+  std::atomic<bool> failed;
+  size_t sent;
+  size_t dropped;
+  std::thread thread;
+
+  void run() {
+    bool headerWritten = connect();
+    failed = !headerWritten;
+    std::shared_ptr<AVPacket> packet;
+    while (!failed && packets.popGetFront(packet, discard)) {
+      av_packet_rescale_ts(packet.get(), timeBase, stream->time_base);
+      packet->stream_index = stream->index;
+      // takes ownership of the packet data
+      if (av_interleaved_write_frame(formatContext, packet.get()) < 0) {
+        CSLOG("Failed to write packet to", url);
+        failed = true;
+      } else {
+        ++sent;
+      }
+      packet.reset();
+    }
+    if (headerWritten) av_write_trailer(formatContext);
+    if (formatContext) {
+      if (!(formatContext->oformat->flags & AVFMT_NOFILE)) avio_closep(&formatContext->pb);
+      avformat_free_context(formatContext);
+      formatContext = nullptr;
+    }
+  }
+
+  bool connect() {
+    bool isRtsp = url.find("rtsp://") != std::string::npos;
+    avformat_alloc_output_context2(&formatContext, nullptr, isRtsp ? "rtsp" : nullptr,
+                                   url.c_str());
+    if (!formatContext) {
+      CSLOG("Failed to create output context for", url);
+      return false;
+    }
+    stream = avformat_new_stream(formatContext, nullptr);
+    avcodec_parameters_copy(stream->codecpar, codecParameters);
+    stream->time_base = timeBase;
+    if (!(formatContext->oformat->flags & AVFMT_NOFILE) &&
+        avio_open(&formatContext->pb, url.c_str(), AVIO_FLAG_WRITE) < 0) {
+      CSLOG("Failed to open output", url);
+      return false;
+    }
+    AVDictionary *formatOptions = nullptr;
+    if (isRtsp) {
+      av_dict_set(&formatOptions, "rtsp_transport", "udp", 0);
+      av_dict_set(&formatOptions, "rtpflags", "skip_rtcp", 0);
+    }
+    int error = avformat_write_header(formatContext, &formatOptions);
+    av_dict_free(&formatOptions);
+    if (error < 0) {
+      CSLOG("Failed to write header to", url);
+      return false;
+    }
+    return true;
+  }
+};
+
+EncoderFrameSink::EncoderFrameSink()
+    : codecContext(nullptr), frame(nullptr), packet(nullptr), format(yuv::Format::I420),
+      convertBands(1), frameIndex(0), forceKeyFrame(false) {}
+
+bool EncoderFrameSink::open(const FrameSinkConfig &config) {
+  assert(!codecContext && "Frame sink already open.");
+  const AVCodec *codec = avcodec_find_encoder_by_name(config.isNvidia ? "h264_nvenc" : "libx264");
+  if (!codec) {
+    CSLOG("Encoder not found.");
+    return false;
+  }
+  // published under the lock once open, addOutput reads it
+  AVCodecContext *context = avcodec_alloc_context3(codec);
+  context->width = config.width;
+  context->height = config.height;
+  context->time_base = {1, config.fps};
+  context->framerate = {config.fps, 1};
+  context->gop_size = config.fps;
+  context->max_b_frames = 0;
+  format = config.isNvidia ? yuv::Format::NV12 : yuv::Format::I420;
+  context->pix_fmt = config.isNvidia ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+  // slice threads don't add frames of delay like frame threads
+  context->thread_count = 0;
+  context->thread_type = FF_THREAD_SLICE;
+  // outputs are added later, sps/pps must be in extradata for any muxer
+  context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  if (config.maxBitrate > 0) {
+    context->bit_rate = config.maxBitrate;
+    context->rc_max_rate = config.maxBitrate;
+    // half a second of buffering
+    context->rc_buffer_size = config.maxBitrate / 2;
+  }
+
+  AVDictionary *codecOptions = nullptr;
+  av_dict_set(&codecOptions, "preset", "fast", 0);
+  // key frames requested for new/lagging outputs are IDR frames
+  av_dict_set(&codecOptions, "forced-idr", "1", 0);
+  if (config.isNvidia)
+    av_dict_set(&codecOptions, "zerolatency", "1", 0);
+  else
+    av_dict_set(&codecOptions, "tune", "zerolatency", 0);
+  int error = avcodec_open2(context, codec, &codecOptions);
+  av_dict_free(&codecOptions);
+  if (error < 0) {
+    CSLOG("Failed to open encoder", codec->name);
+    avcodec_free_context(&context);
+    return false;
+  }
+
+  frame = av_frame_alloc();
+  frame->format = context->pix_fmt;
+  frame->width = config.width;
+  frame->height = config.height;
+  av_frame_get_buffer(frame, 0);
+  packet = av_packet_alloc();
+  convertBands = config.convertBands;
+  convertExecutor = config.convertExecutor;
+  frameIndex = 0;
+  std::lock_guard<std::mutex> lock(outputsMutex);
+  codecContext = context;
+  if (!config.output.empty()) pendingOutputs.emplace(CONFIG_OUTPUT, config.output);
+  for (auto &output : pendingOutputs)
+    outputs.emplace(output.first, std::make_unique<Output>(output.second, codecContext));
+  pendingOutputs.clear();
+  forceKeyFrame = true;
+  return true;
+}
+
+bool EncoderFrameSink::addOutput(u32 id, const std::string &output) {
+  std::lock_guard<std::mutex> lock(outputsMutex);
+  if (outputs.count(id) || pendingOutputs.count(id)) return false;
+  if (!codecContext) {
+    pendingOutputs.emplace(id, output);
+    return true;
+  }
+  outputs.emplace(id, std::make_unique<Output>(output, codecContext));
+  forceKeyFrame = true;
+  return true;
+}
+
+void EncoderFrameSink::removeOutput(u32 id) {
+  std::unique_ptr<Output> output;
+  {
+    std::lock_guard<std::mutex> lock(outputsMutex);
+    pendingOutputs.erase(id);
+    auto it = outputs.find(id);
+    if (it == outputs.end()) return;
+    output = std::move(it->second);
+    outputs.erase(it);
+  }
+  // joins the output thread, outside the lock so the encoder keeps going
+  output->close(false);
+}
+
+bool EncoderFrameSink::write(const Image &image) {
+  assert(image.getWidth() == codecContext->width && image.getHeight() == codecContext->height &&
+         "Frame size doesn't match sink.");
+  {
+    // nobody is watching, keep the timing but don't encode
+    std::lock_guard<std::mutex> lock(outputsMutex);
+    if (outputs.empty()) return skip();
+  }
+  // encoder may still hold a reference to the previous frame
+  if (av_frame_make_writable(frame) < 0) return false;
+  // rows are bottom-up, flipped while converting
+  yuv::Planes planes = {frame->data[0], frame->data[1], frame->data[2], frame->linesize[0],
+                        frame->linesize[1]};
+  yuv::convert(image, format, planes, true, convertBands, convertExecutor);
+  frame->pts = frameIndex++;
+  frame->pict_type = forceKeyFrame.exchange(false) ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+  return encode(frame);
+}
+
+bool EncoderFrameSink::encode(AVFrame *frame) {
+  if (avcodec_send_frame(codecContext, frame) < 0) return false;
+  while (true) {
+    int error = avcodec_receive_packet(codecContext, packet);
+    if (error == AVERROR(EAGAIN) || error == AVERROR_EOF) return true;
+    if (error < 0) return false;
+    std::vector<std::unique_ptr<Output>> failed;
+    {
+      std::lock_guard<std::mutex> lock(outputsMutex);
+      for (auto it = outputs.begin(); it != outputs.end();) {
+        if (it->second->hasFailed()) {
+          failed.push_back(std::move(it->second));
+          it = outputs.erase(it);
+          continue;
+        }
+        if (!it->second->push(packet)) forceKeyFrame = true;
+        ++it;
+      }
+    }
+    av_packet_unref(packet);
+    for (auto &output : failed)
+      output->close(false);
+  }
+}
+
+void EncoderFrameSink::close() {
+  if (codecContext) encode(nullptr);
+  std::map<u32, std::unique_ptr<Output>> closing;
+  {
+    std::lock_guard<std::mutex> lock(outputsMutex);
+    closing.swap(outputs);
+  }
+  for (auto &output : closing)
+    output.second->close(true);
+  release();
+}
+
+void EncoderFrameSink::release() {
+  av_packet_free(&packet);
+  av_frame_free(&frame);
+  // addOutput reads the codec context
+  std::lock_guard<std::mutex> lock(outputsMutex);
+  avcodec_free_context(&codecContext);
+}
+} // namespace app
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "frame_sink.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+
+namespace app {
+
+/**
+ * @brief The EncoderFrameSink class
+ * Encodes frames in process with libavcodec (libx264 or h264_nvenc) and muxes
+ * them with libavformat to a file or rtsp server. Frames are converted & flipped
+ * (see yuv::convert) straight from the readback buffer into the encoder frame.
+ *
+ * Fans out, each output has its own muxer, packet queue & thread. An output
+ * that can't keep up drops packets until the next key frame (which is then
+ * requested), so it never stalls the encoder or the other outputs.
+ * Only built with FFMPEG_ENABLED.
+ */
+class EncoderFrameSink : public FrameSink {
+public:
+  // packets queued per output before it is considered too slow
+  static constexpr size_t OUTPUT_QUEUE_SIZE = 64;
+
+  EncoderFrameSink();
+  ~EncoderFrameSink() override { close(); }
+
+  // config.output may be empty, outputs can be added later
+  bool open(const FrameSinkConfig &config) override;
+  bool write(const Image &frame) override;
+  // no frame is encoded, the next frame's pts accounts for the gap
+  bool skip() override {
+    ++frameIndex;
+    return true;
+  }
+  void close() override;
+  const char *getName() const override { return "encoder"; }
+
+  bool canFanOut() const override { return true; }
+  // false if id is in use, output is connected on its own thread once open
+  bool addOutput(u32 id, const std::string &output) override;
+  void removeOutput(u32 id) override;
+
+private:
+  class Output;
+
+  AVCodecContext *codecContext;
+  AVFrame *frame;
+  AVPacket *packet;
+  yuv::Format format;
+  uint convertBands;
+  yuv::Executor convertExecutor;
+  s64 frameIndex;
+  // set when an output needs a key frame to (re)start
+  std::atomic<bool> forceKeyFrame;
+  std::mutex outputsMutex;
+  std::map<u32, std::unique_ptr<Output>> outputs;
+  // added before open
+  std::map<u32, std::string> pendingOutputs;
+
+  // send frame (nullptr flushes) and fan out all available packets
+  bool encode(AVFrame *frame);
+  void release();
+};
+} // namespace app
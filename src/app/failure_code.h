@@ -7,5 +7,7 @@ namespace FailureCode {
 constexpr uint GLFW_INIT_FAILURE = 300;
 constexpr uint GLFW_CREATE_WINDOW_FAILURE = 3001;
 constexpr uint GLAD_INIT_FALUIRE = 3002;
+constexpr uint EGL_INIT_FAILURE = 3003;
+constexpr uint EGL_CREATE_CONTEXT_FAILURE = 3004;
 } // namespace FailureCode
 } // namespace app
@@ -0,0 +1,104 @@
+#include "frame_sink.h"
+#include "core/image.h"
+#include "utils/slogger.h"
+#include <cassert>
+#include <csignal>
+#ifdef FFMPEG_ENABLED
+#include "encoder_frame_sink.h"
+#endif
+
+namespace app {
+
+std::unique_ptr<FrameSink> FrameSink::create(Type type) {
+  if (type == Type::ENCODER) {
+#ifdef FFMPEG_ENABLED
+    return std::make_unique<EncoderFrameSink>();
+#else
+    SLOG("Built without FFMPEG_ENABLED, falling back to ffmpeg pipe.");
+#endif
+  }
+  return std::make_unique<PipeFrameSink>();
+}
+
+std::string PipeFrameSink::buildCommand(const FrameSinkConfig &config) {
+  std::string format = "";
+  std::string command;
+  std::string res = std::to_string(config.width) + "x" + std::to_string(config.height);
+  std::string fps = std::to_string(config.fps);
+  if (config.output.find("rtsp://") != std::string::npos) {
+    format = "-rtpflags skip_rtcp -allowed_media_types video -rtsp_transport "
+             "udp -f rtsp ";
+  }
+  if (!config.isNvidia) {
+    command = "ffmpeg -loglevel error -fflags 'nobuffer;flush_packets' -r " + fps +
+              " -f rawvideo "
+              "-pix_fmt yuv420p -s " +
+              res +
+              " -i - "
+              "-tune zerolatency -threads 1 -preset fast -y "
+              "-vsync 1 -r " +
+              fps + " -c:v libx264 ";
+  } else {
+    command = "ffmpeg -loglevel error -fflags 'nobuffer;flush_packets' "
+              "-hwaccel cuda -r " +
+              fps +
+              " -f "
+              "rawvideo -pix_fmt "
+              "nv12 -s " +
+              res +
+              " -i - "
+              "-tune zerolatency -threads 1 -preset fast -y "
+              "-vsync 1 -r " +
+              fps + " -c:v h264_nvenc ";
+  }
+  if (config.maxBitrate) {
+    std::string bitrate = std::to_string(config.maxBitrate);
+    command += "-b:v " + bitrate + " -maxrate " + bitrate + " -bufsize " +
+               std::to_string(config.maxBitrate / 2) + " ";
+  }
+  command += format;
+  command += config.output;
+  return command;
+}
+
+bool PipeFrameSink::open(const FrameSinkConfig &config) {
+  assert(!ffmpegStream && "Frame sink already open.");
+  // if ffmpeg exits, fail the write instead of killing the app with SIGPIPE
+  signal(SIGPIPE, SIG_IGN);
+  // start ffmpeg process
+  ffmpegStream = popen(buildCommand(config).c_str(), "w");
+  if (!ffmpegStream) {
+    CSLOG("Failed to init ffmpeg.");
+    return false;
+  }
+  // flipped & converted here, ffmpeg reads 1.5 instead of 4 bytes per pixel
+  format = config.isNvidia ? yuv::Format::NV12 : yuv::Format::I420;
+  yuvFrame = Buffer(yuv::getFrameSize(format, config.width, config.height));
+  convertBands = config.convertBands;
+  convertExecutor = config.convertExecutor;
+  return true;
+}
+
+bool PipeFrameSink::write(const Image &frame) {
+  assert(yuvFrame.getSize() == yuv::getFrameSize(format, frame.getWidth(), frame.getHeight()) &&
+         "Frame size doesn't match sink.");
+  yuv::convert(frame, format,
+               yuv::makePlanes(yuvFrame.data(), format, frame.getWidth(), frame.getHeight()),
+               true, convertBands, convertExecutor);
+  return fwrite(yuvFrame.data(), sizeof(uchar), yuvFrame.getSize(), ffmpegStream) ==
+         yuvFrame.getSize();
+}
+
+bool PipeFrameSink::skip() {
+  return fwrite(yuvFrame.data(), sizeof(uchar), yuvFrame.getSize(), ffmpegStream) ==
+         yuvFrame.getSize();
+}
+
+void PipeFrameSink::close() {
+  if (ffmpegStream) {
+    // stop ffmpeg
+    pclose(ffmpegStream);
+    ffmpegStream = NULL;
+  }
+}
+} // namespace app
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "core/buffer.h"
+#include "core/yuv_convert.h"
+#include "types.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+
+class Image;
+namespace app {
+
+struct FrameSinkConfig {
+  int width;
+  int height;
+  int fps = 60;
+  // rtsp://... streams, anything else is a file, format is picked from extension
+  std::string output;
+  bool isNvidia = false; // encode with nvenc
+  int maxBitrate = 0;     // bits/s, 0 - encoder default
+  // RGBA to YUV conversion can be split in row bands on convertExecutor
+  uint convertBands = 1;
+  yuv::Executor convertExecutor = nullptr;
+};
+
+/**
+ * @brief The FrameSink class
+ * Consumes rendered frames and encodes/streams them. Frames are RGBA with
+ * 4-byte aligned, bottom-up rows, as read back from GL, the sink flips them.
+ * Not thread safe, RtspClient drives a sink from its own thread.
+ */
+class FrameSink {
+public:
+  /**
+   * PIPE - raw frames are written to an ffmpeg process through popen
+   * ENCODER - in-process libavcodec encoder, needs FFMPEG_ENABLED
+   */
+  enum class Type { PIPE, ENCODER };
+
+  virtual ~FrameSink() = default;
+  virtual bool open(const FrameSinkConfig &config) = 0;
+  /**
+   * @brief write - encode/send a frame of the configured size
+   * @return false on failure, the sink must be closed
+   */
+  virtual bool write(const Image &frame) = 0;
+  /**
+   * @brief skip - the frame is identical to the previous one and was not
+   * written, keeps stream timing
+   */
+  virtual bool skip() { return true; }
+  // flushes pending frames, safe to call if not open
+  virtual void close() = 0;
+  virtual const char *getName() const = 0;
+
+  /**
+   * Fan out - sinks that canFanOut encode once and send the stream to several
+   * outputs, added & removed while the sink runs (thread safe). Others only
+   * send to FrameSinkConfig::output, which fan out sinks add as CONFIG_OUTPUT.
+   */
+  static constexpr u32 CONFIG_OUTPUT = ~0u;
+  virtual bool canFanOut() const { return false; }
+  // starts with the next key frame
+  virtual bool addOutput(u32, const std::string &) { return false; }
+  virtual void removeOutput(u32) {}
+
+  /**
+   * @brief create
+   * @return sink of type, ENCODER falls back to PIPE if built without ffmpeg
+   */
+  static std::unique_ptr<FrameSink> create(Type type);
+};
+
+/**
+ * @brief The PipeFrameSink class
+ * Fallback sink, frames are converted to YUV420 and copied through a pipe to an
+ * ffmpeg process.
+ */
+class PipeFrameSink : public FrameSink {
+public:
+  PipeFrameSink() : ffmpegStream(NULL), format(yuv::Format::I420), convertBands(1) {}
+  ~PipeFrameSink() override { close(); }
+
+  bool open(const FrameSinkConfig &config) override;
+  bool write(const Image &frame) override;
+  // raw input has a fixed rate, the last frame is sent again without converting
+  bool skip() override;
+  void close() override;
+  const char *getName() const override { return "pipe"; }
+
+private:
+  FILE *ffmpegStream; // Input stream to feed ffmpeg
+  yuv::Format format;
+  Buffer yuvFrame; // converted frame, reused
+  uint convertBands;
+  yuv::Executor convertExecutor;
+
+  static std::string buildCommand(const FrameSinkConfig &config);
+};
+} // namespace app
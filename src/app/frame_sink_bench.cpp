@@ -0,0 +1,88 @@
+#include "core/buffer_pool.h"
+#include "core/image.h"
+#include "frame_sink.h"
+#include "rtsp_client.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+/**
+ * File output test mode, measures end-to-end per frame latency of the frame
+ * sinks without a network or GL context.
+ * Synthetic frames are pushed at the target fps to the FrameQueue, like the
+ * render loop does, RtspClient encodes them to a file. Latency is the time from
+ * push until the sink returned.
+ * The idle runs repeat the same frame with unchanged frame skipping enabled.
+ *
+ * usage: frame-sink-bench [frames] [width] [height]
+ */
+namespace frame_sink_bench {
+
+constexpr int FPS = 60;
+
+// moving gradient so the encoder has some work
+void fill(Buffer &buffer, int width, int height, int frame) {
+  uchar *data = buffer.data();
+  for (int y = 0; y < height; ++y) {
+    uchar *row = data + size_t(y) * width * 4;
+    for (int x = 0; x < width; ++x) {
+      row[x * 4 + 0] = uchar(x + frame);
+      row[x * 4 + 1] = uchar(y + frame);
+      row[x * 4 + 2] = uchar(x ^ y);
+      row[x * 4 + 3] = 255;
+    }
+  }
+}
+
+void run(app::FrameSink::Type type, int frames, int width, int height, bool idle) {
+  BufferPool pool;
+  app::FrameQueue frameQueue(app::FRAME_QUEUE_SIZE, app::FRAME_QUEUE_POLICY);
+  auto sink = app::FrameSink::create(type);
+  std::string output = std::string("frame_sink_bench_") + sink->getName() + ".mp4";
+  app::RtspClient client(frameQueue, std::move(sink),
+                         app::FrameSinkConfig{width, height, FPS, output, false});
+  client.setSkipUnchanged(idle);
+  client.start();
+
+  auto period = std::chrono::microseconds(1000000 / FPS);
+  auto next = app::FrameClock::now();
+  for (int i = 0; i < frames; ++i) {
+    Buffer buffer = pool.acquire(size_t(width) * height * 4);
+    fill(buffer, width, height, idle ? 0 : i);
+    auto image = std::make_shared<Image>(std::move(buffer), width, height, 4);
+    frameQueue.pushBack({image, app::FrameClock::now()});
+    next += period;
+    std::this_thread::sleep_until(next);
+  }
+  // let the sink drain the queue
+  while (!frameQueue.isEmpty() && client.isRunning())
+    std::this_thread::sleep_for(period);
+  client.stop();
+
+  auto stats = client.getLatencyStats();
+  auto diffStats = client.getFrameDiffStats();
+  printf("%-10s %-6s %8zu %10zu %8zu %14.2f %14.2f   %s\n", client.getSinkName(),
+         idle ? "idle" : "moving", stats.frames, frameQueue.getDroppedCount(),
+         diffStats.unchangedFrames, stats.avgMs, stats.maxMs, output.c_str());
+}
+} // namespace frame_sink_bench
+
+int main(int argc, char **argv) {
+  using namespace frame_sink_bench;
+  int frames = argc > 1 ? atoi(argv[1]) : 600;
+  int width = argc > 2 ? atoi(argv[2]) : 1440;
+  int height = argc > 3 ? atoi(argv[3]) : 1080;
+
+  printf("%d frames %dx%d at %d fps\n", frames, width, height, FPS);
+  printf("%-10s %-6s %8s %10s %8s %14s %14s\n", "sink", "scene", "frames", "dropped", "skipped",
+         "latency(ms)", "max(ms)");
+  for (bool idle : {false, true}) {
+    run(app::FrameSink::Type::PIPE, frames, width, height, idle);
+#ifdef FFMPEG_ENABLED
+    run(app::FrameSink::Type::ENCODER, frames, width, height, idle);
+#endif
+  }
+  return 0;
+}
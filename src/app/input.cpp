@@ -8,6 +8,8 @@ Input::Input(Display &display)
     : display(display),
       cursorMode(CursorMode::NORMAL), lastCursorPos{display.getDisplaySize().x / 2.0f,
                                                     display.getDisplaySize().y / 2.0f} {
+  // headless displays have no window events, only remote input
+  if (display.isHeadless()) return;
   GLFWwindow *window = display.window;
   //  glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
   glfwSetWindowUserPointer(window, this);
@@ -60,7 +62,8 @@ Input::Input(Display &display)
 void Input::setCursorMode(CursorMode mode) {
   cursorMode = mode;
   if (cursorModeCallback) cursorModeCallback(mode);
-  glfwSetInputMode(display.window, GLFW_CURSOR, toUnderlying<CursorMode>(mode));
+  if (!display.isHeadless())
+    glfwSetInputMode(display.window, GLFW_CURSOR, toUnderlying<CursorMode>(mode));
 }
 
 void Input::toggleCursorMode() {
@@ -71,7 +74,9 @@ void Input::toggleCursorMode() {
   setCursorMode(cursorMode);
 }
 
-void Input::setCursorPos(CursorPos pos) { glfwSetCursorPos(display.window, pos.x, pos.y); }
+void Input::setCursorPos(CursorPos pos) {
+  if (!display.isHeadless()) glfwSetCursorPos(display.window, pos.x, pos.y);
+}
 
 void Input::update() {
   /* CursorPos Events */
@@ -1,6 +1,8 @@
 #include "loaders.h"
 #include "core/buffer.h"
 #include "core/image.h"
+#include "model_cache.h"
+#include "systems/render_system/model_data.h"
 #include "types.h"
 #include "utils/slogger.h"
 
@@ -32,6 +34,33 @@ bool loadModel(tinygltf::Model &model, const char *fileName) {
   return res;
 }
 
+bool loadModel(render_system::ModelData &model, Buffer &storage, const char *fileName) {
+  if (model_cache::open(fileName, storage, model)) {
+    DEBUG_SLOG("Loaded model cache:", fileName);
+    return true;
+  }
+  tinygltf::Model gltfModel;
+  if (!loadModel(gltfModel, fileName)) return false;
+
+  // external files, embedded data uris are hashed with the glTF file
+  std::vector<std::string> dependencies;
+  for (const tinygltf::Buffer &buffer : gltfModel.buffers) {
+    if (!buffer.uri.empty() && buffer.uri.rfind("data:", 0) != 0)
+      dependencies.push_back(buffer.uri);
+  }
+  for (const tinygltf::Image &image : gltfModel.images) {
+    if (!image.uri.empty() && image.uri.rfind("data:", 0) != 0)
+      dependencies.push_back(image.uri);
+  }
+  u64 sourceHash = 0;
+  bool canCache = model_cache::hashSources(fileName, dependencies, sourceHash);
+  // cooking copies the blobs, so model doesn't depend on gltfModel
+  storage = model_cache::cook(render_system::ModelData::fromGltf(gltfModel), dependencies,
+                              sourceHash);
+  if (canCache) writeBinaryFile(storage, model_cache::getCachePath(fileName).c_str());
+  return model_cache::read(storage, model);
+}
+
 bool loadImage(Image &image, const char *fileName, bool isHDR) {
   int width = 0;
   int height = 0;
@@ -82,6 +111,16 @@ bool loadBinaryFile(Buffer &buffer, const char *fileName) {
   }
 }
 
+bool writeBinaryFile(const Buffer &buffer, const char *fileName) {
+  std::ofstream file(fileName, std::ios::binary);
+  file.write((const char *)buffer.data(), buffer.getSize());
+  if (file.fail()) {
+    SLOG("Failed to write binary file:", fileName);
+    return false;
+  }
+  return true;
+}
+
 bool writeImage(std::shared_ptr<Image> image, const char *fileName) {
   int nrChannels = image->getNumChannels();
   int width = image->getWidth();
@@ -8,10 +8,20 @@ class Buffer;
 namespace tinygltf {
 struct Model;
 }
+namespace render_system {
+struct ModelData;
+}
 
 namespace app::Loaders {
 bool loadModel(tinygltf::Model &model, const char *fileName);
+/**
+ * @brief loadModel - loads the model cache of a glTF file (see app::model_cache),
+ * parses the glTF & rebuilds the cache if it is missing or stale
+ * @param storage - owns the memory model points into
+ */
+bool loadModel(render_system::ModelData &model, Buffer &storage, const char *fileName);
 bool loadImage(Image &image, const char *fileName, bool isHDR = false);
 bool loadBinaryFile(Buffer &buffer, const char *fileName);
+bool writeBinaryFile(const Buffer &buffer, const char *fileName);
 bool writeImage(std::shared_ptr<Image> image, const char *fileName);
 }; // namespace app::Loaders
@@ -0,0 +1,364 @@
+#include "model_cache.h"
+#include "core/serializer.h"
+#include "utils/slogger.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace app::model_cache {
+
+using render_system::ModelData;
+
+namespace {
+
+inline u64 rotl(u64 value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+// murmur3 finalizer
+inline u64 mix(u64 h) {
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDull;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ull;
+  return h ^ (h >> 33);
+}
+
+/**
+ * 4 lane multiply-rotate hash over 8-byte words, fast enough to hash the
+ * sources (tens of MB of buffers & images) on every start.
+ */
+u64 hashBytes(const uchar *data, size_t size, u64 seed) {
+  constexpr u64 PRIME1 = 0x9E3779B185EBCA87ull;
+  constexpr u64 PRIME2 = 0xC2B2AE3D27D4EB4Full;
+  u64 acc[4] = {seed + PRIME1, seed ^ PRIME2, seed, seed - PRIME1};
+  size_t offset = 0;
+  for (; offset + 32 <= size; offset += 32) {
+    for (int lane = 0; lane < 4; ++lane) {
+      u64 word;
+      std::memcpy(&word, data + offset + lane * 8, 8);
+      acc[lane] = rotl(acc[lane] + word * PRIME2, 31) * PRIME1;
+    }
+  }
+  u64 h = size + acc[0] + rotl(acc[1], 17) + rotl(acc[2], 31) + rotl(acc[3], 47);
+  for (; offset < size; ++offset)
+    h = (h ^ data[offset]) * PRIME1;
+  return mix(h);
+}
+
+std::string getDirectory(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+/**
+ * Packs values with Serializer into a growing buffer, blobs are only recorded
+ * and are copied once into the final cache.
+ */
+class Writer {
+public:
+  template <typename... T> void pack(const T &...values) {
+    constexpr size_t size = (sizeof(T) + ...);
+    reserve(size);
+    serializer.pack(buffer, used, values...);
+    used += size;
+  }
+
+  void pack(const std::string &value) {
+    pack(u32(value.size()));
+    reserve(value.size());
+    serializer.packArray(buffer, used, reinterpret_cast<const u8 *>(value.data()), value.size());
+    used += value.size();
+  }
+
+  // offset of the blob in the blob region
+  u64 addBlob(const uchar *data, size_t size) {
+    u64 offset = Buffer::align(blobSize, BLOB_ALIGNMENT);
+    blobSize = offset + size;
+    blobs.push_back({data, size, offset});
+    return offset;
+  }
+
+  Buffer finish(u64 sourceHash) {
+    u64 blobOffset = Buffer::align(used, BLOB_ALIGNMENT);
+    Buffer cache(blobOffset + blobSize);
+    std::memset(cache.data(), 0, cache.getSize());
+    std::memcpy(cache.data(), buffer.data(), used);
+    serializer.pack(cache, 0, MAGIC, VERSION, u16(0), sourceHash, blobOffset, blobSize);
+    for (const Blob &blob : blobs) {
+      if (blob.size) std::memcpy(cache.data() + blobOffset + blob.offset, blob.data, blob.size);
+    }
+    return cache;
+  }
+
+  Writer() : buffer(4096), used(HEADER_SIZE), blobSize(0) {}
+
+private:
+  struct Blob {
+    const uchar *data;
+    size_t size;
+    u64 offset;
+  };
+  Serializer &serializer = Serializer::getInstance();
+  Buffer buffer;
+  size_t used;
+  u64 blobSize;
+  std::vector<Blob> blobs;
+
+  void reserve(size_t size) {
+    if (used + size <= buffer.getSize()) return;
+    Buffer bigger(std::max(buffer.getSize() * 2, used + size));
+    std::memcpy(bigger.data(), buffer.data(), used);
+    buffer = std::move(bigger);
+  }
+};
+
+/**
+ * Bounds checked unpacking, reads after the first failure are ignored and
+ * leave isValid() false.
+ */
+class Reader {
+public:
+  explicit Reader(const Buffer &cache) : cache(cache), offset(0), blobOffset(0), blobSize(0) {}
+
+  template <typename... T> void unPack(T &...values) {
+    constexpr size_t size = (sizeof(T) + ...);
+    if (!fits(1, size)) return;
+    serializer.unPack(cache, offset, values...);
+    offset += size;
+  }
+
+  void unPack(std::string &value) {
+    u32 size = 0;
+    unPack(size);
+    if (!fits(size, 1)) return;
+    value.assign(reinterpret_cast<const char *>(cache.data() + offset), size);
+    offset += size;
+  }
+
+  // false if count records of recordSize can't be in the rest of the tables
+  bool fits(u64 count, size_t recordSize) {
+    valid = valid && count <= (cache.getSize() - offset) / recordSize;
+    return valid;
+  }
+
+  bool readHeader(u64 &sourceHash) {
+    u32 magic = 0;
+    u16 version = 0;
+    u16 reserved;
+    unPack(magic, version, reserved, sourceHash, blobOffset, blobSize);
+    valid = valid && magic == MAGIC && version == VERSION && blobOffset >= offset &&
+            blobOffset <= cache.getSize() && blobSize <= cache.getSize() - blobOffset;
+    return valid;
+  }
+
+  const uchar *getBlob(u64 blob, u64 size) {
+    valid = valid && blob <= blobSize && size <= blobSize - blob;
+    return valid ? cache.data() + blobOffset + blob : nullptr;
+  }
+
+  bool isValid() const { return valid; }
+
+private:
+  Serializer &serializer = Serializer::getInstance();
+  const Buffer &cache;
+  size_t offset;
+  u64 blobOffset;
+  u64 blobSize;
+  bool valid = true;
+};
+
+void readDependencies(Reader &reader, std::vector<std::string> &dependencies) {
+  u32 count = 0;
+  reader.unPack(count);
+  if (!reader.fits(count, 4)) return;
+  dependencies.resize(count);
+  for (std::string &dependency : dependencies)
+    reader.unPack(dependency);
+}
+
+// minimum packed size of the records, to reject counts before allocating
+constexpr size_t VIEW_SIZE = 20;
+constexpr size_t ATTRIBUTE_SIZE = 29;
+constexpr size_t PRIMITIVE_SIZE = 36;
+constexpr size_t MESH_SIZE = 12;
+constexpr size_t IMAGE_SIZE = 32;
+constexpr size_t MATERIAL_SIZE = 60;
+} // namespace
+
+std::string getCachePath(const std::string &gltfPath) { return gltfPath + ".cache"; }
+
+bool hashSources(const std::string &gltfPath, const std::vector<std::string> &dependencies,
+                 u64 &hash) {
+  Buffer source;
+  if (!mapFile(source, gltfPath)) return false;
+  hash = hashBytes(source.data(), source.getSize(), VERSION);
+  std::string directory = getDirectory(gltfPath);
+  for (const std::string &dependency : dependencies) {
+    if (!mapFile(source, directory + dependency)) return false;
+    hash = hashBytes(source.data(), source.getSize(), hash);
+  }
+  return true;
+}
+
+Buffer cook(const ModelData &model, const std::vector<std::string> &dependencies, u64 sourceHash) {
+  assert(model.isValid() && "Invalid model data.");
+  Writer writer;
+  writer.pack(u32(dependencies.size()));
+  for (const std::string &dependency : dependencies)
+    writer.pack(dependency);
+
+  writer.pack(model.name);
+  writer.pack(u32(model.views.size()));
+  for (const ModelData::View &view : model.views)
+    writer.pack(view.target, writer.addBlob(view.data, view.size), u64(view.size));
+  writer.pack(u32(model.attributes.size()));
+  for (const ModelData::Attribute &attribute : model.attributes)
+    writer.pack(attribute.location, attribute.size, attribute.componentType,
+                u8(attribute.normalized), attribute.byteStride, attribute.byteOffset,
+                attribute.view);
+  writer.pack(u32(model.primitives.size()));
+  for (const ModelData::Primitive &primitive : model.primitives)
+    writer.pack(primitive.mode, primitive.material, primitive.firstAttribute,
+                primitive.attributeCount, primitive.indexType, primitive.indexCount,
+                primitive.indexOffset, primitive.indexView);
+  writer.pack(u32(model.meshes.size()));
+  for (const ModelData::Mesh &mesh : model.meshes) {
+    writer.pack(mesh.name);
+    writer.pack(mesh.firstPrimitive, mesh.primitiveCount);
+  }
+  writer.pack(u32(model.images.size()));
+  for (const ModelData::Image &image : model.images)
+    writer.pack(image.width, image.height, image.component, image.bits,
+                writer.addBlob(image.pixels, image.size), u64(image.size));
+  writer.pack(u32(model.materials.size()));
+  for (const ModelData::Material &material : model.materials) {
+    writer.pack(material.name);
+    const float *base = material.baseColorFactor;
+    const float *emissive = material.emissiveFactor;
+    writer.pack(base[0], base[1], base[2], base[3], emissive[0], emissive[1], emissive[2],
+                material.metallicFactor, material.roughnessFactor);
+    writer.pack(material.baseColorImage, material.normalImage, material.emissiveImage,
+                material.metallicRoughnessImage, material.occlusionImage);
+  }
+  return writer.finish(sourceHash);
+}
+
+bool readSources(const Buffer &cache, std::vector<std::string> &dependencies, u64 &sourceHash) {
+  Reader reader(cache);
+  if (!reader.readHeader(sourceHash)) return false;
+  readDependencies(reader, dependencies);
+  return reader.isValid();
+}
+
+bool read(const Buffer &cache, ModelData &model) {
+  Reader reader(cache);
+  u64 sourceHash;
+  std::vector<std::string> dependencies;
+  if (!reader.readHeader(sourceHash)) return false;
+  readDependencies(reader, dependencies);
+
+  ModelData result;
+  reader.unPack(result.name);
+  u32 count = 0;
+  reader.unPack(count);
+  if (!reader.fits(count, VIEW_SIZE)) return false;
+  result.views.resize(count);
+  for (ModelData::View &view : result.views) {
+    u64 blob = 0;
+    u64 size = 0;
+    reader.unPack(view.target, blob, size);
+    view.data = reader.getBlob(blob, size);
+    view.size = size;
+  }
+  reader.unPack(count);
+  if (!reader.fits(count, ATTRIBUTE_SIZE)) return false;
+  result.attributes.resize(count);
+  for (ModelData::Attribute &attribute : result.attributes) {
+    u8 normalized = 0;
+    reader.unPack(attribute.location, attribute.size, attribute.componentType, normalized,
+                  attribute.byteStride, attribute.byteOffset, attribute.view);
+    attribute.normalized = normalized;
+  }
+  reader.unPack(count);
+  if (!reader.fits(count, PRIMITIVE_SIZE)) return false;
+  result.primitives.resize(count);
+  for (ModelData::Primitive &primitive : result.primitives)
+    reader.unPack(primitive.mode, primitive.material, primitive.firstAttribute,
+                  primitive.attributeCount, primitive.indexType, primitive.indexCount,
+                  primitive.indexOffset, primitive.indexView);
+  reader.unPack(count);
+  if (!reader.fits(count, MESH_SIZE)) return false;
+  result.meshes.resize(count);
+  for (ModelData::Mesh &mesh : result.meshes) {
+    reader.unPack(mesh.name);
+    reader.unPack(mesh.firstPrimitive, mesh.primitiveCount);
+  }
+  reader.unPack(count);
+  if (!reader.fits(count, IMAGE_SIZE)) return false;
+  result.images.resize(count);
+  for (ModelData::Image &image : result.images) {
+    u64 blob = 0;
+    u64 size = 0;
+    reader.unPack(image.width, image.height, image.component, image.bits, blob, size);
+    image.pixels = reader.getBlob(blob, size);
+    image.size = size;
+  }
+  reader.unPack(count);
+  if (!reader.fits(count, MATERIAL_SIZE)) return false;
+  result.materials.resize(count);
+  for (ModelData::Material &material : result.materials) {
+    reader.unPack(material.name);
+    float *base = material.baseColorFactor;
+    float *emissive = material.emissiveFactor;
+    reader.unPack(base[0], base[1], base[2], base[3], emissive[0], emissive[1], emissive[2],
+                  material.metallicFactor, material.roughnessFactor);
+    reader.unPack(material.baseColorImage, material.normalImage, material.emissiveImage,
+                  material.metallicRoughnessImage, material.occlusionImage);
+  }
+
+  if (!reader.isValid() || !result.isValid()) return false;
+  model = std::move(result);
+  return true;
+}
+
+bool open(const std::string &gltfPath, Buffer &cache, ModelData &model) {
+  const std::string cachePath = getCachePath(gltfPath);
+  Buffer mapped;
+  if (!mapFile(mapped, cachePath)) return false;
+  std::vector<std::string> dependencies;
+  u64 sourceHash = 0;
+  u64 hash = 0;
+  if (!readSources(mapped, dependencies, sourceHash)) {
+    SLOG("Invalid model cache:", cachePath);
+    return false;
+  }
+  if (!hashSources(gltfPath, dependencies, hash) || hash != sourceHash) {
+    SLOG("Stale model cache:", cachePath);
+    return false;
+  }
+  if (!read(mapped, model)) {
+    SLOG("Corrupt model cache:", cachePath);
+    return false;
+  }
+  // moving keeps the mapping, model stays valid
+  cache = std::move(mapped);
+  return true;
+}
+
+bool mapFile(Buffer &buffer, const std::string &fileName) {
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd == -1) return false;
+  struct stat status;
+  if (fstat(fd, &status) == -1 || status.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  size_t size = status.st_size;
+  void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) return false;
+  buffer = Buffer::wrap(static_cast<uchar *>(data), size,
+                        [size](uchar *data) { munmap(data, size); });
+  return true;
+}
+} // namespace app::model_cache
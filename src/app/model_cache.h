@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/buffer.h"
+#include "systems/render_system/model_data.h"
+#include "types.h"
+#include <string>
+#include <vector>
+
+/**
+ * Binary cache of cooked glTF models, so startup maps a file instead of
+ * parsing JSON, buffers and decoding images.
+ *
+ * A cache holds a render_system::ModelData: tables packed with Serializer and
+ * vertex/index/pixel blobs in host layout, 16-byte aligned, ready for upload
+ * straight from the mapping. It also holds a content hash of the glTF file and
+ * the files it references, a cache whose sources changed is stale.
+ *
+ * Layout:
+ *   header       - magic, version, source hash, blob region offset & size
+ *   dependencies - files referenced by the glTF, relative to it
+ *   tables       - name, views, attributes, primitives, meshes, images,
+ *                  materials, blobs are offsets into the blob region
+ *   blobs
+ */
+namespace app::model_cache {
+
+constexpr u32 MAGIC = 0x524D4443; // RMDC
+// bump on any layout change, other versions are rebuilt
+constexpr u16 VERSION = 1;
+constexpr size_t HEADER_SIZE = 32;
+constexpr uint BLOB_ALIGNMENT = 16;
+
+// cache file of a glTF file
+std::string getCachePath(const std::string &gltfPath);
+
+/**
+ * @brief hashSources - content hash of the glTF file and its dependencies
+ * @param dependencies - paths relative to the glTF file
+ * @return false if a file can't be read
+ */
+bool hashSources(const std::string &gltfPath, const std::vector<std::string> &dependencies,
+                 u64 &hash);
+
+Buffer cook(const render_system::ModelData &model, const std::vector<std::string> &dependencies,
+            u64 sourceHash);
+
+// false if cache is not a cache of this version
+bool readSources(const Buffer &cache, std::vector<std::string> &dependencies, u64 &sourceHash);
+/**
+ * @brief read - model of a cooked cache, blobs point into cache
+ * @return false if cache is corrupt or of another version
+ */
+bool read(const Buffer &cache, render_system::ModelData &model);
+
+/**
+ * @brief open - maps the cache of gltfPath into cache and reads it
+ * @return false if the cache is missing, invalid or stale
+ */
+bool open(const std::string &gltfPath, Buffer &cache, render_system::ModelData &model);
+
+// read only mapping of a file, unmapped when buffer is destroyed
+bool mapFile(Buffer &buffer, const std::string &fileName);
+} // namespace app::model_cache
@@ -0,0 +1,92 @@
+#include "core/buffer.h"
+#include "loaders.h"
+#include "model_cache.h"
+#include "systems/render_system/model_data.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define TINYGLTF_NOEXCEPTION
+#define JSON_NOEXCEPTION
+#include <third_party/tinygltf/tiny_gltf.h>
+
+/**
+ * Benchmark, startup model loading: parsing glTF files with tinygltf (as App
+ * did before the model cache) vs opening their model caches.
+ *
+ * model-cache-bench [gltf files...], run from the directory with resources/,
+ * caches are written next to the glTF files. GPU upload is not part of either
+ * path, both end with a ModelData ready for RenderSystem::registerModel.
+ */
+namespace model_cache_bench {
+
+using Clock = std::chrono::steady_clock;
+using render_system::ModelData;
+
+constexpr int RUNS = 5;
+
+// best of RUNS, in ms
+template <typename Op> double measure(Op op) {
+  double best = 1e30;
+  for (int run = 0; run < RUNS; ++run) {
+    auto start = Clock::now();
+    op();
+    best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+  }
+  return best;
+}
+} // namespace model_cache_bench
+
+int main(int argc, char **argv) {
+  using namespace model_cache_bench;
+  std::vector<std::string> files(argv + std::min(argc, 1), argv + argc);
+  if (files.empty())
+    files = {"resources/meshes/DamagedHelmet.gltf", "resources/meshes/FlightHelmet.gltf",
+             "resources/meshes/lantern.gltf", "resources/meshes/gun.gltf",
+             "resources/meshes/sniper.gltf"};
+
+  // cooks missing or stale caches
+  size_t cacheSize = 0;
+  for (const std::string &file : files) {
+    ModelData model;
+    Buffer storage;
+    if (!app::Loaders::loadModel(model, storage, file.c_str())) {
+      printf("failed to load %s\n", file.c_str());
+      return 1;
+    }
+    cacheSize += storage.getSize();
+  }
+
+  double gltf = measure([&]() {
+    for (const std::string &file : files) {
+      tinygltf::Model gltfModel;
+      app::Loaders::loadModel(gltfModel, file.c_str());
+      ModelData model = ModelData::fromGltf(gltfModel);
+    }
+  });
+  double cache = measure([&]() {
+    for (const std::string &file : files) {
+      ModelData model;
+      Buffer storage;
+      app::model_cache::open(file, storage, model);
+    }
+  });
+  // open without the hash of the sources, what a trusted cache would cost
+  double mapped = measure([&]() {
+    for (const std::string &file : files) {
+      ModelData model;
+      Buffer storage;
+      app::model_cache::mapFile(storage, app::model_cache::getCachePath(file));
+      app::model_cache::read(storage, model);
+    }
+  });
+
+  printf("%zu glTF files, caches %zu bytes\n", files.size(), cacheSize);
+  printf("%-28s %10s %10s\n", "load", "ms", "speedup");
+  printf("%-28s %10.3f %10.1f\n", "glTF parse", gltf, 1.0);
+  printf("%-28s %10.3f %10.1f\n", "model cache", cache, gltf / cache);
+  printf("%-28s %10.3f %10.1f\n", "model cache (no hash)", mapped, gltf / mapped);
+  return 0;
+}
@@ -0,0 +1,196 @@
+#include "core/buffer.h"
+#include "model_cache.h"
+#include "third_party/catch.hpp"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+namespace model_cache_test {
+using render_system::ModelData;
+namespace model_cache = app::model_cache;
+
+// one triangle with a textured material, blobs point into the test's arrays
+struct TestModel {
+  float vertices[9] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+  u16 indices[3] = {0, 1, 2};
+  uchar pixels[16] = {255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 255};
+  ModelData model;
+
+  TestModel() {
+    model.name = "triangle";
+    model.views = {{0x8892, reinterpret_cast<const uchar *>(vertices), sizeof(vertices)},
+                   {0x8893, reinterpret_cast<const uchar *>(indices), sizeof(indices)}};
+    model.attributes = {{0, 3, 0x1406, false, 12, 0, 0}};
+    model.primitives = {{4, 0, 0, 1, 0x1403, 3, 0, 1}};
+    model.meshes = {{"mesh", 0, 1}};
+    model.images = {{2, 2, 4, 8, pixels, sizeof(pixels)}};
+    model.materials = {{"material",
+                        {1.0f, 0.5f, 0.25f, 1.0f},
+                        {0.0f, 0.0f, 1.0f},
+                        0.5f,
+                        0.75f,
+                        0,
+                        ModelData::NONE,
+                        ModelData::NONE,
+                        ModelData::NONE,
+                        ModelData::NONE}};
+  }
+};
+
+bool writeFile(const std::string &fileName, const std::string &content) {
+  std::ofstream file(fileName, std::ios::binary);
+  file << content;
+  return !file.fail();
+}
+
+TEST_CASE("Model cache round trip") {
+  TestModel test;
+  Buffer cache = model_cache::cook(test.model, {"triangle.bin"}, 42);
+
+  std::vector<std::string> dependencies;
+  u64 sourceHash = 0;
+  REQUIRE(model_cache::readSources(cache, dependencies, sourceHash));
+  REQUIRE(dependencies == std::vector<std::string>{"triangle.bin"});
+  REQUIRE(sourceHash == 42);
+
+  ModelData model;
+  REQUIRE(model_cache::read(cache, model));
+  REQUIRE(model.isValid());
+  REQUIRE(model.name == "triangle");
+  REQUIRE(model.views.size() == 2);
+  REQUIRE(model.views[0].target == 0x8892);
+  REQUIRE(model.views[0].size == sizeof(test.vertices));
+  REQUIRE(std::memcmp(model.views[0].data, test.vertices, sizeof(test.vertices)) == 0);
+  REQUIRE(std::memcmp(model.views[1].data, test.indices, sizeof(test.indices)) == 0);
+  // blobs can be uploaded straight from the cache
+  for (const ModelData::View &view : model.views) {
+    REQUIRE(view.data >= cache.data());
+    REQUIRE(view.data + view.size <= cache.data() + cache.getSize());
+    REQUIRE((view.data - cache.data()) % model_cache::BLOB_ALIGNMENT == 0);
+  }
+  REQUIRE(model.attributes.size() == 1);
+  REQUIRE(model.attributes[0].size == 3);
+  REQUIRE(model.attributes[0].byteStride == 12);
+  REQUIRE(!model.attributes[0].normalized);
+  REQUIRE(model.primitives.size() == 1);
+  REQUIRE(model.primitives[0].indexCount == 3);
+  REQUIRE(model.primitives[0].indexView == 1);
+  REQUIRE(model.meshes.size() == 1);
+  REQUIRE(model.meshes[0].name == "mesh");
+  REQUIRE(model.images.size() == 1);
+  REQUIRE(model.images[0].width == 2);
+  REQUIRE(std::memcmp(model.images[0].pixels, test.pixels, sizeof(test.pixels)) == 0);
+  REQUIRE(model.materials.size() == 1);
+  const ModelData::Material &material = model.materials[0];
+  REQUIRE(material.name == "material");
+  REQUIRE(material.baseColorFactor[1] == 0.5f);
+  REQUIRE(material.emissiveFactor[2] == 1.0f);
+  REQUIRE(material.roughnessFactor == 0.75f);
+  REQUIRE(material.baseColorImage == 0);
+  REQUIRE(material.normalImage == ModelData::NONE);
+}
+
+TEST_CASE("Model cache rejects invalid caches") {
+  TestModel test;
+  Buffer cache = model_cache::cook(test.model, {}, 0);
+  ModelData model;
+
+  SECTION("Other version") {
+    Buffer other(cache);
+    other.data()[4] = model_cache::VERSION + 1;
+    REQUIRE(!model_cache::read(other, model));
+  }
+  SECTION("Truncated") {
+    for (size_t size : {size_t(0), size_t(16), cache.getSize() / 2, cache.getSize() - 1}) {
+      Buffer truncated(cache.data(), size);
+      REQUIRE(!model_cache::read(truncated, model));
+    }
+  }
+  SECTION("Out of range index") {
+    // material of the first primitive, after header, dependencies, name,
+    // 2 views, 1 attribute & primitive mode
+    size_t offset = model_cache::HEADER_SIZE + 4 + (4 + test.model.name.size()) + 4 + 2 * 20 +
+                    4 + 29 + 4 + 4;
+    Buffer invalid(cache);
+    REQUIRE(invalid.data()[offset] == 0);
+    invalid.data()[offset] = 1;
+    REQUIRE(!model_cache::read(invalid, model));
+  }
+  REQUIRE(model.views.empty());
+}
+
+TEST_CASE("ModelData rejects blobs too small for their users") {
+  TestModel test;
+  ModelData &model = test.model;
+  REQUIRE(model.isValid());
+
+  SECTION("Image pixels") {
+    model.images[0].size = sizeof(test.pixels) - 1;
+    REQUIRE(!model.isValid());
+    model.images[0].size = sizeof(test.pixels);
+    model.images[0].bits = 16;
+    REQUIRE(!model.isValid());
+  }
+  SECTION("Attribute offset") {
+    // the last vertex still fits
+    model.attributes[0].byteOffset = sizeof(test.vertices) - 12;
+    REQUIRE(model.isValid());
+    model.attributes[0].byteOffset = sizeof(test.vertices) - 8;
+    REQUIRE(!model.isValid());
+    model.attributes[0].byteOffset = ~u64(0);
+    REQUIRE(!model.isValid());
+  }
+  SECTION("Index range") {
+    model.primitives[0].indexCount = 4;
+    REQUIRE(!model.isValid());
+    model.primitives[0].indexCount = 3;
+    model.primitives[0].indexOffset = 2;
+    REQUIRE(!model.isValid());
+    // u32 indices need twice the bytes
+    model.primitives[0].indexOffset = 0;
+    model.primitives[0].indexType = 0x1405;
+    REQUIRE(!model.isValid());
+  }
+}
+
+TEST_CASE("Model cache open") {
+  char directory[] = "/tmp/model_cache_testXXXXXX";
+  REQUIRE(mkdtemp(directory));
+  const std::string gltfPath = std::string(directory) + "/triangle.gltf";
+  const std::string binPath = std::string(directory) + "/triangle.bin";
+  REQUIRE(writeFile(gltfPath, "{\"asset\":{\"version\":\"2.0\"}}"));
+  REQUIRE(writeFile(binPath, "vertices"));
+
+  TestModel test;
+  const std::vector<std::string> dependencies = {"triangle.bin"};
+  u64 sourceHash = 0;
+  REQUIRE(model_cache::hashSources(gltfPath, dependencies, sourceHash));
+  Buffer cooked = model_cache::cook(test.model, dependencies, sourceHash);
+  {
+    std::ofstream file(model_cache::getCachePath(gltfPath), std::ios::binary);
+    file.write(reinterpret_cast<const char *>(cooked.data()), cooked.getSize());
+  }
+
+  Buffer cache;
+  ModelData model;
+  REQUIRE(model_cache::open(gltfPath, cache, model));
+  REQUIRE(model.name == "triangle");
+  REQUIRE(std::memcmp(model.views[0].data, test.vertices, sizeof(test.vertices)) == 0);
+
+  SECTION("Stale dependency") {
+    REQUIRE(writeFile(binPath, "vertices2"));
+    Buffer stale;
+    REQUIRE(!model_cache::open(gltfPath, stale, model));
+  }
+  SECTION("Missing dependency") {
+    std::remove(binPath.c_str());
+    Buffer missing;
+    REQUIRE(!model_cache::open(gltfPath, missing, model));
+  }
+
+  std::remove(model_cache::getCachePath(gltfPath).c_str());
+  std::remove(binPath.c_str());
+  std::remove(gltfPath.c_str());
+  rmdir(directory);
+}
+} // namespace model_cache_test
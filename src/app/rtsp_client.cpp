@@ -1,75 +1,104 @@
 #include "rtsp_client.h"
 #include "core/image.h"
-#include "core/shared_queue.h"
+#include "core/trace.h"
 #include "utils/slogger.h"
+#include <algorithm>
 
 namespace app {
 RtspClient::RtspClient(int width, int height, FrameQueue &frameQueue,
-                       std::string_view serverAddr, bool isNvidia)
-    : frameQueue(frameQueue), shouldStop(true), ffmpegStream(NULL) {
-  std::string format = "";
-  std::string res = std::to_string(width) + "x" + std::to_string(height);
-  if (serverAddr.find("rtsp://") != std::string::npos) {
-    format = "-rtpflags skip_rtcp -allowed_media_types video -rtsp_transport "
-             "udp -f rtsp ";
-  }
-  if (!isNvidia) {
-    command = "ffmpeg -loglevel error -fflags 'nobuffer;flush_packets' -r 60 "
-              "-f rawvideo "
-              "-pix_fmt rgba -s " +
-              res +
-              " -i - "
-              "-tune zerolatency -threads 1 -preset fast -y -pix_fmt yuv420p "
-              "-vf vflip -vsync 1 -r 60 -c:v libx264 ";
-  } else {
-    command = "ffmpeg -loglevel error -fflags 'nobuffer;flush_packets' "
-              "-hwaccel cuda -r 60 -f "
-              "rawvideo -pix_fmt "
-              "rgba -s " +
-              res +
-              " -i - "
-              "-tune zerolatency -threads 1 -preset fast -y -pix_fmt bgr0 "
-              "-vf vflip -vsync 1 -r 60 -c:v h264_nvenc ";
-  }
-  command += format;
-  command += serverAddr;
-}
+                       std::string_view serverAddr, bool isNvidia, FrameSink::Type sinkType)
+    : RtspClient(frameQueue, FrameSink::create(sinkType),
+                 FrameSinkConfig{width, height, 60, std::string(serverAddr), isNvidia}) {}
+
+RtspClient::RtspClient(FrameQueue &frameQueue, std::unique_ptr<FrameSink> sink,
+                       const FrameSinkConfig &config)
+    : frameQueue(frameQueue), shouldStop(true), fullFrameRequested(false),
+      sink(std::move(sink)), config(config),
+      frameCount(0), latencySumMs(0.0), latencyMaxMs(0.0), rateLimitedCount(0), skipUnchanged(false),
+      keepAliveFrames(60) {}
 
 RtspClient::~RtspClient() { stop(); }
 
 bool RtspClient::start() {
-  if (!shouldStop && !ffmpegStream) {
+  if (thread.joinable()) {
     SLOG("RTSP Client already running.");
     return false;
   }
+  frameCount = 0;
+  latencySumMs = latencyMaxMs = 0.0;
+  rateLimitedCount = 0;
+  frameDiff.reset();
+  frameDiff.resetStats();
   shouldStop = false;
-  thread = std::thread([&shouldStop = shouldStop, &frameQueue = frameQueue,
-                        &ffmpegStream = ffmpegStream, command = command]() {
-    // start ffmpeg process
-    ffmpegStream = popen(command.c_str(), "w");
-    if (!ffmpegStream) {
-      CSLOG("Failed to init ffmpeg.");
-      shouldStop = true;
-    } else {
-      while (!shouldStop) {
-        // feed fames to ffmpeg
-        std::shared_ptr<Image> image;
-        frameQueue.popGetFront(image, shouldStop);
-        if (shouldStop)
-          break;
-        auto buffer = image->getBuffer();
-        fwrite(buffer->data(), sizeof(uchar), buffer->getSize(), ffmpegStream);
+  thread = std::thread([this]() { run(); });
+  return true;
+}
+
+void RtspClient::run() {
+  TRACE_THREAD_NAME("rtsp client");
+  if (!sink->open(config)) {
+    CSLOG("Failed to open frame sink", sink->getName(), config.output);
+    shouldStop = true;
+    return;
+  }
+  uint skipped = 0;
+  // 10% slack so capture jitter doesn't drop frames rendered at the capped rate
+  const auto minInterval = std::chrono::duration_cast<FrameClock::duration>(
+      std::chrono::duration<double>(0.9 / config.fps));
+  FrameClock::time_point lastFrameTime;
+  while (!shouldStop) {
+    // feed fames to the sink
+    Frame frame;
+    frameQueue.popGetFront(frame, shouldStop);
+    if (shouldStop)
+      break;
+    TRACE_ZONE("RtspClient::frame");
+    if (frame.captureTime - lastFrameTime < minInterval) {
+      ++rateLimitedCount;
+      continue;
+    }
+    lastFrameTime = frame.captureTime;
+    if (fullFrameRequested.exchange(false)) frameDiff.reset();
+    if (skipUnchanged && frameDiff.update(*frame.image) == 0 && ++skipped < keepAliveFrames) {
+      if (!sink->skip()) {
+        CSLOG("Failed to skip frame on", sink->getName());
+        shouldStop = true;
+        break;
       }
-      // stop ffmpeg
-      pclose(ffmpegStream);
+      continue;
     }
-  });
-  return true;
-} // namespace app
+    skipped = 0;
+    if (!sink->write(*frame.image)) {
+      CSLOG("Failed to write frame to", sink->getName());
+      shouldStop = true;
+      break;
+    }
+    double latencyMs = std::chrono::duration<double, std::milli>(FrameClock::now() -
+                                                                 frame.captureTime)
+                           .count();
+    ++frameCount;
+    latencySumMs += latencyMs;
+    latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+  }
+  sink->close();
+}
 
 void RtspClient::stop() {
   shouldStop = true;
-  if (thread.joinable())
+  if (thread.joinable()) {
     thread.join();
+    auto stats = getLatencyStats();
+    SLOG("Frame sink", sink->getName(), "frames", stats.frames, "latency avg(ms)",
+         stats.avgMs, "max(ms)", stats.maxMs, "rate limited", rateLimitedCount);
+    if (skipUnchanged) {
+      auto diffStats = frameDiff.getStats();
+      SLOG("Unchanged frames", diffStats.unchangedFrames, "of", diffStats.frames,
+           "changed tiles", diffStats.getChangedTileRatio());
+    }
+  }
+}
+
+RtspClient::LatencyStats RtspClient::getLatencyStats() const {
+  return {frameCount, frameCount ? latencySumMs / frameCount : 0.0, latencyMaxMs};
 }
 } // namespace app
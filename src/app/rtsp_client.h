@@ -1,20 +1,45 @@
 #pragma once
 
-#include "core/shared_queue.h"
+#include "core/frame_diff.h"
+#include "core/ring_buffer.h"
+#include "frame_sink.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
 #include <thread>
 
 class Image;
 /**
  * @brief The RtspClient class
- * A simple RTSP client that sends frames to a RTSP server with ffmpeg
- * Runs on a separate thread.
+ * A simple RTSP client that sends frames to a RTSP server (or file) through a
+ * FrameSink. Runs on a separate thread. Frames arriving faster than the
+ * configured fps are dropped.
  */
 namespace app {
-using FrameQueue = SharedQueue<std::shared_ptr<Image>>;
+using FrameClock = std::chrono::steady_clock;
+struct Frame {
+  std::shared_ptr<Image> image;
+  FrameClock::time_point captureTime; // when the frame was read back
+};
+// render thread never blocks on frame hand off, stale frames are dropped
+using FrameQueue = RingBuffer<Frame>;
+constexpr size_t FRAME_QUEUE_SIZE = 4;
+constexpr OverflowPolicy FRAME_QUEUE_POLICY = OverflowPolicy::DROP_OLDEST;
 class RtspClient {
 public:
+  // time from capture until the sink returned, valid after stop
+  struct LatencyStats {
+    size_t frames;
+    double avgMs;
+    double maxMs;
+  };
+
   RtspClient(int width, int height, FrameQueue &frameQueue,
-             std::string_view serverAddr, bool isNvidia);
+             std::string_view serverAddr, bool isNvidia,
+             FrameSink::Type sinkType = FrameSink::Type::ENCODER);
+  RtspClient(FrameQueue &frameQueue, std::unique_ptr<FrameSink> sink,
+             const FrameSinkConfig &config);
   ~RtspClient();
   /**
    * @brief start
@@ -23,17 +48,54 @@ public:
    */
   bool start();
 
+  /**
+   * @brief setSkipUnchanged - frames identical to the previous one (see
+   * FrameDiff) are not encoded, at least one frame per keepAliveFrames is.
+   * Call before start.
+   */
+  void setSkipUnchanged(bool skip, uint keepAliveFrames = 60) {
+    skipUnchanged = skip;
+    this->keepAliveFrames = keepAliveFrames;
+  }
+
+  /**
+   * @brief requestFullFrame - the next frame is written even if unchanged, ie
+   * a new output joined the sink and needs a complete frame. Thread safe, the
+   * client thread resets its FrameDiff.
+   */
+  void requestFullFrame() { fullFrameRequested = true; }
+
   /**
    * @brief stop
    * Stop stream frames to RTSP server
    */
   void stop();
 
+  // false once stopped or the sink failed
+  bool isRunning() const { return !shouldStop; }
+  LatencyStats getLatencyStats() const;
+  // skipped frames & changed tile ratio, valid after stop
+  FrameDiff::Stats getFrameDiffStats() const { return frameDiff.getStats(); }
+  const char *getSinkName() const { return sink->getName(); }
+  // frames dropped to stay within config.fps
+  size_t getRateLimitedCount() const { return rateLimitedCount; }
+  FrameSink &getSink() { return *sink; }
+
 private:
   FrameQueue &frameQueue; // refence to fo shared frame queues
-  bool shouldStop;
-  std::string command;
-  FILE *ffmpegStream; // Input stream to feed ffmpeg
+  std::atomic<bool> shouldStop; // set by stop & read by the client thread
+  std::atomic<bool> fullFrameRequested; // see requestFullFrame
+  std::unique_ptr<FrameSink> sink;
+  FrameSinkConfig config;
   std::thread thread;
+  size_t frameCount;
+  double latencySumMs;
+  double latencyMaxMs;
+  size_t rateLimitedCount;
+  bool skipUnchanged;
+  uint keepAliveFrames;
+  FrameDiff frameDiff;
+
+  void run();
 };
 } // namespace app
@@ -0,0 +1,124 @@
+#include "components/light.h"
+#include "components/model.h"
+#include "core/buffer.h"
+#include "loaders.h"
+#include "systems/world_system/scene_snapshot.h"
+#include "systems/world_system/world_system.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define TINYGLTF_NOEXCEPTION
+#define JSON_NOEXCEPTION
+#include <third_party/tinygltf/tiny_gltf.h>
+
+/**
+ * Benchmark, scene setup from glTF (parsing the JSON of each model and adding
+ * world objects one by one, as App::renderHelments does) vs loading the same
+ * scene from a SceneSnapshot file.
+ *
+ * scene-snapshot-bench [objects] [gltf files...], run from the directory with
+ * resources/, GPU registration of meshes is not part of either path.
+ */
+namespace scene_snapshot_bench {
+
+using Clock = std::chrono::steady_clock;
+using namespace world_system;
+
+constexpr int RUNS = 10;
+constexpr const char *SNAPSHOT_FILE = "scene_snapshot_bench.snap";
+
+// best of RUNS, in ms, world is cleared before each run
+template <typename Op> double measure(WorldSystem &worldSystem, Op op) {
+  double best = 1e30;
+  for (int run = 0; run < RUNS; ++run) {
+    worldSystem.clearWorld();
+    auto start = Clock::now();
+    op();
+    best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+  }
+  return best;
+}
+
+// objects cycle through the models, every 16th object is a light
+void buildScene(WorldSystem &worldSystem, const std::vector<tinygltf::Model> &models,
+                uint objects) {
+  for (uint i = 0; i < objects; ++i) {
+    float x = float(i % 32) * 2.5f;
+    float z = float(i / 32) * -2.5f;
+    auto &object = worldSystem.createWorldObject(component::Transform(
+        glm::vec3(x, 4.0f, z), glm::vec3(0.0f, glm::radians(i * 10.0f), 0.0f)));
+    if (i % 16 == 0) {
+      object.addComponent<component::Light>(glm::vec3(1.0f), 300.0f, 100.0f,
+                                            LightType::POINT_LIGHT);
+      continue;
+    }
+    uint meshId = i % models.size();
+    component::Model model = {meshId, {}};
+    // primitive index to glTF material index, stands in for registered ids
+    PrimitiveId primId = 0;
+    for (const tinygltf::Mesh &mesh : models[meshId].meshes) {
+      for (const tinygltf::Primitive &primitive : mesh.primitives)
+        model.primIdToMatId.emplace(primId++, std::max(primitive.material, 0));
+    }
+    object.addComponent<component::Model>(model);
+  }
+}
+
+bool loadModels(std::vector<tinygltf::Model> &models, const std::vector<std::string> &files) {
+  models.assign(files.size(), tinygltf::Model());
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!app::Loaders::loadModel(models[i], files[i].c_str())) return false;
+  }
+  return true;
+}
+} // namespace scene_snapshot_bench
+
+int main(int argc, char **argv) {
+  using namespace scene_snapshot_bench;
+  uint objects = argc > 1 ? std::atoi(argv[1]) : 1000;
+  std::vector<std::string> files(argv + std::min(argc, 2), argv + argc);
+  if (files.empty())
+    files = {"resources/meshes/DamagedHelmet.gltf", "resources/meshes/FlightHelmet.gltf",
+             "resources/meshes/lantern.gltf", "resources/meshes/gun.gltf",
+             "resources/meshes/sniper.gltf"};
+
+  ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+  coordinator.registerComponent<component::Transform>();
+  coordinator.registerComponent<component::Light>();
+  coordinator.registerComponent<component::Model>();
+  WorldSystem worldSystem;
+
+  std::vector<tinygltf::Model> models;
+  if (!loadModels(models, files)) {
+    printf("failed to load glTF models\n");
+    return 1;
+  }
+  double gltf = measure(worldSystem, [&]() {
+    loadModels(models, files);
+    buildScene(worldSystem, models, objects);
+  });
+  double perEntity = measure(worldSystem, [&]() { buildScene(worldSystem, models, objects); });
+
+  Buffer snapshot = scene_snapshot::save(worldSystem);
+  if (!app::Loaders::writeBinaryFile(snapshot, SNAPSHOT_FILE)) return 1;
+  double fromMemory = measure(worldSystem, [&]() { scene_snapshot::load(worldSystem, snapshot); });
+  double fromFile = measure(worldSystem, [&]() {
+    Buffer buffer;
+    app::Loaders::loadBinaryFile(buffer, SNAPSHOT_FILE);
+    scene_snapshot::load(worldSystem, buffer);
+  });
+  std::remove(SNAPSHOT_FILE);
+
+  printf("%u objects, %zu glTF files, snapshot %zu bytes\n", objects, files.size(),
+         snapshot.getSize());
+  printf("%-28s %10s %10s\n", "setup", "ms", "speedup");
+  printf("%-28s %10.3f %10.1f\n", "glTF parse + per entity", gltf, 1.0);
+  printf("%-28s %10.3f %10.1f\n", "per entity (parsed)", perEntity, gltf / perEntity);
+  printf("%-28s %10.3f %10.1f\n", "snapshot file", fromFile, gltf / fromFile);
+  printf("%-28s %10.3f %10.1f\n", "snapshot memory", fromMemory, gltf / fromMemory);
+  return 0;
+}
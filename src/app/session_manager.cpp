@@ -0,0 +1,130 @@
+#include "session_manager.h"
+#include "utils/slogger.h"
+#include <algorithm>
+
+namespace app {
+SessionManager::SessionManager(int width, int height, FrameSink::Type sinkType, bool isNvidia)
+    : SessionManager(width, height, [sinkType]() { return FrameSink::create(sinkType); },
+                     isNvidia) {}
+
+SessionManager::SessionManager(int width, int height, SinkFactory sinkFactory, bool isNvidia)
+    : width(width), height(height), isNvidia(isNvidia), sinkFactory(std::move(sinkFactory)),
+      convertBands(1), convertExecutor(nullptr) {}
+
+bool SessionManager::connect(SessionId id, const std::string &output,
+                             const SessionConfig &config) {
+  if (sessions.count(id)) {
+    SLOG("Session already connected", id);
+    return false;
+  }
+  Session session = {findGroup(config), id, false, {}, 0, 0.0, 0.0};
+  if (session.group) {
+    if (!session.group->client->getSink().addOutput(id, output)) {
+      CSLOG("Failed to add output", output, "to session", id);
+      return false;
+    }
+    // the group may be skipping unchanged frames, the new output needs one
+    session.group->client->requestFullFrame();
+  } else {
+    // the first output is passed in the sink config
+    session.group = createGroup(output, config);
+    session.outputId = FrameSink::CONFIG_OUTPUT;
+    if (!session.group) return false;
+  }
+  ++session.group->sessionCount;
+  sessions.emplace(id, session);
+  SLOG("Session", id, "connected to", output, "view", config.view, "groups", groups.size());
+  return true;
+}
+
+void SessionManager::disconnect(SessionId id) {
+  auto it = sessions.find(id);
+  if (it == sessions.end()) return;
+  Session session = it->second;
+  sessions.erase(it);
+  if (session.inputSamples)
+    SLOG("Session", id, "input latency avg(ms)", session.inputLatencySumMs / session.inputSamples,
+         "max(ms)", session.inputLatencyMaxMs);
+  StreamGroup *group = session.group;
+  if (--group->sessionCount > 0) {
+    group->client->getSink().removeOutput(session.outputId);
+  } else {
+    // last session, stops the client & closes the sink
+    groups.erase(std::find_if(groups.begin(), groups.end(),
+                              [group](const auto &g) { return g.get() == group; }));
+  }
+  SLOG("Session", id, "disconnected, groups", groups.size());
+}
+
+void SessionManager::disconnectAll() {
+  sessions.clear();
+  groups.clear();
+}
+
+void SessionManager::pushFrame(ViewId view, const Frame &frame) {
+  for (auto &group : groups) {
+    if (group->config.view == view && group->client->isRunning())
+      group->frameQueue.pushBack(frame);
+  }
+  for (auto &entry : sessions) {
+    Session &session = entry.second;
+    if (!session.hasInput || session.group->config.view != view ||
+        frame.captureTime < session.inputTime)
+      continue;
+    double latencyMs =
+        std::chrono::duration<double, std::milli>(frame.captureTime - session.inputTime).count();
+    ++session.inputSamples;
+    session.inputLatencySumMs += latencyMs;
+    session.inputLatencyMaxMs = std::max(session.inputLatencyMaxMs, latencyMs);
+    session.hasInput = false;
+  }
+}
+
+void SessionManager::onInput(SessionId id, FrameClock::time_point receiveTime) {
+  auto it = sessions.find(id);
+  if (it == sessions.end()) return;
+  Session &session = it->second;
+  if (!session.hasInput || receiveTime < session.inputTime) session.inputTime = receiveTime;
+  session.hasInput = true;
+}
+
+RtspClient::LatencyStats SessionManager::getInputLatencyStats(SessionId id) const {
+  auto it = sessions.find(id);
+  if (it == sessions.end() || !it->second.inputSamples) return {0, 0.0, 0.0};
+  const Session &session = it->second;
+  return {session.inputSamples, session.inputLatencySumMs / session.inputSamples,
+          session.inputLatencyMaxMs};
+}
+
+std::vector<ViewId> SessionManager::getActiveViews() const {
+  std::vector<ViewId> views;
+  for (auto &group : groups) {
+    if (std::find(views.begin(), views.end(), group->config.view) == views.end())
+      views.push_back(group->config.view);
+  }
+  return views;
+}
+
+SessionManager::StreamGroup *SessionManager::findGroup(const SessionConfig &config) {
+  for (auto &group : groups) {
+    const SessionConfig &other = group->config;
+    if (other.view == config.view && other.maxFps == config.maxFps && other.maxBitrate == config.maxBitrate &&
+        other.skipUnchanged == config.skipUnchanged && group->client->getSink().canFanOut() &&
+        group->client->isRunning())
+      return group.get();
+  }
+  return nullptr;
+}
+
+SessionManager::StreamGroup *SessionManager::createGroup(const std::string &output,
+                                                         const SessionConfig &config) {
+  auto group = std::make_unique<StreamGroup>(config);
+  FrameSinkConfig sinkConfig{width, height, config.maxFps, output, isNvidia, config.maxBitrate,
+                             convertBands, convertExecutor};
+  group->client = std::make_unique<RtspClient>(group->frameQueue, sinkFactory(), sinkConfig);
+  group->client->setSkipUnchanged(config.skipUnchanged);
+  if (!group->client->start()) return nullptr;
+  groups.push_back(std::move(group));
+  return groups.back().get();
+}
+} // namespace app
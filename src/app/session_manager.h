@@ -0,0 +1,110 @@
+#pragma once
+
+#include "frame_sink.h"
+#include "rtsp_client.h"
+#include "types.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace app {
+using SessionId = u32;
+// camera a session watches, sessions with their own camera use their id
+using ViewId = u32;
+constexpr ViewId MAIN_VIEW = 0;
+
+struct SessionConfig {
+  ViewId view = MAIN_VIEW;
+  int maxFps = 60;
+  int maxBitrate = 0; // bits/s, 0 - encoder default
+  // frames identical to the previous one aren't encoded, see RtspClient::setSkipUnchanged
+  bool skipUnchanged = false;
+};
+
+/**
+ * @brief The SessionManager class
+ * Streams rendered views to several clients.
+ *
+ * Sessions watching the same view with the same config share a stream group, frames are converted & encoded once and the sink fans the
+ * stream out to every session (see FrameSink::canFanOut). Each group has its
+ * own frame queue, RtspClient thread & encoder, so a group that falls behind
+ * drops its own frames without stalling the render loop or other groups.
+ * Sinks that can't fan out get a group per session.
+ * Not thread safe, used from the render thread.
+ */
+class SessionManager : NonCopyable {
+public:
+  using SinkFactory = std::function<std::unique_ptr<FrameSink>()>;
+
+  SessionManager(int width, int height, FrameSink::Type sinkType, bool isNvidia);
+  SessionManager(int width, int height, SinkFactory sinkFactory, bool isNvidia = false);
+  ~SessionManager() { disconnectAll(); }
+
+  /**
+   * @brief connect - starts streaming config.view to output
+   * @return false if id is already connected or the stream couldn't be added
+   */
+  bool connect(SessionId id, const std::string &output, const SessionConfig &config = {});
+  void disconnect(SessionId id);
+  void disconnectAll();
+  /**
+   * @brief setConvertExecutor - sinks of groups created afterwards split RGBA
+   * to YUV conversion into bands, bands - 1 of them run on executor, see
+   * yuv::convert
+   */
+  void setConvertExecutor(yuv::Executor executor, uint bands) {
+    convertExecutor = std::move(executor);
+    convertBands = bands;
+  }
+
+  // hands frame to every group of view, never blocks
+  void pushFrame(ViewId view, const Frame &frame);
+  /**
+   * @brief onInput - input of session id was applied, the next frame pushed
+   * for its view completes an input to photon latency sample
+   * @param receiveTime - when the server received the input
+   */
+  void onInput(SessionId id, FrameClock::time_point receiveTime);
+  // time from receiving input until a frame showing it was handed to the stream
+  RtspClient::LatencyStats getInputLatencyStats(SessionId id) const;
+  // views with at least one session, only these need to be rendered
+  std::vector<ViewId> getActiveViews() const;
+  bool hasSessions() const { return !sessions.empty(); }
+  size_t getSessionCount() const { return sessions.size(); }
+  size_t getGroupCount() const { return groups.size(); }
+
+private:
+  struct StreamGroup {
+    StreamGroup(const SessionConfig &config)
+        : config(config), frameQueue(FRAME_QUEUE_SIZE, FRAME_QUEUE_POLICY), sessionCount(0) {}
+    SessionConfig config;
+    FrameQueue frameQueue;
+    std::unique_ptr<RtspClient> client; // destroyed before frameQueue
+    size_t sessionCount;
+  };
+  struct Session {
+    StreamGroup *group;
+    u32 outputId; // in the group's sink
+    bool hasInput; // not shown by a pushed frame yet
+    FrameClock::time_point inputTime; // oldest input not shown yet
+    size_t inputSamples;
+    double inputLatencySumMs;
+    double inputLatencyMaxMs;
+  };
+
+  const int width;
+  const int height;
+  const bool isNvidia;
+  SinkFactory sinkFactory;
+  uint convertBands;
+  yuv::Executor convertExecutor;
+  std::map<SessionId, Session> sessions;
+  std::vector<std::unique_ptr<StreamGroup>> groups;
+
+  // running group the session can join, nullptr if none
+  StreamGroup *findGroup(const SessionConfig &config);
+  StreamGroup *createGroup(const std::string &output, const SessionConfig &config);
+};
+} // namespace app
@@ -0,0 +1,229 @@
+#include "core/image.h"
+#include "session_manager.h"
+#include "third_party/catch.hpp"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace session_manager_test {
+
+// what the fake sinks saw, shared with the test
+struct SinkLog {
+  std::mutex mutex;
+  std::atomic<int> sinks{0};
+  std::atomic<int> writes{0};
+  std::atomic<int> skips{0};
+  std::atomic<uint> convertBands{0};
+  std::atomic<bool> hasConvertExecutor{false};
+  std::atomic<int> closed{0};
+  std::set<u32> outputs;
+};
+
+class FakeSink : public app::FrameSink {
+public:
+  FakeSink(SinkLog &log, bool fanOut) : log(log), fanOut(fanOut) { ++log.sinks; }
+  bool open(const app::FrameSinkConfig &config) override {
+    // convertBands is polled by the test, written last
+    log.hasConvertExecutor = bool(config.convertExecutor);
+    log.convertBands = config.convertBands;
+    if (fanOut) addOutput(CONFIG_OUTPUT, config.output);
+    return true;
+  }
+  bool write(const Image &) override {
+    ++log.writes;
+    return true;
+  }
+  bool skip() override {
+    ++log.skips;
+    return true;
+  }
+  void close() override { ++log.closed; }
+  const char *getName() const override { return "fake"; }
+  bool canFanOut() const override { return fanOut; }
+  bool addOutput(u32 id, const std::string &) override {
+    std::lock_guard<std::mutex> lock(log.mutex);
+    return log.outputs.insert(id).second;
+  }
+  void removeOutput(u32 id) override {
+    std::lock_guard<std::mutex> lock(log.mutex);
+    log.outputs.erase(id);
+  }
+
+private:
+  SinkLog &log;
+  bool fanOut;
+};
+
+app::Frame makeFrame() {
+  return {std::make_shared<Image>(Buffer(4 * 4 * 4), 4, 4, 4), app::FrameClock::now()};
+}
+
+// frames are written on the client threads
+bool waitForWrites(SinkLog &log, int writes) {
+  for (int i = 0; i < 1000 && log.writes < writes; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return log.writes >= writes;
+}
+
+TEST_CASE("SessionManager shares a stream between sessions on the same view.",
+          "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, true); });
+  REQUIRE(manager.connect(1, "rtsp://a"));
+  REQUIRE(manager.connect(2, "rtsp://b"));
+  REQUIRE_FALSE(manager.connect(2, "rtsp://c"));
+  REQUIRE(manager.getSessionCount() == 2);
+  REQUIRE(manager.getGroupCount() == 1);
+  REQUIRE(log.sinks == 1);
+
+  // encoded once for both
+  manager.pushFrame(app::MAIN_VIEW, makeFrame());
+  REQUIRE(waitForWrites(log, 1));
+  // not rendered
+  manager.pushFrame(1, makeFrame());
+  {
+    std::lock_guard<std::mutex> lock(log.mutex);
+    REQUIRE(log.outputs == std::set<u32>{app::FrameSink::CONFIG_OUTPUT, 2});
+  }
+
+  // first session was the config output
+  manager.disconnect(1);
+  {
+    std::lock_guard<std::mutex> lock(log.mutex);
+    REQUIRE(log.outputs == std::set<u32>{2});
+  }
+  REQUIRE(manager.getGroupCount() == 1);
+  manager.disconnect(2);
+  REQUIRE(manager.getGroupCount() == 0);
+  REQUIRE(log.closed == 1);
+  REQUIRE(log.writes == 1);
+}
+
+TEST_CASE("SessionManager splits groups by view & caps.", "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, true); });
+  REQUIRE(manager.connect(1, "a", {app::MAIN_VIEW, 60, 0}));
+  REQUIRE(manager.connect(2, "b", {app::MAIN_VIEW, 30, 0}));
+  REQUIRE(manager.connect(3, "c", {app::MAIN_VIEW, 60, 1000000}));
+  REQUIRE(manager.connect(4, "d", {app::MAIN_VIEW, 60, 0}));
+  REQUIRE(manager.connect(5, "e", {5, 60, 0}));
+  REQUIRE(manager.getGroupCount() == 4);
+  REQUIRE(manager.getActiveViews() == std::vector<app::ViewId>{app::MAIN_VIEW, 5});
+
+  manager.pushFrame(5, makeFrame());
+  REQUIRE(waitForWrites(log, 1));
+  manager.pushFrame(app::MAIN_VIEW, makeFrame());
+  REQUIRE(waitForWrites(log, 4));
+
+  manager.disconnect(2);
+  manager.disconnect(5);
+  REQUIRE(manager.getGroupCount() == 2);
+  REQUIRE(manager.getActiveViews() == std::vector<app::ViewId>{app::MAIN_VIEW});
+  manager.disconnectAll();
+  REQUIRE_FALSE(manager.hasSessions());
+  REQUIRE(log.closed == 4);
+}
+
+TEST_CASE("SessionManager skips unchanged frames if configured.", "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, true); });
+  app::SessionConfig config;
+  config.skipUnchanged = true;
+  REQUIRE(manager.connect(1, "a", config));
+  REQUIRE(manager.connect(2, "b"));
+  REQUIRE(manager.getGroupCount() == 2);
+
+  app::Frame frame = makeFrame();
+  manager.pushFrame(app::MAIN_VIEW, frame);
+  REQUIRE(waitForWrites(log, 2));
+  // same image, past the fps cap
+  frame.captureTime += std::chrono::milliseconds(100);
+  manager.pushFrame(app::MAIN_VIEW, frame);
+  REQUIRE(waitForWrites(log, 3));
+  for (int i = 0; i < 1000 && log.skips < 1; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  manager.disconnectAll();
+  REQUIRE(log.writes == 3);
+  REQUIRE(log.skips == 1);
+}
+
+TEST_CASE("SessionManager sends a full frame to sessions joining a group.",
+          "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, true); });
+  app::SessionConfig config;
+  config.skipUnchanged = true;
+  REQUIRE(manager.connect(1, "a", config));
+
+  app::Frame frame = makeFrame();
+  manager.pushFrame(app::MAIN_VIEW, frame);
+  REQUIRE(waitForWrites(log, 1));
+  frame.captureTime += std::chrono::milliseconds(100);
+  manager.pushFrame(app::MAIN_VIEW, frame);
+  for (int i = 0; i < 1000 && log.skips < 1; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  REQUIRE(log.skips == 1);
+
+  // same image, but the new session hasn't seen it
+  REQUIRE(manager.connect(2, "b", config));
+  REQUIRE(manager.getGroupCount() == 1);
+  frame.captureTime += std::chrono::milliseconds(100);
+  manager.pushFrame(app::MAIN_VIEW, frame);
+  REQUIRE(waitForWrites(log, 2));
+  manager.disconnectAll();
+  REQUIRE(log.skips == 1);
+}
+
+TEST_CASE("SessionManager passes the convert executor to new sinks.", "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, true); });
+  manager.setConvertExecutor([](std::function<void()> task) { task(); }, 3);
+  REQUIRE(manager.connect(1, "a"));
+  // opened on the client thread
+  for (int i = 0; i < 1000 && !log.convertBands; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  REQUIRE(log.convertBands == 3);
+  REQUIRE(log.hasConvertExecutor);
+}
+
+TEST_CASE("SessionManager gives each session its own sink without fan out.",
+          "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, false); });
+  REQUIRE(manager.connect(1, "a"));
+  REQUIRE(manager.connect(2, "b"));
+  REQUIRE(manager.getGroupCount() == 2);
+  manager.pushFrame(app::MAIN_VIEW, makeFrame());
+  REQUIRE(waitForWrites(log, 2));
+  manager.disconnect(1);
+  REQUIRE(manager.getGroupCount() == 1);
+  REQUIRE(log.closed == 1);
+}
+TEST_CASE("SessionManager measures input latency per session.", "[SESSION_MANAGER]") {
+  SinkLog log;
+  app::SessionManager manager(4, 4, [&log]() { return std::make_unique<FakeSink>(log, true); });
+  REQUIRE(manager.connect(1, "a"));
+  REQUIRE(manager.connect(2, "b", {2, 60, 0}));
+
+  auto start = app::FrameClock::now();
+  manager.onInput(1, start);
+  manager.onInput(1, start + std::chrono::milliseconds(5)); // oldest one counts
+  manager.onInput(2, start);
+  manager.onInput(3, start); // not connected
+  app::Frame frame = makeFrame();
+  frame.captureTime = start + std::chrono::milliseconds(20);
+  manager.pushFrame(app::MAIN_VIEW, frame);
+  // shown once
+  frame.captureTime += std::chrono::milliseconds(20);
+  manager.pushFrame(app::MAIN_VIEW, frame);
+
+  auto stats = manager.getInputLatencyStats(1);
+  REQUIRE(stats.frames == 1);
+  REQUIRE(stats.avgMs == Approx(20.0));
+  REQUIRE(stats.maxMs == Approx(20.0));
+  // view 2 wasn't pushed
+  REQUIRE(manager.getInputLatencyStats(2).frames == 0);
+  REQUIRE(manager.getInputLatencyStats(3).frames == 0);
+}
+} // namespace session_manager_test
@@ -3,16 +3,34 @@
 #include "types.h"
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <utility>
 /**
  * @brief The Buffer class
  *
  * Represents data buffer. Can be use to store content of binary files.
+ *
+ * A buffer can also wrap memory it doesn't own (see Buffer::wrap), ie mapped
+ * GPU memory, the release callback is called instead of delete[].
  */
 class Buffer {
+public:
+  using ReleaseCallback = std::function<void(uchar *data)>;
+
 private:
-  uchar *buf;
-  size_t size;
-  uint alignment;
+  uchar *buf = nullptr;
+  size_t size = 0;
+  uint alignment = 0;
+  ReleaseCallback release;
+
+  void free() {
+    if (release)
+      release(buf);
+    else if (buf)
+      delete[] buf;
+    buf = nullptr;
+    release = nullptr;
+  }
 
 public:
   explicit Buffer(size_t size, uint alignment = 0) : size(size), alignment(alignment) {
@@ -24,36 +42,56 @@ public:
       memcpy((void *)this->buf, (void *)data, size);
     else {
       delete[] buf;
+      buf = nullptr;
       this->size = 0;
     }
   }
 
   Buffer() = default;
 
+  /**
+   * @brief wrap - buffer that refers to data without copying it
+   * @param release - called with data when the buffer is destroyed
+   */
+  static Buffer wrap(uchar *data, size_t size, ReleaseCallback release, uint alignment = 0) {
+    Buffer buffer;
+    buffer.buf = data;
+    buffer.size = size;
+    buffer.alignment = alignment;
+    buffer.release = std::move(release);
+    return buffer;
+  }
+
   Buffer(const Buffer &buffer) : Buffer(buffer.data(), buffer.size, buffer.alignment) {}
 
   Buffer(Buffer &&buffer) {
     this->buf = buffer.buf;
     this->size = buffer.size;
     this->alignment = buffer.alignment;
+    this->release = std::move(buffer.release);
     buffer.buf = nullptr;
     buffer.size = 0;
     buffer.alignment = 0;
+    buffer.release = nullptr;
   };
   Buffer &operator=(Buffer &&buffer) {
+    if (this == &buffer) return *this;
+    free();
     this->buf = buffer.buf;
     this->size = buffer.size;
     this->alignment = buffer.alignment;
+    this->release = std::move(buffer.release);
     buffer.buf = nullptr;
     buffer.size = 0;
     buffer.alignment = 0;
+    buffer.release = nullptr;
     return *this;
   }
 
   Buffer &operator=(Buffer &) = delete;
 
   ~Buffer() {
-    if (buf) delete[] buf;
+    free();
     size = 0;
   }
 
@@ -64,6 +102,6 @@ public:
   uint getAlignment() const { return alignment; }
   void clear() { memset(buf, 0, size); }
   static size_t align(size_t offset, uint alignment) {
-    return (offset + (alignment - 1)) & -alignment;
+    return (offset + (alignment - 1)) & ~(size_t(alignment) - 1);
   }
 };
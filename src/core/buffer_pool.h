@@ -0,0 +1,143 @@
+#pragma once
+
+#include "buffer.h"
+#include "image.h"
+#include "ring_buffer.h"
+#include "types.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+
+/**
+ * @brief The BufferPool class
+ * Recycles fixed size, aligned slabs for buffers that are allocated every frame
+ * ie readback frames, instead of new/delete per frame.
+ *
+ * acquire returns a Buffer (see Buffer::wrap) which returns its slab to the pool
+ * when destroyed, on any thread. So a shared_ptr<Image> holding it works as a
+ * ref counted handle, the slab goes back once the last consumer drops it.
+ *
+ * Slab size follows the last requested size, if it changes (ie window resize)
+ * slabs of the old size are freed instead of reused. At most maxFree (rounded up
+ * to a power of 2) slabs are kept, extra slabs are freed on release.
+ */
+class BufferPool : NonCopyable {
+public:
+  static constexpr uint DEFAULT_ALIGNMENT = 64;
+  static constexpr size_t DEFAULT_MAX_FREE = 8;
+
+  struct Stats {
+    size_t hits;      // acquire served from a free slab
+    size_t misses;    // acquire had to allocate
+    size_t inUse;     // slabs currently handed out
+    size_t highWater; // max inUse
+  };
+
+  explicit BufferPool(size_t maxFree = DEFAULT_MAX_FREE, uint alignment = DEFAULT_ALIGNMENT)
+      : shared(std::make_shared<Shared>(maxFree, alignment)) {}
+
+  /**
+   * @brief acquire - buffer of size bytes, content is undefined
+   */
+  Buffer acquire(size_t size) {
+    Shared &pool = *shared;
+    if (pool.slabSize.load(std::memory_order_relaxed) != size)
+      pool.slabSize.store(size, std::memory_order_relaxed);
+
+    Slab slab;
+    bool hit = false;
+    while (pool.freeSlabs.tryPopFront(slab)) {
+      if (slab.size == size) {
+        hit = true;
+        break;
+      }
+      std::free(slab.data); // stale size
+    }
+    if (hit) {
+      pool.hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      pool.misses.fetch_add(1, std::memory_order_relaxed);
+      slab = {allocate(size, pool.alignment), size};
+    }
+
+    size_t inUse = pool.inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t highWater = pool.highWater.load(std::memory_order_relaxed);
+    while (highWater < inUse &&
+           !pool.highWater.compare_exchange_weak(highWater, inUse, std::memory_order_relaxed))
+      ;
+
+    // the callback keeps the pool state alive, buffers may outlive the pool
+    std::shared_ptr<Shared> owner = shared;
+    return Buffer::wrap(
+        slab.data, size, [owner, size](uchar *data) { owner->release({data, size}); },
+        owner->alignment);
+  }
+
+  /**
+   * @brief acquireImage - pooled image of width x height with 4-byte row alignment
+   */
+  std::shared_ptr<Image> acquireImage(int width, int height, int numChannels) {
+    size_t stride = Buffer::align(numChannels * width, 4);
+    return std::make_shared<Image>(acquire(stride * height), width, height, numChannels);
+  }
+
+  Stats getStats() const {
+    return {shared->hits.load(std::memory_order_relaxed),
+            shared->misses.load(std::memory_order_relaxed),
+            shared->inUse.load(std::memory_order_relaxed),
+            shared->highWater.load(std::memory_order_relaxed)};
+  }
+  void resetStats() {
+    shared->hits.store(0, std::memory_order_relaxed);
+    shared->misses.store(0, std::memory_order_relaxed);
+    shared->highWater.store(shared->inUse.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+  }
+  size_t getSlabSize() const { return shared->slabSize.load(std::memory_order_relaxed); }
+  uint getAlignment() const { return shared->alignment; }
+
+private:
+  struct Slab {
+    uchar *data = nullptr;
+    size_t size = 0;
+  };
+
+  struct Shared {
+    const uint alignment;
+    RingBuffer<Slab> freeSlabs;
+    std::atomic<size_t> slabSize;
+    std::atomic<size_t> hits;
+    std::atomic<size_t> misses;
+    std::atomic<size_t> inUse;
+    std::atomic<size_t> highWater;
+
+    Shared(size_t maxFree, uint alignment)
+        : alignment(alignment), freeSlabs(std::max<size_t>(maxFree, 1), OverflowPolicy::DROP_NEWEST),
+          slabSize(0), hits(0), misses(0), inUse(0), highWater(0) {
+      assert(alignment && !(alignment & (alignment - 1)) &&
+             "BufferPool alignment must be a power of 2.");
+    }
+
+    ~Shared() {
+      Slab slab;
+      while (freeSlabs.tryPopFront(slab))
+        std::free(slab.data);
+    }
+
+    void release(Slab slab) {
+      inUse.fetch_sub(1, std::memory_order_relaxed);
+      // DROP_NEWEST, pushBack fails if maxFree slabs are already pooled
+      if (slab.size != slabSize.load(std::memory_order_relaxed) || !freeSlabs.pushBack(slab))
+        std::free(slab.data);
+    }
+  };
+
+  std::shared_ptr<Shared> shared;
+
+  static uchar *allocate(size_t size, uint alignment) {
+    // aligned_alloc requires size to be a multiple of alignment
+    return static_cast<uchar *>(std::aligned_alloc(alignment, Buffer::align(size, alignment)));
+  }
+};
@@ -0,0 +1,65 @@
+#include "buffer_pool.h"
+#include "third_party/catch.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_CASE("BufferPool reuses released slabs.", "[BUFFER_POOL]") {
+  BufferPool pool(4);
+  const uchar *first;
+  {
+    Buffer buffer = pool.acquire(1000);
+    REQUIRE(buffer.isValid());
+    REQUIRE(buffer.getSize() == 1000);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.data()) % BufferPool::DEFAULT_ALIGNMENT == 0);
+    first = buffer.data();
+    REQUIRE(pool.getStats().inUse == 1);
+  }
+  auto stats = pool.getStats();
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.inUse == 0);
+
+  Buffer buffer = pool.acquire(1000);
+  REQUIRE(buffer.data() == first);
+  stats = pool.getStats();
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.highWater == 1);
+}
+
+TEST_CASE("BufferPool tracks high water & drops stale sizes.", "[BUFFER_POOL]") {
+  BufferPool pool(2);
+  {
+    std::vector<std::shared_ptr<Image>> images;
+    for (int i = 0; i < 5; ++i)
+      images.push_back(pool.acquireImage(33, 10, 4));
+    REQUIRE(images[0]->getBuffer()->getSize() == 33 * 4 * 10);
+    REQUIRE(pool.getStats().highWater == 5);
+    REQUIRE(pool.getStats().misses == 5);
+  }
+  // only maxFree slabs were kept
+  for (int i = 0; i < 3; ++i)
+    pool.acquire(33 * 4 * 10);
+  REQUIRE(pool.getStats().hits == 3);
+
+  pool.resetStats();
+  Buffer resized = pool.acquire(2000);
+  REQUIRE(pool.getSlabSize() == 2000);
+  REQUIRE(pool.getStats().misses == 1);
+  REQUIRE(pool.getStats().highWater == 1);
+}
+
+TEST_CASE("BufferPool buffers released on other threads & after the pool.", "[BUFFER_POOL]") {
+  auto pool = std::make_unique<BufferPool>();
+  std::vector<std::shared_ptr<Image>> frames;
+  for (int i = 0; i < 4; ++i)
+    frames.push_back(pool->acquireImage(64, 64, 4));
+
+  std::thread consumer([&frames]() { frames.resize(2); });
+  consumer.join();
+  REQUIRE(pool->getStats().inUse == 2);
+
+  pool.reset();
+  // slabs are freed by the last buffer
+  frames.clear();
+}
@@ -0,0 +1,30 @@
+#include "buffer.h"
+#include "third_party/catch.hpp"
+#include <utility>
+
+TEST_CASE("Buffer wrap releases instead of deleting.", "[BUFFER]") {
+  uchar data[16] = {1, 2, 3};
+  int released = 0;
+  {
+    Buffer buffer = Buffer::wrap(data, sizeof(data), [&released, &data](uchar *ptr) {
+      REQUIRE(ptr == data);
+      ++released;
+    });
+    REQUIRE(buffer.isValid());
+    REQUIRE(buffer.data() == data);
+    REQUIRE(buffer.getSize() == sizeof(data));
+
+    // ownership moves with the buffer
+    Buffer moved(std::move(buffer));
+    REQUIRE_FALSE(buffer.isValid());
+    Buffer assigned(4);
+    assigned = std::move(moved);
+    REQUIRE(released == 0);
+
+    // copies own their memory
+    Buffer copy(assigned);
+    REQUIRE(copy.data() != data);
+    REQUIRE(copy.data()[2] == 3);
+  }
+  REQUIRE(released == 1);
+}
@@ -0,0 +1,149 @@
+#include "frame_diff.h"
+#include "image.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#if defined(__x86_64__)
+#define FRAME_DIFF_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * 4 lane multiply-accumulate hash (like xxh3's accumulate loop) over 32-byte
+ * blocks: acc += lo32(data ^ key) * hi32(data ^ key) + data.
+ * Keys change per block and lanes are scrambled after each row, so moved
+ * blocks or rows change the hash.
+ */
+constexpr u64 KEYS[4] = {0x9E3779B185EBCA87ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+                         0x85EBCA77C2B2AE63ull};
+constexpr u64 BLOCK_STEP = 0x27D4EB2F165667C5ull;
+constexpr u64 PRIME32 = 0x9E3779B1ull;
+constexpr int BLOCK_SIZE = 32;
+
+void hashRowsScalar(const uchar *data, int stride, int bytes, int height, u64 acc[4]) {
+  for (int y = 0; y < height; ++y) {
+    const uchar *row = data + size_t(stride) * y;
+    u64 step = 0;
+    for (int offset = 0; offset < bytes; offset += BLOCK_SIZE, step += BLOCK_STEP) {
+      u64 block[4] = {};
+      std::memcpy(block, row + offset, std::min(BLOCK_SIZE, bytes - offset));
+      for (int i = 0; i < 4; ++i) {
+        u64 dk = block[i] ^ (KEYS[i] + step);
+        acc[i] += (dk & 0xFFFFFFFF) * (dk >> 32) + block[i];
+      }
+    }
+    for (int i = 0; i < 4; ++i) {
+      acc[i] ^= acc[i] >> 47;
+      acc[i] *= PRIME32;
+    }
+  }
+}
+
+#ifdef FRAME_DIFF_X86
+__attribute__((target("avx2"))) void hashRowsAvx2(const uchar *data, int stride, int bytes,
+                                                   int height, u64 acc[4]) {
+  __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc));
+  const __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(KEYS));
+  const __m256i step = _mm256_set1_epi64x(BLOCK_STEP);
+  const __m256i prime = _mm256_set1_epi64x(PRIME32);
+  const int fullBytes = bytes - bytes % BLOCK_SIZE;
+  for (int y = 0; y < height; ++y) {
+    const uchar *row = data + size_t(stride) * y;
+    __m256i key = keys;
+    for (int offset = 0; offset < bytes; offset += BLOCK_SIZE) {
+      __m256i d;
+      if (offset < fullBytes) {
+        d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + offset));
+      } else {
+        alignas(32) uchar tail[BLOCK_SIZE] = {};
+        std::memcpy(tail, row + offset, bytes - offset);
+        d = _mm256_load_si256(reinterpret_cast<const __m256i *>(tail));
+      }
+      __m256i dk = _mm256_xor_si256(d, key);
+      a = _mm256_add_epi64(a, _mm256_add_epi64(_mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32)), d));
+      key = _mm256_add_epi64(key, step);
+    }
+    // acc * PRIME32 mod 2^64 from two 32x32 multiplies
+    a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+    __m256i lo = _mm256_mul_epu32(a, prime);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+    a = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc), a);
+}
+#endif
+
+inline u64 rotl(u64 value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+// murmur3 finalizer
+inline u64 mix(u64 h) {
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDull;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ull;
+  return h ^ (h >> 33);
+}
+
+bool hasAvx2() {
+#ifdef FRAME_DIFF_X86
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+#else
+  return false;
+#endif
+}
+} // namespace
+
+FrameDiff::FrameDiff(int tileSize) : tileSize(tileSize), width(0), height(0), stats{} {
+  assert(tileSize > 0 && "Tile size must be > 0.");
+}
+
+u64 FrameDiff::hashTile(const uchar *data, int stride, int width, int height, bool useSimd) {
+  u64 acc[4] = {KEYS[0], KEYS[1], KEYS[2], KEYS[3]};
+#ifdef FRAME_DIFF_X86
+  if (useSimd && hasAvx2())
+    hashRowsAvx2(data, stride, width * 4, height, acc);
+  else
+#endif
+    hashRowsScalar(data, stride, width * 4, height, acc);
+  u64 h = acc[0] + rotl(acc[1], 17) + rotl(acc[2], 31) + rotl(acc[3], 47);
+  return mix(h ^ (u64(width) << 32 | u32(height)));
+}
+
+size_t FrameDiff::update(const Image &frame) {
+  assert(frame.getNumChannels() == 4 && "Only 4 channel images can be compared.");
+  const int stride = Buffer::align(4 * frame.getWidth(), 4);
+  const int tilesX = (frame.getWidth() + tileSize - 1) / tileSize;
+  const int tilesY = (frame.getHeight() + tileSize - 1) / tileSize;
+  const uchar *data = frame.getBuffer()->data();
+
+  // everything is dirty if there is nothing to compare with
+  bool isFullFrame = frame.getWidth() != width || frame.getHeight() != height ||
+                     hashes.size() != size_t(tilesX) * tilesY;
+  if (isFullFrame) {
+    width = frame.getWidth();
+    height = frame.getHeight();
+    hashes.assign(size_t(tilesX) * tilesY, 0);
+  }
+
+  dirtyTiles.clear();
+  for (int ty = 0; ty < tilesY; ++ty) {
+    for (int tx = 0; tx < tilesX; ++tx) {
+      Tile tile = {tx * tileSize, ty * tileSize, std::min(tileSize, width - tx * tileSize),
+                   std::min(tileSize, height - ty * tileSize)};
+      u64 hash = hashTile(data + size_t(tile.y) * stride + tile.x * 4, stride, tile.width,
+                          tile.height);
+      u64 &previous = hashes[size_t(ty) * tilesX + tx];
+      if (isFullFrame || hash != previous) dirtyTiles.push_back(tile);
+      previous = hash;
+    }
+  }
+
+  ++stats.frames;
+  if (dirtyTiles.empty()) ++stats.unchangedFrames;
+  stats.changedTiles += dirtyTiles.size();
+  stats.totalTiles += hashes.size();
+  return dirtyTiles.size();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <vector>
+
+class Image;
+/**
+ * @brief The FrameDiff class
+ * Detects which tiles of a frame changed since the previous frame, so the
+ * streaming path can skip identical frames.
+ *
+ * Each tile is hashed (see hashTile) and compared with the hash of the previous
+ * frame, only hashes are kept, not the previous frame. The first frame and
+ * frames after a size change or reset are fully dirty.
+ */
+class FrameDiff : NonCopyable {
+public:
+  static constexpr int DEFAULT_TILE_SIZE = 64;
+
+  // in pixels
+  struct Tile {
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  struct Stats {
+    size_t frames;
+    size_t unchangedFrames;
+    size_t changedTiles;
+    size_t totalTiles;
+    double getChangedTileRatio() const { return totalTiles ? double(changedTiles) / totalTiles : 0.0; }
+  };
+
+  explicit FrameDiff(int tileSize = DEFAULT_TILE_SIZE);
+
+  /**
+   * @brief update - compares frame (4 channels, 4-byte aligned rows) with the
+   * previous one
+   * @return number of changed tiles, 0 if the frame is identical
+   */
+  size_t update(const Image &frame);
+  // changed tiles of the last update
+  const std::vector<Tile> &getDirtyTiles() const { return dirtyTiles; }
+  // next frame is fully dirty, ie a new client needs a complete frame
+  void reset() { hashes.clear(); }
+
+  Stats getStats() const { return stats; }
+  void resetStats() { stats = {}; }
+  int getTileSize() const { return tileSize; }
+
+  /**
+   * @brief hashTile - 64-bit hash of width x height pixels (4 bytes each)
+   * @param useSimd - AVX2 when supported, same result as the scalar path
+   */
+  static u64 hashTile(const uchar *data, int stride, int width, int height, bool useSimd = true);
+
+private:
+  const int tileSize;
+  int width;
+  int height;
+  std::vector<u64> hashes; // previous frame, row major tiles
+  std::vector<Tile> dirtyTiles;
+  Stats stats;
+};
@@ -0,0 +1,62 @@
+#include "frame_diff.h"
+#include "image.h"
+#include "third_party/catch.hpp"
+#include <random>
+
+namespace frame_diff_test {
+
+Image randomImage(int width, int height, unsigned seed) {
+  std::mt19937 random(seed);
+  Buffer buffer(size_t(width) * height * 4);
+  for (size_t i = 0; i < buffer.getSize(); ++i)
+    buffer.data()[i] = uchar(random());
+  return Image(std::move(buffer), width, height, 4);
+}
+
+TEST_CASE("FrameDiff detects changed tiles.", "[FRAME_DIFF]") {
+  FrameDiff frameDiff(16);
+  Image frame = randomImage(70, 40, 1); // 5x3 tiles, partial edges
+  REQUIRE(frameDiff.update(frame) == 15);
+  REQUIRE(frameDiff.update(frame) == 0);
+
+  // single pixel in the bottom right edge tile
+  Image changed(frame);
+  const_cast<uchar *>(changed.getBuffer()->data())[(39 * 70 + 69) * 4 + 1] ^= 1;
+  REQUIRE(frameDiff.update(changed) == 1);
+  auto tile = frameDiff.getDirtyTiles()[0];
+  REQUIRE(tile.x == 64);
+  REQUIRE(tile.y == 32);
+  REQUIRE(tile.width == 6);
+  REQUIRE(tile.height == 8);
+  REQUIRE(frameDiff.update(changed) == 0);
+
+  frameDiff.reset();
+  REQUIRE(frameDiff.update(changed) == 15);
+  // size change
+  REQUIRE(frameDiff.update(randomImage(32, 32, 1)) == 4);
+
+  auto stats = frameDiff.getStats();
+  REQUIRE(stats.frames == 6);
+  REQUIRE(stats.unchangedFrames == 2);
+  REQUIRE(stats.changedTiles == 15 + 1 + 15 + 4);
+  REQUIRE(stats.totalTiles == 5 * 15 + 4);
+}
+
+TEST_CASE("FrameDiff hash is order sensitive & matches scalar.", "[FRAME_DIFF]") {
+  Image image = randomImage(67, 9, 2);
+  const uchar *data = image.getBuffer()->data();
+  for (int width : {1, 7, 8, 9, 16, 67}) {
+    REQUIRE(FrameDiff::hashTile(data, 67 * 4, width, 9, true) ==
+            FrameDiff::hashTile(data, 67 * 4, width, 9, false));
+  }
+
+  // swapped rows & swapped 32-byte blocks
+  Buffer rows(64 * 2 * 4);
+  for (size_t i = 0; i < rows.getSize(); ++i)
+    rows.data()[i] = uchar(i / 32);
+  u64 hash = FrameDiff::hashTile(rows.data(), 64 * 4, 64, 2);
+  REQUIRE(hash != FrameDiff::hashTile(rows.data() + 64 * 4, -64 * 4, 64, 2));
+  std::swap_ranges(rows.data(), rows.data() + 32, rows.data() + 32);
+  REQUIRE(hash != FrameDiff::hashTile(rows.data(), 64 * 4, 64, 2));
+}
+} // namespace frame_diff_test
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief radixSort - stable LSD radix sort of items by a 64-bit key, 8 bits per
+ * pass.
+ *
+ * Histograms of all passes are built in one read of the keys, passes whose
+ * byte is the same for every key are skipped, so keys using only their high &
+ * low bits cost few passes. scratch is resized to items & can be kept between
+ * calls to avoid allocations, its content is unspecified afterwards.
+ *
+ * @param keyOf - u64 keyOf(const T &), called a few times per item
+ */
+template <typename T, typename KeyOf>
+void radixSort(std::vector<T> &items, std::vector<T> &scratch, KeyOf keyOf) {
+  constexpr uint RADIX_BITS = 8;
+  constexpr uint BUCKETS = 1 << RADIX_BITS;
+  constexpr uint PASSES = 64 / RADIX_BITS;
+  const size_t count = items.size();
+  if (count < 2) return;
+
+  std::array<std::array<size_t, BUCKETS>, PASSES> histograms;
+  std::memset(histograms.data(), 0, sizeof(histograms));
+  for (const T &item : items) {
+    u64 key = keyOf(item);
+    for (uint pass = 0; pass < PASSES; ++pass)
+      ++histograms[pass][(key >> (pass * RADIX_BITS)) & (BUCKETS - 1)];
+  }
+
+  scratch.resize(count);
+  std::vector<T> *from = &items;
+  std::vector<T> *to = &scratch;
+  for (uint pass = 0; pass < PASSES; ++pass) {
+    std::array<size_t, BUCKETS> &offsets = histograms[pass];
+    const uint shift = pass * RADIX_BITS;
+    // every key has the same byte, order doesn't change
+    if (offsets[(keyOf(from->front()) >> shift) & (BUCKETS - 1)] == count) continue;
+
+    size_t offset = 0;
+    for (size_t &bucket : offsets) {
+      size_t bucketCount = bucket;
+      bucket = offset;
+      offset += bucketCount;
+    }
+    for (const T &item : *from)
+      (*to)[offsets[(keyOf(item) >> shift) & (BUCKETS - 1)]++] = item;
+    std::swap(from, to);
+  }
+  // odd number of passes, sorted items are in scratch
+  if (from != &items) items.swap(scratch);
+}
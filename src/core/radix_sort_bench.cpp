@@ -0,0 +1,74 @@
+#include "radix_sort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * Benchmark, radixSort vs std::stable_sort (RenderQueue's small queue path) &
+ * std::sort on render queue like keys: few programs &
+ * materials in the high bits, vao & depth below, see render_system::RenderQueue.
+ *
+ * usage: radix-sort-bench [items] [iterations]
+ */
+namespace radix_sort_bench {
+
+using Clock = std::chrono::steady_clock;
+
+struct Item {
+  u64 key;
+  u32 index;
+};
+
+std::vector<Item> makeItems(size_t count) {
+  std::mt19937_64 random(1);
+  std::vector<Item> items(count);
+  for (size_t i = 0; i < count; ++i) {
+    u64 program = random() % 2;
+    u64 material = random() % 64;
+    u64 vao = random() % 512;
+    u64 depth = random() & 0xFFFFFF;
+    items[i] = {program << 60 | material << 40 | vao << 24 | depth, u32(i)};
+  }
+  return items;
+}
+
+template <typename Sort> double run(const std::vector<Item> &input, int iterations, Sort sort) {
+  std::vector<Item> items;
+  double totalUs = 0.0;
+  for (int i = 0; i < iterations; ++i) {
+    items = input;
+    auto start = Clock::now();
+    sort(items);
+    totalUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  }
+  return totalUs / iterations;
+}
+} // namespace radix_sort_bench
+
+int main(int argc, char **argv) {
+  using namespace radix_sort_bench;
+  size_t count = argc > 1 ? atoi(argv[1]) : 10000;
+  int iterations = argc > 2 ? atoi(argv[2]) : 200;
+  auto input = makeItems(count);
+
+  std::vector<Item> scratch;
+  double radixUs = run(input, iterations, [&scratch](std::vector<Item> &items) {
+    radixSort(items, scratch, [](const Item &item) { return item.key; });
+  });
+  double stableUs = run(input, iterations, [](std::vector<Item> &items) {
+    std::stable_sort(items.begin(), items.end(),
+                     [](const Item &a, const Item &b) { return a.key < b.key; });
+  });
+  double stdUs = run(input, iterations, [](std::vector<Item> &items) {
+    std::sort(items.begin(), items.end(),
+              [](const Item &a, const Item &b) { return a.key < b.key; });
+  });
+  printf("%zu items, %d iterations\n", count, iterations);
+  printf("%-16s %10s\n", "sort", "us");
+  printf("%-16s %10.1f\n", "radix", radixUs);
+  printf("%-16s %10.1f\n", "std::stable_sort", stableUs);
+  printf("%-16s %10.1f\n", "std::sort", stdUs);
+  return 0;
+}
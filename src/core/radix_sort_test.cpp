@@ -0,0 +1,77 @@
+#include "radix_sort.h"
+#include "third_party/catch.hpp"
+#include <algorithm>
+#include <random>
+
+namespace radix_sort_test {
+
+struct Item {
+  u64 key;
+  u32 index; // submission order
+};
+
+u64 keyOf(const Item &item) { return item.key; }
+
+std::vector<Item> makeItems(size_t count, u64 keyMask, unsigned seed) {
+  std::mt19937_64 random(seed);
+  std::vector<Item> items(count);
+  for (size_t i = 0; i < count; ++i)
+    items[i] = {random() & keyMask, u32(i)};
+  return items;
+}
+
+bool isStableSorted(const std::vector<Item> &items) {
+  return std::is_sorted(items.begin(), items.end(), [](const Item &a, const Item &b) {
+    return a.key < b.key || (a.key == b.key && a.index < b.index);
+  });
+}
+
+TEST_CASE("radixSort sorts by key and keeps equal keys in order.", "[RADIX_SORT]") {
+  std::vector<Item> scratch;
+  SECTION("Full keys") {
+    auto items = makeItems(5000, ~u64(0), 1);
+    radixSort(items, scratch, keyOf);
+    REQUIRE(items.size() == 5000);
+    REQUIRE(isStableSorted(items));
+  }
+  SECTION("Few distinct keys") {
+    auto items = makeItems(5000, 0x7, 2);
+    radixSort(items, scratch, keyOf);
+    REQUIRE(isStableSorted(items));
+  }
+  SECTION("Odd number of varying bytes") {
+    // bytes 0, 3 & 7 vary, the other passes are skipped
+    auto items = makeItems(1000, 0xFF000000FF0000FFull, 3);
+    radixSort(items, scratch, keyOf);
+    REQUIRE(isStableSorted(items));
+  }
+  SECTION("Equal keys") {
+    auto items = makeItems(100, 0, 4);
+    radixSort(items, scratch, keyOf);
+    REQUIRE(isStableSorted(items));
+  }
+  SECTION("Empty & single item") {
+    std::vector<Item> items;
+    radixSort(items, scratch, keyOf);
+    REQUIRE(items.empty());
+    items.push_back({42, 0});
+    radixSort(items, scratch, keyOf);
+    REQUIRE(items.front().key == 42);
+  }
+}
+
+TEST_CASE("radixSort matches std::stable_sort.", "[RADIX_SORT]") {
+  std::vector<Item> scratch;
+  for (unsigned seed = 0; seed < 8; ++seed) {
+    auto items = makeItems(1 + seed * 97, 0xF0F00000000000FFull >> seed, seed);
+    auto expected = items;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const Item &a, const Item &b) { return a.key < b.key; });
+    radixSort(items, scratch, keyOf);
+    for (size_t i = 0; i < items.size(); ++i) {
+      REQUIRE(items[i].key == expected[i].key);
+      REQUIRE(items[i].index == expected[i].index);
+    }
+  }
+}
+} // namespace radix_sort_test
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "types.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/**
+ * What pushBack does when the ring buffer is full.
+ *
+ * DROP_OLDEST - the oldest item is discarded to make room, ie live frames
+ * BLOCK - producer waits (spins/yields) until there is space or the buffer is closed
+ * DROP_NEWEST - the new item is discarded and pushBack returns false
+ */
+enum class OverflowPolicy { DROP_OLDEST, BLOCK, DROP_NEWEST };
+
+/**
+ * @brief The RingBuffer class
+ * Bounded lock free MPMC queue, also used as SPSC.
+ *
+ * Each slot carries a sequence number that tells producers and consumers
+ * whether it is free or holds an item for the current lap, so push & pop only
+ * need a CAS on the head/tail index. Capacity is rounded up to a power of 2.
+ */
+template <typename T> class RingBuffer : NonCopyable {
+public:
+  explicit RingBuffer(size_t capacity, OverflowPolicy policy = OverflowPolicy::DROP_OLDEST)
+      : capacity(roundUpPow2(capacity)), mask(this->capacity - 1), policy(policy),
+        slots(new Slot[this->capacity]), head(0), tail(0), dropped(0), closed(false) {
+    for (size_t i = 0; i < this->capacity; ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief pushBack
+   * @return false if item was dropped (DROP_NEWEST) or buffer is closed.
+   */
+  bool pushBack(T item) {
+    while (!tryPush(item)) {
+      if (closed.load(std::memory_order_relaxed)) return false;
+      switch (policy) {
+      case OverflowPolicy::DROP_NEWEST:
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      case OverflowPolicy::DROP_OLDEST: {
+        T oldest;
+        if (tryPopFront(oldest)) dropped.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+      case OverflowPolicy::BLOCK:
+        std::this_thread::yield();
+        break;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief tryPopFront - never blocks
+   * @return false if empty
+   */
+  bool tryPopFront(T &front) {
+    size_t pos = head.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[pos & mask];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          front = std::move(slot.data);
+          slot.data = T();
+          // free the slot for the producer one lap ahead
+          slot.sequence.store(pos + capacity, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief popGetFront - waits until an item is available, same as
+   * SharedQueue::popGetFront. Consumer backs off from spinning to short sleeps.
+   * @param discard - set by another thread to stop waiting
+   * @return false if discard was set or the buffer is closed
+   */
+  bool popGetFront(T &front, const std::atomic<bool> &discard) {
+    for (uint spins = 0; !tryPopFront(front); ++spins) {
+      if (discard.load(std::memory_order_relaxed) || closed.load(std::memory_order_relaxed))
+        return false;
+      if (spins < 64)
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+  }
+
+  // wakes blocked producers/consumers, they return false
+  void close() { closed.store(true, std::memory_order_relaxed); }
+
+  // approximate when used concurrently
+  size_t size() const {
+    size_t t = tail.load(std::memory_order_acquire);
+    size_t h = head.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+  }
+  bool isEmpty() const { return size() == 0; }
+  size_t getCapacity() const { return capacity; }
+  // items discarded by the overflow policy
+  size_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr size_t CACHE_LINE = 64;
+  struct alignas(CACHE_LINE) Slot {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  const size_t capacity;
+  const size_t mask;
+  const OverflowPolicy policy;
+  std::unique_ptr<Slot[]> slots;
+  // head & tail on their own cache lines to avoid false sharing
+  alignas(CACHE_LINE) std::atomic<size_t> head;
+  alignas(CACHE_LINE) std::atomic<size_t> tail;
+  alignas(CACHE_LINE) std::atomic<size_t> dropped;
+  std::atomic<bool> closed;
+
+  static size_t roundUpPow2(size_t value) {
+    assert(value && "RingBuffer capacity must be > 0.");
+    size_t pow2 = 1;
+    while (pow2 < value)
+      pow2 <<= 1;
+    return pow2 < 2 ? 2 : pow2;
+  }
+
+  bool tryPush(T &item) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[pos & mask];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.data = std::move(item);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+};
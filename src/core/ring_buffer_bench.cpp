@@ -0,0 +1,103 @@
+#include "ring_buffer.h"
+#include "shared_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Benchmark, SharedQueue vs RingBuffer on the frame hand off pattern: one
+ * producer (render thread) pushes shared_ptr items, one consumer pops them.
+ *
+ * throughput - producer pushes as fast as it can
+ * latency - producer is paced, time from push to pop is recorded
+ */
+namespace ring_buffer_bench {
+
+using Clock = std::chrono::steady_clock;
+// frame stand in, carries the push time
+using Item = std::shared_ptr<Clock::time_point>;
+
+struct Result {
+  double itemsPerSecond;
+  double pushNs; // average time spent in push
+  double latencyAvgUs;
+  double latencyP99Us;
+};
+
+struct SharedQueueAdapter {
+  SharedQueue<Item> queue;
+  void push(Item item) { queue.pushBack(std::move(item)); }
+  bool pop(Item &item, const std::atomic<bool> &discard) {
+    // SharedQueue reads discard under its mutex, the bench never sets it
+    bool stop = discard;
+    return queue.popGetFront(item, stop);
+  }
+};
+
+struct RingBufferAdapter {
+  RingBuffer<Item> ringBuffer{256, OverflowPolicy::BLOCK};
+  void push(Item item) { ringBuffer.pushBack(std::move(item)); }
+  bool pop(Item &item, const std::atomic<bool> &discard) {
+    return ringBuffer.popGetFront(item, discard);
+  }
+};
+
+template <typename Queue> Result run(size_t items, std::chrono::microseconds pacing) {
+  Queue queue;
+  std::vector<double> latencies;
+  latencies.reserve(items);
+  std::atomic<bool> discard(false);
+
+  std::thread consumer([&]() {
+    Item item;
+    for (size_t i = 0; i < items; ++i) {
+      queue.pop(item, discard);
+      latencies.push_back(
+          std::chrono::duration<double, std::micro>(Clock::now() - *item).count());
+    }
+  });
+
+  double pushNs = 0.0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < items; ++i) {
+    Item item = std::make_shared<Clock::time_point>(Clock::now());
+    auto pushStart = Clock::now();
+    queue.push(std::move(item));
+    pushNs += std::chrono::duration<double, std::nano>(Clock::now() - pushStart).count();
+    if (pacing.count()) std::this_thread::sleep_for(pacing);
+  }
+  consumer.join();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  double latencySum = 0.0;
+  for (double latency : latencies)
+    latencySum += latency;
+  return {items / seconds, pushNs / items, latencySum / items,
+          latencies[std::min(items - 1, items * 99 / 100)]};
+}
+
+void print(const char *name, const Result &result) {
+  printf("%-14s %14.0f %12.1f %14.2f %14.2f\n", name, result.itemsPerSecond, result.pushNs,
+         result.latencyAvgUs, result.latencyP99Us);
+}
+} // namespace ring_buffer_bench
+
+int main() {
+  using namespace ring_buffer_bench;
+  const char *header = "%-14s %14s %12s %14s %14s\n";
+
+  printf("throughput, 1000000 items\n");
+  printf(header, "queue", "items/s", "push(ns)", "latency(us)", "p99(us)");
+  print("SharedQueue", run<SharedQueueAdapter>(1000000, std::chrono::microseconds(0)));
+  print("RingBuffer", run<RingBufferAdapter>(1000000, std::chrono::microseconds(0)));
+
+  printf("\nlatency, 5000 items paced at 100us\n");
+  printf(header, "queue", "items/s", "push(ns)", "latency(us)", "p99(us)");
+  print("SharedQueue", run<SharedQueueAdapter>(5000, std::chrono::microseconds(100)));
+  print("RingBuffer", run<RingBufferAdapter>(5000, std::chrono::microseconds(100)));
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include "ring_buffer.h"
+#include "third_party/catch.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_CASE("RingBuffer push & pop in order.", "[RING_BUFFER]") {
+  RingBuffer<int> ringBuffer(5, OverflowPolicy::DROP_NEWEST);
+  REQUIRE(ringBuffer.getCapacity() == 8);
+  REQUIRE(ringBuffer.isEmpty());
+  for (int i = 0; i < 8; ++i)
+    REQUIRE(ringBuffer.pushBack(i));
+  REQUIRE(ringBuffer.size() == 8);
+
+  int front;
+  for (int i = 0; i < 8; ++i) {
+    REQUIRE(ringBuffer.tryPopFront(front));
+    REQUIRE(front == i);
+  }
+  REQUIRE_FALSE(ringBuffer.tryPopFront(front));
+  REQUIRE(ringBuffer.getDroppedCount() == 0);
+}
+
+TEST_CASE("RingBuffer overflow policies.", "[RING_BUFFER]") {
+  int front;
+  SECTION("drop newest") {
+    RingBuffer<int> ringBuffer(4, OverflowPolicy::DROP_NEWEST);
+    for (int i = 0; i < 6; ++i)
+      REQUIRE(ringBuffer.pushBack(i) == (i < 4));
+    REQUIRE(ringBuffer.getDroppedCount() == 2);
+    REQUIRE(ringBuffer.tryPopFront(front));
+    REQUIRE(front == 0);
+  }
+  SECTION("drop oldest") {
+    RingBuffer<int> ringBuffer(4, OverflowPolicy::DROP_OLDEST);
+    for (int i = 0; i < 6; ++i)
+      REQUIRE(ringBuffer.pushBack(i));
+    REQUIRE(ringBuffer.getDroppedCount() == 2);
+    for (int i = 2; i < 6; ++i) {
+      REQUIRE(ringBuffer.tryPopFront(front));
+      REQUIRE(front == i);
+    }
+  }
+  SECTION("block") {
+    constexpr int items = 100000;
+    RingBuffer<int> ringBuffer(16, OverflowPolicy::BLOCK);
+    std::thread producer([&ringBuffer]() {
+      for (int i = 0; i < items; ++i)
+        ringBuffer.pushBack(i);
+    });
+    std::atomic<bool> discard(false);
+    for (int i = 0; i < items; ++i) {
+      REQUIRE(ringBuffer.popGetFront(front, discard));
+      REQUIRE(front == i);
+    }
+    producer.join();
+    REQUIRE(ringBuffer.getDroppedCount() == 0);
+  }
+}
+
+TEST_CASE("RingBuffer releases popped items.", "[RING_BUFFER]") {
+  RingBuffer<std::shared_ptr<int>> ringBuffer(2);
+  auto item = std::make_shared<int>(1);
+  ringBuffer.pushBack(item);
+  REQUIRE(item.use_count() == 2);
+  std::shared_ptr<int> front;
+  REQUIRE(ringBuffer.tryPopFront(front));
+  front.reset();
+  REQUIRE(item.use_count() == 1);
+
+  // dropped items are released too
+  for (int i = 0; i < 3; ++i)
+    ringBuffer.pushBack(item);
+  REQUIRE(item.use_count() == 3);
+}
+
+TEST_CASE("RingBuffer multiple producers & consumers.", "[RING_BUFFER]") {
+  constexpr u64 producers = 4;
+  constexpr u64 consumers = 4;
+  constexpr u64 perProducer = 50000;
+  RingBuffer<u64> ringBuffer(64, OverflowPolicy::BLOCK);
+  std::atomic<u64> sum(0);
+  std::atomic<u64> count(0);
+  std::atomic<bool> discard(false);
+
+  std::vector<std::thread> threads;
+  for (u64 p = 0; p < producers; ++p) {
+    threads.emplace_back([&ringBuffer, p]() {
+      for (u64 i = 0; i < perProducer; ++i)
+        ringBuffer.pushBack(p * perProducer + i);
+    });
+  }
+  for (u64 c = 0; c < consumers; ++c) {
+    threads.emplace_back([&]() {
+      u64 item;
+      while (ringBuffer.popGetFront(item, discard)) {
+        sum += item;
+        if (++count == producers * perProducer) ringBuffer.close();
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  const u64 total = producers * perProducer;
+  REQUIRE(count == total);
+  REQUIRE(sum == total * (total - 1) / 2);
+}
+
+TEST_CASE("RingBuffer wait returns on discard.", "[RING_BUFFER]") {
+  RingBuffer<int> ringBuffer(4);
+  int front;
+  std::atomic<bool> discard(true);
+  REQUIRE_FALSE(ringBuffer.popGetFront(front, discard));
+}
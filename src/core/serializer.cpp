@@ -1,4 +1,115 @@
 #include "serializer.h"
+#if defined(__x86_64__)
+#define SERIALIZER_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * Copies count values of Size bytes from src to dst reversing the bytes of
+ * each value, ie host (little-endian) to network order and back.
+ */
+template <size_t Size> void swapBytesScalar(uchar *dst, const uchar *src, size_t count) {
+  for (size_t i = 0; i < count; ++i, src += Size, dst += Size) {
+    if constexpr (Size == 2) {
+      u16 value;
+      std::memcpy(&value, src, Size);
+      value = __builtin_bswap16(value);
+      std::memcpy(dst, &value, Size);
+    } else if constexpr (Size == 4) {
+      u32 value;
+      std::memcpy(&value, src, Size);
+      value = __builtin_bswap32(value);
+      std::memcpy(dst, &value, Size);
+    } else {
+      u64 value;
+      std::memcpy(&value, src, Size);
+      value = __builtin_bswap64(value);
+      std::memcpy(dst, &value, Size);
+    }
+  }
+}
+
+#ifdef SERIALIZER_X86
+// pshufb mask reversing each Size byte lane of a 16 byte block
+template <size_t Size> constexpr char shuffleIndex(int i) {
+  return char(i - i % Size + (Size - 1 - i % Size));
+}
+
+template <size_t Size>
+__attribute__((target("avx2"))) void swapBytesAvx2(uchar *dst, const uchar *src,
+                                                   size_t count) {
+  const __m256i mask = _mm256_setr_epi8(
+      shuffleIndex<Size>(0), shuffleIndex<Size>(1), shuffleIndex<Size>(2), shuffleIndex<Size>(3),
+      shuffleIndex<Size>(4), shuffleIndex<Size>(5), shuffleIndex<Size>(6), shuffleIndex<Size>(7),
+      shuffleIndex<Size>(8), shuffleIndex<Size>(9), shuffleIndex<Size>(10),
+      shuffleIndex<Size>(11), shuffleIndex<Size>(12), shuffleIndex<Size>(13),
+      shuffleIndex<Size>(14), shuffleIndex<Size>(15), shuffleIndex<Size>(0),
+      shuffleIndex<Size>(1), shuffleIndex<Size>(2), shuffleIndex<Size>(3), shuffleIndex<Size>(4),
+      shuffleIndex<Size>(5), shuffleIndex<Size>(6), shuffleIndex<Size>(7), shuffleIndex<Size>(8),
+      shuffleIndex<Size>(9), shuffleIndex<Size>(10), shuffleIndex<Size>(11),
+      shuffleIndex<Size>(12), shuffleIndex<Size>(13), shuffleIndex<Size>(14),
+      shuffleIndex<Size>(15));
+  const size_t bytes = count * Size;
+  size_t offset = 0;
+  // 4 registers per iteration to keep the load & store ports busy
+  for (; offset + 128 <= bytes; offset += 128) {
+    for (size_t j = 0; j < 128; j += 32) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + offset + j));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + offset + j),
+                          _mm256_shuffle_epi8(v, mask));
+    }
+  }
+  for (; offset + 32 <= bytes; offset += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + offset));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + offset), _mm256_shuffle_epi8(v, mask));
+  }
+  swapBytesScalar<Size>(dst + offset, src + offset, (bytes - offset) / Size);
+}
+#endif
+
+bool hasAvx2() {
+#ifdef SERIALIZER_X86
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+// values are stored big-endian (network order)
+template <size_t Size> void toNetworkOrder(uchar *dst, const uchar *src, size_t count) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  std::memcpy(dst, src, count * Size);
+#else
+#ifdef SERIALIZER_X86
+  if (hasAvx2()) {
+    swapBytesAvx2<Size>(dst, src, count);
+    return;
+  }
+#endif
+  swapBytesScalar<Size>(dst, src, count);
+#endif
+}
+
+template <typename T>
+size_t packValues(Buffer &buffer, size_t bytesUsed, const T *values, size_t count) {
+  assert(bytesUsed + count * sizeof(T) <= buffer.getSize());
+  toNetworkOrder<sizeof(T)>(buffer.data() + bytesUsed, reinterpret_cast<const uchar *>(values),
+                            count);
+  return count * sizeof(T);
+}
+
+template <typename T>
+size_t unPackValues(const Buffer &buffer, size_t bytesUnPacked, T *values, size_t count) {
+  assert(bytesUnPacked + count * sizeof(T) <= buffer.getSize());
+  // swapping is its own inverse
+  toNetworkOrder<sizeof(T)>(reinterpret_cast<uchar *>(values), buffer.data() + bytesUnPacked,
+                            count);
+  return count * sizeof(T);
+}
+} // namespace
 
 void Serializer::pack(Buffer &buffer, size_t bytesUsed, u8 value) {
   assert(bytesUsed + 1 <= buffer.getSize());
@@ -35,70 +146,6 @@ void Serializer::pack(Buffer &buffer, size_t bytesUsed, u64 value) {
   *data = value;
 }
 
-u64 Serializer::pack754(long double value, unsigned bits, unsigned expbits) {
-  long double vnorm;
-  int shift = 0;
-  u64 sign, exp, mantissa;
-  unsigned manbits = bits - expbits - 1;
-
-  if (value == 0.0)
-    return 0;
-
-  // sign
-  if (value < 0.0) {
-    sign = 1;
-    vnorm = -value;
-  } else {
-    sign = 0;
-    vnorm = value;
-  }
-
-  // normalize value and calcuate number of shits required to normalize;
-  while (vnorm >= 2.0) {
-    vnorm /= 2.0;
-    ++shift;
-  }
-  while (vnorm < 1.0) {
-    vnorm *= 2.0f;
-    --shift;
-  }
-  vnorm = vnorm - 1.0f;
-
-  // calcuate mantissa, +0.5f to round off large vnorm values
-  mantissa = vnorm * ((1LL << manbits) + 0.5f);
-  exp = shift + ((1LL << (expbits - 1)) - 1); // adding bias (2^(n-1)-1)
-  // combine all
-  return (sign << (bits - 1)) | (exp << (bits - expbits - 1)) | mantissa;
-}
-
-long double Serializer::unPack754(u64 value, unsigned bits, unsigned expbits) {
-  long double result;
-  long long shift;
-  unsigned bias;
-  unsigned manbits = bits - expbits - 1;
-
-  if (value == 0)
-    return 0.0;
-  result = (value & ((1LL << manbits) - 1)); // extract mantissa
-  result /= (1LL << manbits);                // convert to floating point
-  result += 1.0;                             // back to normal form(normalize)
-
-  // apply exponent
-  bias = (1 << (expbits - 1)) - 1; // 2^(n-1)-1
-  shift = ((value >> manbits) & ((1LL << expbits) - 1)) - bias;
-  while (shift > 0) {
-    result *= 2.0;
-    --shift;
-  }
-  while (shift < 0) {
-    result /= 2.0f;
-    ++shift;
-  }
-  // add sign
-  result *= (value >> (bits - 1)) & 1 ? -1.0 : 1.0;
-  return result;
-}
-
 void Serializer::unPack(const Buffer &buffer, size_t bytesUnPacked,
                         char &value) {
   auto data = *(buffer.data() + bytesUnPacked);
@@ -181,12 +228,72 @@ void Serializer::unPack(const Buffer &buffer, size_t bytesUnPacked,
                         float &value) {
   u32 bin;
   unPack(buffer, bytesUnPacked, bin);
-  value = unPack754(bin, FLOAT_TOTAL_BITS, FLOAT_EXPONENT_BITS);
+  value = bitCast<float>(bin);
 }
 
 void Serializer::unPack(const Buffer &buffer, size_t bytesUnPacked,
                         double &value) {
   u64 bin;
   unPack(buffer, bytesUnPacked, bin);
-  value = unPack754(bin, DOUBLE_TOTAL_BITS, DOUBLE_EXPONENT_BITS);
+  value = bitCast<double>(bin);
+}
+
+size_t Serializer::packArray(Buffer &buffer, size_t bytesUsed, const u8 *values, size_t count) {
+  assert(bytesUsed + count <= buffer.getSize());
+  std::memcpy(buffer.data() + bytesUsed, values, count);
+  return count;
+}
+
+size_t Serializer::packArray(Buffer &buffer, size_t bytesUsed, const u16 *values, size_t count) {
+  return packValues(buffer, bytesUsed, values, count);
+}
+
+size_t Serializer::packArray(Buffer &buffer, size_t bytesUsed, const u32 *values, size_t count) {
+  return packValues(buffer, bytesUsed, values, count);
+}
+
+size_t Serializer::packArray(Buffer &buffer, size_t bytesUsed, const u64 *values, size_t count) {
+  return packValues(buffer, bytesUsed, values, count);
+}
+
+size_t Serializer::packArray(Buffer &buffer, size_t bytesUsed, const float *values,
+                             size_t count) {
+  return packValues(buffer, bytesUsed, values, count);
+}
+
+size_t Serializer::packArray(Buffer &buffer, size_t bytesUsed, const double *values,
+                             size_t count) {
+  return packValues(buffer, bytesUsed, values, count);
+}
+
+size_t Serializer::unPackArray(const Buffer &buffer, size_t bytesUnPacked, u8 *values,
+                               size_t count) {
+  assert(bytesUnPacked + count <= buffer.getSize());
+  std::memcpy(values, buffer.data() + bytesUnPacked, count);
+  return count;
+}
+
+size_t Serializer::unPackArray(const Buffer &buffer, size_t bytesUnPacked, u16 *values,
+                               size_t count) {
+  return unPackValues(buffer, bytesUnPacked, values, count);
+}
+
+size_t Serializer::unPackArray(const Buffer &buffer, size_t bytesUnPacked, u32 *values,
+                               size_t count) {
+  return unPackValues(buffer, bytesUnPacked, values, count);
+}
+
+size_t Serializer::unPackArray(const Buffer &buffer, size_t bytesUnPacked, u64 *values,
+                               size_t count) {
+  return unPackValues(buffer, bytesUnPacked, values, count);
+}
+
+size_t Serializer::unPackArray(const Buffer &buffer, size_t bytesUnPacked, float *values,
+                               size_t count) {
+  return unPackValues(buffer, bytesUnPacked, values, count);
+}
+
+size_t Serializer::unPackArray(const Buffer &buffer, size_t bytesUnPacked, double *values,
+                               size_t count) {
+  return unPackValues(buffer, bytesUnPacked, values, count);
 }
@@ -2,7 +2,9 @@
 
 #include "buffer.h"
 #include "common.h"
+#include <cstring>
 #include <iostream>
+#include <type_traits>
 #include <utility>
 
 class Serializer : NonCopyable {
@@ -61,14 +63,12 @@ public:
 
   template <typename... Args>
   void pack(Buffer &buffer, size_t bytesUsed, float value, Args &&... args) {
-    u32 bin = pack754(value, FLOAT_TOTAL_BITS, FLOAT_EXPONENT_BITS);
-    pack(buffer, bytesUsed, bin, std::forward<Args>(args)...);
+    pack(buffer, bytesUsed, bitCast<u32>(value), std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void pack(Buffer &buffer, size_t bytesUsed, double value, Args &&... args) {
-    u64 bin = pack754(value, DOUBLE_TOTAL_BITS, DOUBLE_EXPONENT_BITS);
-    pack(buffer, bytesUsed, bin, std::forward<Args>(args)...);
+    pack(buffer, bytesUsed, bitCast<u64>(value), std::forward<Args>(args)...);
   }
 
   /**
@@ -95,20 +95,57 @@ public:
     unPack(buffer, bytesUnPacked + sizeof(T), args...);
   }
 
-private:
-  static constexpr short FLOAT_TOTAL_BITS = 32;
-  static constexpr short FLOAT_EXPONENT_BITS = 8;
-  static constexpr short DOUBLE_TOTAL_BITS = 64;
-  static constexpr short DOUBLE_EXPONENT_BITS = 11;
+  /**
+   * Bulk pack/unpack of count values at once, same bytes as packing them one
+   * by one. Byte swapped with SIMD shuffles (AVX2 when supported), a plain copy
+   * on big-endian hosts.
+   *
+   * @return bytes packed/unpacked
+   */
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const u8 *values, size_t count);
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const u16 *values, size_t count);
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const u32 *values, size_t count);
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const u64 *values, size_t count);
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const float *values, size_t count);
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const double *values, size_t count);
+
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, u8 *values, size_t count);
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, u16 *values, size_t count);
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, u32 *values, size_t count);
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, u64 *values, size_t count);
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, float *values, size_t count);
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, double *values, size_t count);
+
+  // vectors & matrices of floats, ie glm::vec3, glm::mat4, packed component-wise
+  template <typename Vec>
+  size_t packArray(Buffer &buffer, size_t bytesUsed, const Vec *values, size_t count) {
+    assertFloatVector<Vec>();
+    return packArray(buffer, bytesUsed, reinterpret_cast<const float *>(values),
+                     count * (sizeof(Vec) / sizeof(float)));
+  }
+
+  template <typename Vec>
+  size_t unPackArray(const Buffer &buffer, size_t bytesUnPacked, Vec *values, size_t count) {
+    assertFloatVector<Vec>();
+    return unPackArray(buffer, bytesUnPacked, reinterpret_cast<float *>(values),
+                       count * (sizeof(Vec) / sizeof(float)));
+  }
 
+private:
   Serializer() = default;
   ~Serializer() = default;
 
-  /**
-   * floating point conversion IEEE 754
-   * float - 32-bit (8-bit exp + 23-bit mantissa)
-   * double - 64-bit (11-bit exp + 52-bit mantissa)
-   */
-  u64 pack754(long double value, unsigned bits, unsigned expbits);
-  long double unPack754(u64 value, unsigned bits, unsigned expbits);
+  // floats are packed as their IEEE 754 bits, exact for every value
+  template <typename To, typename From> static To bitCast(From value) {
+    static_assert(sizeof(To) == sizeof(From), "Size mismatch.");
+    To result;
+    std::memcpy(&result, &value, sizeof(To));
+    return result;
+  }
+
+  template <typename Vec> static constexpr void assertFloatVector() {
+    static_assert(!std::is_arithmetic_v<Vec> && std::is_trivially_copyable_v<Vec> &&
+                      sizeof(Vec) % sizeof(float) == 0,
+                  "Only vectors of floats can be packed as arrays.");
+  }
 };
@@ -0,0 +1,64 @@
+#include "serializer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/**
+ * Benchmark, Serializer bulk pack/unpack vs packing values one by one, with
+ * memcpy of the same bytes as the upper bound. In cache (64 KiB) and out of
+ * cache (16 MiB) arrays.
+ */
+namespace serializer_bench {
+
+using Clock = std::chrono::steady_clock;
+
+// GB/s of the bytes produced by op, best of a few runs
+template <typename Op> double measure(size_t bytes, Op op) {
+  size_t iterations = std::max<size_t>(1, (256u << 20) / bytes);
+  double best = 0.0;
+  for (int run = 0; run < 5; ++run) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+      op();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    best = std::max(best, bytes * iterations / seconds / 1e9);
+  }
+  return best;
+}
+
+template <typename T> void run(const char *name, size_t count) {
+  Serializer &serializer = Serializer::getInstance();
+  std::vector<T> values(count);
+  for (size_t i = 0; i < count; ++i)
+    values[i] = T(i * 7 + 1);
+  std::vector<T> unPacked(count);
+  const size_t bytes = count * sizeof(T);
+  Buffer buffer(bytes);
+
+  double scalar = measure(bytes, [&]() {
+    for (size_t i = 0; i < count; ++i)
+      serializer.pack(buffer, i * sizeof(T), values[i]);
+  });
+  double pack = measure(bytes, [&]() { serializer.packArray(buffer, 0, values.data(), count); });
+  double unPack =
+      measure(bytes, [&]() { serializer.unPackArray(buffer, 0, unPacked.data(), count); });
+  double copy = measure(bytes, [&]() { std::memcpy(buffer.data(), values.data(), bytes); });
+  if (std::memcmp(values.data(), unPacked.data(), bytes) != 0) printf("round trip failed\n");
+  printf("%-8s %10zu %12.2f %12.2f %12.2f %12.2f\n", name, bytes, scalar, pack, unPack, copy);
+}
+} // namespace serializer_bench
+
+int main() {
+  using namespace serializer_bench;
+  printf("%-8s %10s %12s %12s %12s %12s\n", "type", "bytes", "scalar GB/s", "pack GB/s",
+         "unpack GB/s", "memcpy GB/s");
+  for (size_t bytes : {size_t(64) << 10, size_t(16) << 20}) {
+    run<u16>("u16", bytes / sizeof(u16));
+    run<u32>("u32", bytes / sizeof(u32));
+    run<float>("float", bytes / sizeof(float));
+    run<double>("double", bytes / sizeof(double));
+  }
+  return 0;
+}
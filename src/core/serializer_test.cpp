@@ -1,5 +1,9 @@
 #include "serializer.h"
 #include "third_party/catch.hpp"
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
 
 Serializer &serializer = Serializer::getInstance();
 
@@ -276,3 +280,100 @@ TEST_CASE("Multiple floating point pack & unpack test.") {
   REQUIRE(toPakC == unPakC);
   REQUIRE(toPakD == unPakD);
 }
+
+TEST_CASE("Special floating point values pack & unpack exactly.") {
+  std::vector<float> floats = {0.0f,
+                               -0.0f,
+                               1.0f / 3.0f,
+                               std::numeric_limits<float>::denorm_min(),
+                               -std::numeric_limits<float>::denorm_min(),
+                               std::numeric_limits<float>::lowest(),
+                               std::numeric_limits<float>::infinity(),
+                               -std::numeric_limits<float>::infinity(),
+                               std::numeric_limits<float>::quiet_NaN()};
+  Buffer buf(4);
+  for (float toPak : floats) {
+    float unPak;
+    serializer.pack(buf, 0, toPak);
+    serializer.unPack(buf, 0, unPak);
+    REQUIRE(std::memcmp(&toPak, &unPak, sizeof(float)) == 0);
+  }
+  double toPak = std::numeric_limits<double>::denorm_min();
+  double unPak;
+  Buffer bufD(8);
+  serializer.pack(bufD, 0, toPak);
+  serializer.unPack(bufD, 0, unPak);
+  REQUIRE(toPak == unPak);
+}
+
+// random bit patterns, odd count so the SIMD path has a tail
+template <typename T> std::vector<T> randomValues(size_t count, unsigned seed) {
+  std::mt19937_64 random(seed);
+  std::vector<T> values(count);
+  for (auto &value : values) {
+    u64 bits = random();
+    std::memcpy(&value, &bits, sizeof(T));
+  }
+  return values;
+}
+
+template <typename T> void requireArrayRoundTrip(size_t count) {
+  auto toPak = randomValues<T>(count, unsigned(count));
+  Buffer buf(3 + count * sizeof(T));
+  REQUIRE(serializer.packArray(buf, 3, toPak.data(), count) == count * sizeof(T));
+
+  // same bytes as packing one by one
+  Buffer single(3 + count * sizeof(T));
+  for (size_t i = 0; i < count; ++i)
+    serializer.pack(single, 3 + i * sizeof(T), toPak[i]);
+  REQUIRE(std::memcmp(buf.data() + 3, single.data() + 3, count * sizeof(T)) == 0);
+
+  std::vector<T> unPak(count);
+  REQUIRE(serializer.unPackArray(buf, 3, unPak.data(), count) == count * sizeof(T));
+  // bitwise, NaNs included
+  REQUIRE(std::memcmp(toPak.data(), unPak.data(), count * sizeof(T)) == 0);
+}
+
+TEST_CASE("Array pack & unpack test.") {
+  for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(64), size_t(1001)}) {
+    requireArrayRoundTrip<u8>(count);
+    requireArrayRoundTrip<u16>(count);
+    requireArrayRoundTrip<u32>(count);
+    requireArrayRoundTrip<u64>(count);
+    requireArrayRoundTrip<float>(count);
+    requireArrayRoundTrip<double>(count);
+  }
+}
+
+// same layout as glm::vec3 & glm::mat4
+struct Vec3 {
+  float x, y, z;
+};
+struct Mat4 {
+  float m[4][4];
+};
+
+TEST_CASE("Float vector array pack & unpack test.") {
+  std::vector<Vec3> vertices = {{1.0f, -2.5f, 3e-8f}, {0.0f, -0.0f, 1e30f}, {7.0f, 8.0f, 9.0f}};
+  Mat4 matrix;
+  for (int i = 0; i < 16; ++i)
+    matrix.m[i / 4][i % 4] = float(i) / 7.0f;
+
+  Buffer buf(vertices.size() * sizeof(Vec3) + sizeof(Mat4));
+  size_t bytesUsed = serializer.packArray(buf, 0, vertices.data(), vertices.size());
+  REQUIRE(bytesUsed == 36);
+  bytesUsed += serializer.packArray(buf, bytesUsed, &matrix, 1);
+  REQUIRE(bytesUsed == buf.getSize());
+
+  // component-wise, like scalar floats
+  float y;
+  serializer.unPack(buf, 4, y);
+  REQUIRE(y == -2.5f);
+
+  std::vector<Vec3> unPakVertices(vertices.size());
+  Mat4 unPakMatrix;
+  size_t bytesUnPacked = serializer.unPackArray(buf, 0, unPakVertices.data(), vertices.size());
+  serializer.unPackArray(buf, bytesUnPacked, &unPakMatrix, 1);
+  REQUIRE(std::memcmp(vertices.data(), unPakVertices.data(), 36) == 0);
+  REQUIRE(std::memcmp(&matrix, &unPakMatrix, sizeof(Mat4)) == 0);
+}
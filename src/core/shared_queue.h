@@ -52,6 +52,16 @@ public:
     return !stop && !discard;
   }
 
+  // never blocks, false if empty
+  bool tryPopFront(T &front) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (queue.empty() || stop)
+      return false;
+    front = queue.front();
+    queue.pop();
+    return true;
+  }
+
   void pushBack(const T &item) {
     std::unique_lock<std::mutex> lock(mutex);
     queue.push(item);
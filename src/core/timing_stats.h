@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief The TimingStats class
+ * Rolling window of the last window samples of a timing (ie ms per frame of a
+ * render pass), with its average & percentiles.
+ *
+ * Samples are kept in a ring, getSamples/getOffset can be plotted directly.
+ * Percentiles are nearest rank over the window, computed on request.
+ */
+class TimingStats {
+public:
+  static constexpr uint DEFAULT_WINDOW = 120;
+
+  explicit TimingStats(uint window = DEFAULT_WINDOW)
+      : samples(window, 0.0f), offset(0), count(0), sum(0.0) {
+    assert(window > 0 && "TimingStats window must not be empty.");
+  }
+
+  void add(float sample) {
+    if (count == samples.size())
+      sum -= samples[offset];
+    else
+      ++count;
+    samples[offset] = sample;
+    sum += sample;
+    last = sample;
+    offset = (offset + 1) % samples.size();
+  }
+
+  void clear() {
+    std::fill(samples.begin(), samples.end(), 0.0f);
+    offset = 0;
+    count = 0;
+    sum = 0.0;
+  }
+
+  // average of the window, 0 without samples
+  float getAverage() const { return count ? float(sum / count) : 0.0f; }
+  /**
+   * @brief getPercentile - nearest rank percentile of the window
+   * @param percentile - in [0, 100], ie 50 median, 95, 99
+   */
+  float getPercentile(float percentile) const {
+    if (!count) return 0.0f;
+    scratch.assign(samples.begin(), samples.begin() + count);
+    // rank = ceil(p / 100 * count), 1 based
+    double rank = std::ceil(std::clamp(percentile, 0.0f, 100.0f) / 100.0 * count);
+    size_t index = std::min<size_t>(count - 1, rank > 0.0 ? size_t(rank) - 1 : 0);
+    std::nth_element(scratch.begin(), scratch.begin() + index, scratch.end());
+    return scratch[index];
+  }
+  float getMax() const {
+    return count ? *std::max_element(samples.begin(), samples.begin() + count) : 0.0f;
+  }
+  float getLast() const { return count ? last : 0.0f; }
+  uint getCount() const { return count; }
+  uint getWindow() const { return samples.size(); }
+
+  // ring of samples, oldest at getOffset once the window is full
+  const std::vector<float> &getSamples() const { return samples; }
+  uint getOffset() const { return offset; }
+
+private:
+  std::vector<float> samples;
+  mutable std::vector<float> scratch;
+  uint offset;
+  uint count;
+  // double so the running sum doesn't drift over long runs
+  double sum;
+  float last = 0.0f;
+};
@@ -0,0 +1,42 @@
+#include "third_party/catch.hpp"
+#include "timing_stats.h"
+
+TEST_CASE("TimingStats average & percentiles.", "[TIMING_STATS]") {
+  TimingStats stats(100);
+  REQUIRE(stats.getAverage() == 0.0f);
+  REQUIRE(stats.getPercentile(50) == 0.0f);
+
+  for (int i = 100; i >= 1; --i)
+    stats.add(float(i));
+  REQUIRE(stats.getCount() == 100);
+  REQUIRE(stats.getAverage() == Approx(50.5f));
+  REQUIRE(stats.getPercentile(50) == 50.0f);
+  REQUIRE(stats.getPercentile(95) == 95.0f);
+  REQUIRE(stats.getPercentile(99) == 99.0f);
+  REQUIRE(stats.getPercentile(100) == 100.0f);
+  REQUIRE(stats.getPercentile(0) == 1.0f);
+  REQUIRE(stats.getMax() == 100.0f);
+  REQUIRE(stats.getLast() == 1.0f);
+}
+
+TEST_CASE("TimingStats rolling window.", "[TIMING_STATS]") {
+  TimingStats stats(4);
+  for (float sample : {10.0f, 10.0f, 10.0f, 10.0f, 2.0f, 2.0f})
+    stats.add(sample);
+  REQUIRE(stats.getCount() == 4);
+  REQUIRE(stats.getAverage() == Approx(6.0f));
+  REQUIRE(stats.getPercentile(50) == 2.0f);
+  REQUIRE(stats.getMax() == 10.0f);
+  // oldest sample is at the offset
+  REQUIRE(stats.getOffset() == 2);
+  REQUIRE(stats.getSamples()[stats.getOffset()] == 10.0f);
+
+  for (int i = 0; i < 4; ++i)
+    stats.add(1.0f);
+  REQUIRE(stats.getAverage() == Approx(1.0f));
+  REQUIRE(stats.getMax() == 1.0f);
+
+  stats.clear();
+  REQUIRE(stats.getCount() == 0);
+  REQUIRE(stats.getAverage() == 0.0f);
+}
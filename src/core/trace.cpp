@@ -0,0 +1,223 @@
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trace {
+
+namespace {
+const Clock::time_point epoch = Clock::now();
+
+struct Event {
+  std::atomic<const char *> name{nullptr};
+  std::atomic<u64> begin{0};    // ns since epoch
+  std::atomic<u64> duration{0}; // ns
+};
+
+struct ThreadBuffer {
+  Event events[THREAD_CAPACITY];
+  // events recorded, next one goes to head % THREAD_CAPACITY
+  std::atomic<u64> head{0};
+  // set by the owner when it exits
+  std::atomic<bool> exited{false};
+  // guarded by registryMutex
+  u32 id;
+  std::string name;
+  u64 written = 0; // head when the zones were last written out
+
+  explicit ThreadBuffer(u32 id) : id(id) {}
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+u32 nextThreadId = 1; // guarded by registryMutex
+// zones of reused rings & of threads without a ring
+std::atomic<size_t> lostCount{0};
+
+// zones of buffer that were overwritten or are never written out
+size_t getLostCount(const ThreadBuffer &buffer, u64 head) {
+  u64 first = head > THREAD_CAPACITY ? head - THREAD_CAPACITY : 0;
+  return head - std::max(first, std::min(buffer.written, head)) + first;
+}
+
+// registryMutex must be held, nullptr if every ring belongs to a live thread
+std::shared_ptr<ThreadBuffer> acquireThreadBuffer() {
+  std::shared_ptr<ThreadBuffer> reusable;
+  for (const auto &buffer : registry) {
+    // only the registry holds it, ie no writeChromeTrace is reading it
+    if (!buffer->exited.load(std::memory_order_acquire) || buffer.use_count() > 1) continue;
+    u64 head = buffer->head.load(std::memory_order_relaxed);
+    if (buffer->written == head) {
+      reusable = buffer;
+      break;
+    }
+    // registry is in creation order
+    if (!reusable) reusable = buffer;
+  }
+  bool writtenOut =
+      reusable && reusable->written == reusable->head.load(std::memory_order_relaxed);
+  // unwritten zones are only given up once there is no room for another ring
+  if (!writtenOut && registry.size() < MAX_THREAD_BUFFERS) {
+    registry.push_back(std::make_shared<ThreadBuffer>(nextThreadId++));
+    return registry.back();
+  }
+  if (!reusable) return nullptr;
+  lostCount.fetch_add(getLostCount(*reusable, reusable->head.load(std::memory_order_relaxed)),
+                      std::memory_order_relaxed);
+  // a new tid, zones of the old thread must not join its track
+  reusable->id = nextThreadId++;
+  reusable->name.clear();
+  reusable->written = 0;
+  reusable->head.store(0, std::memory_order_relaxed);
+  reusable->exited.store(false, std::memory_order_relaxed);
+  return reusable;
+}
+
+// the thread's ring, marks it exited when the thread ends
+struct ThreadHandle {
+  std::shared_ptr<ThreadBuffer> buffer;
+  bool acquired = false;
+
+  ~ThreadHandle() {
+    if (buffer) buffer->exited.store(true, std::memory_order_release);
+  }
+};
+
+// nullptr if the thread has no ring, see MAX_THREAD_BUFFERS
+ThreadBuffer *getThreadBuffer() {
+  // shared with the registry so recorded zones outlive the thread
+  thread_local ThreadHandle handle;
+  if (!handle.acquired) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    handle.buffer = acquireThreadBuffer();
+    handle.acquired = true;
+  }
+  return handle.buffer.get();
+}
+
+u64 toNs(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+// names are literals, only quotes & backslashes need escaping
+void writeString(std::ostream &out, const char *value) {
+  out << '"';
+  for (const char *c = value; *c; ++c) {
+    if (*c == '"' || *c == '\\') out << '\\';
+    out << *c;
+  }
+  out << '"';
+}
+} // namespace
+
+void setThreadName(const char *name) {
+  ThreadBuffer *buffer = getThreadBuffer();
+  if (!buffer) return;
+  std::lock_guard<std::mutex> lock(registryMutex);
+  buffer->name = name;
+}
+
+void record(const char *name, Clock::time_point begin, Clock::time_point end) {
+  ThreadBuffer *threadBuffer = getThreadBuffer();
+  if (!threadBuffer) {
+    lostCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ThreadBuffer &buffer = *threadBuffer;
+  u64 head = buffer.head.load(std::memory_order_relaxed);
+  Event &event = buffer.events[head % THREAD_CAPACITY];
+  event.name.store(name, std::memory_order_relaxed);
+  event.begin.store(toNs(begin - epoch), std::memory_order_relaxed);
+  event.duration.store(toNs(end - begin), std::memory_order_relaxed);
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool writeChromeTrace(std::ostream &out) {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::vector<std::string> names;
+  std::vector<u32> ids;
+  std::vector<u64> heads;
+  {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffers = registry;
+    for (const auto &buffer : buffers) {
+      names.push_back(buffer->name);
+      ids.push_back(buffer->id);
+    }
+  }
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+         "\"args\":{\"name\":\"renderer\"}}";
+  out.setf(std::ios::fixed);
+  out.precision(3);
+  struct Copy {
+    const char *name;
+    u64 begin;
+    u64 duration;
+  };
+  std::vector<Copy> copies;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    ThreadBuffer &buffer = *buffers[i];
+    if (!names[i].empty()) {
+      out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ids[i]
+          << ",\"args\":{\"name\":";
+      writeString(out, names[i].c_str());
+      out << "}}";
+    }
+    u64 head = buffer.head.load(std::memory_order_acquire);
+    heads.push_back(head);
+    u64 first = head > THREAD_CAPACITY ? head - THREAD_CAPACITY : 0;
+    copies.clear();
+    for (u64 index = first; index < head; ++index) {
+      const Event &event = buffer.events[index % THREAD_CAPACITY];
+      copies.push_back({event.name.load(std::memory_order_relaxed),
+                        event.begin.load(std::memory_order_relaxed),
+                        event.duration.load(std::memory_order_relaxed)});
+    }
+    // the owner may have overwritten the oldest copies meanwhile, and may be
+    // writing the slot of event newHead
+    std::atomic_thread_fence(std::memory_order_acquire);
+    u64 newHead = buffer.head.load(std::memory_order_relaxed);
+    u64 valid = newHead >= THREAD_CAPACITY ? newHead - THREAD_CAPACITY + 1 : 0;
+    for (u64 index = std::max(first, valid); index < head; ++index) {
+      const Copy &copy = copies[index - first];
+      out << ",\n{\"name\":";
+      writeString(out, copy.name);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ids[i] << ",\"ts\":" << copy.begin / 1000.0
+          << ",\"dur\":" << copy.duration / 1000.0 << "}";
+    }
+  }
+  out << "\n]}\n";
+  if (!out) return false;
+  // rings of exited threads can be reused now
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (size_t i = 0; i < buffers.size(); ++i)
+    buffers[i]->written = std::max(buffers[i]->written, heads[i]);
+  return true;
+}
+
+bool writeChromeTrace(const char *fileName) {
+  std::ofstream file(fileName);
+  return file.is_open() && writeChromeTrace(file);
+}
+
+size_t getOverwrittenCount() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  size_t count = lostCount.load(std::memory_order_relaxed);
+  for (const auto &buffer : registry) {
+    u64 head = buffer->head.load(std::memory_order_relaxed);
+    if (head > THREAD_CAPACITY) count += head - THREAD_CAPACITY;
+  }
+  return count;
+}
+
+size_t getThreadBufferCount() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  return registry.size();
+}
+} // namespace trace
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "types.h"
+#include <chrono>
+#include <ostream>
+
+/**
+ * CPU trace zones of all threads, exported as Chrome trace-event JSON (open in
+ * chrome://tracing or ui.perfetto.dev).
+ *
+ * Each thread records into its own ring of the last THREAD_CAPACITY zones, the
+ * owner thread is the only writer so recording is a few relaxed stores. Rings
+ * outlive their threads & are read without stopping the writers, zones being
+ * overwritten while writing the trace are skipped. Once its zones were written
+ * out, the ring of an exited thread is reused by the next new thread. At most
+ * MAX_THREAD_BUFFERS rings exist, past that the oldest exited thread's ring is
+ * reused even if unwritten, and if every ring belongs to a live thread, new
+ * threads don't record.
+ *
+ * Instrument with the macros, they compile to nothing unless TRACE_ENABLED is
+ * defined (cmake -DTRACE_ENABLED=on). Zone & thread names must outlive the
+ * trace, ie string literals.
+ *
+ *   void RenderSystem::update() {
+ *     TRACE_ZONE("RenderSystem::update");
+ *     ...
+ */
+namespace trace {
+using Clock = std::chrono::steady_clock;
+
+// zones kept per thread, older ones are overwritten
+constexpr size_t THREAD_CAPACITY = 1 << 14;
+// rings of THREAD_CAPACITY zones, ie threads traced at once
+constexpr size_t MAX_THREAD_BUFFERS = 64;
+
+constexpr bool isEnabled() {
+#ifdef TRACE_ENABLED
+  return true;
+#else
+  return false;
+#endif
+}
+
+void setThreadName(const char *name);
+void record(const char *name, Clock::time_point begin, Clock::time_point end);
+
+/**
+ * @brief writeChromeTrace - writes the zones recorded so far, can be called
+ * any time from any thread
+ * @return false if the file can't be written
+ */
+bool writeChromeTrace(std::ostream &out);
+bool writeChromeTrace(const char *fileName);
+// zones overwritten or not recorded before they were written, for all threads
+size_t getOverwrittenCount();
+// rings allocated so far, live & reusable ones
+size_t getThreadBufferCount();
+
+/**
+ * @brief The Zone class
+ * Records the time between its construction & destruction.
+ */
+class Zone : NonCopyable {
+public:
+  explicit Zone(const char *name) : name(name), begin(Clock::now()) {}
+  ~Zone() { record(name, begin, Clock::now()); }
+
+private:
+  const char *name;
+  Clock::time_point begin;
+};
+} // namespace trace
+
+#ifdef TRACE_ENABLED
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_ZONE(name) ::trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) ::trace::setThreadName(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,124 @@
+#include "third_party/catch.hpp"
+#include "trace.h"
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+size_t countOf(const std::string &text, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + pattern.size()))
+    ++count;
+  return count;
+}
+
+std::string writeTrace() {
+  std::ostringstream out;
+  REQUIRE(trace::writeChromeTrace(out));
+  return out.str();
+}
+} // namespace
+
+TEST_CASE("Trace zones of all threads are written as Chrome trace JSON.", "[TRACE]") {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([]() {
+      trace::setThreadName("trace \"test\" worker");
+      for (int i = 0; i < 10; ++i) {
+        trace::Zone zone("trace_test_outer");
+        trace::Zone inner("trace_test_inner");
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  // zones outlive their threads
+  std::string json = writeTrace();
+  REQUIRE(json.front() == '{');
+  REQUIRE(json.find("\"traceEvents\":[") != std::string::npos);
+  REQUIRE(countOf(json, "\"name\":\"trace_test_outer\",\"ph\":\"X\"") == 30);
+  REQUIRE(countOf(json, "\"name\":\"trace_test_inner\",\"ph\":\"X\"") == 30);
+  REQUIRE(countOf(json, "\"args\":{\"name\":\"trace \\\"test\\\" worker\"}") == 3);
+}
+
+TEST_CASE("Trace keeps the latest zones of a thread.", "[TRACE]") {
+  size_t overwritten = trace::getOverwrittenCount();
+  std::thread([]() {
+    auto now = trace::Clock::now();
+    for (size_t i = 0; i < trace::THREAD_CAPACITY + 100; ++i)
+      trace::record("trace_test_ring", now, now + std::chrono::microseconds(i));
+  }).join();
+  REQUIRE(trace::getOverwrittenCount() - overwritten == 100);
+  std::string json = writeTrace();
+  // the oldest slot may be being rewritten, so it is skipped too
+  REQUIRE(countOf(json, "\"name\":\"trace_test_ring\"") == trace::THREAD_CAPACITY - 1);
+  // oldest zones (dur 0-100us) are gone
+  REQUIRE(json.find("\"name\":\"trace_test_ring\",\"ph\":\"X\",\"pid\":1,\"tid\":") !=
+          std::string::npos);
+  REQUIRE(json.find(",\"dur\":100.000}") == std::string::npos);
+  REQUIRE(json.find(",\"dur\":101.000}") != std::string::npos);
+}
+
+TEST_CASE("Trace can be written while threads record.", "[TRACE]") {
+  std::atomic<bool> stop{false};
+  std::thread recorder([&stop]() {
+    while (!stop.load()) {
+      trace::Zone zone("trace_test_concurrent");
+    }
+  });
+  for (int i = 0; i < 5; ++i) {
+    std::string json = writeTrace();
+    REQUIRE(json.substr(json.size() - 4) == "\n]}\n");
+  }
+  stop = true;
+  recorder.join();
+}
+
+TEST_CASE("Trace reuses the rings of exited threads once written.", "[TRACE]") {
+  auto recordZone = []() { std::thread([]() { trace::Zone zone("trace_test_reuse"); }).join(); };
+  // earlier threads may have zones that weren't written out yet
+  writeTrace();
+  recordZone();
+  writeTrace();
+  size_t buffers = trace::getThreadBufferCount();
+  for (int i = 0; i < 10; ++i) {
+    recordZone();
+    writeTrace();
+  }
+  REQUIRE(trace::getThreadBufferCount() == buffers);
+  // zones of the reused rings are gone
+  REQUIRE(countOf(writeTrace(), "\"name\":\"trace_test_reuse\"") == 1);
+}
+
+TEST_CASE("Trace drops zones of threads past MAX_THREAD_BUFFERS.", "[TRACE]") {
+  // every exited thread's ring can be reused without losing zones
+  writeTrace();
+  size_t overwritten = trace::getOverwrittenCount();
+  std::atomic<size_t> started{0};
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < trace::MAX_THREAD_BUFFERS; ++t) {
+    threads.emplace_back([&started, &stop]() {
+      { trace::Zone zone("trace_test_live"); }
+      ++started;
+      while (!stop.load())
+        std::this_thread::yield();
+    });
+  }
+  while (started.load() < trace::MAX_THREAD_BUFFERS)
+    std::this_thread::yield();
+  std::thread([]() { trace::Zone zone("trace_test_dropped"); }).join();
+  stop = true;
+  for (std::thread &thread : threads)
+    thread.join();
+
+  REQUIRE(trace::getThreadBufferCount() == trace::MAX_THREAD_BUFFERS);
+  REQUIRE(trace::getOverwrittenCount() - overwritten == 1);
+  std::string json = writeTrace();
+  REQUIRE(countOf(json, "\"name\":\"trace_test_live\"") == trace::MAX_THREAD_BUFFERS);
+  REQUIRE(countOf(json, "\"name\":\"trace_test_dropped\"") == 0);
+}
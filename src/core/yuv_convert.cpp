@@ -0,0 +1,290 @@
+#include "yuv_convert.h"
+#include "image.h"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define YUV_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+namespace yuv {
+namespace {
+
+// BT.601 limited range, coefficients scaled by 256
+inline uchar toY(int r, int g, int b) { return uchar(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16); }
+inline uchar toU(int r, int g, int b) {
+  return uchar(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+inline uchar toV(int r, int g, int b) {
+  return uchar(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+/**
+ * Converts a pair of rows from column x, bottom is top & yBottom nullptr for the
+ * last row of an odd height. v is nullptr for NV12.
+ */
+void rowsScalar(const uchar *top, const uchar *bottom, uchar *yTop, uchar *yBottom, uchar *u,
+                uchar *v, int x, int width) {
+  for (; x < width; x += 2) {
+    int x1 = std::min(x + 1, width - 1);
+    const uchar *p0 = top + 4 * x;
+    const uchar *p1 = top + 4 * x1;
+    const uchar *p2 = bottom + 4 * x;
+    const uchar *p3 = bottom + 4 * x1;
+    yTop[x] = toY(p0[0], p0[1], p0[2]);
+    yTop[x1] = toY(p1[0], p1[1], p1[2]);
+    if (yBottom) {
+      yBottom[x] = toY(p2[0], p2[1], p2[2]);
+      yBottom[x1] = toY(p3[0], p3[1], p3[2]);
+    }
+    int r = (p0[0] + p1[0] + p2[0] + p3[0] + 2) >> 2;
+    int g = (p0[1] + p1[1] + p2[1] + p3[1] + 2) >> 2;
+    int b = (p0[2] + p1[2] + p2[2] + p3[2] + 2) >> 2;
+    int c = x / 2;
+    if (v) {
+      u[c] = toU(r, g, b);
+      v[c] = toV(r, g, b);
+    } else {
+      u[2 * c] = toU(r, g, b);
+      u[2 * c + 1] = toV(r, g, b);
+    }
+  }
+}
+
+#ifdef YUV_CONVERT_X86
+/**
+ * SIMD paths use 16-bit lanes, all intermediate values fit without overflow:
+ * Y sum <= 56228 (unsigned), U/V sum in [-28560, 28688] (signed).
+ */
+
+// r, g, b of 8 pixels as 16-bit lanes
+inline void unpackSse2(const uchar *src, __m128i &r, __m128i &g, __m128i &b) {
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+  __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+  r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+  g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+                      _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+  b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+                      _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+}
+
+inline __m128i lumaSse2(__m128i r, __m128i g, __m128i b) {
+  __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)),
+                            _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+  y = _mm_add_epi16(y, _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)), _mm_set1_epi16(128)));
+  return _mm_add_epi16(_mm_srli_epi16(y, 8), _mm_set1_epi16(16));
+}
+
+inline __m128i chromaSse2(__m128i r, __m128i g, __m128i b, short cr, short cg, short cb) {
+  __m128i c = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(cr)),
+                            _mm_mullo_epi16(g, _mm_set1_epi16(cg)));
+  c = _mm_add_epi16(c, _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(cb)), _mm_set1_epi16(128)));
+  return _mm_add_epi16(_mm_srai_epi16(c, 8), _mm_set1_epi16(128));
+}
+
+// sums of horizontal pixel pairs of top + bottom, 16 pixels to 8 averages
+inline __m128i averageSse2(__m128i top0, __m128i bottom0, __m128i top1, __m128i bottom1) {
+  const __m128i mask = _mm_set1_epi32(0xFFFF);
+  __m128i s0 = _mm_add_epi16(top0, bottom0);
+  __m128i s1 = _mm_add_epi16(top1, bottom1);
+  s0 = _mm_add_epi32(_mm_and_si128(s0, mask), _mm_srli_epi32(s0, 16));
+  s1 = _mm_add_epi32(_mm_and_si128(s1, mask), _mm_srli_epi32(s1, 16));
+  return _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(s0, s1), _mm_set1_epi16(2)), 2);
+}
+
+int rowsSse2(const uchar *top, const uchar *bottom, uchar *yTop, uchar *yBottom, uchar *u,
+             uchar *v, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m128i r[4], g[4], b[4]; // top 0-7, top 8-15, bottom 0-7, bottom 8-15
+    unpackSse2(top + 4 * x, r[0], g[0], b[0]);
+    unpackSse2(top + 4 * x + 32, r[1], g[1], b[1]);
+    unpackSse2(bottom + 4 * x, r[2], g[2], b[2]);
+    unpackSse2(bottom + 4 * x + 32, r[3], g[3], b[3]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(yTop + x),
+                     _mm_packus_epi16(lumaSse2(r[0], g[0], b[0]), lumaSse2(r[1], g[1], b[1])));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(yBottom + x),
+                     _mm_packus_epi16(lumaSse2(r[2], g[2], b[2]), lumaSse2(r[3], g[3], b[3])));
+
+    __m128i ra = averageSse2(r[0], r[2], r[1], r[3]);
+    __m128i ga = averageSse2(g[0], g[2], g[1], g[3]);
+    __m128i ba = averageSse2(b[0], b[2], b[1], b[3]);
+    __m128i cu = chromaSse2(ra, ga, ba, -38, -74, 112);
+    __m128i cv = chromaSse2(ra, ga, ba, 112, -94, -18);
+    cu = _mm_packus_epi16(cu, cu);
+    cv = _mm_packus_epi16(cv, cv);
+    if (v) {
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x / 2), cu);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(v + x / 2), cv);
+    } else {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(u + x), _mm_unpacklo_epi8(cu, cv));
+    }
+  }
+  return x;
+}
+
+#define YUV_AVX2 __attribute__((target("avx2")))
+// restores pixel order after in-lane packs
+#define YUV_FIX_LANES(value) _mm256_permute4x64_epi64(value, _MM_SHUFFLE(3, 1, 2, 0))
+
+// r, g, b of 16 pixels as 16-bit lanes
+YUV_AVX2 inline void unpackAvx2(const uchar *src, __m256i &r, __m256i &g, __m256i &b) {
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+  __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 32));
+  r = YUV_FIX_LANES(_mm256_packs_epi32(_mm256_and_si256(p0, mask), _mm256_and_si256(p1, mask)));
+  g = YUV_FIX_LANES(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 8), mask),
+                                       _mm256_and_si256(_mm256_srli_epi32(p1, 8), mask)));
+  b = YUV_FIX_LANES(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 16), mask),
+                                       _mm256_and_si256(_mm256_srli_epi32(p1, 16), mask)));
+}
+
+YUV_AVX2 inline __m256i lumaAvx2(__m256i r, __m256i g, __m256i b) {
+  __m256i y = _mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(66)),
+                               _mm256_mullo_epi16(g, _mm256_set1_epi16(129)));
+  y = _mm256_add_epi16(
+      y, _mm256_add_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(25)), _mm256_set1_epi16(128)));
+  return _mm256_add_epi16(_mm256_srli_epi16(y, 8), _mm256_set1_epi16(16));
+}
+
+YUV_AVX2 inline __m256i chromaAvx2(__m256i r, __m256i g, __m256i b, short cr, short cg,
+                                   short cb) {
+  __m256i c = _mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(cr)),
+                               _mm256_mullo_epi16(g, _mm256_set1_epi16(cg)));
+  c = _mm256_add_epi16(
+      c, _mm256_add_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(cb)), _mm256_set1_epi16(128)));
+  return _mm256_add_epi16(_mm256_srai_epi16(c, 8), _mm256_set1_epi16(128));
+}
+
+YUV_AVX2 inline __m256i averageAvx2(__m256i top0, __m256i bottom0, __m256i top1,
+                                    __m256i bottom1) {
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+  __m256i s0 = _mm256_add_epi16(top0, bottom0);
+  __m256i s1 = _mm256_add_epi16(top1, bottom1);
+  s0 = _mm256_add_epi32(_mm256_and_si256(s0, mask), _mm256_srli_epi32(s0, 16));
+  s1 = _mm256_add_epi32(_mm256_and_si256(s1, mask), _mm256_srli_epi32(s1, 16));
+  __m256i s = YUV_FIX_LANES(_mm256_packs_epi32(s0, s1));
+  return _mm256_srli_epi16(_mm256_add_epi16(s, _mm256_set1_epi16(2)), 2);
+}
+
+YUV_AVX2 int rowsAvx2(const uchar *top, const uchar *bottom, uchar *yTop, uchar *yBottom,
+                      uchar *u, uchar *v, int width) {
+  int x = 0;
+  for (; x + 32 <= width; x += 32) {
+    __m256i r[4], g[4], b[4]; // top 0-15, top 16-31, bottom 0-15, bottom 16-31
+    unpackAvx2(top + 4 * x, r[0], g[0], b[0]);
+    unpackAvx2(top + 4 * x + 64, r[1], g[1], b[1]);
+    unpackAvx2(bottom + 4 * x, r[2], g[2], b[2]);
+    unpackAvx2(bottom + 4 * x + 64, r[3], g[3], b[3]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(yTop + x),
+                        YUV_FIX_LANES(_mm256_packus_epi16(lumaAvx2(r[0], g[0], b[0]),
+                                                          lumaAvx2(r[1], g[1], b[1]))));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(yBottom + x),
+                        YUV_FIX_LANES(_mm256_packus_epi16(lumaAvx2(r[2], g[2], b[2]),
+                                                          lumaAvx2(r[3], g[3], b[3]))));
+
+    __m256i ra = averageAvx2(r[0], r[2], r[1], r[3]);
+    __m256i ga = averageAvx2(g[0], g[2], g[1], g[3]);
+    __m256i ba = averageAvx2(b[0], b[2], b[1], b[3]);
+    __m256i cu = chromaAvx2(ra, ga, ba, -38, -74, 112);
+    __m256i cv = chromaAvx2(ra, ga, ba, 112, -94, -18);
+    // 16 bytes of each in the low lane
+    __m128i u16 = _mm256_castsi256_si128(YUV_FIX_LANES(_mm256_packus_epi16(cu, cu)));
+    __m128i v16 = _mm256_castsi256_si128(YUV_FIX_LANES(_mm256_packus_epi16(cv, cv)));
+    if (v) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(u + x / 2), u16);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(v + x / 2), v16);
+    } else {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(u + x), _mm_unpacklo_epi8(u16, v16));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(u + x + 16), _mm_unpackhi_epi8(u16, v16));
+    }
+  }
+  return x;
+}
+#undef YUV_FIX_LANES
+#undef YUV_AVX2
+#endif
+} // namespace
+
+size_t getFrameSize(Format, int width, int height) {
+  size_t chroma = size_t((width + 1) / 2) * ((height + 1) / 2);
+  return size_t(width) * height + 2 * chroma;
+}
+
+Planes makePlanes(uchar *data, Format format, int width, int height) {
+  int chromaWidth = (width + 1) / 2;
+  uchar *u = data + size_t(width) * height;
+  if (format == Format::NV12) return {data, u, nullptr, width, 2 * chromaWidth};
+  return {data, u, u + size_t(chromaWidth) * ((height + 1) / 2), width, chromaWidth};
+}
+
+Isa getBestIsa() {
+#ifdef YUV_CONVERT_X86
+  static const Isa isa = __builtin_cpu_supports("avx2") ? Isa::AVX2 : Isa::SSE2;
+  return isa;
+#else
+  return Isa::SCALAR;
+#endif
+}
+
+void convert(const uchar *rgba, int rgbaStride, int width, int height, Format format,
+             const Planes &out, bool flip, int rowBegin, int rowEnd, Isa isa) {
+  assert(rowBegin % 2 == 0 && "Row band must start at an even row.");
+  assert((rowEnd % 2 == 0 || rowEnd == height) && "Row band must end at an even row.");
+  for (int row = rowBegin; row < rowEnd; row += 2) {
+    bool hasBottom = row + 1 < height;
+    const uchar *top = rgba + size_t(rgbaStride) * (flip ? height - 1 - row : row);
+    const uchar *bottom = hasBottom ? top + (flip ? -rgbaStride : rgbaStride) : top;
+    uchar *yTop = out.y + size_t(out.yStride) * row;
+    uchar *yBottom = hasBottom ? yTop + out.yStride : nullptr;
+    uchar *u = out.u + size_t(out.uvStride) * (row / 2);
+    uchar *v = format == Format::I420 ? out.v + size_t(out.uvStride) * (row / 2) : nullptr;
+
+    int x = 0;
+#ifdef YUV_CONVERT_X86
+    if (hasBottom && isa == Isa::AVX2) x = rowsAvx2(top, bottom, yTop, yBottom, u, v, width);
+    if (hasBottom && isa != Isa::SCALAR)
+      x += rowsSse2(top + 4 * x, bottom + 4 * x, yTop + x, yBottom + x,
+                    u + (v ? x / 2 : x), v ? v + x / 2 : nullptr, width - x);
+#endif
+    rowsScalar(top, bottom, yTop, yBottom, u, v, x, width);
+  }
+}
+
+void convert(const Image &image, Format format, const Planes &out, bool flip, uint bandCount,
+             const Executor &executor) {
+  assert(image.getNumChannels() == 4 && "Only 4 channel images can be converted.");
+  const int width = image.getWidth();
+  const int height = image.getHeight();
+  const int stride = Buffer::align(4 * width, 4);
+  const uchar *rgba = image.getBuffer()->data();
+  const Isa isa = getBestIsa();
+
+  // bands are made of row pairs
+  int rowPairs = (height + 1) / 2;
+  if (!executor) bandCount = 1;
+  bandCount = std::max(1u, std::min<uint>(bandCount, rowPairs));
+  auto convertBand = [&](uint band) {
+    int begin = 2 * (rowPairs * band / bandCount);
+    int end = std::min(height, 2 * int(rowPairs * (band + 1) / bandCount));
+    convert(rgba, stride, width, height, format, out, flip, begin, end, isa);
+  };
+
+  std::mutex mutex;
+  std::condition_variable done;
+  uint remaining = bandCount - 1;
+  for (uint band = 0; band + 1 < bandCount; ++band) {
+    executor([&, band]() {
+      convertBand(band);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--remaining == 0) done.notify_one();
+    });
+  }
+  convertBand(bandCount - 1);
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&remaining]() { return remaining == 0; });
+}
+} // namespace yuv
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.h"
+#include <functional>
+
+class Image;
+/**
+ * RGBA to YUV 4:2:0 conversion for encoding read back frames, optionally
+ * flipping rows (GL frames are bottom-up) in the same pass.
+ *
+ * BT.601 limited range, same integer math as ffmpeg's default rgba->yuv420p.
+ * Chroma is the average of each 2x2 block, odd edges are replicated.
+ * The SSE2/AVX2 paths give the same bytes as the scalar one.
+ */
+namespace yuv {
+
+/**
+ * I420 - planar Y, U, V
+ * NV12 - planar Y, interleaved UV
+ */
+enum class Format { I420, NV12 };
+enum class Isa { SCALAR, SSE2, AVX2 };
+
+struct Planes {
+  uchar *y;
+  uchar *u; // NV12 - interleaved UV plane
+  uchar *v; // NV12 - unused
+  int yStride;
+  int uvStride;
+};
+
+size_t getFrameSize(Format format, int width, int height);
+// planes of a contiguous frame of getFrameSize bytes
+Planes makePlanes(uchar *data, Format format, int width, int height);
+// best instruction set supported by this cpu
+Isa getBestIsa();
+
+/**
+ * @brief convert - converts output rows [rowBegin, rowEnd)
+ * @param rgba - first row of the source
+ * @param rgbaStride - bytes per source row
+ * @param flip - output row y is read from source row height - 1 - y
+ * @param rowBegin - must be even, rowEnd may be odd only if it is height
+ */
+void convert(const uchar *rgba, int rgbaStride, int width, int height, Format format,
+             const Planes &out, bool flip, int rowBegin, int rowEnd, Isa isa = getBestIsa());
+
+using Executor = std::function<void(std::function<void()>)>;
+/**
+ * @brief convert - converts a 4 channel image, rows with 4-byte alignment
+ * @param bandCount - rows are split into bands which are posted to executor,
+ * the calling thread converts the last band and waits for the rest.
+ */
+void convert(const Image &image, Format format, const Planes &out, bool flip,
+             uint bandCount = 1, const Executor &executor = nullptr);
+} // namespace yuv
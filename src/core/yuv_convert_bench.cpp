@@ -0,0 +1,112 @@
+#include "image.h"
+#include "ring_buffer.h"
+#include "yuv_convert.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * Benchmark, RGBA to YUV420 with flip on a 1440x1080 frame, per instruction set
+ * and split in row bands over worker threads.
+ */
+namespace yuv_convert_bench {
+
+using Clock = std::chrono::steady_clock;
+constexpr int WIDTH = 1440;
+constexpr int HEIGHT = 1080;
+constexpr int FRAMES = 200;
+
+// workers poll a ring buffer of tasks
+class Workers {
+public:
+  explicit Workers(uint count) : tasks(64, OverflowPolicy::BLOCK), discard(false) {
+    for (uint i = 0; i < count; ++i) {
+      threads.emplace_back([this]() {
+        std::function<void()> task;
+        while (tasks.popGetFront(task, discard))
+          task();
+      });
+    }
+  }
+  ~Workers() {
+    discard = true;
+    tasks.close();
+    for (auto &thread : threads)
+      thread.join();
+  }
+  yuv::Executor getExecutor() {
+    return [this](std::function<void()> task) { tasks.pushBack(std::move(task)); };
+  }
+
+private:
+  RingBuffer<std::function<void()>> tasks;
+  std::atomic<bool> discard;
+  std::vector<std::thread> threads;
+};
+
+double run(const Image &image, yuv::Format format, yuv::Isa isa) {
+  std::vector<uchar> out(yuv::getFrameSize(format, WIDTH, HEIGHT));
+  yuv::Planes planes = yuv::makePlanes(out.data(), format, WIDTH, HEIGHT);
+  auto start = Clock::now();
+  for (int i = 0; i < FRAMES; ++i)
+    yuv::convert(image.getBuffer()->data(), WIDTH * 4, WIDTH, HEIGHT, format, planes, true, 0,
+                 HEIGHT, isa);
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAMES;
+}
+
+double runBands(const Image &image, uint bands) {
+  Workers workers(bands - 1);
+  yuv::Executor executor = workers.getExecutor();
+  std::vector<uchar> out(yuv::getFrameSize(yuv::Format::I420, WIDTH, HEIGHT));
+  yuv::Planes planes = yuv::makePlanes(out.data(), yuv::Format::I420, WIDTH, HEIGHT);
+  auto start = Clock::now();
+  for (int i = 0; i < FRAMES; ++i)
+    yuv::convert(image, yuv::Format::I420, planes, true, bands, executor);
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAMES;
+}
+} // namespace yuv_convert_bench
+
+int main() {
+  using namespace yuv_convert_bench;
+  std::mt19937 random(1);
+  Buffer buffer(size_t(WIDTH) * HEIGHT * 4);
+  for (size_t i = 0; i < buffer.getSize(); ++i)
+    buffer.data()[i] = uchar(random());
+  Image image(std::move(buffer), WIDTH, HEIGHT, 4);
+
+  const double rgbaMB = WIDTH * HEIGHT * 4 / 1e6;
+  const double yuvMB = yuv::getFrameSize(yuv::Format::I420, WIDTH, HEIGHT) / 1e6;
+  printf("%dx%d, rgba %.2f MB -> yuv420 %.2f MB per frame (%.2fx)\n", WIDTH, HEIGHT, rgbaMB,
+         yuvMB, rgbaMB / yuvMB);
+
+  printf("%-8s %-6s %10s %10s\n", "isa", "format", "ms/frame", "speedup");
+  const char *isaNames[] = {"scalar", "sse2", "avx2"};
+  std::vector<yuv::Isa> isas = {yuv::Isa::SCALAR};
+#if defined(__x86_64__)
+  isas.push_back(yuv::Isa::SSE2);
+  if (yuv::getBestIsa() == yuv::Isa::AVX2) isas.push_back(yuv::Isa::AVX2);
+#endif
+  for (auto format : {yuv::Format::I420, yuv::Format::NV12}) {
+    double scalar = 0.0;
+    for (auto isa : isas) {
+      double ms = run(image, format, isa);
+      if (isa == yuv::Isa::SCALAR) scalar = ms;
+      printf("%-8s %-6s %10.3f %9.2fx\n", isaNames[int(isa)],
+             format == yuv::Format::I420 ? "i420" : "nv12", ms, scalar / ms);
+    }
+  }
+
+  printf("\nrow bands, %s i420\n", isaNames[int(yuv::getBestIsa())]);
+  printf("%-8s %10s %10s\n", "bands", "ms/frame", "speedup");
+  double single = 0.0;
+  uint maxBands = std::max(2u, std::thread::hardware_concurrency());
+  for (uint bands = 1; bands <= maxBands; bands *= 2) {
+    double ms = runBands(image, bands);
+    if (bands == 1) single = ms;
+    printf("%-8u %10.3f %9.2fx\n", bands, ms, single / ms);
+  }
+  return 0;
+}
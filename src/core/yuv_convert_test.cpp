@@ -0,0 +1,127 @@
+#include "image.h"
+#include "third_party/catch.hpp"
+#include "yuv_convert.h"
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace yuv_convert_test {
+
+Image randomImage(int width, int height, unsigned seed) {
+  std::mt19937 random(seed);
+  Buffer buffer(size_t(width) * height * 4);
+  for (size_t i = 0; i < buffer.getSize(); ++i)
+    buffer.data()[i] = uchar(random());
+  return Image(std::move(buffer), width, height, 4);
+}
+
+// straight from the BT.601 formulas, no shared code with the converter
+std::vector<uchar> reference(const Image &image, yuv::Format format, bool flip) {
+  int width = image.getWidth();
+  int height = image.getHeight();
+  int chromaWidth = (width + 1) / 2;
+  int chromaHeight = (height + 1) / 2;
+  const uchar *data = image.getBuffer()->data();
+  auto pixel = [&](int x, int y) {
+    x = std::min(x, width - 1);
+    y = std::min(y, height - 1);
+    return data + (size_t(flip ? height - 1 - y : y) * width + x) * 4;
+  };
+
+  std::vector<uchar> out(yuv::getFrameSize(format, width, height));
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const uchar *p = pixel(x, y);
+      out[size_t(y) * width + x] = uchar(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+    }
+  }
+  uchar *chroma = out.data() + size_t(width) * height;
+  for (int y = 0; y < chromaHeight; ++y) {
+    for (int x = 0; x < chromaWidth; ++x) {
+      int sum[3] = {};
+      for (int i = 0; i < 4; ++i) {
+        const uchar *p = pixel(2 * x + i % 2, 2 * y + i / 2);
+        for (int c = 0; c < 3; ++c)
+          sum[c] += p[c];
+      }
+      int r = (sum[0] + 2) / 4, g = (sum[1] + 2) / 4, b = (sum[2] + 2) / 4;
+      uchar u = uchar(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      uchar v = uchar(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      size_t index = size_t(y) * chromaWidth + x;
+      if (format == yuv::Format::NV12) {
+        chroma[2 * index] = u;
+        chroma[2 * index + 1] = v;
+      } else {
+        chroma[index] = u;
+        chroma[size_t(chromaWidth) * chromaHeight + index] = v;
+      }
+    }
+  }
+  return out;
+}
+
+std::vector<uchar> convert(const Image &image, yuv::Format format, bool flip, yuv::Isa isa) {
+  std::vector<uchar> out(yuv::getFrameSize(format, image.getWidth(), image.getHeight()));
+  yuv::convert(image.getBuffer()->data(), image.getWidth() * 4, image.getWidth(),
+               image.getHeight(), format,
+               yuv::makePlanes(out.data(), format, image.getWidth(), image.getHeight()), flip, 0,
+               image.getHeight(), isa);
+  return out;
+}
+
+TEST_CASE("yuv convert known colors.", "[YUV_CONVERT]") {
+  Buffer buffer(8 * 2 * 4);
+  for (size_t i = 0; i < buffer.getSize(); i += 4) {
+    bool white = i < buffer.getSize() / 2; // first row
+    buffer.data()[i] = buffer.data()[i + 1] = buffer.data()[i + 2] = white ? 255 : 0;
+    buffer.data()[i + 3] = 255;
+  }
+  Image image(std::move(buffer), 8, 2, 4);
+  auto out = convert(image, yuv::Format::I420, true, yuv::Isa::SCALAR);
+  // flipped, black row first
+  REQUIRE(out[0] == 16);
+  REQUIRE(out[8] == 235);
+  REQUIRE(out[16] == 128);
+  REQUIRE(out[20] == 128);
+}
+
+TEST_CASE("yuv convert matches the reference.", "[YUV_CONVERT]") {
+  const int sizes[][2] = {{64, 32}, {1, 1}, {7, 5}, {33, 17}, {100, 3}, {130, 66}};
+  std::vector<yuv::Isa> isas = {yuv::Isa::SCALAR};
+#if defined(__x86_64__)
+  isas.push_back(yuv::Isa::SSE2);
+  if (yuv::getBestIsa() == yuv::Isa::AVX2) isas.push_back(yuv::Isa::AVX2);
+#endif
+  for (auto &size : sizes) {
+    Image image = randomImage(size[0], size[1], size[0] * 31 + size[1]);
+    for (auto format : {yuv::Format::I420, yuv::Format::NV12}) {
+      for (bool flip : {false, true}) {
+        auto expected = reference(image, format, flip);
+        for (auto isa : isas) {
+          INFO("size " << size[0] << "x" << size[1] << " isa " << int(isa) << " flip " << flip);
+          REQUIRE(convert(image, format, flip, isa) == expected);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("yuv convert split in row bands.", "[YUV_CONVERT]") {
+  Image image = randomImage(250, 141, 7);
+  auto expected = reference(image, yuv::Format::NV12, true);
+  std::vector<std::thread> threads;
+  yuv::Executor executor = [&threads](std::function<void()> task) {
+    threads.emplace_back(std::move(task));
+  };
+
+  for (uint bands : {1u, 2u, 3u, 8u, 200u}) {
+    std::vector<uchar> out(expected.size());
+    yuv::convert(image, yuv::Format::NV12,
+                 yuv::makePlanes(out.data(), yuv::Format::NV12, 250, 141), true, bands, executor);
+    for (auto &thread : threads)
+      thread.join();
+    threads.clear();
+    REQUIRE(out == expected);
+  }
+}
+} // namespace yuv_convert_test
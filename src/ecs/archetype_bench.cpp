@@ -0,0 +1,137 @@
+#include "archetype_storage.h"
+#include "component_array.h"
+#include "view.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+/**
+ * Benchmark, per-type ComponentArray storage vs ArchetypeStorage on the render
+ * loop access pattern: visit every entity with Transform + Model and build its
+ * model matrix. 1 in 8 entities is a light (Transform + Light) which only
+ * shares the Transform array.
+ */
+namespace archetype_bench {
+
+struct Transform {
+  float position[3];
+  float scale[3];
+  float rotation[4];
+};
+
+struct Model {
+  u32 meshId;
+  u32 materialIds[7];
+};
+
+struct Light {
+  float color[3];
+  float intensity;
+  float range;
+};
+
+constexpr ecs::ComponentFamily TRANSFORM = 1;
+constexpr ecs::ComponentFamily MODEL = 2;
+constexpr ecs::ComponentFamily LIGHT = 3;
+
+using Clock = std::chrono::steady_clock;
+
+// stand in for Transform::transformation + draw submission
+inline float renderEntity(const Transform &transform, const Model &model) {
+  float matrix = transform.position[0] * transform.scale[0] +
+                 transform.position[1] * transform.scale[1] +
+                 transform.position[2] * transform.scale[2] +
+                 transform.rotation[0] * transform.rotation[3];
+  return matrix + model.meshId;
+}
+
+struct Scene {
+  std::vector<ecs::Entity> entities;
+  std::vector<ecs::Entity> modelOrder;
+};
+
+Scene createScene(size_t count, std::mt19937 &rng) {
+  Scene scene;
+  scene.entities.resize(count);
+  std::iota(scene.entities.begin(), scene.entities.end(), 1);
+  std::shuffle(scene.entities.begin(), scene.entities.end(), rng);
+  // models are attached in a different order than transforms, as in a scene
+  // that has been edited
+  scene.modelOrder = scene.entities;
+  std::shuffle(scene.modelOrder.begin(), scene.modelOrder.end(), rng);
+  return scene;
+}
+
+inline bool isLight(ecs::Entity entity) { return entity % 8 == 0; }
+
+template <typename Func> double measure(uint frames, Func &&func) {
+  auto start = Clock::now();
+  for (uint i = 0; i < frames; ++i)
+    func();
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+}
+
+void run(size_t count, std::mt19937 &rng) {
+  constexpr uint frames = 20;
+  Scene scene = createScene(count, rng);
+  float sum = 0.0f;
+
+  // per-type component arrays
+  ecs::ComponentArray<Transform> transforms;
+  ecs::ComponentArray<Model> models;
+  ecs::ComponentArray<Light> lights;
+  for (ecs::Entity entity : scene.entities) {
+    transforms.insertData(entity, Transform{{1.0f, 2.0f, 3.0f}, {1.0f, 1.0f, 1.0f}, {0, 0, 0, 1}});
+    if (isLight(entity)) lights.insertData(entity, Light{{1.0f, 1.0f, 1.0f}, 300.0f, 100.0f});
+  }
+  for (ecs::Entity entity : scene.modelOrder) {
+    if (!isLight(entity)) models.insertData(entity, Model{entity, {}});
+  }
+  ecs::View<Transform, Model> view(&transforms, &models);
+  double arrayMs = measure(frames, [&]() {
+    view.each([&sum](ecs::Entity, Transform &transform, Model &model) {
+      sum += renderEntity(transform, model);
+    });
+  });
+
+  // archetype storage
+  ecs::ArchetypeStorage storage;
+  storage.registerComponent<Transform>(TRANSFORM);
+  storage.registerComponent<Model>(MODEL);
+  storage.registerComponent<Light>(LIGHT);
+  for (ecs::Entity entity : scene.entities) {
+    storage.addComponent<Transform>(
+        entity, TRANSFORM, Transform{{1.0f, 2.0f, 3.0f}, {1.0f, 1.0f, 1.0f}, {0, 0, 0, 1}});
+    if (isLight(entity))
+      storage.addComponent<Light>(entity, LIGHT, Light{{1.0f, 1.0f, 1.0f}, 300.0f, 100.0f});
+  }
+  auto setupStart = Clock::now();
+  for (ecs::Entity entity : scene.modelOrder) {
+    if (!isLight(entity)) storage.addComponent<Model>(entity, MODEL, Model{entity, {}});
+  }
+  double archetypeSetupMs =
+      std::chrono::duration<double, std::milli>(Clock::now() - setupStart).count();
+  double archetypeMs = measure(frames, [&]() {
+    storage.each<Transform, Model>({TRANSFORM, MODEL},
+                                   [&sum](ecs::Entity, Transform &transform, Model &model) {
+                                     sum += renderEntity(transform, model);
+                                   });
+  });
+
+  printf("%8zu %20.3f %20.3f %20.3f   (checksum %.0f)\n", count, arrayMs, archetypeMs,
+         archetypeSetupMs, sum);
+}
+} // namespace archetype_bench
+
+int main() {
+  using namespace archetype_bench;
+  std::mt19937 rng(42);
+  printf("%8s %20s %20s %20s\n", "entities", "arrays(ms/frame)", "archetype(ms/frame)",
+         "archetype add(ms)");
+  for (size_t count : {5000, 50000, 500000}) {
+    run(count, rng);
+  }
+  return 0;
+}
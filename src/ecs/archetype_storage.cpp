@@ -0,0 +1,146 @@
+#include "archetype_storage.h"
+
+namespace ecs {
+
+Archetype::Archetype(const Signature &signature,
+                     const std::array<ComponentInfo, MAX_COMPONENTS> &componentInfos)
+    : signature(signature), componentInfos(componentInfos), chunkCapacity(0), size(0) {
+  columnOffsets.fill(INVALID_OFFSET);
+  size_t rowSize = sizeof(Entity);
+  for (ComponentFamily family = 1; family < MAX_COMPONENTS; ++family) {
+    if (!signature[family]) continue;
+    assert(componentInfos[family].size && "Components must be registered before use.");
+    families.push_back(family);
+    rowSize += componentInfos[family].size;
+  }
+
+  // find the largest capacity whose aligned columns fit in a chunk
+  auto layout = [this](size_t capacity) {
+    size_t offset = capacity * sizeof(Entity);
+    for (ComponentFamily family : families) {
+      const ComponentInfo &info = this->componentInfos[family];
+      offset = (offset + info.alignment - 1) / info.alignment * info.alignment;
+      columnOffsets[family] = offset;
+      offset += capacity * info.size;
+    }
+    return offset;
+  };
+  chunkCapacity = CHUNK_SIZE / rowSize;
+  while (chunkCapacity > 1 && layout(chunkCapacity) > CHUNK_SIZE)
+    --chunkCapacity;
+  assert(chunkCapacity && "Components too large for archetype chunk.");
+  layout(chunkCapacity);
+}
+
+Archetype::~Archetype() {
+  for (size_t row = 0; row < size; ++row) {
+    for (ComponentFamily family : families)
+      componentInfos[family].destroy(getComponent(family, row));
+  }
+  for (uchar *chunk : chunks)
+    ::operator delete(chunk, std::align_val_t(CHUNK_ALIGNMENT));
+}
+
+size_t Archetype::addRow(Entity entity) {
+  if (size == chunks.size() * chunkCapacity) {
+    chunks.push_back(
+        static_cast<uchar *>(::operator new(CHUNK_SIZE, std::align_val_t(CHUNK_ALIGNMENT))));
+  }
+  size_t row = size++;
+  *getEntities(row) = entity;
+  return row;
+}
+
+Entity Archetype::removeRow(size_t row, bool destroy) {
+  assert(row < size && "Archetype row out of range.");
+  size_t lastRow = size - 1;
+  if (destroy) {
+    for (ComponentFamily family : families)
+      componentInfos[family].destroy(getComponent(family, row));
+  }
+  Entity movedEntity = INVALID_ENTITY;
+  if (row != lastRow) {
+    // fill the hole with the last row
+    for (ComponentFamily family : families)
+      componentInfos[family].relocate(getComponent(family, row), getComponent(family, lastRow));
+    movedEntity = *getEntities(lastRow);
+    *getEntities(row) = movedEntity;
+  }
+  --size;
+  // release empty trailing chunk
+  if (size <= (chunks.size() - 1) * chunkCapacity) {
+    ::operator delete(chunks.back(), std::align_val_t(CHUNK_ALIGNMENT));
+    chunks.pop_back();
+  }
+  return movedEntity;
+}
+
+ArchetypeStorage::~ArchetypeStorage() {
+  signatureToArchetype.clear();
+  archetypes.clear();
+}
+
+Archetype *ArchetypeStorage::getArchetype(const Signature &signature) {
+  auto it = signatureToArchetype.find(signature);
+  if (it != signatureToArchetype.end()) return it->second;
+  archetypes.push_back(std::make_unique<Archetype>(signature, componentInfos));
+  Archetype *archetype = archetypes.back().get();
+  signatureToArchetype.emplace(signature, archetype);
+  return archetype;
+}
+
+size_t ArchetypeStorage::moveEntity(Entity entity, const Signature &signature) {
+  EntityLocation &location = getLocation(entity);
+  Archetype *from = location.archetype;
+  size_t fromRow = location.row;
+  location.archetype = nullptr;
+  location.row = 0;
+  if (signature.none()) {
+    // entities without components are not stored
+    if (from) {
+      Entity moved = from->removeRow(fromRow, true);
+      if (moved != INVALID_ENTITY) locations[entityIndex(moved)].row = fromRow;
+    }
+    return 0;
+  }
+
+  Archetype *to = getArchetype(signature);
+  size_t toRow = to->addRow(entity);
+  if (from) {
+    for (ComponentFamily family = 1; family < MAX_COMPONENTS; ++family) {
+      if (!from->hasComponent(family)) continue;
+      void *src = from->getComponent(family, fromRow);
+      if (to->hasComponent(family))
+        componentInfos[family].relocate(to->getComponent(family, toRow), src);
+      else
+        componentInfos[family].destroy(src);
+    }
+    Entity moved = from->removeRow(fromRow, false);
+    if (moved != INVALID_ENTITY) locations[entityIndex(moved)].row = fromRow;
+  }
+  location.archetype = to;
+  location.row = toRow;
+  return toRow;
+}
+
+void ArchetypeStorage::removeComponent(Entity entity, ComponentFamily family) {
+  assert(hasComponent(entity, family) && "Removing non-existent component.");
+  Signature signature = locations[entityIndex(entity)].archetype->getSignature();
+  moveEntity(entity, signature.set(family, false));
+}
+
+void ArchetypeStorage::entityDestoryed(Entity entity) {
+  Entity index = entityIndex(entity);
+  if (index < locations.size() && locations[index].archetype)
+    moveEntity(entity, Signature());
+}
+
+size_t ArchetypeStorage::getComponentCount(ComponentFamily family) const {
+  size_t count = 0;
+  for (const auto &archetype : archetypes) {
+    if (archetype->hasComponent(family)) count += archetype->getSize();
+  }
+  return count;
+}
+
+} // namespace ecs
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "common.h"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * Type erased component information required to move components between
+ * archetype chunks.
+ */
+struct ComponentInfo {
+  size_t size = 0;
+  size_t alignment = 0;
+  // move constructs dst from src and destroys src
+  void (*relocate)(void *dst, void *src) = nullptr;
+  void (*destroy)(void *ptr) = nullptr;
+
+  template <typename T> static ComponentInfo create() {
+    return {sizeof(T), alignof(T),
+            [](void *dst, void *src) {
+              new (dst) T(std::move(*static_cast<T *>(src)));
+              static_cast<T *>(src)->~T();
+            },
+            [](void *ptr) { static_cast<T *>(ptr)->~T(); }};
+  }
+};
+
+/**
+ * @brief The Archetype class
+ * Stores all entities with the same signature in fixed size chunks.
+ *
+ * Each chunk is SoA, [entities | component A | component B ...], so iterating
+ * a component within a chunk touches contiguous memory.
+ */
+class Archetype : NonCopyable {
+public:
+  static constexpr size_t CHUNK_SIZE = 16 * 1024;
+  static constexpr size_t CHUNK_ALIGNMENT = 64;
+  static constexpr size_t INVALID_OFFSET = ~size_t(0);
+
+  Archetype(const Signature &signature,
+            const std::array<ComponentInfo, MAX_COMPONENTS> &componentInfos);
+  ~Archetype();
+
+  /**
+   * @brief addRow - appends an uninitialized row for entity
+   * @return row index
+   */
+  size_t addRow(Entity entity);
+
+  /**
+   * @brief removeRow - fills the row with the last row of the archetype.
+   * @param destroy - false if components on the row are already relocated.
+   * @return entity that was moved into row or INVALID_ENTITY
+   */
+  Entity removeRow(size_t row, bool destroy);
+
+  void *getComponent(ComponentFamily family, size_t row) const {
+    assert(columnOffsets[family] != INVALID_OFFSET && "Archetype doesn't have the component.");
+    return chunks[row / chunkCapacity] + columnOffsets[family] +
+           (row % chunkCapacity) * componentInfos[family].size;
+  }
+
+  bool hasComponent(ComponentFamily family) const { return signature[family]; }
+  const Signature &getSignature() const { return signature; }
+  size_t getSize() const { return size; }
+  size_t getChunkCount() const { return chunks.size(); }
+  size_t getChunkCapacity() const { return chunkCapacity; }
+  size_t getChunkSize(size_t chunk) const {
+    return std::min(chunkCapacity, size - chunk * chunkCapacity);
+  }
+  const Entity *getChunkEntities(size_t chunk) const {
+    return reinterpret_cast<const Entity *>(chunks[chunk]);
+  }
+  template <typename T> T *getChunkColumn(size_t chunk, ComponentFamily family) const {
+    assert(columnOffsets[family] != INVALID_OFFSET && "Archetype doesn't have the component.");
+    return reinterpret_cast<T *>(chunks[chunk] + columnOffsets[family]);
+  }
+
+private:
+  const Signature signature;
+  const std::array<ComponentInfo, MAX_COMPONENTS> &componentInfos;
+  std::vector<ComponentFamily> families;
+  std::array<size_t, MAX_COMPONENTS> columnOffsets;
+  size_t chunkCapacity;
+  size_t size;
+  std::vector<uchar *> chunks;
+
+  Entity *getEntities(size_t row) const {
+    return reinterpret_cast<Entity *>(chunks[row / chunkCapacity]) + row % chunkCapacity;
+  }
+};
+
+/**
+ * @brief The ArchetypeStorage class
+ * Component storage that groups entities by signature into archetypes.
+ *
+ * Alternative to per-type ComponentArray storage, components of an entity are
+ * moved between archetypes whenever its signature changes.
+ */
+class ArchetypeStorage : NonCopyable {
+public:
+  ArchetypeStorage() = default;
+  ~ArchetypeStorage();
+
+  template <typename T> void registerComponent(ComponentFamily family) {
+    assert(family < MAX_COMPONENTS && "Component family out of range.");
+    componentInfos[family] = ComponentInfo::create<T>();
+  }
+
+  template <typename T> void addComponent(Entity entity, ComponentFamily family, T component) {
+    assert(componentInfos[family].size && "Components must be registered before use.");
+    EntityLocation &location = getLocation(entity);
+    assert(!(location.archetype && location.archetype->hasComponent(family)) &&
+           "Component added to same entity more than once.");
+    Signature signature = location.archetype ? location.archetype->getSignature() : Signature();
+    size_t row = moveEntity(entity, signature.set(family, true));
+    new (location.archetype->getComponent(family, row)) T(std::move(component));
+  }
+
+  void removeComponent(Entity entity, ComponentFamily family);
+
+  template <typename T> T &getComponent(Entity entity, ComponentFamily family) {
+    assert(hasComponent(entity, family) && "Retrieving non-existent component.");
+    const EntityLocation &location = locations[entityIndex(entity)];
+    return *static_cast<T *>(location.archetype->getComponent(family, location.row));
+  }
+
+  bool hasComponent(Entity entity, ComponentFamily family) const {
+    Entity index = entityIndex(entity);
+    return index < locations.size() && locations[index].archetype &&
+           locations[index].archetype->hasComponent(family);
+  }
+
+  void entityDestoryed(Entity entity);
+
+  /**
+   * @brief each - iterates every entity that has components T...
+   * @param families - component family of each T
+   * @param func - callable as func(Entity, T &...)
+   */
+  template <typename... T, typename Func>
+  void each(const std::array<ComponentFamily, sizeof...(T)> &families, Func &&func) {
+    Signature query;
+    for (ComponentFamily family : families)
+      query.set(family, true);
+    for (const auto &archetype : archetypes) {
+      if ((archetype->getSignature() & query) != query) continue;
+      for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) {
+        eachInChunk<T...>(*archetype, chunk, families, func, std::index_sequence_for<T...>{});
+      }
+    }
+  }
+
+  size_t getComponentCount(ComponentFamily family) const;
+  size_t getArchetypeCount() const { return archetypes.size(); }
+
+private:
+  struct EntityLocation {
+    Archetype *archetype = nullptr;
+    size_t row = 0;
+  };
+
+  std::array<ComponentInfo, MAX_COMPONENTS> componentInfos{};
+  std::vector<std::unique_ptr<Archetype>> archetypes;
+  std::unordered_map<Signature, Archetype *> signatureToArchetype;
+  // indexed by entity index
+  std::vector<EntityLocation> locations;
+
+  EntityLocation &getLocation(Entity entity) {
+    Entity index = entityIndex(entity);
+    if (index >= locations.size())
+      locations.resize(std::max<size_t>(index + 1, locations.size() * 2));
+    return locations[index];
+  }
+  Archetype *getArchetype(const Signature &signature);
+  /**
+   * Moves entity and its shared components into the archetype of signature,
+   * components not in signature are destroyed.
+   * @return row of the entity in the new archetype
+   */
+  size_t moveEntity(Entity entity, const Signature &signature);
+
+  template <typename... T, typename Func, size_t... I>
+  void eachInChunk(const Archetype &archetype, size_t chunk,
+                   const std::array<ComponentFamily, sizeof...(T)> &families, Func &func,
+                   std::index_sequence<I...>) {
+    const size_t size = archetype.getChunkSize(chunk);
+    const Entity *entities = archetype.getChunkEntities(chunk);
+    std::tuple<T *...> columns(archetype.getChunkColumn<T>(chunk, families[I])...);
+    for (size_t i = 0; i < size; ++i) {
+      func(entities[i], std::get<I>(columns)[i]...);
+    }
+  }
+};
+} // namespace ecs
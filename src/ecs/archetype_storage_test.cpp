@@ -0,0 +1,68 @@
+#include "archetype_storage.h"
+#include "third_party/catch.hpp"
+#include <string>
+
+namespace archetype_storage_test {
+
+struct Position {
+  float x;
+  float y;
+  float z;
+
+  Position(float x, float y, float z) : x(x), y(y), z(z) {}
+
+  friend inline bool operator==(const Position &lhs, const Position &rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+  }
+};
+
+constexpr ecs::ComponentFamily POSITION = 1;
+constexpr ecs::ComponentFamily NAME = 2;
+
+TEST_CASE("ArchetypeStorage add, move & remove components", "[ARCHETYPE_STORAGE]") {
+  ecs::ArchetypeStorage storage;
+  storage.registerComponent<Position>(POSITION);
+  storage.registerComponent<std::string>(NAME);
+
+  // enough entities to span multiple chunks
+  const ecs::Entity count = 2000;
+  for (ecs::Entity e = 1; e <= count; ++e) {
+    storage.addComponent<Position>(e, POSITION, Position(e, e, e));
+    if (e % 2 == 0) storage.addComponent<std::string>(e, NAME, std::to_string(e));
+  }
+  REQUIRE(storage.getArchetypeCount() == 2);
+  REQUIRE(storage.getComponentCount(POSITION) == count);
+  REQUIRE(storage.getComponentCount(NAME) == count / 2);
+  for (ecs::Entity e = 1; e <= count; ++e) {
+    REQUIRE(storage.getComponent<Position>(e, POSITION) == Position(e, e, e));
+    REQUIRE(storage.hasComponent(e, NAME) == (e % 2 == 0));
+    if (e % 2 == 0) REQUIRE(storage.getComponent<std::string>(e, NAME) == std::to_string(e));
+  }
+
+  size_t visited = 0;
+  storage.each<Position, std::string>(
+      {POSITION, NAME}, [&visited](ecs::Entity entity, Position &position, std::string &name) {
+        REQUIRE(position == Position(entity, entity, entity));
+        REQUIRE(name == std::to_string(entity));
+        ++visited;
+      });
+  REQUIRE(visited == count / 2);
+
+  // move entities back to the position only archetype
+  for (ecs::Entity e = 2; e <= count; e += 4) {
+    storage.removeComponent(e, NAME);
+  }
+  REQUIRE(storage.getComponentCount(NAME) == count / 4);
+  for (ecs::Entity e = 1; e <= count; ++e) {
+    REQUIRE(storage.getComponent<Position>(e, POSITION) == Position(e, e, e));
+    if (storage.hasComponent(e, NAME))
+      REQUIRE(storage.getComponent<std::string>(e, NAME) == std::to_string(e));
+  }
+
+  for (ecs::Entity e = 1; e <= count; ++e) {
+    storage.entityDestoryed(e);
+  }
+  REQUIRE(storage.getComponentCount(POSITION) == 0);
+  REQUIRE(storage.getComponentCount(NAME) == 0);
+}
+} // namespace archetype_storage_test
@@ -4,6 +4,15 @@
 #include "types.h"
 #include <bitset>
 
+// maximum number of live entities, can be set from cmake (ECS_MAX_ENTITES)
+#ifndef ECS_MAX_ENTITES
+#define ECS_MAX_ENTITES (1u << 24)
+#endif
+// initial size of entity pools/tables, they grow on demand
+#ifndef ECS_INITIAL_ENTITES
+#define ECS_INITIAL_ENTITES 5000u
+#endif
+
 namespace ecs {
 using Entity = EntityId;
 using ComponentFamily = size_t;
@@ -15,8 +24,28 @@ constexpr ComponentFamily INVALID_COMPONENT_FAMILY = 0;
 constexpr SystemFamily INVALID_SYSTEM_FAMILY = 0;
 constexpr EventFamily INVALID_EVENT_FAMILY = 0;
 
-const Entity MAX_ENTITES = 5000;
+/**
+ * Entity handle is [generation | index], index is used to address entity
+ * tables and generation is bumped each time index is recycled so stale
+ * handles can be detected.
+ */
+constexpr u32 ENTITY_INDEX_BITS = 24;
+constexpr u32 ENTITY_GENERATION_BITS = 32 - ENTITY_INDEX_BITS;
+constexpr Entity ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+constexpr u32 ENTITY_GENERATION_MASK = (1u << ENTITY_GENERATION_BITS) - 1;
+
+const Entity MAX_ENTITES = ECS_MAX_ENTITES;
+const Entity INITIAL_ENTITES = ECS_INITIAL_ENTITES;
+static_assert(MAX_ENTITES <= (1u << ENTITY_INDEX_BITS), "MAX_ENTITES exceeds entity index bits.");
+static_assert(INITIAL_ENTITES <= MAX_ENTITES, "INITIAL_ENTITES exceeds MAX_ENTITES.");
+
 const size_t MAX_COMPONENTS = 32;
 // used to track component type in an entity
 using Signature = std::bitset<MAX_COMPONENTS>;
+
+constexpr Entity entityIndex(Entity entity) { return entity & ENTITY_INDEX_MASK; }
+constexpr u32 entityGeneration(Entity entity) { return entity >> ENTITY_INDEX_BITS; }
+constexpr Entity makeEntity(Entity index, u32 generation) {
+  return (generation << ENTITY_INDEX_BITS) | index;
+}
 } // namespace ecs
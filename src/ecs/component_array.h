@@ -1,7 +1,10 @@
 #pragma once
 
 #include "common.h"
-#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
 #include <vector>
 
 namespace ecs {
@@ -17,15 +20,19 @@ class BaseComponentArray : NonCopyable {
 public:
   virtual ~BaseComponentArray() = default;
   virtual void entityDestoryed(Entity entity) = 0;
+  virtual size_t getSize() const = 0;
 };
 
 /**
  * @brief The ComponentArray class
  * Packed array that stores a collection components of type T that exists.
+ *
+ * Sparse set, components are densely packed in componentArray and
+ * entityToIndex (indexed by entity index) maps an entity into the packed array.
  */
 template <typename T> class ComponentArray : public BaseComponentArray {
 public:
-  ComponentArray() { reserve(); }
+  ComponentArray() : entityToIndex(INITIAL_ENTITES, INVALID_INDEX) { reserve(); }
 
   /**
    * @brief insertData
@@ -34,12 +41,15 @@ public:
    * @return true if vector reallocation(component cache invalid)
    */
   bool insertData(Entity entity, T component) {
-    assert(entityToIndexMap.find(entity) == entityToIndexMap.end() &&
+    Entity index = entityIndex(entity);
+    if (index >= entityToIndex.size())
+      entityToIndex.resize(std::max<size_t>(index + 1, entityToIndex.size() * 2), INVALID_INDEX);
+    assert(entityToIndex[index] == INVALID_INDEX &&
            "Component added to same entity more than once.");
     size_t newIndex = componentArray.size();
-    entityToIndexMap[entity] = newIndex;
-    indexToEntityMap[newIndex] = entity;
-    componentArray.push_back(component);
+    entityToIndex[index] = newIndex;
+    indexToEntity.push_back(entity);
+    componentArray.push_back(std::move(component));
     if (newIndex >= reserveSize) {
       reserveSize += RESERVE_BLOCK;
       reserve();
@@ -49,27 +59,75 @@ public:
     }
   }
 
+  /**
+   * @brief insertBulk - moves count components into the array at once, ie
+   * when loading a scene, tables are grown once instead of per component.
+   * @return true if vector reallocation(component cache invalid)
+   */
+  bool insertBulk(const Entity *entities, T *components, size_t count) {
+    if (!count) return false;
+    Entity maxIndex = 0;
+    for (size_t i = 0; i < count; ++i) maxIndex = std::max(maxIndex, entityIndex(entities[i]));
+    if (maxIndex >= entityToIndex.size())
+      entityToIndex.resize(std::max<size_t>(maxIndex + 1, entityToIndex.size() * 2), INVALID_INDEX);
+
+    const T *data = componentArray.data();
+    size_t first = componentArray.size();
+    if (first + count >= reserveSize) {
+      reserveSize = ((first + count) / RESERVE_BLOCK + 1) * RESERVE_BLOCK;
+      reserve();
+    }
+    for (size_t i = 0; i < count; ++i) {
+      Entity index = entityIndex(entities[i]);
+      assert(entityToIndex[index] == INVALID_INDEX &&
+             "Component added to same entity more than once.");
+      entityToIndex[index] = first + i;
+    }
+    indexToEntity.insert(indexToEntity.end(), entities, entities + count);
+    componentArray.insert(componentArray.end(), std::make_move_iterator(components),
+                          std::make_move_iterator(components + count));
+    return componentArray.data() != data;
+  }
+
   void removeData(Entity entity) {
-    assert(entityToIndexMap.find(entity) != entityToIndexMap.end() &&
-           "Removing non-existent component.");
-    // move remove entity to the end componentArray
-    size_t removeIndex = entityToIndexMap[entity];
+    assert(hasData(entity) && "Removing non-existent component.");
+    // move last component into the removed slot to keep the array packed
+    size_t removeIndex = entityToIndex[entityIndex(entity)];
     size_t lastIndex = componentArray.size() - 1;
-    Entity lastIndexEntity = indexToEntityMap[lastIndex];
-    componentArray[removeIndex] = componentArray[lastIndex];
+    Entity lastIndexEntity = indexToEntity[lastIndex];
+    if (removeIndex != lastIndex) {
+      componentArray[removeIndex] = std::move(componentArray[lastIndex]);
+      indexToEntity[removeIndex] = lastIndexEntity;
+      entityToIndex[entityIndex(lastIndexEntity)] = removeIndex;
+    }
 
-    // pop back and update maps
+    // pop back and invalidate removed entity
     componentArray.pop_back();
-    entityToIndexMap[lastIndexEntity] = removeIndex;
-    indexToEntityMap[removeIndex] = lastIndexEntity;
-    entityToIndexMap.erase(entity);
-    indexToEntityMap.erase(lastIndex);
+    indexToEntity.pop_back();
+    entityToIndex[entityIndex(entity)] = INVALID_INDEX;
   }
 
   T &getData(Entity entity) {
-    assert(entityToIndexMap.find(entity) != entityToIndexMap.end() &&
-           "Retrieving non-existent component.");
-    return componentArray[entityToIndexMap[entity]];
+    assert(hasData(entity) && "Retrieving non-existent component.");
+    return componentArray[entityToIndex[entityIndex(entity)]];
+  }
+
+  // packed array access, index must be less than getSize()
+  T &getDataAt(size_t index) {
+    assert(index < componentArray.size() && "Component index out of range.");
+    return componentArray[index];
+  }
+
+  Entity getEntityAt(size_t index) const {
+    assert(index < indexToEntity.size() && "Component index out of range.");
+    return indexToEntity[index];
+  }
+
+  // false for stale entities, whose index is reused by another entity
+  bool hasData(Entity entity) const {
+    Entity index = entityIndex(entity);
+    return index < entityToIndex.size() && entityToIndex[index] != INVALID_INDEX &&
+           indexToEntity[entityToIndex[index]] == entity;
   }
 
   /**
@@ -77,25 +135,25 @@ public:
    * Doesn't check whether the given entity has the component or not
    */
   void entityDestoryed(Entity entity) override {
-    assert(entityToIndexMap.find(entity) != entityToIndexMap.end());
+    assert(hasData(entity));
     removeData(entity);
   }
 
-  size_t getSize() const { return componentArray.size(); }
+  size_t getSize() const override { return componentArray.size(); }
 
 private:
-  static constexpr size_t RESERVE_BLOCK = MAX_ENTITES / 4;
+  static constexpr size_t RESERVE_BLOCK = INITIAL_ENTITES / 4;
+  static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
   size_t reserveSize = RESERVE_BLOCK;
   std::vector<T> componentArray;
-  // entity id to componentArrayIndex map
-  std::unordered_map<Entity, size_t> entityToIndexMap;
-  // entity componentArrayIndex to entity id map
-  std::unordered_map<size_t, Entity> indexToEntityMap;
+  // entity index to componentArray index, INVALID_INDEX if entity has no component
+  std::vector<u32> entityToIndex;
+  // componentArray index to entity id
+  std::vector<Entity> indexToEntity;
 
   void reserve() {
     componentArray.reserve(reserveSize);
-    entityToIndexMap.reserve(reserveSize);
-    indexToEntityMap.reserve(reserveSize);
+    indexToEntity.reserve(reserveSize);
   }
 };
 } // namespace ecs
@@ -0,0 +1,116 @@
+#include "component_array.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+/**
+ * Micro-benchmark, ComponentArray (sparse set) vs the previous unordered_map
+ * based component array. Insert/get/remove churn with shuffled entity ids.
+ */
+namespace component_array_bench {
+
+struct Dummy {
+  float transform[16];
+  u32 meshId;
+};
+
+/**
+ * Previous implementation, kept here as the baseline.
+ */
+template <typename T> class MapComponentArray {
+public:
+  void insertData(ecs::Entity entity, T component) {
+    size_t newIndex = componentArray.size();
+    entityToIndexMap[entity] = newIndex;
+    indexToEntityMap[newIndex] = entity;
+    componentArray.push_back(component);
+  }
+
+  void removeData(ecs::Entity entity) {
+    size_t removeIndex = entityToIndexMap[entity];
+    size_t lastIndex = componentArray.size() - 1;
+    ecs::Entity lastIndexEntity = indexToEntityMap[lastIndex];
+    componentArray[removeIndex] = componentArray[lastIndex];
+    componentArray.pop_back();
+    entityToIndexMap[lastIndexEntity] = removeIndex;
+    indexToEntityMap[removeIndex] = lastIndexEntity;
+    entityToIndexMap.erase(entity);
+    indexToEntityMap.erase(lastIndex);
+  }
+
+  T &getData(ecs::Entity entity) { return componentArray[entityToIndexMap[entity]]; }
+
+private:
+  std::vector<T> componentArray;
+  std::unordered_map<ecs::Entity, size_t> entityToIndexMap;
+  std::unordered_map<size_t, ecs::Entity> indexToEntityMap;
+};
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  double insertMs = 0.0;
+  double getMs = 0.0;
+  double removeMs = 0.0;
+  u64 checksum = 0; // prevents get loop from being optimized out
+};
+
+template <typename Array>
+Result churn(const std::vector<ecs::Entity> &entities, const std::vector<ecs::Entity> &order,
+             uint rounds) {
+  Result result;
+  Array array;
+  for (uint r = 0; r < rounds; ++r) {
+    auto start = Clock::now();
+    for (ecs::Entity entity : entities) {
+      array.insertData(entity, Dummy{{static_cast<float>(entity)}, entity});
+    }
+    auto inserted = Clock::now();
+    for (ecs::Entity entity : order) {
+      result.checksum += array.getData(entity).meshId;
+    }
+    auto fetched = Clock::now();
+    for (ecs::Entity entity : order) {
+      array.removeData(entity);
+    }
+    auto removed = Clock::now();
+    result.insertMs += std::chrono::duration<double, std::milli>(inserted - start).count();
+    result.getMs += std::chrono::duration<double, std::milli>(fetched - inserted).count();
+    result.removeMs += std::chrono::duration<double, std::milli>(removed - fetched).count();
+  }
+  result.insertMs /= rounds;
+  result.getMs /= rounds;
+  result.removeMs /= rounds;
+  return result;
+}
+
+void print(const char *name, size_t count, const Result &result) {
+  printf("%-16s %8zu %12.3f %12.3f %12.3f   (checksum %llu)\n", name, count, result.insertMs,
+         result.getMs, result.removeMs, static_cast<unsigned long long>(result.checksum));
+}
+} // namespace component_array_bench
+
+int main() {
+  using namespace component_array_bench;
+  constexpr size_t counts[] = {5000, 50000, 500000};
+  constexpr uint rounds = 5;
+  std::mt19937 rng(42);
+
+  printf("%-16s %8s %12s %12s %12s\n", "array", "entities", "insert(ms)", "get(ms)",
+         "remove(ms)");
+  for (size_t count : counts) {
+    // valid entity ids start from 1
+    std::vector<ecs::Entity> entities(count);
+    std::iota(entities.begin(), entities.end(), 1);
+    std::shuffle(entities.begin(), entities.end(), rng);
+    std::vector<ecs::Entity> order = entities;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    print("unordered_map", count, churn<MapComponentArray<Dummy>>(entities, order, rounds));
+    print("sparse_set", count, churn<ecs::ComponentArray<Dummy>>(entities, order, rounds));
+  }
+  return 0;
+}
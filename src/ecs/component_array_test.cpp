@@ -21,9 +21,9 @@ struct Dummy {
 TEST_CASE("ComponentArray CURD test", "[COMPONENT_ARRAY]") {
   ecs::ComponentArray<Dummy> componentArray;
   ecs::EntityManager &entityManager = ecs::EntityManager::getInstace();
-  ecs::Entity entites[ecs::MAX_ENTITES];
+  ecs::Entity entites[ecs::INITIAL_ENTITES];
 
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     srand(time(0));
     auto e = entityManager.createEntity();
     entites[i] = e;
@@ -43,15 +43,64 @@ TEST_CASE("ComponentArray CURD test", "[COMPONENT_ARRAY]") {
   }
 
   // delete
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     componentArray.removeData(entites[i]);
-    REQUIRE(componentArray.getSize() == ecs::MAX_ENTITES - 2 - i);
+    REQUIRE(componentArray.getSize() == ecs::INITIAL_ENTITES - 2 - i);
   }
 
   // remove entites
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     entityManager.destoryEntity(entites[i]);
   }
   REQUIRE(entityManager.getLivingCount() == 0);
 }
+
+TEST_CASE("ComponentArray remove keeps remaining entities valid", "[COMPONENT_ARRAY]") {
+  ecs::ComponentArray<Dummy> componentArray;
+  for (ecs::Entity e = 1; e <= 10; ++e) {
+    componentArray.insertData(e, Dummy(e, e, e, e));
+  }
+  // remove from middle, front and back of the packed array
+  componentArray.removeData(5);
+  componentArray.removeData(1);
+  componentArray.removeData(10);
+  REQUIRE(componentArray.getSize() == 7);
+  for (ecs::Entity e = 1; e <= 10; ++e) {
+    bool removed = e == 1 || e == 5 || e == 10;
+    REQUIRE(componentArray.hasData(e) == !removed);
+    if (!removed) REQUIRE(componentArray.getData(e) == Dummy(e, e, e, e));
+  }
+  // reinsert removed entity
+  componentArray.insertData(5, Dummy(50, 50, 50, 50));
+  REQUIRE(componentArray.getData(5) == Dummy(50, 50, 50, 50));
+  REQUIRE(componentArray.getSize() == 8);
+}
+
+TEST_CASE("ComponentArray bulk insert", "[COMPONENT_ARRAY]") {
+  ecs::ComponentArray<Dummy> componentArray;
+  componentArray.insertData(3, Dummy(3, 3, 3, 3));
+  // more than the initial tables, so they have to grow
+  const size_t count = ecs::INITIAL_ENTITES * 2;
+  std::vector<ecs::Entity> entites;
+  std::vector<Dummy> components;
+  for (size_t i = 0; i < count; ++i) {
+    ecs::Entity e = ecs::makeEntity(i + 4, 1);
+    entites.push_back(e);
+    components.emplace_back(i, i, i, i);
+  }
+  REQUIRE(componentArray.insertBulk(entites.data(), components.data(), count));
+  REQUIRE(componentArray.getSize() == count + 1);
+  REQUIRE(componentArray.getData(3) == Dummy(3, 3, 3, 3));
+  for (size_t i = 0; i < count; ++i) {
+    REQUIRE(componentArray.getData(entites[i]) == components[i]);
+    REQUIRE(componentArray.getEntityAt(i + 1) == entites[i]);
+  }
+  // single inserts & removes keep working after a bulk insert
+  componentArray.removeData(entites[10]);
+  componentArray.insertData(2, Dummy(2, 2, 2, 2));
+  REQUIRE_FALSE(componentArray.hasData(entites[10]));
+  REQUIRE(componentArray.getData(2) == Dummy(2, 2, 2, 2));
+  REQUIRE(componentArray.getData(entites.back()) == components.back());
+  REQUIRE_FALSE(componentArray.insertBulk(entites.data(), components.data(), 0));
+}
 } // namespace component_array_test
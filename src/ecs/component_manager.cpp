@@ -5,10 +5,25 @@ namespace ecs {
 ComponentFamily BaseComponent::familyCount = 1;
 void ComponentManager::entityDestoryed(Entity entity,
                                        Signature entitySignature) {
+  if (storageMode == StorageMode::ARCHETYPE) {
+    archetypeStorage.entityDestoryed(entity);
+    return;
+  }
   for (ComponentFamily i = 1; i < MAX_COMPONENTS; ++i) {
     if (entitySignature[i]) // check if entity has the component
       componentArrays[i - 1]->entityDestoryed(entity);
   }
 }
 
+size_t ComponentManager::componentCount() const {
+  size_t count = 0;
+  for (ComponentFamily i = 1; i < MAX_COMPONENTS; ++i) {
+    if (storageMode == StorageMode::ARCHETYPE)
+      count += archetypeStorage.getComponentCount(i);
+    else if (componentArrays[i - 1])
+      count += componentArrays[i - 1]->getSize();
+  }
+  return count;
+}
+
 } // namespace ecs
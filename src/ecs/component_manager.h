@@ -1,7 +1,9 @@
 #pragma once
 
+#include "archetype_storage.h"
 #include "common.h"
 #include "component_array.h"
+#include "view.h"
 #include <array>
 #include <memory>
 #include <typeinfo>
@@ -42,16 +44,32 @@ ComponentFamily Component<T>::family = INVALID_COMPONENT_FAMILY;
  */
 class ComponentManager : NonCopyable {
 public:
+  /**
+   * COMPONENT_ARRAY - each component type is stored in its own ComponentArray
+   * ARCHETYPE - entities are grouped by signature into SoA chunks
+   */
+  enum class StorageMode { COMPONENT_ARRAY, ARCHETYPE };
+
   static ComponentManager &getInstace() {
     static ComponentManager instance;
     return instance;
   }
 
+  /**
+   * Must be set before any component is added.
+   */
+  void setStorageMode(StorageMode mode) {
+    assert(componentCount() == 0 && "Storage mode changed with existing components.");
+    storageMode = mode;
+  }
+  StorageMode getStorageMode() const { return storageMode; }
+
   template <typename T> ComponentFamily registerComponent() {
     assert(!Component<T>::family && "Registering component more than once.");
     ComponentFamily family = Component<T>::genFamily();
     // since valid component family starts from 1 and arrays start from 0
     componentArrays[family - 1] = std::make_unique<ComponentArray<T>>();
+    archetypeStorage.registerComponent<T>(family);
     return family;
   }
 
@@ -60,20 +78,38 @@ public:
   }
 
   template <typename T> void addComponent(Entity entity, const T &component) {
-    getComponentArray<T>()->insertData(entity, component);
+    if (storageMode == StorageMode::ARCHETYPE)
+      archetypeStorage.addComponent<T>(entity, getFamily<T>(), component);
+    else
+      getComponentArray<T>()->insertData(entity, component);
   }
 
   template <typename T, typename... Args>
   void addComponent(Entity entity, Args &&... args) {
-    T component(std::forward<Args>(args)...);
-    getComponentArray<T>()->insertData(entity, component);
+    const T component(std::forward<Args>(args)...);
+    addComponent<T>(entity, component);
+  }
+
+  // moves components to count entities, component arrays are grown once
+  template <typename T> void addComponents(const Entity *entities, T *components, size_t count) {
+    if (storageMode == StorageMode::ARCHETYPE) {
+      for (size_t i = 0; i < count; ++i)
+        archetypeStorage.addComponent<T>(entities[i], getFamily<T>(), components[i]);
+    } else {
+      getComponentArray<T>()->insertBulk(entities, components, count);
+    }
   }
 
   template <typename T> void removeComponent(Entity entity) {
-    getComponentArray<T>()->removeData(entity);
+    if (storageMode == StorageMode::ARCHETYPE)
+      archetypeStorage.removeComponent(entity, getFamily<T>());
+    else
+      getComponentArray<T>()->removeData(entity);
   }
 
   template <typename T> T &getComponent(Entity entity) {
+    if (storageMode == StorageMode::ARCHETYPE)
+      return archetypeStorage.getComponent<T>(entity, getFamily<T>());
     return getComponentArray<T>()->getData(entity);
   }
 
@@ -81,11 +117,15 @@ public:
    * Returns total number of componets of type T
    */
   template <typename T> size_t getComponentCount() {
-    assert(Component<T>::family &&
-           "Components must be regiestered before use.");
-    return static_cast<ComponentArray<T> *>(
-               componentArrays[Component<T>::family - 1].get())
-        ->getSize();
+    if (storageMode == StorageMode::ARCHETYPE)
+      return archetypeStorage.getComponentCount(getFamily<T>());
+    return getComponentArray<T>()->getSize();
+  }
+
+  template <typename... T> View<T...> view() {
+    if (storageMode == StorageMode::ARCHETYPE)
+      return View<T...>(archetypeStorage, {getFamily<T>()...});
+    return View<T...>(getComponentArray<T>()...);
   }
 
   void entityDestoryed(Entity entity, Signature entitySignature);
@@ -93,14 +133,27 @@ public:
   // get raw pointer to component array of T component
   template <typename T> ComponentArray<T> *getComponentArray() const {
     assert(Component<T>::family && "Components must be registered before use.");
+    assert(storageMode == StorageMode::COMPONENT_ARRAY &&
+           "Component arrays are unused in archetype storage mode.");
     return static_cast<ComponentArray<T> *>(
         componentArrays[Component<T>::family - 1].get());
   }
 
+  ArchetypeStorage &getArchetypeStorage() { return archetypeStorage; }
+
 private:
   ComponentManager() = default;
   ~ComponentManager() = default;
+  StorageMode storageMode = StorageMode::COMPONENT_ARRAY;
   std::array<std::unique_ptr<BaseComponentArray>, MAX_COMPONENTS>
       componentArrays{};
+  ArchetypeStorage archetypeStorage;
+
+  template <typename T> ComponentFamily getFamily() const {
+    assert(Component<T>::family && "Components must be registered before use.");
+    return Component<T>::family;
+  }
+  // total number of components in the active storage
+  size_t componentCount() const;
 };
 } // namespace ecs
@@ -9,6 +9,13 @@ Entity Coordinator::createEntity() {
   eventManager.emit<event::EntityChanged>(entity, sig, event::EntityChanged::Status::CREATED);
   return entity;
 }
+void Coordinator::createEntities(Entity *entities, size_t count) {
+  entityManager.createEntities(entities, count);
+  for (size_t i = 0; i < count; ++i)
+    eventManager.emit<event::EntityChanged>(entities[i], Signature(),
+                                            event::EntityChanged::Status::CREATED);
+}
+
 void Coordinator::destoryEntity(Entity entity) {
   Signature sig = entityManager.getSignature(entity);
   eventManager.emit<event::EntityChanged>(entity, sig, event::EntityChanged::Status::DELETED);
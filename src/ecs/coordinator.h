@@ -22,7 +22,10 @@ public:
   }
 
   Entity createEntity();
+  // creates count entities into entities, ie when loading a scene
+  void createEntities(Entity *entities, size_t count);
   void destoryEntity(Entity entity);
+  bool isAlive(Entity entity) const { return entityManager.isAlive(entity); }
 
   // component
   template <typename T> ComponentFamily registerComponent() {
@@ -30,6 +33,7 @@ public:
   }
 
   template <typename T> void addComponent(Entity entity, const T &component) {
+    assert(isAlive(entity) && "Invalid or stale entity.");
     componentManager.addComponent<T>(entity, component);
     Signature sig =
         entityManager.updateSignaure(entity, componentManager.getComponentFamily<T>(), true);
@@ -38,6 +42,7 @@ public:
   }
 
   template <typename T, typename... Args> void addComponent(Entity entity, Args &&... args) {
+    assert(isAlive(entity) && "Invalid or stale entity.");
     T component(std::forward<Args>(args)...);
     componentManager.addComponent<T>(entity, component);
     Signature sig =
@@ -46,7 +51,26 @@ public:
     systemManager.entitySignatureChanged(entity, sig);
   }
 
+  /**
+   * Moves components[i] to entities[i] for count entities, storage is grown
+   * once. Signatures, systems and EntityChanged are updated per entity like
+   * addComponent.
+   */
+  template <typename T> void addComponents(const Entity *entities, T *components, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+      assert(isAlive(entities[i]) && "Invalid or stale entity.");
+    componentManager.addComponents<T>(entities, components, count);
+    ComponentFamily family = componentManager.getComponentFamily<T>();
+    for (size_t i = 0; i < count; ++i) {
+      Signature sig = entityManager.updateSignaure(entities[i], family, true);
+      eventManager.emit<event::EntityChanged>(entities[i], sig,
+                                              event::EntityChanged::Status::UPDATED);
+      systemManager.entitySignatureChanged(entities[i], sig);
+    }
+  }
+
   template <typename T> void removeComponent(Entity entity) {
+    assert(isAlive(entity) && "Invalid or stale entity.");
     componentManager.removeComponent<T>(entity);
     Signature signature =
         entityManager.updateSignaure(entity, componentManager.getComponentFamily<T>(), false);
@@ -60,6 +84,7 @@ public:
   }
 
   template <typename T> T &getComponent(Entity entity) {
+    assert(isAlive(entity) && "Invalid or stale entity.");
     return componentManager.getComponent<T>(entity);
   }
 
@@ -67,6 +92,12 @@ public:
     return componentManager.getComponentFamily<T>();
   }
 
+  /**
+   * Returns a view to iterate entities with components T..., ie
+   * view<Transform, Model>().each([](Entity, Transform &, Model &) {});
+   */
+  template <typename... T> View<T...> view() { return componentManager.view<T...>(); }
+
   // system
   template <typename T> void registerSystem(const Signature &signature) {
     systemManager.registerSystem<T>(signature);
@@ -89,9 +120,10 @@ public:
 
   template <typename E> void emitEvent(const E &event) { eventManager.emit<E>(event); }
   template <typename E, typename... Args> void emitEvent(Args &&... args) {
-    E event(std::forward<Args>(args)...);
-    eventManager.emit<E>(event);
+    eventManager.emit<E>(std::forward<Args>(args)...);
   }
+  // delivers queued events, see EventManager::DispatchMode
+  void dispatchEvents() { eventManager.dispatch(); }
 
 private:
   Coordinator() { registerEvent<event::EntityChanged>(); };
@@ -1,6 +1,8 @@
 #include "coordinator.h"
 #include "third_party/catch.hpp"
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace coordinator_test {
 
@@ -65,19 +67,89 @@ TEST_CASE("Coordinator entity & component test.", "[COORDINATOR") {
 }
 
 TEST_CASE("Add data and check") {
-  ecs::Entity entites[ecs::MAX_ENTITES];
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  ecs::Entity entites[ecs::INITIAL_ENTITES];
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     entites[i] = coordiantor.createEntity();
     coordiantor.addComponent<Position>(entites[i],
                                        Position(i + 1.0f, i + 2.0f, i + 3.0f));
   }
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     auto position = coordiantor.getComponent<Position>(entites[i]);
     REQUIRE(position == Position(i + 1.0f, i + 2.0f, i + 3.0f));
   }
 
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     coordiantor.destoryEntity(entites[i]);
   }
 }
+
+TEST_CASE("Coordinator bulk add", "[COORDINATOR]") {
+  const size_t count = 1000;
+  std::vector<ecs::Entity> entites(count);
+  std::vector<Position> positions;
+  for (size_t i = 0; i < count; ++i) positions.emplace_back(i, i + 1.0f, i + 2.0f);
+  coordiantor.createEntities(entites.data(), count);
+  coordiantor.addComponents<Position>(entites.data(), positions.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    REQUIRE(coordiantor.hasComponent<Position>(entites[i]));
+    REQUIRE(coordiantor.getComponent<Position>(entites[i]) == positions[i]);
+  }
+  // systems see bulk added entities like single ones
+  size_t inSystem = 0;
+  for (ecs::Entity entity : MovementSystem::getEntites())
+    inSystem += std::count(entites.begin(), entites.end(), entity);
+  REQUIRE(inSystem == count);
+  for (ecs::Entity entity : entites) coordiantor.destoryEntity(entity);
+}
+struct Rotation {
+  float angle;
+  Rotation(float angle) : angle(angle) {}
+};
+
+struct Scale {
+  float factor;
+  Scale(float factor) : factor(factor) {}
+};
+
+TEST_CASE("Coordinator in archetype storage mode", "[COORDINATOR]") {
+  ecs::ComponentManager &componentManager = coordiantor.componentManager;
+  componentManager.setStorageMode(ecs::ComponentManager::StorageMode::ARCHETYPE);
+  coordiantor.registerComponent<Rotation>();
+  coordiantor.registerComponent<Scale>();
+
+  const size_t count = 100;
+  std::vector<ecs::Entity> entites(count);
+  coordiantor.createEntities(entites.data(), count);
+  for (size_t i = 0; i < count; ++i)
+    coordiantor.addComponent<Rotation>(entites[i], i + 0.5f);
+  std::vector<Scale> scales;
+  for (size_t i = 0; i < count; ++i) scales.emplace_back(i * 2.0f);
+  // moves every entity to the Rotation + Scale archetype
+  coordiantor.addComponents<Scale>(entites.data(), scales.data(), count);
+  REQUIRE(componentManager.getComponentCount<Rotation>() == count);
+  REQUIRE(componentManager.getComponentCount<Scale>() == count);
+  for (size_t i = 0; i < count; ++i) {
+    REQUIRE(coordiantor.hasComponent<Scale>(entites[i]));
+    REQUIRE(coordiantor.getComponent<Rotation>(entites[i]).angle == i + 0.5f);
+    REQUIRE(coordiantor.getComponent<Scale>(entites[i]).factor == i * 2.0f);
+  }
+
+  // every other entity moves back to the Scale only archetype
+  for (size_t i = 0; i < count; i += 2)
+    coordiantor.removeComponent<Rotation>(entites[i]);
+  REQUIRE(componentManager.getComponentCount<Rotation>() == count / 2);
+  REQUIRE(componentManager.getComponentCount<Scale>() == count);
+  for (size_t i = 0; i < count; ++i) {
+    REQUIRE(coordiantor.hasComponent<Rotation>(entites[i]) == (i % 2 == 1));
+    REQUIRE(coordiantor.getComponent<Scale>(entites[i]).factor == i * 2.0f);
+    if (i % 2) REQUIRE(coordiantor.getComponent<Rotation>(entites[i]).angle == i + 0.5f);
+  }
+  coordiantor.getComponent<Scale>(entites[1]).factor = -1.0f;
+  REQUIRE(coordiantor.getComponent<Scale>(entites[1]).factor == -1.0f);
+
+  for (ecs::Entity entity : entites) coordiantor.destoryEntity(entity);
+  REQUIRE(componentManager.getComponentCount<Rotation>() == 0);
+  REQUIRE(componentManager.getComponentCount<Scale>() == 0);
+  componentManager.setStorageMode(ecs::ComponentManager::StorageMode::COMPONENT_ARRAY);
+}
 } // namespace coordinator_test
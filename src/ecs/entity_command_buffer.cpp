@@ -0,0 +1,144 @@
+#include "entity_command_buffer.h"
+#include "coordinator.h"
+#include "default_events.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace ecs {
+
+EntityCommandBuffer::~EntityCommandBuffer() { destroyComponents(commands); }
+
+EntityCommandBuffer::PendingEntity EntityCommandBuffer::createEntity() {
+  std::lock_guard<std::mutex> lock(mutex);
+  PendingEntity entity{pendingCount++};
+  commands.push_back({Command::Type::CREATE, true, entity.id, INVALID_COMPONENT_FAMILY, nullptr,
+                      nullptr});
+  return entity;
+}
+
+void EntityCommandBuffer::destoryEntity(Entity entity) {
+  record(Command::Type::DESTORY, false, entity);
+}
+
+void EntityCommandBuffer::destoryEntity(PendingEntity entity) {
+  record(Command::Type::DESTORY, true, entity.id);
+}
+
+void EntityCommandBuffer::record(Command::Type type, bool pending, Entity target,
+                                 ComponentFamily family, const ComponentOps *ops) {
+  std::lock_guard<std::mutex> lock(mutex);
+  commands.push_back({type, pending, target, family, ops, nullptr});
+}
+
+size_t EntityCommandBuffer::getCommandCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return commands.size();
+}
+
+void *EntityCommandBuffer::allocate(size_t size, size_t alignment) {
+  auto alignedOffset = [this, alignment]() {
+    uintptr_t base = reinterpret_cast<uintptr_t>(blocks.back().get());
+    return ((base + blockOffset + alignment - 1) & ~(alignment - 1)) - base;
+  };
+  if (blocks.empty() || alignedOffset() + size > BLOCK_SIZE) {
+    // components bigger than a block get their own block
+    blocks.emplace_back(new uchar[std::max(BLOCK_SIZE, size + alignment)]);
+    blockOffset = 0;
+  }
+  size_t offset = alignedOffset();
+  // a dedicated block is full after one component
+  blockOffset = size + alignment > BLOCK_SIZE ? BLOCK_SIZE : offset + size;
+  return blocks.back().get() + offset;
+}
+
+void EntityCommandBuffer::destroyComponents(const std::vector<Command> &commands) {
+  for (const Command &command : commands) {
+    if (command.component) command.ops->destroy(command.component);
+  }
+}
+
+std::vector<Entity> EntityCommandBuffer::playback() {
+  std::vector<Command> recorded;
+  std::vector<std::unique_ptr<uchar[]>> recordedBlocks;
+  u32 recordedPendingCount;
+  {
+    // swap out so receivers of the events can record into this buffer again
+    std::lock_guard<std::mutex> lock(mutex);
+    recorded.swap(commands);
+    recordedBlocks.swap(blocks);
+    blockOffset = BLOCK_SIZE;
+    recordedPendingCount = pendingCount;
+    pendingCount = 0;
+  }
+
+  Coordinator &coordinator = Coordinator::getInstance();
+  EntityManager &entityManager = coordinator.entityManager;
+  ComponentManager &componentManager = coordinator.componentManager;
+
+  struct EntityState {
+    Entity entity;
+    Signature signature;
+    bool created;
+    bool destroyed;
+  };
+  // touched entities in order of first command
+  std::vector<EntityState> states;
+  std::unordered_map<Entity, size_t> entityToState;
+  std::vector<Entity> created(recordedPendingCount, INVALID_ENTITY);
+
+  auto getState = [&](const Command &command) -> EntityState & {
+    Entity entity = command.pending ? created[command.target] : command.target;
+    assert(entityManager.isAlive(entity) && "Invalid or stale entity.");
+    auto it = entityToState.find(entity);
+    if (it != entityToState.end()) return states[it->second];
+    entityToState.emplace(entity, states.size());
+    states.push_back({entity, entityManager.getSignature(entity), false, false});
+    return states.back();
+  };
+
+  for (const Command &command : recorded) {
+    if (command.type == Command::Type::CREATE) {
+      created[command.target] = entityManager.createEntity();
+      getState(command).created = true;
+      continue;
+    }
+    EntityState &state = getState(command);
+    assert(!state.destroyed && "Entity used after destory.");
+    switch (command.type) {
+    case Command::Type::DESTORY:
+      state.destroyed = true;
+      break;
+    case Command::Type::ADD:
+      command.ops->add(componentManager, state.entity, command.component);
+      state.signature.set(command.family, true);
+      break;
+    case Command::Type::REMOVE:
+      command.ops->remove(componentManager, state.entity);
+      state.signature.set(command.family, false);
+      break;
+    default:
+      break;
+    }
+  }
+  destroyComponents(recorded);
+
+  // one signature update, system update & event per entity
+  for (const EntityState &state : states) {
+    if (state.destroyed) {
+      coordinator.eventManager.emit<event::EntityChanged>(state.entity, state.signature,
+                                                          event::EntityChanged::Status::DELETED);
+      entityManager.destoryEntity(state.entity);
+      componentManager.entityDestoryed(state.entity, state.signature);
+      coordinator.systemManager.entityDestoryed(state.entity);
+      continue;
+    }
+    entityManager.setSignature(state.entity, state.signature);
+    coordinator.eventManager.emit<event::EntityChanged>(
+        state.entity, state.signature,
+        state.created ? event::EntityChanged::Status::CREATED
+                      : event::EntityChanged::Status::UPDATED);
+    coordinator.systemManager.entitySignatureChanged(state.entity, state.signature);
+  }
+  return created;
+}
+} // namespace ecs
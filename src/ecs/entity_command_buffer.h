@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common.h"
+#include "component_manager.h"
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief The EntityCommandBuffer class
+ * Records structural changes (create/destory entity, add/remove component)
+ * and applies them later in one batch with playback().
+ *
+ * Recording is thread safe, so systems running in parallel can record into a
+ * shared buffer. Playback must happen at a sync point when no system is
+ * iterating components, ie after Scheduler::run.
+ *
+ * On playback signature changes of an entity are coalesced, systems are
+ * updated and a single EntityChanged event is emitted once per entity.
+ */
+class EntityCommandBuffer : NonCopyable {
+public:
+  // handle of an entity created by this buffer, resolved on playback
+  struct PendingEntity {
+    u32 id;
+  };
+
+  EntityCommandBuffer() = default;
+  ~EntityCommandBuffer();
+
+  PendingEntity createEntity();
+  void destoryEntity(Entity entity);
+  void destoryEntity(PendingEntity entity);
+
+  template <typename T> void addComponent(Entity entity, const T &component) {
+    record(Command::Type::ADD, false, entity, getFamily<T>(), &ComponentOps::get<T>(),
+           component);
+  }
+  template <typename T> void addComponent(PendingEntity entity, const T &component) {
+    record(Command::Type::ADD, true, entity.id, getFamily<T>(), &ComponentOps::get<T>(),
+           component);
+  }
+
+  template <typename T> void removeComponent(Entity entity) {
+    record(Command::Type::REMOVE, false, entity, getFamily<T>(), &ComponentOps::get<T>());
+  }
+  template <typename T> void removeComponent(PendingEntity entity) {
+    record(Command::Type::REMOVE, true, entity.id, getFamily<T>(), &ComponentOps::get<T>());
+  }
+
+  /**
+   * @brief playback - applies and clears all recorded commands.
+   * Must not be called concurrently with systems that access components.
+   * @return created entities, indexed by PendingEntity::id
+   */
+  std::vector<Entity> playback();
+
+  size_t getCommandCount() const;
+  bool empty() const { return getCommandCount() == 0; }
+
+private:
+  struct ComponentOps {
+    void (*add)(ComponentManager &componentManager, Entity entity, const void *component);
+    void (*remove)(ComponentManager &componentManager, Entity entity);
+    void (*destroy)(void *component);
+
+    template <typename T> static const ComponentOps &get() {
+      static const ComponentOps ops{
+          [](ComponentManager &componentManager, Entity entity, const void *component) {
+            componentManager.addComponent<T>(entity, *static_cast<const T *>(component));
+          },
+          [](ComponentManager &componentManager, Entity entity) {
+            componentManager.removeComponent<T>(entity);
+          },
+          [](void *component) { static_cast<T *>(component)->~T(); }};
+      return ops;
+    }
+  };
+
+  struct Command {
+    enum class Type : u8 { CREATE, DESTORY, ADD, REMOVE };
+    Type type;
+    // target is a PendingEntity id
+    bool pending;
+    Entity target;
+    ComponentFamily family;
+    const ComponentOps *ops;
+    // ADD only, component copy in the arena
+    void *component;
+  };
+
+  static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+  mutable std::mutex mutex;
+  std::vector<Command> commands;
+  u32 pendingCount = 0;
+  // components are stored in fixed blocks so they never move once recorded
+  std::vector<std::unique_ptr<uchar[]>> blocks;
+  size_t blockOffset = BLOCK_SIZE;
+
+  template <typename T> static ComponentFamily getFamily() {
+    ComponentFamily family = ComponentManager::getInstace().getComponentFamily<T>();
+    assert(family && "Components must be registered before use.");
+    return family;
+  }
+
+  template <typename T>
+  void record(Command::Type type, bool pending, Entity target, ComponentFamily family,
+              const ComponentOps *ops, const T &component) {
+    std::lock_guard<std::mutex> lock(mutex);
+    void *data = new (allocate(sizeof(T), alignof(T))) T(component);
+    commands.push_back({type, pending, target, family, ops, data});
+  }
+  void record(Command::Type type, bool pending, Entity target,
+              ComponentFamily family = INVALID_COMPONENT_FAMILY,
+              const ComponentOps *ops = nullptr);
+
+  // allocates from the arena, must hold mutex
+  void *allocate(size_t size, size_t alignment);
+  static void destroyComponents(const std::vector<Command> &commands);
+};
+} // namespace ecs
@@ -0,0 +1,145 @@
+#include "coordinator.h"
+#include "entity_command_buffer.h"
+#include "third_party/catch.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace entity_command_buffer_test {
+
+ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+
+struct Velocity {
+  float x;
+  float y;
+};
+
+struct Name {
+  std::string name;
+};
+
+// bigger than a command buffer arena block
+struct Blob {
+  char data[20 * 1024];
+};
+
+class EntityChangedCounter : public ecs::Receiver<event::EntityChanged> {
+public:
+  size_t created = 0;
+  size_t updated = 0;
+  size_t deleted = 0;
+  void receive(const event::EntityChanged &event) {
+    switch (event.status) {
+    case event::EntityChanged::Status::CREATED:
+      ++created;
+      break;
+    case event::EntityChanged::Status::UPDATED:
+      ++updated;
+      break;
+    case event::EntityChanged::Status::DELETED:
+      ++deleted;
+      break;
+    }
+  }
+};
+
+static void registerComponents() {
+  if (!coordinator.getComponentFamily<Velocity>()) {
+    coordinator.registerComponent<Velocity>();
+    coordinator.registerComponent<Name>();
+    coordinator.registerComponent<Blob>();
+  }
+}
+
+TEST_CASE("EntityCommandBuffer records from threads and plays back", "[COMMAND_BUFFER]") {
+  registerComponents();
+  constexpr size_t threads = 4;
+  constexpr size_t perThread = 250;
+  ecs::EntityCommandBuffer commandBuffer;
+  EntityChangedCounter counter;
+  coordinator.subscribeToEvent<event::EntityChanged>(counter);
+  ecs::Entity livingCount = coordinator.entityManager.getLivingCount();
+
+  std::vector<std::thread> workers;
+  std::vector<std::vector<ecs::EntityCommandBuffer::PendingEntity>> pending(threads);
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&commandBuffer, &pending, t]() {
+      for (size_t i = 0; i < perThread; ++i) {
+        auto entity = commandBuffer.createEntity();
+        commandBuffer.addComponent<Velocity>(entity, Velocity{float(t), float(i)});
+        commandBuffer.addComponent<Name>(entity, Name{"entity " + std::to_string(i)});
+        pending[t].push_back(entity);
+      }
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  // nothing is applied while recording
+  REQUIRE(commandBuffer.getCommandCount() == threads * perThread * 3);
+  REQUIRE(coordinator.entityManager.getLivingCount() == livingCount);
+  REQUIRE(counter.created == 0);
+
+  std::vector<ecs::Entity> created = commandBuffer.playback();
+  REQUIRE(commandBuffer.empty());
+  REQUIRE(created.size() == threads * perThread);
+  REQUIRE(coordinator.entityManager.getLivingCount() == livingCount + threads * perThread);
+  // a single event per entity
+  REQUIRE(counter.created == threads * perThread);
+  REQUIRE(counter.updated == 0);
+
+  for (size_t t = 0; t < threads; ++t) {
+    for (size_t i = 0; i < perThread; ++i) {
+      ecs::Entity entity = created[pending[t][i].id];
+      REQUIRE(coordinator.isAlive(entity));
+      REQUIRE(coordinator.hasComponent<Velocity>(entity));
+      REQUIRE(coordinator.getComponent<Velocity>(entity).x == float(t));
+      REQUIRE(coordinator.getComponent<Velocity>(entity).y == float(i));
+      REQUIRE(coordinator.getComponent<Name>(entity).name == "entity " + std::to_string(i));
+    }
+  }
+
+  for (ecs::Entity entity : created)
+    commandBuffer.destoryEntity(entity);
+  commandBuffer.playback();
+  REQUIRE(counter.deleted == threads * perThread);
+  REQUIRE(coordinator.entityManager.getLivingCount() == livingCount);
+  coordinator.unsubscribeFromEvent<event::EntityChanged>(counter);
+}
+
+TEST_CASE("EntityCommandBuffer coalesces changes per entity", "[COMMAND_BUFFER]") {
+  registerComponents();
+  ecs::EntityCommandBuffer commandBuffer;
+  EntityChangedCounter counter;
+  coordinator.subscribeToEvent<event::EntityChanged>(counter);
+
+  ecs::Entity entity = coordinator.createEntity();
+  coordinator.addComponent<Velocity>(entity, Velocity{1.0f, 2.0f});
+  counter.created = counter.updated = 0;
+
+  commandBuffer.removeComponent<Velocity>(entity);
+  commandBuffer.addComponent<Name>(entity, Name{"player"});
+  commandBuffer.addComponent<Blob>(entity, Blob{});
+  commandBuffer.addComponent<Velocity>(entity, Velocity{3.0f, 4.0f});
+  // created and destroyed within the same playback
+  auto temporary = commandBuffer.createEntity();
+  commandBuffer.addComponent<Name>(temporary, Name{"temporary"});
+  commandBuffer.destoryEntity(temporary);
+
+  std::vector<ecs::Entity> created = commandBuffer.playback();
+  REQUIRE(counter.updated == 1);
+  REQUIRE(counter.deleted == 1);
+  REQUIRE_FALSE(coordinator.isAlive(created[temporary.id]));
+
+  ecs::Signature signature;
+  signature.set(coordinator.getComponentFamily<Velocity>(), true);
+  signature.set(coordinator.getComponentFamily<Name>(), true);
+  signature.set(coordinator.getComponentFamily<Blob>(), true);
+  REQUIRE(coordinator.entityManager.getSignature(entity) == signature);
+  REQUIRE(coordinator.getComponent<Velocity>(entity).x == 3.0f);
+  REQUIRE(coordinator.getComponent<Name>(entity).name == "player");
+
+  coordinator.destoryEntity(entity);
+  coordinator.unsubscribeFromEvent<event::EntityChanged>(counter);
+}
+} // namespace entity_command_buffer_test
@@ -4,45 +4,72 @@
 
 namespace ecs {
 EntityManager::EntityManager() {
-  for (Entity entity = 1; entity < MAX_ENTITES; ++entity)
-    availableEntities.push(entity);
+  static_assert(ENTITY_GENERATION_BITS <= 8, "Generation doesn't fit generation table.");
+  signatures.reserve(INITIAL_ENTITES);
+  generations.reserve(INITIAL_ENTITES);
+  // index 0 is invalid entity
+  signatures.emplace_back();
+  generations.emplace_back(0);
 }
 
 Entity EntityManager::createEntity() {
   assert(livingEntityCount < MAX_ENTITES && "Too many entities in existance.");
-  Entity id = availableEntities.front();
-  availableEntities.pop();
+  Entity index;
+  if (!availableEntities.empty()) {
+    index = availableEntities.front();
+    availableEntities.pop();
+  } else {
+    // lazily grow entity tables
+    index = generations.size();
+    signatures.emplace_back();
+    generations.emplace_back(0);
+  }
   ++livingEntityCount;
-  return id;
+  return makeEntity(index, generations[index]);
+}
+
+void EntityManager::createEntities(Entity *entities, size_t count) {
+  assert(livingEntityCount + count <= MAX_ENTITES && "Too many entities in existance.");
+  size_t i = 0;
+  for (; i < count && !availableEntities.empty(); ++i) {
+    Entity index = availableEntities.front();
+    availableEntities.pop();
+    entities[i] = makeEntity(index, generations[index]);
+  }
+  // rest are new indices
+  Entity first = generations.size();
+  signatures.resize(first + (count - i));
+  generations.resize(first + (count - i), 0);
+  for (Entity index = first; i < count; ++i, ++index)
+    entities[i] = makeEntity(index, 0);
+  livingEntityCount += count;
 }
 
 void EntityManager::destoryEntity(Entity entity) {
-  assert(entity < MAX_ENTITES && "Entity out of range" &&
-         entity != INVALID_ENTITY && "Invalid entity.");
-  signatures[entity].reset();
-  availableEntities.push(entity);
+  assert(isAlive(entity) && "Invalid or stale entity.");
+  Entity index = entityIndex(entity);
+  signatures[index].reset();
+  generations[index] = (generations[index] + 1) & ENTITY_GENERATION_MASK;
+  availableEntities.push(index);
   --livingEntityCount;
 }
 
 void EntityManager::setSignature(Entity entity, const Signature &signature) {
-  assert(entity < MAX_ENTITES && "Entity out of range" &&
-         entity != INVALID_ENTITY && "Invalid entity.");
-  signatures[entity] = signature;
+  assert(isAlive(entity) && "Invalid or stale entity.");
+  signatures[entityIndex(entity)] = signature;
 }
 
 Signature EntityManager::updateSignaure(Entity entity, ComponentFamily family,
                                         bool enable) {
-  assert(entity < MAX_ENTITES && "Entity out of range" &&
-         entity != INVALID_ENTITY && "Invalid entity." &&
+  assert(isAlive(entity) && "Invalid or stale entity." &&
          family != INVALID_COMPONENT_FAMILY &&
          "Component family must be valid." && family < MAX_COMPONENTS &&
          "Component family out of range.");
-  return signatures[entity].set(family, enable);
+  return signatures[entityIndex(entity)].set(family, enable);
 }
 
 Signature EntityManager::getSignature(Entity entity) const {
-  assert(entity < MAX_ENTITES && "Entity out of range" &&
-         entity != INVALID_ENTITY && "Invalid entity.");
-  return signatures[entity];
+  assert(isAlive(entity) && "Invalid or stale entity.");
+  return signatures[entityIndex(entity)];
 }
 } // namespace ecs
@@ -1,14 +1,17 @@
 #pragma once
 
 #include "common.h"
-#include <array>
 #include <queue>
+#include <vector>
 
 namespace ecs {
 
 /**
  * @brief The EntityManager class
  * Used to create entities and track their components
+ *
+ * Entity tables grow on demand up to MAX_ENTITES, freed indices are recycled
+ * with a bumped generation.
  */
 class EntityManager : NonCopyable {
 public:
@@ -17,17 +20,28 @@ public:
     return instace;
   }
   Entity createEntity();
+  // creates count entities into entities, tables are grown once
+  void createEntities(Entity *entities, size_t count);
   void destoryEntity(Entity entity);
   void setSignature(Entity entity, const Signature &signature);
   Signature updateSignaure(Entity entity, ComponentFamily family, bool enable);
   Signature getSignature(Entity entity) const;
   Entity getLivingCount() const { return livingEntityCount - 1; }
+  // false if entity is invalid or has been destroyed (stale handle)
+  bool isAlive(Entity entity) const {
+    Entity index = entityIndex(entity);
+    return index != INVALID_ENTITY && index < generations.size() &&
+           generations[index] == entityGeneration(entity);
+  }
 
 private:
   EntityManager();
   ~EntityManager() = default;
+  // free list of recycled entity indices
   std::queue<Entity> availableEntities{};
-  std::array<Signature, MAX_ENTITES> signatures{};
+  // indexed by entity index
+  std::vector<Signature> signatures;
+  std::vector<u8> generations;
   Entity livingEntityCount = 1; // since 0 is invalid entity
 };
 } // namespace ecs
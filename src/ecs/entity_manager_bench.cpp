@@ -0,0 +1,52 @@
+#include "entity_manager.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Benchmark, EntityManager create & destroy throughput, one by one and with
+ * createEntities. Destroyed indices are recycled by the following rounds.
+ */
+namespace entity_manager_bench {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Func> double measure(Func &&func) {
+  auto start = Clock::now();
+  func();
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+} // namespace entity_manager_bench
+
+int main() {
+  using namespace entity_manager_bench;
+  constexpr u32 count = 1000000;
+  constexpr u32 rounds = 3;
+  ecs::EntityManager &entityManager = ecs::EntityManager::getInstace();
+  std::vector<ecs::Entity> entites(count);
+
+  double singleS = measure([&]() {
+    for (u32 r = 0; r < rounds; ++r) {
+      for (u32 i = 0; i < count; ++i) {
+        entites[i] = entityManager.createEntity();
+      }
+      for (u32 i = 0; i < count; ++i) {
+        entityManager.destoryEntity(entites[i]);
+      }
+    }
+  });
+  double bulkS = measure([&]() {
+    for (u32 r = 0; r < rounds; ++r) {
+      entityManager.createEntities(entites.data(), count);
+      for (u32 i = 0; i < count; ++i) {
+        entityManager.destoryEntity(entites[i]);
+      }
+    }
+  });
+
+  printf("%u entities x %u rounds\n", count, rounds);
+  printf("%-16s %10s %16s\n", "create", "s", "entities/s");
+  printf("%-16s %10.3f %16.0f\n", "createEntity", singleS, count * rounds / singleS);
+  printf("%-16s %10.3f %16.0f\n", "createEntities", bulkS, count * rounds / bulkS);
+  return entityManager.getLivingCount() == 0 ? 0 : 1;
+}
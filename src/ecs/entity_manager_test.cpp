@@ -1,15 +1,20 @@
 #include "entity_manager.h"
 #include "third_party/catch.hpp"
+#include <algorithm>
 #include <array>
 #include <random>
+#include <set>
+#include <vector>
 
 namespace entity_manager_test {
 
 ecs::EntityManager &entityManager = ecs::EntityManager::getInstace();
 
 TEST_CASE("EntityManager test with setSignature", "[ENTITY_MANAGER]") {
-  ecs::Entity entites[ecs::MAX_ENTITES];
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  ecs::Entity entites[ecs::INITIAL_ENTITES];
+  // other tests share the singleton, counts are relative to its state
+  u32 livingBefore = entityManager.getLivingCount();
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     auto e = entityManager.createEntity();
     entites[i] = e;
     entityManager.setSignature(e,
@@ -18,18 +23,19 @@ TEST_CASE("EntityManager test with setSignature", "[ENTITY_MANAGER]") {
     REQUIRE(entityManager.getSignature(e) ==
             std::bitset<ecs::MAX_COMPONENTS>().set(
                 1 + (i % (ecs::MAX_COMPONENTS - 1)), true));
-    REQUIRE(entityManager.getLivingCount() == i + 1);
-    REQUIRE(entites[i] == i + 1);
+    REQUIRE(entityManager.getLivingCount() == livingBefore + i + 1);
+    REQUIRE(entityManager.isAlive(e));
   }
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     entityManager.destoryEntity(entites[i]);
   }
-  REQUIRE(entityManager.getLivingCount() == 0);
+  REQUIRE(entityManager.getLivingCount() == livingBefore);
 }
 
 TEST_CASE("EntityManager test with update signature", "[ENTITY_MANAGER]") {
-  ecs::Entity entites[ecs::MAX_ENTITES];
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  ecs::Entity entites[ecs::INITIAL_ENTITES];
+  u32 livingBefore = entityManager.getLivingCount();
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     auto e = entityManager.createEntity();
     entites[i] = e;
     srand(time(0));
@@ -43,18 +49,73 @@ TEST_CASE("EntityManager test with update signature", "[ENTITY_MANAGER]") {
                 .set(1 + (num % (ecs::MAX_COMPONENTS - 1)), num % 2)
                 .set(1 + (i % (ecs::MAX_COMPONENTS - 1)), num % 2 == 0));
   }
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
     entityManager.destoryEntity(entites[i]);
   }
-  REQUIRE(entityManager.getLivingCount() == 0);
+  REQUIRE(entityManager.getLivingCount() == livingBefore);
 }
 
-TEST_CASE("Valid entity ids", "[ENTITY_MANAGER") {
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
-    REQUIRE(entityManager.createEntity() == i + 1);
+TEST_CASE("Valid entity ids", "[ENTITY_MANAGER]") {
+  std::vector<ecs::Entity> entites;
+  std::set<ecs::Entity> indices;
+  for (u32 i = 0; i < ecs::INITIAL_ENTITES - 1; ++i) {
+    entites.push_back(entityManager.createEntity());
+    REQUIRE(ecs::entityIndex(entites.back()) != ecs::INVALID_ENTITY);
+    REQUIRE(entityManager.isAlive(entites.back()));
+    indices.insert(ecs::entityIndex(entites.back()));
   }
-  for (u32 i = 0; i < ecs::MAX_ENTITES - 1; ++i) {
-    entityManager.destoryEntity(i + 1);
+  REQUIRE(indices.size() == entites.size());
+  for (ecs::Entity entity : entites) {
+    entityManager.destoryEntity(entity);
   }
+  // indices are recycled in order, with a new generation, once the indices
+  // freed before them are reused
+  std::vector<ecs::Entity> recreated;
+  while (recreated.size() < entites.size() ||
+         ecs::entityIndex(recreated.back()) != ecs::entityIndex(entites.back())) {
+    recreated.push_back(entityManager.createEntity());
+  }
+  std::vector<ecs::Entity> recycled(recreated.end() - entites.size(), recreated.end());
+  for (size_t i = 0; i < entites.size(); ++i) {
+    REQUIRE_FALSE(entityManager.isAlive(entites[i]));
+    REQUIRE(ecs::entityIndex(recycled[i]) == ecs::entityIndex(entites[i]));
+    REQUIRE(ecs::entityGeneration(recycled[i]) ==
+            ((ecs::entityGeneration(entites[i]) + 1) & ecs::ENTITY_GENERATION_MASK));
+  }
+  for (ecs::Entity entity : recreated) {
+    entityManager.destoryEntity(entity);
+  }
+}
+
+TEST_CASE("Stale entity detection", "[ENTITY_MANAGER]") {
+  ecs::Entity entity = entityManager.createEntity();
+  REQUIRE(entityManager.isAlive(entity));
+  entityManager.destoryEntity(entity);
+  REQUIRE_FALSE(entityManager.isAlive(entity));
+  REQUIRE_FALSE(entityManager.isAlive(ecs::INVALID_ENTITY));
+}
+
+TEST_CASE("EntityManager bulk create", "[ENTITY_MANAGER]") {
+  ecs::Entity recycled = entityManager.createEntity();
+  entityManager.destoryEntity(recycled);
+  u32 livingBefore = entityManager.getLivingCount();
+  std::vector<ecs::Entity> entites(ecs::INITIAL_ENTITES * 2);
+  entityManager.createEntities(entites.data(), entites.size());
+  REQUIRE(entityManager.getLivingCount() == livingBefore + entites.size());
+  // free indices are reused with a new generation
+  ecs::Entity reused =
+      ecs::makeEntity(ecs::entityIndex(recycled), ecs::entityGeneration(recycled) + 1);
+  REQUIRE(std::count(entites.begin(), entites.end(), reused) == 1);
+  std::set<ecs::Entity> indices;
+  for (ecs::Entity entity : entites) {
+    REQUIRE(entityManager.isAlive(entity));
+    REQUIRE(entityManager.getSignature(entity).none());
+    indices.insert(ecs::entityIndex(entity));
+  }
+  REQUIRE(indices.size() == entites.size());
+  for (ecs::Entity entity : entites) {
+    entityManager.destoryEntity(entity);
+  }
+  REQUIRE(entityManager.getLivingCount() == livingBefore);
 }
 } // namespace entity_manager_test
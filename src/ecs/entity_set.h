@@ -0,0 +1,97 @@
+#pragma once
+
+#include "common.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief The EntityRange class
+ * Non owning view over a contiguous list of entities.
+ */
+class EntityRange {
+public:
+  EntityRange(const Entity *first, size_t size) : first(first), count(size) {}
+
+  const Entity *begin() const { return first; }
+  const Entity *end() const { return first + count; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  Entity operator[](size_t index) const {
+    assert(index < count && "Entity index out of range.");
+    return first[index];
+  }
+
+private:
+  const Entity *first;
+  size_t count;
+};
+
+/**
+ * @brief The EntitySet class
+ * Set of entities stored as a packed vector plus an entity indexed table, for
+ * O(1) insert/erase/contains and linear iteration.
+ *
+ * Erase moves the last entity into the erased slot, so order is not preserved.
+ */
+class EntitySet {
+public:
+  EntitySet() : entityToIndex(INITIAL_ENTITES, INVALID_INDEX) {}
+
+  /**
+   * @return false if entity already exists in the set
+   */
+  bool insert(Entity entity) {
+    Entity index = entityIndex(entity);
+    if (index >= entityToIndex.size())
+      entityToIndex.resize(std::max<size_t>(index + 1, entityToIndex.size() * 2), INVALID_INDEX);
+    if (entityToIndex[index] != INVALID_INDEX) {
+      assert(entities[entityToIndex[index]] == entity && "Stale entity in set.");
+      return false;
+    }
+    entityToIndex[index] = entities.size();
+    entities.push_back(entity);
+    return true;
+  }
+
+  /**
+   * @return number of entities erased (0 or 1)
+   */
+  size_t erase(Entity entity) {
+    if (!contains(entity)) return 0;
+    u32 index = entityToIndex[entityIndex(entity)];
+    Entity last = entities.back();
+    entities[index] = last;
+    entityToIndex[entityIndex(last)] = index;
+    entities.pop_back();
+    entityToIndex[entityIndex(entity)] = INVALID_INDEX;
+    return 1;
+  }
+
+  bool contains(Entity entity) const {
+    Entity index = entityIndex(entity);
+    return index < entityToIndex.size() && entityToIndex[index] != INVALID_INDEX &&
+           entities[entityToIndex[index]] == entity;
+  }
+
+  void clear() {
+    for (Entity entity : entities)
+      entityToIndex[entityIndex(entity)] = INVALID_INDEX;
+    entities.clear();
+  }
+
+  size_t size() const { return entities.size(); }
+  bool empty() const { return entities.empty(); }
+  EntityRange range() const { return EntityRange(entities.data(), entities.size()); }
+  std::vector<Entity>::const_iterator begin() const { return entities.begin(); }
+  std::vector<Entity>::const_iterator end() const { return entities.end(); }
+
+private:
+  static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+  std::vector<Entity> entities;
+  // entity index to entities index, INVALID_INDEX if not in set
+  std::vector<u32> entityToIndex;
+};
+} // namespace ecs
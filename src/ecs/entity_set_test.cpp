@@ -0,0 +1,34 @@
+#include "entity_set.h"
+#include "third_party/catch.hpp"
+#include <algorithm>
+
+namespace entity_set_test {
+
+TEST_CASE("EntitySet insert, erase & iterate", "[ENTITY_SET]") {
+  ecs::EntitySet set;
+  for (ecs::Entity e = 1; e < ecs::INITIAL_ENTITES; ++e) {
+    REQUIRE(set.insert(e));
+  }
+  REQUIRE_FALSE(set.insert(1));
+  REQUIRE(set.size() == ecs::INITIAL_ENTITES - 1);
+
+  // erase odd entities
+  for (ecs::Entity e = 1; e < ecs::INITIAL_ENTITES; e += 2) {
+    REQUIRE(set.erase(e) == 1);
+  }
+  REQUIRE(set.erase(1) == 0);
+  REQUIRE(set.size() == (ecs::INITIAL_ENTITES - 1) / 2);
+
+  ecs::EntityRange range = set.range();
+  REQUIRE(range.size() == set.size());
+  REQUIRE(std::all_of(range.begin(), range.end(),
+                      [](ecs::Entity e) { return e % 2 == 0; }));
+  for (ecs::Entity e = 1; e < ecs::INITIAL_ENTITES; ++e) {
+    REQUIRE(set.contains(e) == (e % 2 == 0));
+  }
+
+  set.clear();
+  REQUIRE(set.empty());
+  REQUIRE_FALSE(set.contains(2));
+}
+} // namespace entity_set_test
@@ -2,4 +2,20 @@
 
 namespace ecs {
 EventFamily BaseEvent::familyCount = 1;
+
+void EventManager::dispatch() {
+  for (const auto &queue : queues) {
+    if (queue)
+      queue->dispatch();
+  }
+}
+
+size_t EventManager::totalQueuedEvents() const {
+  size_t size = 0;
+  for (const auto &queue : queues) {
+    if (queue)
+      size += queue->size();
+  }
+  return size;
+}
 } // namespace ecs
@@ -2,7 +2,10 @@
 
 #include "common.h"
 #include "third_party/simplesignal.h"
+#include <functional>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace ecs {
 using EventSignal = Simple::Signal<void(const void *)>;
@@ -31,10 +34,29 @@ private:
 };
 template <typename T> EventFamily Event<T>::family = INVALID_EVENT_FAMILY;
 
+/**
+ * Non owning view of contiguous events, used to deliver events in a batch.
+ */
+template <typename T> class Span {
+public:
+  Span(T *data, size_t size) : data_(data), size_(size) {}
+  T *begin() const { return data_; }
+  T *end() const { return data_ + size_; }
+  T *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  T &operator[](size_t index) const { return data_[index]; }
+
+private:
+  T *data_;
+  size_t size_;
+};
+
 /**
  * Base class for all receivers.
  *
- * All receivers must have a receiver method.
+ * All receivers must have a receive(const E &) or receive(Span<const E>)
+ * method, if both exists the batch receive(Span<const E>) is used.
  *
  * E : Must be a valid registered event.
  */
@@ -55,8 +77,18 @@ private:
   friend class EventManager;
 };
 
+/**
+ * @brief The EventManager class
+ *
+ * IMMEDIATE - (default) emit delivers the event to receivers right away.
+ * QUEUED - emit appends the event to a contiguous per event type queue, all
+ * queued events are delivered on dispatch(), once per frame. Batch receivers
+ * get the whole queue in one call.
+ */
 class EventManager : NonCopyable {
 public:
+  enum class DispatchMode { IMMEDIATE, QUEUED };
+
   static EventManager &getInstace() {
     static EventManager instance;
     return instance;
@@ -66,10 +98,35 @@ public:
     checkIsDerived<E>();
     assert(!Event<E>::family && "Event can be registered only once.");
     EventFamily family = Event<E>::genFamily();
-    if (family >= handlers.size())
+    if (family >= handlers.size()) {
       handlers.resize(handlers.size() + 1);
+      batchHandlers.resize(handlers.size());
+      queues.resize(handlers.size());
+    }
     // since valid event component family starts from 1 and arrays start from 0
     handlers[family - 1] = std::make_shared<EventSignal>();
+    batchHandlers[family - 1] = std::make_shared<EventSignal>();
+  }
+
+  /**
+   * Switching to IMMEDIATE delivers events that are still queued.
+   */
+  template <typename E> void setDispatchMode(DispatchMode mode) {
+    assert(Event<E>::family && "Event must be registered before use.");
+    auto &queue = queues[Event<E>::family - 1];
+    if (mode == DispatchMode::QUEUED) {
+      if (!queue)
+        queue = std::make_unique<EventQueue<E>>(handlers[Event<E>::family - 1],
+                                                batchHandlers[Event<E>::family - 1]);
+    } else if (queue) {
+      queue->dispatch();
+      queue.reset();
+    }
+  }
+
+  template <typename E> DispatchMode getDispatchMode() const {
+    assert(Event<E>::family && "Event must be registered before use.");
+    return queues[Event<E>::family - 1] ? DispatchMode::QUEUED : DispatchMode::IMMEDIATE;
   }
 
   // subscribe to an event E with receiver R
@@ -77,12 +134,22 @@ public:
     assert(Event<E>::family && "Event must be registered before use." &&
            receiver.connection.first.expired() &&
            "Receiver is already subscribed to an event.");
-    // Receiver must have ::receive method
-    void (R::*receive)(const E &) = &R::receive;
-    auto wrapper = EventCallbackWrapper<E>(
-        std::bind(receive, &receiver, std::placeholders::_1));
-    auto signal = handlers[Event<E>::family - 1];
-    auto connectionId = signal->connect(wrapper);
+    EventSignalPtr signal;
+    size_t connectionId;
+    if constexpr (HasBatchReceive<E, R>::value) {
+      void (R::*receive)(Span<const E>) = &R::receive;
+      auto wrapper = EventCallbackWrapper<Span<const E>>(
+          std::bind(receive, &receiver, std::placeholders::_1));
+      signal = batchHandlers[Event<E>::family - 1];
+      connectionId = signal->connect(wrapper);
+    } else {
+      // Receiver must have ::receive method
+      void (R::*receive)(const E &) = &R::receive;
+      auto wrapper = EventCallbackWrapper<E>(
+          std::bind(receive, &receiver, std::placeholders::_1));
+      signal = handlers[Event<E>::family - 1];
+      connectionId = signal->connect(wrapper);
+    }
     receiver.connection =
         std::make_pair(EventSignalWeakPtr(signal), connectionId);
   }
@@ -100,21 +167,38 @@ public:
   // emit events
   template <typename E> void emit(const E &event) {
     assert(Event<E>::family && "Event must be registered before use.");
-    handlers[Event<E>::family - 1]->emit(&event);
+    if (auto &queue = queues[Event<E>::family - 1]) {
+      static_cast<EventQueue<E> &>(*queue).events.push_back(event);
+      return;
+    }
+    deliver(event);
   }
 
   // construct a new object of type E and emit
   template <typename E, typename... Args> void emit(Args &&... args) {
     assert(Event<E>::family && "Event must be registered before use.");
+    if (auto &queue = queues[Event<E>::family - 1]) {
+      static_cast<EventQueue<E> &>(*queue).events.emplace_back(std::forward<Args>(args)...);
+      return;
+    }
     E event(std::forward<Args>(args)...); // unfold args with std::forward
-    handlers[Event<E>::family - 1]->emit(&event);
+    deliver(event);
   }
 
+  /**
+   * Delivers all queued events, events emitted by receivers while dispatching
+   * are delivered on the next dispatch.
+   */
+  void dispatch();
+
+  // number of events waiting for dispatch
+  size_t totalQueuedEvents() const;
+
   size_t totalConnectedReceivers() const {
     size_t size = 0;
-    for (EventSignalPtr handler : handlers) {
-      if (handler)
-        size += handler->size();
+    for (size_t i = 0; i < handlers.size(); ++i) {
+      if (handlers[i])
+        size += handlers[i]->size() + batchHandlers[i]->size();
     }
     return size;
   }
@@ -149,7 +233,62 @@ private:
     std::function<void(const E &)> callback;
   };
 
+  template <typename E, typename R, typename = void> struct HasBatchReceive : std::false_type {};
+  template <typename E, typename R>
+  struct HasBatchReceive<E, R,
+                         std::void_t<decltype(static_cast<void (R::*)(Span<const E>)>(
+                             &R::receive))>> : std::true_type {};
+
+  class BaseEventQueue {
+  public:
+    virtual ~BaseEventQueue() = default;
+    virtual void dispatch() = 0;
+    virtual size_t size() const = 0;
+  };
+
+  template <typename E> class EventQueue : public BaseEventQueue {
+  public:
+    EventQueue(EventSignalPtr signal, EventSignalPtr batchSignal)
+        : signal(std::move(signal)), batchSignal(std::move(batchSignal)) {}
+
+    void dispatch() override {
+      if (events.empty()) return;
+      // receivers may emit new events while dispatching
+      dispatching.swap(events);
+      if (batchSignal->size()) {
+        Span<const E> span(dispatching.data(), dispatching.size());
+        batchSignal->emit(&span);
+      }
+      if (signal->size()) {
+        for (const E &event : dispatching)
+          signal->emit(&event);
+      }
+      dispatching.clear(); // keep capacity for the next frame
+    }
+    size_t size() const override { return events.size(); }
+
+    std::vector<E> events;
+
+  private:
+    std::vector<E> dispatching;
+    EventSignalPtr signal;
+    EventSignalPtr batchSignal;
+  };
+
+  template <typename E> void deliver(const E &event) {
+    EventFamily index = Event<E>::family - 1;
+    handlers[index]->emit(&event);
+    if (batchHandlers[index]->size()) {
+      Span<const E> span(&event, 1);
+      batchHandlers[index]->emit(&span);
+    }
+  }
+
+  // [index - event family - 1]
   std::vector<EventSignalPtr> handlers;
+  std::vector<EventSignalPtr> batchHandlers;
+  // null if event is dispatched immediately
+  std::vector<std::unique_ptr<BaseEventQueue>> queues;
 };
 
 } // namespace ecs
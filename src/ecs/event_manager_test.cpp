@@ -1,6 +1,7 @@
 #include "event_manager.h"
 #include "third_party/catch.hpp"
 #include <iostream>
+#include <vector>
 
 namespace event_manager_test {
 ecs::EventManager &eventManager = ecs::EventManager::getInstace();
@@ -62,4 +63,68 @@ TEST_CASE("EventManager event unsubscribe test.", "[EVENT_MANAGER]") {
   eventManager.emit<TestEvent>(TestEvent(20, 4));
   REQUIRE(eventManager.totalConnectedReceivers() == 0);
 }
+struct QueuedEvent : public ecs::Event<QueuedEvent> {
+  int state = 0;
+  explicit QueuedEvent(int state) : state(state) {}
+};
+
+class BatchSystem : public ecs::Receiver<QueuedEvent> {
+public:
+  std::vector<size_t> batchSizes;
+  std::vector<int> states;
+  void receive(const QueuedEvent &) { FAIL("single receive used by batch receiver"); }
+  void receive(ecs::Span<const QueuedEvent> events) {
+    batchSizes.push_back(events.size());
+    for (const QueuedEvent &event : events)
+      states.push_back(event.state);
+  }
+};
+
+class SingleSystem : public ecs::Receiver<QueuedEvent> {
+public:
+  std::vector<int> states;
+  void receive(const QueuedEvent &event) { states.push_back(event.state); }
+};
+
+TEST_CASE("EventManager queued dispatch test.", "[EVENT_MANAGER]") {
+  eventManager.registerEvent<QueuedEvent>();
+  BatchSystem batchSystem;
+  SingleSystem singleSystem;
+  eventManager.subscribe<QueuedEvent>(batchSystem);
+  eventManager.subscribe<QueuedEvent>(singleSystem);
+
+  // immediate, batch receivers get a single event span
+  eventManager.emit<QueuedEvent>(1);
+  REQUIRE(batchSystem.batchSizes == std::vector<size_t>{1});
+  REQUIRE(singleSystem.states == std::vector<int>{1});
+
+  eventManager.setDispatchMode<QueuedEvent>(ecs::EventManager::DispatchMode::QUEUED);
+  REQUIRE(eventManager.getDispatchMode<QueuedEvent>() ==
+          ecs::EventManager::DispatchMode::QUEUED);
+  for (int i = 2; i < 1002; ++i)
+    eventManager.emit<QueuedEvent>(i);
+  eventManager.emit<QueuedEvent>(QueuedEvent(1002));
+  REQUIRE(eventManager.totalQueuedEvents() == 1001);
+  REQUIRE(batchSystem.states.size() == 1);
+  REQUIRE(singleSystem.states.size() == 1);
+
+  eventManager.dispatch();
+  REQUIRE(eventManager.totalQueuedEvents() == 0);
+  REQUIRE(batchSystem.batchSizes == std::vector<size_t>{1, 1001});
+  REQUIRE(batchSystem.states.size() == 1002);
+  REQUIRE(singleSystem.states == batchSystem.states);
+  for (int i = 0; i < 1002; ++i)
+    REQUIRE(batchSystem.states[i] == i + 1);
+
+  // nothing queued, no delivery
+  eventManager.dispatch();
+  REQUIRE(batchSystem.batchSizes.size() == 2);
+
+  // switching back delivers pending events
+  eventManager.emit<QueuedEvent>(2000);
+  eventManager.setDispatchMode<QueuedEvent>(ecs::EventManager::DispatchMode::IMMEDIATE);
+  REQUIRE(singleSystem.states.back() == 2000);
+  eventManager.unsubscribe<QueuedEvent>(batchSystem);
+  eventManager.unsubscribe<QueuedEvent>(singleSystem);
+}
 } // namespace event_manager_test
@@ -0,0 +1,72 @@
+#include "scheduler.h"
+
+namespace ecs {
+
+Scheduler::Scheduler(Executor executor)
+    : executor(std::move(executor)), pending(0), frameDt(0.0f) {}
+
+Scheduler::SystemId Scheduler::addSystem(std::string name, const SystemAccess &access,
+                                         Update update) {
+  SystemId id = systems.size();
+  ScheduledSystem system{std::move(name), access, std::move(update), {}, {}};
+  // depend on every earlier system that conflicts, keeps their relative order
+  for (SystemId other = 0; other < id; ++other) {
+    if (systems[other].access.conflicts(access)) {
+      system.dependencies.push_back(other);
+      systems[other].dependents.push_back(id);
+    }
+  }
+  systems.push_back(std::move(system));
+  remaining = std::make_unique<std::atomic<size_t>[]>(systems.size());
+  return id;
+}
+
+void Scheduler::run(float dt) {
+  if (systems.empty()) return;
+  frameDt = dt;
+  pending = systems.size();
+  for (SystemId id = 0; id < systems.size(); ++id) {
+    remaining[id] = systems[id].dependencies.size();
+  }
+  for (SystemId id = 0; id < systems.size(); ++id) {
+    if (systems[id].dependencies.empty()) launch(id);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    condition.wait(lock, [this]() { return !mainThreadQueue.empty() || pending == 0; });
+    if (mainThreadQueue.empty()) break;
+    std::vector<SystemId> ready;
+    ready.swap(mainThreadQueue);
+    lock.unlock();
+    for (SystemId id : ready) {
+      execute(id);
+    }
+    lock.lock();
+  }
+}
+
+void Scheduler::launch(SystemId id) {
+  if (!executor) {
+    execute(id);
+  } else if (systems[id].access.isMainThread()) {
+    std::lock_guard<std::mutex> lock(mutex);
+    mainThreadQueue.push_back(id);
+    condition.notify_all();
+  } else {
+    executor([this, id]() { execute(id); });
+  }
+}
+
+void Scheduler::execute(SystemId id) {
+  systems[id].update(frameDt);
+  for (SystemId dependent : systems[id].dependents) {
+    if (--remaining[dependent] == 0) launch(dependent);
+  }
+  if (--pending == 0) {
+    // notify under lock so run() can't miss the wake up
+    std::lock_guard<std::mutex> lock(mutex);
+    condition.notify_all();
+  }
+}
+} // namespace ecs
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "common.h"
+#include "component_manager.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief The SystemAccess class
+ * Components a scheduled system reads and writes, ie
+ * SystemAccess().read<Transform>().write<Light>()
+ *
+ * Components must be registered before they are used in an access.
+ */
+class SystemAccess {
+public:
+  template <typename... T> SystemAccess &read() {
+    (reads.set(getFamily<T>(), true), ...);
+    return *this;
+  }
+  template <typename... T> SystemAccess &write() {
+    (writes.set(getFamily<T>(), true), ...);
+    return *this;
+  }
+  // system must run on the thread that calls Scheduler::run, ie GL calls
+  SystemAccess &mainThread() {
+    onMainThread = true;
+    return *this;
+  }
+
+  /**
+   * Two systems conflict if either writes a component the other one accesses.
+   */
+  bool conflicts(const SystemAccess &other) const {
+    return (writes & (other.reads | other.writes)).any() ||
+           (other.writes & (reads | writes)).any();
+  }
+
+  const Signature &getReads() const { return reads; }
+  const Signature &getWrites() const { return writes; }
+  bool isMainThread() const { return onMainThread; }
+
+private:
+  Signature reads;
+  Signature writes;
+  bool onMainThread = false;
+
+  template <typename T> static ComponentFamily getFamily() {
+    ComponentFamily family = ComponentManager::getInstace().getComponentFamily<T>();
+    assert(family && "Component used in SystemAccess before registered.");
+    return family;
+  }
+};
+
+/**
+ * @brief The Scheduler class
+ * Runs systems in parallel based on their declared component access.
+ *
+ * A system depends on every system added before it that it conflicts with, so
+ * conflicting systems always run in the order they were added and
+ * independent systems run concurrently on the executor.
+ *
+ * Systems must not create/destory entities or add/remove components while
+ * running, that changes component arrays of other running systems.
+ */
+class Scheduler : NonCopyable {
+public:
+  using SystemId = size_t;
+  using Update = std::function<void(float dt)>;
+  // posts a task to a worker thread, ie asio::post(threadPool, task)
+  using Executor = std::function<void(std::function<void()>)>;
+
+  /**
+   * @param executor - if empty all systems run serially on the calling thread.
+   */
+  explicit Scheduler(Executor executor = Executor());
+
+  SystemId addSystem(std::string name, const SystemAccess &access, Update update);
+
+  /**
+   * @brief run - runs every system once, blocks until all of them finished.
+   * Main thread systems are run on the calling thread.
+   */
+  void run(float dt);
+
+  size_t getSystemCount() const { return systems.size(); }
+  const std::string &getName(SystemId id) const { return systems[id].name; }
+  // systems that must finish before system id starts
+  const std::vector<SystemId> &getDependencies(SystemId id) const {
+    return systems[id].dependencies;
+  }
+
+private:
+  struct ScheduledSystem {
+    std::string name;
+    SystemAccess access;
+    Update update;
+    std::vector<SystemId> dependencies;
+    std::vector<SystemId> dependents;
+  };
+
+  Executor executor;
+  std::vector<ScheduledSystem> systems;
+  // per frame state, remaining dependencies of each system
+  std::unique_ptr<std::atomic<size_t>[]> remaining;
+  std::atomic<size_t> pending;
+  float frameDt;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  // ready main thread systems, guarded by mutex
+  std::vector<SystemId> mainThreadQueue;
+
+  void launch(SystemId id);
+  void execute(SystemId id);
+};
+} // namespace ecs
@@ -0,0 +1,93 @@
+#include "coordinator.h"
+#include "scheduler.h"
+#include <asio/post.hpp>
+#include <asio/thread_pool.hpp>
+#include <asio_noexcept.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <utility>
+
+/**
+ * Benchmark, frame time of the Scheduler with increasing worker count.
+ *
+ * Each frame runs SYSTEMS independent systems that integrate their own
+ * particle component, followed by one system that reads all of them, which
+ * must wait for every writer.
+ */
+namespace scheduler_bench {
+
+constexpr size_t SYSTEMS = 8;
+constexpr size_t ENTITIES = 100000;
+constexpr uint FRAMES = 30;
+
+template <size_t N> struct Particle {
+  float position[3];
+  float velocity[3];
+};
+
+using Clock = std::chrono::steady_clock;
+
+template <size_t N> void integrate(float dt) {
+  ecs::Coordinator::getInstance().view<Particle<N>>().each(
+      [dt](ecs::Entity, Particle<N> &particle) {
+        for (int i = 0; i < 3; ++i) {
+          particle.velocity[i] += std::sin(particle.position[i]) * dt;
+          particle.position[i] += particle.velocity[i] * dt;
+        }
+      });
+}
+
+template <size_t... N> void createScene(std::index_sequence<N...>) {
+  ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+  (coordinator.registerComponent<Particle<N>>(), ...);
+  for (size_t i = 0; i < ENTITIES; ++i) {
+    ecs::Entity entity = coordinator.createEntity();
+    (coordinator.addComponent<Particle<N>>(entity, Particle<N>{{i * 0.1f, 0.0f, 1.0f}, {}}), ...);
+  }
+}
+
+template <size_t... N>
+void addSystems(ecs::Scheduler &scheduler, float &checksum, std::index_sequence<N...>) {
+  (scheduler.addSystem("integrate", ecs::SystemAccess().write<Particle<N>>(), integrate<N>), ...);
+  scheduler.addSystem("gather", ecs::SystemAccess().read<Particle<N>...>(), [&checksum](float) {
+    ecs::Coordinator::getInstance().view<Particle<N>...>().each(
+        [&checksum](ecs::Entity, const Particle<N> &...particles) {
+          checksum += (particles.position[0] + ...);
+        });
+  });
+}
+
+double measure(ecs::Scheduler::Executor executor, float &checksum) {
+  ecs::Scheduler scheduler(std::move(executor));
+  addSystems(scheduler, checksum, std::make_index_sequence<SYSTEMS>{});
+  scheduler.run(0.016f); // warm up
+  auto start = Clock::now();
+  for (uint i = 0; i < FRAMES; ++i)
+    scheduler.run(0.016f);
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAMES;
+}
+} // namespace scheduler_bench
+
+int main() {
+  using namespace scheduler_bench;
+  createScene(std::make_index_sequence<SYSTEMS>{});
+  float checksum = 0.0f;
+
+  double serialMs = measure(ecs::Scheduler::Executor(), checksum);
+  printf("%8s %16s %10s\n", "threads", "frame(ms)", "speedup");
+  printf("%8s %16.3f %10.2f\n", "serial", serialMs, 1.0);
+
+  uint maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (uint threads = 1; threads <= maxThreads; threads *= 2) {
+    asio::thread_pool threadPool(threads);
+    double ms = measure(
+        [&threadPool](std::function<void()> task) { asio::post(threadPool, std::move(task)); },
+        checksum);
+    printf("%8u %16.3f %10.2f\n", threads, ms, serialMs / ms);
+    threadPool.join();
+  }
+  printf("(checksum %.0f)\n", checksum);
+  return 0;
+}
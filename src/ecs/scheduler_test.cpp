@@ -0,0 +1,126 @@
+#include "component_manager.h"
+#include "scheduler.h"
+#include "third_party/catch.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scheduler_test {
+
+struct ComponentA {
+  int value;
+};
+struct ComponentB {
+  int value;
+};
+
+static void registerComponents() {
+  ecs::ComponentManager &componentManager = ecs::ComponentManager::getInstace();
+  if (!componentManager.getComponentFamily<ComponentA>()) {
+    componentManager.registerComponent<ComponentA>();
+    componentManager.registerComponent<ComponentB>();
+  }
+}
+
+// runs each task on its own thread, threads are joined by join()
+class ThreadExecutor {
+public:
+  void post(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.emplace_back(std::move(task));
+  }
+  void join() {
+    std::vector<std::thread> joining;
+    do {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        joining.swap(threads);
+      }
+      for (auto &thread : joining)
+        thread.join();
+      joining.clear();
+    } while (!threadsEmpty());
+  }
+
+private:
+  std::mutex mutex;
+  bool threadsEmpty() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return threads.empty();
+  }
+  std::vector<std::thread> threads;
+};
+
+TEST_CASE("Scheduler builds dependencies from component access", "[SCHEDULER]") {
+  registerComponents();
+  ecs::Scheduler scheduler;
+  auto noop = [](float) {};
+  auto writeA = scheduler.addSystem("writeA", ecs::SystemAccess().write<ComponentA>(), noop);
+  auto readA = scheduler.addSystem("readA", ecs::SystemAccess().read<ComponentA>(), noop);
+  auto readB = scheduler.addSystem("readB", ecs::SystemAccess().read<ComponentB>(), noop);
+  auto readA2 = scheduler.addSystem("readA2", ecs::SystemAccess().read<ComponentA>(), noop);
+  auto writeAB =
+      scheduler.addSystem("writeAB", ecs::SystemAccess().write<ComponentA, ComponentB>(), noop);
+
+  REQUIRE(scheduler.getSystemCount() == 5);
+  REQUIRE(scheduler.getName(readB) == "readB");
+  REQUIRE(scheduler.getDependencies(writeA).empty());
+  REQUIRE(scheduler.getDependencies(readA) == std::vector<ecs::Scheduler::SystemId>{writeA});
+  REQUIRE(scheduler.getDependencies(readB).empty());
+  // readers of the same component don't depend on each other
+  REQUIRE(scheduler.getDependencies(readA2) == std::vector<ecs::Scheduler::SystemId>{writeA});
+  REQUIRE(scheduler.getDependencies(writeAB) ==
+          std::vector<ecs::Scheduler::SystemId>{writeA, readA, readB, readA2});
+}
+
+TEST_CASE("Scheduler runs systems in dependency order", "[SCHEDULER]") {
+  registerComponents();
+  ThreadExecutor threadExecutor;
+  ecs::Scheduler scheduler(
+      [&threadExecutor](std::function<void()> task) { threadExecutor.post(std::move(task)); });
+
+  std::atomic<int> clock(0);
+  std::vector<int> stamps(4, -1);
+  std::thread::id mainThreadId;
+  float receivedDt = 0.0f;
+  scheduler.addSystem("writeA", ecs::SystemAccess().write<ComponentA>(),
+                      [&](float dt) {
+                        receivedDt = dt;
+                        stamps[0] = clock++;
+                      });
+  scheduler.addSystem("readA", ecs::SystemAccess().read<ComponentA>(),
+                      [&](float) { stamps[1] = clock++; });
+  scheduler.addSystem("readB", ecs::SystemAccess().read<ComponentB>().mainThread(),
+                      [&](float) {
+                        mainThreadId = std::this_thread::get_id();
+                        stamps[2] = clock++;
+                      });
+  scheduler.addSystem("writeAB", ecs::SystemAccess().write<ComponentA, ComponentB>(),
+                      [&](float) { stamps[3] = clock++; });
+
+  for (int frame = 0; frame < 10; ++frame) {
+    clock = 0;
+    scheduler.run(0.5f);
+    threadExecutor.join();
+    REQUIRE(clock == 4);
+    REQUIRE(stamps[0] < stamps[1]);
+    REQUIRE(stamps[1] < stamps[3]);
+    REQUIRE(stamps[2] < stamps[3]);
+    REQUIRE(mainThreadId == std::this_thread::get_id());
+    REQUIRE(receivedDt == 0.5f);
+  }
+}
+
+TEST_CASE("Scheduler without executor runs serially", "[SCHEDULER]") {
+  registerComponents();
+  ecs::Scheduler scheduler;
+  std::vector<int> order;
+  for (int i = 0; i < 3; ++i) {
+    scheduler.addSystem("system", ecs::SystemAccess().read<ComponentA>(),
+                        [&order, i](float) { order.push_back(i); });
+  }
+  scheduler.run(0.0f);
+  REQUIRE(order == std::vector<int>{0, 1, 2});
+}
+} // namespace scheduler_test
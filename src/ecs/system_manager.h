@@ -1,9 +1,9 @@
 #pragma once
 
 #include "common.h"
+#include "entity_set.h"
 #include "third_party/simplesignal.h"
 #include <memory>
-#include <set>
 #include <vector>
 
 namespace ecs {
@@ -35,11 +35,12 @@ public:
       const std::function<void(const Entity &)> &callback) {
     entityRemovedSignal.connect(callback);
   }
-  static std::set<Entity> getEntites() { return entites; }
+  // entities that match system signature, invalidated when entites change
+  static EntityRange getEntites() { return entites.range(); }
   static SystemFamily getFamily() { return family; }
 
 private:
-  static std::set<Entity> entites;
+  static EntitySet entites;
   static EntityAddedSignal entityAddedSignal;
   static EntityRemovedSignal entityRemovedSignal;
   static SystemFamily family;
@@ -55,7 +56,7 @@ template <typename T>
 BaseSystem::EntityAddedSignal System<T>::entityAddedSignal;
 template <typename T>
 BaseSystem::EntityRemovedSignal System<T>::entityRemovedSignal;
-template <typename T> std::set<Entity> System<T>::entites{};
+template <typename T> EntitySet System<T>::entites{};
 
 class SystemManager : NonCopyable {
 public:
@@ -104,7 +105,7 @@ private:
   // System arrays, [index - system id]
   std::vector<Signature> signatures;
   // system is set of entites that match system signature
-  std::vector<std::set<Entity> *> systems;
+  std::vector<EntitySet *> systems;
   std::vector<BaseSystem::EntityAddedSignal *> entityAddedSignals;
   std::vector<BaseSystem::EntityRemovedSignal *> entityRemovedSignals;
 };
@@ -22,7 +22,7 @@ struct Position {
   }
 };
 
-class TestSystem : ecs::System<TestSystem> {
+class TestSystem : public ecs::System<TestSystem> {
 public:
   TestSystem() {
     connectEntityAddedSignal(
@@ -70,8 +70,11 @@ TEST_CASE("SystemManager entity added & removed test with matching signature",
                   componentManager.getComponentFamily<Position>(), true));
   systemManager.entitySignatureChanged(entity,
                                        entityManger.getSignature(entity));
+  REQUIRE(TestSystem::getEntites().size() == 1);
+  REQUIRE(TestSystem::getEntites()[0] == entity);
   entityManger.destoryEntity(entity);
   systemManager.entityDestoryed(entity);
+  REQUIRE(TestSystem::getEntites().empty());
 }
 
 TEST_CASE(
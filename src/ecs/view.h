@@ -0,0 +1,104 @@
+#pragma once
+
+#include "archetype_storage.h"
+#include "common.h"
+#include "component_array.h"
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ecs {
+
+/**
+ * @brief The View class
+ * Iterates entities that have all the components T...
+ *
+ * The smallest ComponentArray drives the iteration and is walked densely,
+ * other component arrays are resolved through their flat entity index table.
+ *
+ * In archetype storage mode every matching archetype chunk is walked instead.
+ *
+ * Components must not be added to or removed from the viewed arrays while
+ * iterating, as that reorders the packed arrays.
+ */
+template <typename... T> class View {
+  static_assert(sizeof...(T) > 0, "View requires at least one component.");
+
+public:
+  explicit View(ComponentArray<T> *... arrays) : arrays(arrays...), archetypeStorage(nullptr) {}
+  View(ArchetypeStorage &storage, const std::array<ComponentFamily, sizeof...(T)> &families)
+      : arrays(), archetypeStorage(&storage), families(families) {}
+
+  /**
+   * @brief each
+   * @param func - callable as func(Entity, T &...)
+   */
+  template <typename Func> void each(Func &&func) {
+    if (archetypeStorage) {
+      archetypeStorage->each<T...>(families, func);
+      return;
+    }
+    size_t driver = smallestArray(std::index_sequence_for<T...>{});
+    dispatch(func, driver, std::index_sequence_for<T...>{});
+  }
+
+  /**
+   * Upper bound of entities visited by each().
+   */
+  size_t sizeHint() const {
+    if (archetypeStorage) {
+      size_t size = ~size_t(0);
+      for (ComponentFamily family : families)
+        size = std::min(size, archetypeStorage->getComponentCount(family));
+      return size;
+    }
+    return smallestSize(std::index_sequence_for<T...>{});
+  }
+
+private:
+  using Arrays = std::tuple<ComponentArray<T> *...>;
+  Arrays arrays;
+  ArchetypeStorage *archetypeStorage;
+  std::array<ComponentFamily, sizeof...(T)> families{};
+
+  template <size_t... I> size_t smallestArray(std::index_sequence<I...>) const {
+    size_t smallest = 0;
+    size_t size = std::get<0>(arrays)->getSize();
+    ((std::get<I>(arrays)->getSize() < size ? (size = std::get<I>(arrays)->getSize(), smallest = I)
+                                            : 0),
+     ...);
+    return smallest;
+  }
+
+  template <size_t... I> size_t smallestSize(std::index_sequence<I...> seq) const {
+    size_t smallest = smallestArray(seq);
+    size_t size = 0;
+    ((smallest == I ? (size = std::get<I>(arrays)->getSize(), 0) : 0), ...);
+    return size;
+  }
+
+  template <typename Func, size_t... I>
+  void dispatch(Func &func, size_t driver, std::index_sequence<I...>) {
+    ((driver == I ? (eachDrivenBy<I>(func), 0) : 0), ...);
+  }
+
+  template <size_t D, typename Func> void eachDrivenBy(Func &func) {
+    auto *driver = std::get<D>(arrays);
+    const size_t size = driver->getSize();
+    for (size_t index = 0; index < size; ++index) {
+      Entity entity = driver->getEntityAt(index);
+      if (!(std::get<ComponentArray<T> *>(arrays)->hasData(entity) && ...)) continue;
+      func(entity, getComponent<T, D>(index, entity)...);
+    }
+  }
+
+  template <typename U, size_t D> U &getComponent(size_t index, Entity entity) {
+    if constexpr (std::is_same_v<ComponentArray<U> *, std::tuple_element_t<D, Arrays>>) {
+      return std::get<D>(arrays)->getDataAt(index);
+    } else {
+      return std::get<ComponentArray<U> *>(arrays)->getData(entity);
+    }
+  }
+};
+} // namespace ecs
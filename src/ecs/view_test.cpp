@@ -0,0 +1,113 @@
+#include "coordinator.h"
+#include "third_party/catch.hpp"
+
+namespace view_test {
+
+ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+
+struct Position {
+  float x;
+  float y;
+  float z;
+
+  Position(float x, float y, float z) : x(x), y(y), z(z) {}
+};
+
+struct Velocity {
+  float dx;
+  Velocity(float dx) : dx(dx) {}
+};
+
+TEST_CASE("View iterates entities with all components", "[VIEW]") {
+  coordinator.registerComponent<Position>();
+  coordinator.registerComponent<Velocity>();
+
+  std::vector<ecs::Entity> entites;
+  for (u32 i = 0; i < 100; ++i) {
+    ecs::Entity entity = coordinator.createEntity();
+    coordinator.addComponent<Position>(entity, i + 0.0f, 0.0f, 0.0f);
+    // every third entity moves
+    if (i % 3 == 0) coordinator.addComponent<Velocity>(entity, 1.0f);
+    entites.push_back(entity);
+  }
+
+  size_t visited = 0;
+  coordinator.view<Position, Velocity>().each(
+      [&visited](ecs::Entity, Position &position, Velocity &velocity) {
+        position.x += velocity.dx;
+        ++visited;
+      });
+  REQUIRE(visited == 34);
+  for (u32 i = 0; i < 100; ++i) {
+    float expected = i + (i % 3 == 0 ? 1.0f : 0.0f);
+    REQUIRE(coordinator.getComponent<Position>(entites[i]).x == expected);
+  }
+
+  // single component view visits every entity
+  visited = 0;
+  coordinator.view<Position>().each([&visited](ecs::Entity, Position &) { ++visited; });
+  REQUIRE(visited == 100);
+
+  for (ecs::Entity entity : entites) {
+    coordinator.destoryEntity(entity);
+  }
+  visited = 0;
+  coordinator.view<Velocity, Position>().each(
+      [&visited](ecs::Entity, Velocity &, Position &) { ++visited; });
+  REQUIRE(visited == 0);
+}
+struct Mass {
+  float kg;
+  Mass(float kg) : kg(kg) {}
+};
+
+struct Drag {
+  float coefficient;
+  Drag(float coefficient) : coefficient(coefficient) {}
+};
+
+TEST_CASE("View in archetype storage mode", "[VIEW]") {
+  ecs::ComponentManager &componentManager = coordinator.componentManager;
+  componentManager.setStorageMode(ecs::ComponentManager::StorageMode::ARCHETYPE);
+  coordinator.registerComponent<Mass>();
+  coordinator.registerComponent<Drag>();
+
+  std::vector<ecs::Entity> entites(100);
+  coordinator.createEntities(entites.data(), entites.size());
+  std::vector<Mass> masses;
+  for (u32 i = 0; i < 100; ++i) masses.emplace_back(i + 0.0f);
+  coordinator.addComponents<Mass>(entites.data(), masses.data(), entites.size());
+  for (u32 i = 0; i < 100; i += 3) coordinator.addComponent<Drag>(entites[i], 1.0f);
+
+  size_t visited = 0;
+  coordinator.view<Mass, Drag>().each([&visited](ecs::Entity, Mass &mass, Drag &drag) {
+    mass.kg += drag.coefficient;
+    ++visited;
+  });
+  REQUIRE(visited == 34);
+  for (u32 i = 0; i < 100; ++i) {
+    float expected = i + (i % 3 == 0 ? 1.0f : 0.0f);
+    REQUIRE(coordinator.getComponent<Mass>(entites[i]).kg == expected);
+  }
+  visited = 0;
+  coordinator.view<Mass>().each([&visited](ecs::Entity, Mass &) { ++visited; });
+  REQUIRE(visited == 100);
+
+  // removed components leave the view, the rest stays
+  for (u32 i = 0; i < 100; i += 6) coordinator.removeComponent<Drag>(entites[i]);
+  visited = 0;
+  coordinator.view<Drag, Mass>().each([&visited](ecs::Entity entity, Drag &, Mass &) {
+    REQUIRE(coordinator.hasComponent<Drag>(entity));
+    ++visited;
+  });
+  REQUIRE(visited == 17);
+
+  for (ecs::Entity entity : entites) {
+    coordinator.destoryEntity(entity);
+  }
+  visited = 0;
+  coordinator.view<Mass>().each([&visited](ecs::Entity, Mass &) { ++visited; });
+  REQUIRE(visited == 0);
+  componentManager.setStorageMode(ecs::ComponentManager::StorageMode::COMPONENT_ARRAY);
+}
+} // namespace view_test
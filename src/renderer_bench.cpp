@@ -0,0 +1,49 @@
+#include "app/app.h"
+#include "app/benchmark.h"
+#include "components/light.h"
+#include "components/model.h"
+#include "components/transform.h"
+#include "ecs/coordinator.h"
+#include "systems/render_system/render_system.h"
+#include "utils/slogger.h"
+#include <vector>
+
+/**
+ * Renders the built-in scenes headless along scripted camera paths and writes
+ * their frame, readback & encode timings as json, see app/benchmark.h.
+ * Runs on llvmpipe so CPU-only machines can catch regressions.
+ *
+ * usage: renderer-bench [--frames N] [--warmup N] [--timestep S] [--output FILE]
+ *                       [--encode FILE] [--scene NAME]... [--size WxH]
+ */
+int main(int argc, char **argv) {
+  app::benchmark::Config benchConfig;
+  if (!benchConfig.parseArgs(argc, argv)) return 1;
+
+  // Register Components & systems, like renderer-demo
+  using namespace ecs;
+  Coordinator &coordinator = Coordinator::getInstance();
+  ComponentFamily transformFamily = coordinator.registerComponent<component::Model>();
+  ComponentFamily meshFamily = coordinator.registerComponent<component::Transform>();
+  coordinator.registerComponent<component::Light>();
+
+  ecs::Signature sig;
+  sig.set(transformFamily, true);
+  sig.set(meshFamily, true);
+  coordinator.registerSystem<render_system::RenderSystem>(sig);
+  sig.reset();
+
+  // always headless, the other app options are passed through
+  std::vector<char *> appArgs(argv, argv + argc);
+  char headless[] = "--headless";
+  appArgs.push_back(headless);
+  app::App app(appArgs.size(), appArgs.data());
+
+  app::benchmark::Report report = app.runBenchmark(benchConfig);
+  if (!app::benchmark::writeJson(benchConfig.output.c_str(), benchConfig, report)) {
+    CSLOG("Failed to write", benchConfig.output);
+    return 1;
+  }
+  CSLOG("Benchmark written to", benchConfig.output);
+  return report.scenes.empty() ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+#include "async_readback.h"
+#include "core/buffer.h"
+#include "utils/slogger.h"
+#include <cassert>
+#include <glad/glad.h>
+
+namespace render_system {
+
+AsyncReadback::AsyncReadback(uint depth) : depth(depth), droppedCount(0) {
+  assert(depth >= 2 && "Readback ring needs at least 2 slots.");
+  for (uint i = 0; i < depth; ++i) {
+    slots.emplace_back(std::make_unique<Slot>());
+  }
+}
+
+AsyncReadback::~AsyncReadback() {
+  for (auto &slot : slots) {
+    if (slot->fence) glDeleteSync(static_cast<GLsync>(slot->fence));
+    if (slot->inUse.load(std::memory_order_acquire)) {
+      // a consumer thread still holds the mapped memory, the image's deleter
+      // refers to the slot, so the slot & its buffer are orphaned
+      SLOG("AsyncReadback destroyed while a frame is held, leaking", slot->size, "bytes");
+      slot.release();
+      continue;
+    }
+    release(*slot);
+  }
+}
+
+void AsyncReadback::allocate(Slot &slot, size_t size) {
+  release(slot);
+  const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glCreateBuffers(1, &slot.pbo);
+  glNamedBufferStorage(slot.pbo, size, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+  // mapped once for the lifetime of the slot
+  slot.mapped = static_cast<uchar *>(glMapNamedBufferRange(slot.pbo, 0, size, flags));
+  slot.size = size;
+}
+
+void AsyncReadback::release(Slot &slot) {
+  if (slot.pbo) {
+    glUnmapNamedBuffer(slot.pbo);
+    glDeleteBuffers(1, &slot.pbo);
+  }
+  slot.pbo = 0;
+  slot.mapped = nullptr;
+  slot.size = 0;
+}
+
+std::shared_ptr<Image> AsyncReadback::read(uint fbo, u32 fromColorBuffer, int width,
+                                           int height) {
+  std::shared_ptr<Image> frame;
+  if (!inFlight.empty()) {
+    Slot &oldest = *inFlight.front();
+    // only block when there is no free slot for this frame
+    bool full = inFlight.size() == depth;
+    GLenum status = glClientWaitSync(static_cast<GLsync>(oldest.fence),
+                                     GL_SYNC_FLUSH_COMMANDS_BIT, full ? FENCE_TIMEOUT : 0);
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+      inFlight.pop_front();
+      frame = collect(oldest);
+    }
+  }
+
+  Slot *freeSlot = inFlight.size() < depth ? findFreeSlot() : nullptr;
+  if (!freeSlot) {
+    ++droppedCount;
+    return frame;
+  }
+  Slot &slot = *freeSlot;
+  // add padding, to create 4-byte alignment
+  size_t stride = Buffer::align(NUM_CHANNELS * width, 4);
+  size_t size = stride * height;
+  if (slot.size != size) allocate(slot, size);
+  slot.width = width;
+  slot.height = height;
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  glNamedFramebufferReadBuffer(fbo, fromColorBuffer);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4); // alignment for each pixel in memory
+  // with a pack buffer bound, pixels are written to the pbo at offset 0
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  inFlight.push_back(&slot);
+  return frame;
+}
+
+AsyncReadback::Slot *AsyncReadback::findFreeSlot() {
+  for (auto &slot : slots) {
+    if (!slot->fence && !slot->inUse.load(std::memory_order_acquire)) return slot.get();
+  }
+  // every slot is in flight or held, up to depth more for held images
+  if (slots.size() >= 2 * depth) return nullptr;
+  slots.emplace_back(std::make_unique<Slot>());
+  return slots.back().get();
+}
+
+std::shared_ptr<Image> AsyncReadback::collect(Slot &slot) {
+  glDeleteSync(static_cast<GLsync>(slot.fence));
+  slot.fence = nullptr;
+  slot.inUse.store(true, std::memory_order_relaxed);
+  // mapped memory is read only, the image must not be modified
+  std::atomic<bool> *inUse = &slot.inUse;
+  Buffer buffer = Buffer::wrap(
+      slot.mapped, slot.size,
+      [inUse](uchar *) { inUse->store(false, std::memory_order_release); }, 4);
+  return std::make_shared<Image>(std::move(buffer), slot.width, slot.height, NUM_CHANNELS);
+}
+} // namespace render_system
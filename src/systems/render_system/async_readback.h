@@ -0,0 +1,80 @@
+#pragma once
+#include "core/image.h"
+#include "types.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace render_system {
+
+/**
+ * @brief The AsyncReadback class
+ * Ring of persistently mapped pixel pack buffers (PBO) used to read frames back
+ * without stalling the GPU.
+ *
+ * Each read starts a glReadPixels into the next PBO followed by a fence, and
+ * returns the oldest frame whose fence has signaled. So frame N is copied by
+ * the GPU while frame N+1 renders.
+ *
+ * Returned images point directly into the mapped PBO memory (no copy), the
+ * slot is reused only after the image is destroyed, which can happen on any
+ * thread. Held slots are skipped, the ring grows by up to depth extra slots for
+ * them, if every slot is still held by consumers the frame is dropped.
+ *
+ * Requires GL 4.5 (DSA & buffer storage), must be used on the GL thread.
+ */
+class AsyncReadback : NonCopyable {
+public:
+  static constexpr uint DEFAULT_DEPTH = 3;
+
+  explicit AsyncReadback(uint depth = DEFAULT_DEPTH);
+  /**
+   * Images still held by consumers keep their mapped memory, those slots are
+   * leaked instead of waiting for the consumers.
+   */
+  ~AsyncReadback();
+
+  /**
+   * @brief read - queue readback of fromColorBuffer of fbo
+   * @param fbo - 0 for window (default framebuffer)
+   * @return oldest finished frame, nullptr while the ring is filling or if no
+   * frame finished yet
+   */
+  std::shared_ptr<Image> read(uint fbo, u32 fromColorBuffer, int width, int height);
+
+  uint getDepth() const { return depth; }
+  // frames not read back because all slots were busy
+  size_t getDroppedCount() const { return droppedCount; }
+
+private:
+  static constexpr int NUM_CHANNELS = 4;
+  // max time to wait for the oldest frame when the ring is full (ns)
+  static constexpr u64 FENCE_TIMEOUT = 100000000;
+
+  struct Slot {
+    uint pbo = 0;
+    uchar *mapped = nullptr;
+    size_t size = 0;
+    int width = 0;
+    int height = 0;
+    void *fence = nullptr; // GLsync
+    // set while an image refers to the mapped memory
+    std::atomic<bool> inUse{false};
+  };
+
+  // max readbacks in flight
+  const uint depth;
+  std::vector<std::unique_ptr<Slot>> slots;
+  // slots with a readback in flight, oldest first
+  std::deque<Slot *> inFlight;
+  size_t droppedCount;
+
+  // slot without a readback in flight & not held by an image, nullptr if none
+  Slot *findFreeSlot();
+
+  void allocate(Slot &slot, size_t size);
+  void release(Slot &slot);
+  std::shared_ptr<Image> collect(Slot &slot);
+};
+} // namespace render_system
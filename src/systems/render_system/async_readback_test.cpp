@@ -0,0 +1,103 @@
+#include "async_readback.h"
+#include "test_context.h"
+#include "third_party/catch.hpp"
+#include <glad/glad.h>
+#include <vector>
+
+namespace async_readback_test {
+using namespace render_system;
+
+constexpr int WIDTH = 64;
+constexpr int HEIGHT = 48;
+
+struct Target {
+  uint fbo = 0;
+  uint texture = 0;
+
+  Target() {
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    glTextureStorage2D(texture, 1, GL_RGBA8, WIDTH, HEIGHT);
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0, texture, 0);
+  }
+  ~Target() {
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &texture);
+  }
+  // fills the target with value in every channel
+  void clear(uchar value) {
+    const float color[] = {value / 255.0f, value / 255.0f, value / 255.0f, value / 255.0f};
+    glClearNamedFramebufferfv(fbo, GL_COLOR, 0, color);
+  }
+};
+
+TEST_CASE("AsyncReadback returns frames in order.", "[ASYNC_READBACK]") {
+  if (!makeTestContextCurrent()) {
+    WARN("No GL 4.5 context, skipped.");
+    return;
+  }
+  Target target;
+  AsyncReadback readback(2);
+  std::vector<int> values;
+  for (int i = 1; i <= 6; ++i) {
+    target.clear(uchar(i * 10));
+    auto frame = readback.read(target.fbo, GL_COLOR_ATTACHMENT0, WIDTH, HEIGHT);
+    glFinish();
+    if (frame) {
+      REQUIRE(frame->getWidth() == WIDTH);
+      REQUIRE(frame->getHeight() == HEIGHT);
+      values.push_back(frame->getBuffer()->data()[0]);
+    }
+  }
+  REQUIRE(values == std::vector<int>{10, 20, 30, 40, 50});
+  REQUIRE(readback.getDroppedCount() == 0);
+}
+
+TEST_CASE("AsyncReadback keeps reading while collected frames are held.", "[ASYNC_READBACK]") {
+  if (!makeTestContextCurrent()) {
+    WARN("No GL 4.5 context, skipped.");
+    return;
+  }
+  Target target;
+  const uint depth = 2;
+  AsyncReadback readback(depth);
+  SECTION("Previous frame held") {
+    // the consumer releases a frame only after the next one arrived
+    std::shared_ptr<Image> held;
+    int frames = 0;
+    for (int i = 1; i <= 8; ++i) {
+      target.clear(uchar(i * 10));
+      auto frame = readback.read(target.fbo, GL_COLOR_ATTACHMENT0, WIDTH, HEIGHT);
+      glFinish();
+      if (!frame) continue;
+      REQUIRE(frame->getBuffer()->data()[0] == (frames + 1) * 10);
+      held = frame;
+      ++frames;
+    }
+    REQUIRE(frames == 7);
+    REQUIRE(readback.getDroppedCount() == 0);
+  }
+  SECTION("Every frame held") {
+    // held frames take up to depth extra slots, then frames are dropped
+    std::vector<std::shared_ptr<Image>> held;
+    for (int i = 1; i <= 8; ++i) {
+      target.clear(uchar(i * 10));
+      auto frame = readback.read(target.fbo, GL_COLOR_ATTACHMENT0, WIDTH, HEIGHT);
+      glFinish();
+      if (frame) held.push_back(frame);
+    }
+    REQUIRE(held.size() == 2 * depth);
+    REQUIRE(readback.getDroppedCount() > 0);
+    for (size_t i = 0; i < held.size(); ++i) {
+      REQUIRE(held[i]->getBuffer()->data()[0] == int(i + 1) * 10);
+    }
+    // released slots are written again
+    held.clear();
+    size_t dropped = readback.getDroppedCount();
+    target.clear(200);
+    readback.read(target.fbo, GL_COLOR_ATTACHMENT0, WIDTH, HEIGHT);
+    glFinish();
+    REQUIRE(readback.getDroppedCount() == dropped);
+  }
+}
+} // namespace async_readback_test
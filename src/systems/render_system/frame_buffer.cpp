@@ -9,7 +9,7 @@ FrameBuffer::FrameBuffer(int width, int height)
     : fbo(0), stencilBuffer(0), depthBuffer(0), bufferFlag(0), width(width),
       height(height), depthAttachType(AttachType::NONE),
       stencilAttachType(AttachType::NONE),
-      depthStencilAttachType(AttachType::NONE) {
+      depthStencilAttachType(AttachType::NONE), readbackMode(ReadbackMode::SYNC) {
   colorBuffers.fill(0);
   colorAttachTypes.fill(AttachType::NONE);
   glGenFramebuffers(1, &fbo);
@@ -17,6 +17,7 @@ FrameBuffer::FrameBuffer(int width, int height)
 
 FrameBuffer::~FrameBuffer() {
   // cleanup
+  asyncReadback.reset();
   useDefault();
   deleteAllColorAttachments();
   deleteDepthAttachment();
@@ -243,6 +244,13 @@ uint FrameBuffer::releaseColorAttachment(uint index) {
   return textureId;
 }
 
+void FrameBuffer::readPixels(uint fbo, u32 fromColorBuffer, int width, int height,
+                             uchar *data) {
+  glNamedFramebufferReadBuffer(fbo, fromColorBuffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4); // alignment for each pixel in memory
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
 Image FrameBuffer::readPixels(u32 fromColorBuffer) {
   assert(isComplete() && "Framebuffers must be complete before use.");
   int height = this->height;
@@ -252,9 +260,7 @@ Image FrameBuffer::readPixels(u32 fromColorBuffer) {
   int stride = Buffer::align(nrChannels * width, 4);
   int bufferSize = stride * height;
   Buffer buffer(bufferSize, 4);
-  glNamedFramebufferReadBuffer(fbo, fromColorBuffer);
-  glPixelStorei(GL_PACK_ALIGNMENT, 4); // alignment for each pixel in memory
-  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+  readPixels(fbo, fromColorBuffer, width, height, buffer.data());
   return Image(std::move(buffer), width, height, nrChannels);
 }
 
@@ -267,12 +273,52 @@ Image FrameBuffer::readPixelsWindow(u32 fromColorBuffer) {
   int stride = Buffer::align(nrChannels * width, 4);
   int bufferSize = stride * height;
   Buffer buffer(bufferSize, 4);
-  glNamedFramebufferReadBuffer(0, fromColorBuffer);
-  glPixelStorei(GL_PACK_ALIGNMENT, 4); // alignment for each pixel in memory
-  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+  readPixels(0, fromColorBuffer, width, height, buffer.data());
   return Image(std::move(buffer), width, height, nrChannels);
 }
 
+std::shared_ptr<Image> FrameBuffer::readPixelsWindow(BufferPool &pool, u32 fromColorBuffer) {
+  int viewPort[4] = {};
+  glGetIntegerv(GL_VIEWPORT, viewPort);
+  int width = viewPort[2];
+  int height = viewPort[3];
+  int nrChannels = 4;
+  int stride = Buffer::align(nrChannels * width, 4);
+  Buffer buffer = pool.acquire(stride * height);
+  readPixels(0, fromColorBuffer, width, height, buffer.data());
+  return std::make_shared<Image>(std::move(buffer), width, height, nrChannels);
+}
+
+void FrameBuffer::setReadbackMode(ReadbackMode mode, uint depth) {
+  readbackMode = mode;
+  if (mode == ReadbackMode::ASYNC_PBO) {
+    if (!asyncReadback || asyncReadback->getDepth() != depth)
+      asyncReadback = std::make_unique<AsyncReadback>(depth);
+  } else {
+    asyncReadback.reset();
+  }
+}
+
+std::shared_ptr<Image> FrameBuffer::readback(u32 fromColorBuffer) {
+  if (readbackMode == ReadbackMode::ASYNC_PBO) {
+    assert(isComplete() && "Framebuffers must be complete before use.");
+    return asyncReadback->read(fbo, fromColorBuffer, width, height);
+  }
+  assert(isComplete() && "Framebuffers must be complete before use.");
+  int nrChannels = 4;
+  int stride = Buffer::align(nrChannels * width, 4);
+  Buffer buffer = framePool.acquire(stride * height);
+  readPixels(fbo, fromColorBuffer, width, height, buffer.data());
+  return std::make_shared<Image>(std::move(buffer), width, height, nrChannels);
+}
+
+std::shared_ptr<Image> FrameBuffer::readPixelsWindowAsync(AsyncReadback &readback,
+                                                          u32 fromColorBuffer) {
+  int viewPort[4] = {};
+  glGetIntegerv(GL_VIEWPORT, viewPort);
+  return readback.read(0, fromColorBuffer, viewPort[2], viewPort[3]);
+}
+
 void FrameBuffer::blit(FrameBuffer *toFrameBuffer, u32 toColorBuffer,
                        u32 fromColorBuffer) {
   assert(isComplete() && "Framebuffers must be complete before use.");
@@ -1,8 +1,11 @@
 #pragma once
+#include "async_readback.h"
+#include "core/buffer_pool.h"
 #include "core/image.h"
 #include "types.h"
 #include <array>
 #include <cassert>
+#include <memory>
 #include <unordered_set>
 
 namespace render_system {
@@ -18,6 +21,11 @@ public:
   static constexpr uint MAX_COLOR_ATTACHMENTS = 32;
   enum class AttachType { NONE, TEXTURE_BUFFER, RENDER_BUFFER };
   enum class UseType : u32 { NORMAL = 0x8D40, READ = 0x8CA8, DRAW = 0x8CA9 };
+  /**
+   * SYNC - glReadPixels into a new buffer, waits for the GPU to finish the frame
+   * ASYNC_PBO - reads through an AsyncReadback ring, returns an older frame
+   */
+  enum class ReadbackMode { SYNC, ASYNC_PBO };
   FrameBuffer(int width, int height);
   ~FrameBuffer();
 
@@ -148,6 +156,36 @@ public:
    */
   static Image readPixelsWindow(u32 fromColorBuffer = 0x0404);
 
+  /**
+   * readPixelsWindow into a buffer from pool, the buffer goes back to the pool
+   * when the image is released
+   */
+  static std::shared_ptr<Image> readPixelsWindow(BufferPool &pool,
+                                                 u32 fromColorBuffer = 0x0404);
+
+  /**
+   * @brief setReadbackMode - readback mode used by readback()
+   * @param depth - number of frames in flight for ASYNC_PBO
+   */
+  void setReadbackMode(ReadbackMode mode, uint depth = AsyncReadback::DEFAULT_DEPTH);
+  ReadbackMode getReadbackMode() const { return readbackMode; }
+
+  /**
+   * @brief readback - reads color buffer with the current readback mode, SYNC
+   * reads into buffers from getFramePool
+   * @param fromColorBuffer - Default GL_COLOR_ATTACHMENT0
+   * @return nullptr if no frame is ready yet (ASYNC_PBO)
+   */
+  std::shared_ptr<Image> readback(u32 fromColorBuffer = 0x8CE0);
+
+  /**
+   * Async read of the window (default framebuffer) through readback, see
+   * AsyncReadback::read
+   */
+  static std::shared_ptr<Image> readPixelsWindowAsync(AsyncReadback &readback,
+                                                      u32 fromColorBuffer = 0x0404);
+  const BufferPool &getFramePool() const { return framePool; }
+
   /**
    * @brief blit
    * @param toFrameBuffer - Defaul nullptr (blits to window framebuffer)
@@ -187,11 +225,16 @@ private:
   AttachType stencilAttachType;
   AttachType depthStencilAttachType;
 
+  ReadbackMode readbackMode;
+  std::unique_ptr<AsyncReadback> asyncReadback;
+  BufferPool framePool;
+
   void deleteAttachment(AttachType &type, uint *buffer, uint num);
   void createTextureBuffer(uint &buffer, u32 target, u32 internalFormat,
                            u32 transferFormat, u32 transferType,
                            u32 texAttachment, bool enableMipMap);
   void createRenderBuffer(uint &buffer, u32 internalFormat, u32 texAttachment);
+  static void readPixels(uint fbo, u32 fromColorBuffer, int width, int height, uchar *data);
 };
 
 } // namespace render_system
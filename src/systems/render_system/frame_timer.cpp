@@ -0,0 +1,96 @@
+#include "frame_timer.h"
+#include <cassert>
+#include <glad/glad.h>
+
+namespace render_system {
+
+namespace {
+constexpr double NS_TO_MS = 1e-6;
+}
+
+FrameTimer::FrameTimer(uint passCount, uint bufferCount, uint window)
+    : querySets(bufferCount), cpuStats(passCount, TimingStats(window)),
+      gpuStats(passCount, TimingStats(window)), cpuFrameStats(window), gpuFrameStats(window),
+      cpuTimes(passCount + 1), gpuTimes(passCount + 1), frameIndex(0), currentPass(-1),
+      droppedCount(0) {
+  assert(passCount > 0 && "FrameTimer needs at least one pass.");
+  assert(bufferCount >= 2 && "FrameTimer needs at least 2 query sets.");
+  for (QuerySet &querySet : querySets) {
+    querySet.queries.resize(passCount + 1);
+    glGenQueries(querySet.queries.size(), querySet.queries.data());
+  }
+}
+
+FrameTimer::~FrameTimer() {
+  for (QuerySet &querySet : querySets)
+    glDeleteQueries(querySet.queries.size(), querySet.queries.data());
+}
+
+void FrameTimer::collect(QuerySet &querySet) {
+  querySet.pending = false;
+  // the last timestamp is written last, if it is available all of them are
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(querySet.queries.back(), GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) {
+    ++droppedCount;
+    return;
+  }
+  for (size_t i = 0; i < querySet.queries.size(); ++i)
+    glGetQueryObjectui64v(querySet.queries[i], GL_QUERY_RESULT, &gpuTimes[i]);
+  for (size_t pass = 0; pass < gpuStats.size(); ++pass)
+    gpuStats[pass].add(float((gpuTimes[pass + 1] - gpuTimes[pass]) * NS_TO_MS));
+  gpuFrameStats.add(float((gpuTimes.back() - gpuTimes.front()) * NS_TO_MS));
+}
+
+void FrameTimer::beginFrame() {
+  assert(currentPass == -1 && "Frame already begun.");
+  QuerySet &querySet = querySets[frameIndex % querySets.size()];
+  if (querySet.pending) collect(querySet);
+}
+
+void FrameTimer::beginPass(uint pass) {
+  assert(int(pass) == currentPass + 1 && "Passes must be begun in order.");
+  currentPass = pass;
+  glQueryCounter(querySets[frameIndex % querySets.size()].queries[pass], GL_TIMESTAMP);
+  cpuTimes[pass] = Clock::now();
+}
+
+void FrameTimer::setWindow(uint window) {
+  for (size_t pass = 0; pass < cpuStats.size(); ++pass) {
+    cpuStats[pass] = TimingStats(window);
+    gpuStats[pass] = TimingStats(window);
+  }
+  cpuFrameStats = TimingStats(window);
+  gpuFrameStats = TimingStats(window);
+  clear();
+}
+
+void FrameTimer::clear() {
+  for (size_t pass = 0; pass < cpuStats.size(); ++pass) {
+    cpuStats[pass].clear();
+    gpuStats[pass].clear();
+  }
+  cpuFrameStats.clear();
+  gpuFrameStats.clear();
+  droppedCount = 0;
+  // frames before clear would otherwise add their GPU times later
+  for (QuerySet &querySet : querySets)
+    querySet.pending = false;
+}
+
+void FrameTimer::endFrame() {
+  assert(currentPass + 1 == int(cpuStats.size()) && "Every pass must be begun.");
+  QuerySet &querySet = querySets[frameIndex % querySets.size()];
+  glQueryCounter(querySet.queries.back(), GL_TIMESTAMP);
+  querySet.pending = true;
+  cpuTimes.back() = Clock::now();
+
+  for (size_t pass = 0; pass < cpuStats.size(); ++pass)
+    cpuStats[pass].add(
+        std::chrono::duration<float, std::milli>(cpuTimes[pass + 1] - cpuTimes[pass]).count());
+  cpuFrameStats.add(
+      std::chrono::duration<float, std::milli>(cpuTimes.back() - cpuTimes.front()).count());
+  currentPass = -1;
+  ++frameIndex;
+}
+} // namespace render_system
@@ -0,0 +1,71 @@
+#pragma once
+#include "core/timing_stats.h"
+#include "types.h"
+#include <chrono>
+#include <vector>
+
+namespace render_system {
+
+/**
+ * @brief The FrameTimer class
+ * CPU & GPU time of each pass of a frame, as TimingStats in ms.
+ *
+ * Passes are begun in order 0..passCount-1, each pass ends where the next one
+ * (or the frame) begins. GPU time is measured with GL_TIMESTAMP queries at
+ * those boundaries, the queries of a frame are read bufferCount frames later,
+ * when their set is reused, so reading them never waits on the GPU. A set whose
+ * results aren't available by then is dropped.
+ *
+ * Must be used on the GL thread.
+ */
+class FrameTimer : NonCopyable {
+public:
+  static constexpr uint DEFAULT_BUFFER_COUNT = 2;
+
+  explicit FrameTimer(uint passCount, uint bufferCount = DEFAULT_BUFFER_COUNT,
+                      uint window = TimingStats::DEFAULT_WINDOW);
+  ~FrameTimer();
+
+  // collects the GPU times of the frame that last used this frame's query set
+  void beginFrame();
+  // pass must be the one after the last begun pass
+  void beginPass(uint pass);
+  void endFrame();
+
+  uint getPassCount() const { return cpuStats.size(); }
+  const TimingStats &getCpuStats(uint pass) const { return cpuStats[pass]; }
+  const TimingStats &getGpuStats(uint pass) const { return gpuStats[pass]; }
+  // whole frame, first pass to endFrame
+  const TimingStats &getCpuFrameStats() const { return cpuFrameStats; }
+  const TimingStats &getGpuFrameStats() const { return gpuFrameStats; }
+  // frames without GPU times because their queries weren't ready in time
+  size_t getDroppedCount() const { return droppedCount; }
+  // drops all samples, the dropped count & the queries of frames not collected yet
+  void clear();
+  // clear, then keep the last window samples, ie every frame of a benchmark run
+  void setWindow(uint window);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct QuerySet {
+    // passCount + 1 timestamps, the last one ends the frame
+    std::vector<uint> queries;
+    bool pending = false;
+  };
+
+  std::vector<QuerySet> querySets;
+  std::vector<TimingStats> cpuStats;
+  std::vector<TimingStats> gpuStats;
+  TimingStats cpuFrameStats;
+  TimingStats gpuFrameStats;
+  std::vector<Clock::time_point> cpuTimes;
+  std::vector<u64> gpuTimes;
+  uint frameIndex;
+  // -1 outside a frame
+  int currentPass;
+  size_t droppedCount;
+
+  void collect(QuerySet &querySet);
+};
+} // namespace render_system
@@ -0,0 +1,69 @@
+#include "frame_timer.h"
+#include "test_context.h"
+#include "third_party/catch.hpp"
+#include <glad/glad.h>
+
+namespace frame_timer_test {
+using namespace render_system;
+
+// one pass, queries of a frame are collected 2 frames later
+void renderFrame(FrameTimer &timer) {
+  timer.beginFrame();
+  timer.beginPass(0);
+  glClear(GL_COLOR_BUFFER_BIT);
+  timer.endFrame();
+  // results are available when the set is reused
+  glFinish();
+}
+
+TEST_CASE("FrameTimer collects GPU times of earlier frames.", "[FRAME_TIMER]") {
+  if (!makeTestContextCurrent()) {
+    WARN("No GL 4.5 context, skipped.");
+    return;
+  }
+  FrameTimer timer(1);
+  for (int i = 0; i < 5; ++i)
+    renderFrame(timer);
+  REQUIRE(timer.getCpuFrameStats().getCount() == 5);
+  REQUIRE(timer.getGpuFrameStats().getCount() == 3);
+  REQUIRE(timer.getDroppedCount() == 0);
+}
+
+TEST_CASE("FrameTimer clear discards frames not collected yet.", "[FRAME_TIMER]") {
+  if (!makeTestContextCurrent()) {
+    WARN("No GL 4.5 context, skipped.");
+    return;
+  }
+  FrameTimer timer(1);
+  for (int i = 0; i < 3; ++i)
+    renderFrame(timer);
+  timer.clear();
+  REQUIRE(timer.getGpuFrameStats().getCount() == 0);
+  // the 2 frames before clear aren't collected
+  renderFrame(timer);
+  renderFrame(timer);
+  REQUIRE(timer.getGpuFrameStats().getCount() == 0);
+  REQUIRE(timer.getGpuStats(0).getCount() == 0);
+  renderFrame(timer);
+  REQUIRE(timer.getGpuFrameStats().getCount() == 1);
+  REQUIRE(timer.getCpuFrameStats().getCount() == 3);
+}
+
+TEST_CASE("FrameTimer setWindow keeps every frame of a longer run.", "[FRAME_TIMER]") {
+  if (!makeTestContextCurrent()) {
+    WARN("No GL 4.5 context, skipped.");
+    return;
+  }
+  FrameTimer timer(1);
+  renderFrame(timer);
+  const uint frames = TimingStats::DEFAULT_WINDOW + 30;
+  timer.setWindow(frames);
+  REQUIRE(timer.getCpuFrameStats().getCount() == 0);
+  for (uint i = 0; i < frames + 2; ++i)
+    renderFrame(timer);
+  REQUIRE(timer.getGpuFrameStats().getWindow() == frames);
+  REQUIRE(timer.getGpuFrameStats().getCount() == frames);
+  REQUIRE(timer.getGpuStats(0).getCount() == frames);
+  REQUIRE(timer.getCpuStats(0).getCount() == frames);
+}
+} // namespace frame_timer_test
@@ -0,0 +1,92 @@
+#include "model_data.h"
+#include "shaders/config.h"
+#include <map>
+#include <third_party/tinygltf/tiny_gltf.h>
+
+namespace render_system {
+
+namespace {
+// image of a texture index, NONE without texture
+s32 textureImage(const tinygltf::Model &modelData, int textureIndex) {
+  if (textureIndex == -1) return ModelData::NONE;
+  return modelData.textures[textureIndex].source;
+}
+
+// shader location of a glTF attribute, -1 if shaders don't use it
+int attributeLocation(const std::string &name) {
+  if (name == "POSITION") return shader::vertex::attribute::POSITION_LOC;
+  if (name == "NORMAL") return shader::vertex::attribute::NORMAL_LOC;
+  if (name == "TEXCOORD_0") return shader::vertex::attribute::TEXCOORD0_LOC;
+  return -1;
+}
+} // namespace
+
+ModelData ModelData::fromGltf(const tinygltf::Model &modelData) {
+  ModelData model;
+  if (modelData.defaultScene >= 0)
+    model.name = modelData.scenes[modelData.defaultScene].name;
+  else if (!modelData.scenes.empty())
+    model.name = modelData.scenes.front().name;
+
+  // buffer views without a target (ie images) are not uploaded
+  std::map<int, u32> viewIndices;
+  for (size_t i = 0; i < modelData.bufferViews.size(); ++i) {
+    const tinygltf::BufferView &bufferView = modelData.bufferViews[i];
+    if (bufferView.target == 0) continue;
+    const tinygltf::Buffer &buffer = modelData.buffers[bufferView.buffer];
+    viewIndices[i] = model.views.size();
+    model.views.push_back(
+        {u32(bufferView.target), buffer.data.data() + bufferView.byteOffset, bufferView.byteLength});
+  }
+
+  for (const tinygltf::Mesh &meshData : modelData.meshes) {
+    model.meshes.push_back({meshData.name, u32(model.primitives.size()),
+                            u32(meshData.primitives.size())});
+    for (const tinygltf::Primitive &primitive : meshData.primitives) {
+      u32 firstAttribute = model.attributes.size();
+      for (const auto &[name, accessorIndex] : primitive.attributes) {
+        int location = attributeLocation(name);
+        if (location == -1) continue;
+        const tinygltf::Accessor &accessor = modelData.accessors[accessorIndex];
+        // accessor type is the component count, except for SCALAR
+        s32 size = accessor.type != TINYGLTF_TYPE_SCALAR ? accessor.type : 1;
+        model.attributes.push_back(
+            {u32(location), size, u32(accessor.componentType), accessor.normalized,
+             accessor.ByteStride(modelData.bufferViews[accessor.bufferView]),
+             accessor.byteOffset, viewIndices.at(accessor.bufferView)});
+      }
+      const tinygltf::Accessor &indexAccessor = modelData.accessors[primitive.indices];
+      model.primitives.push_back({u32(primitive.mode), primitive.material, firstAttribute,
+                                  u32(model.attributes.size() - firstAttribute),
+                                  u32(indexAccessor.componentType), s32(indexAccessor.count),
+                                  indexAccessor.byteOffset,
+                                  viewIndices.at(indexAccessor.bufferView)});
+    }
+  }
+
+  for (const tinygltf::Image &image : modelData.images) {
+    model.images.push_back({image.width, image.height, image.component, image.bits,
+                            image.image.data(), image.image.size()});
+  }
+
+  for (const tinygltf::Material &materialData : modelData.materials) {
+    const tinygltf::PbrMetallicRoughness &pbrInfo = materialData.pbrMetallicRoughness;
+    Material material = {materialData.name,
+                         {},
+                         {},
+                         float(pbrInfo.metallicFactor),
+                         float(pbrInfo.roughnessFactor),
+                         textureImage(modelData, pbrInfo.baseColorTexture.index),
+                         textureImage(modelData, materialData.normalTexture.index),
+                         textureImage(modelData, materialData.emissiveTexture.index),
+                         textureImage(modelData, pbrInfo.metallicRoughnessTexture.index),
+                         textureImage(modelData, materialData.occlusionTexture.index)};
+    for (int i = 0; i < 4; ++i)
+      material.baseColorFactor[i] = pbrInfo.baseColorFactor[i];
+    for (int i = 0; i < 3; ++i)
+      material.emissiveFactor[i] = materialData.emissiveFactor[i];
+    model.materials.push_back(material);
+  }
+  return model;
+}
+} // namespace render_system
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "types.h"
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace tinygltf {
+struct Model;
+}
+
+namespace render_system {
+
+/**
+ * @brief The ModelData struct
+ * A glTF model resolved into flat tables, ready for SceneLoader to upload.
+ *
+ * Buffer views & images are raw blobs (vertex/index data and decoded pixels)
+ * pointing to memory owned elsewhere, a parsed tinygltf::Model or a mapped
+ * model cache (see app::model_cache), which must outlive the ModelData.
+ * GL enums are stored as their values so it can be built without a context.
+ */
+struct ModelData {
+  static constexpr s32 NONE = -1;
+
+  // buffer view uploaded to its own GL buffer
+  struct View {
+    u32 target; // GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER
+    const uchar *data;
+    size_t size;
+  };
+
+  // vertex attribute, only the ones the shaders use
+  struct Attribute {
+    u32 location; // shader::vertex::attribute location
+    s32 size;     // components per vertex
+    u32 componentType;
+    bool normalized;
+    s32 byteStride;
+    u64 byteOffset;
+    u32 view;
+  };
+
+  struct Primitive {
+    u32 mode;
+    s32 material; // NONE - default material
+    u32 firstAttribute;
+    u32 attributeCount;
+    u32 indexType;
+    s32 indexCount;
+    u64 indexOffset;
+    u32 indexView;
+  };
+
+  struct Mesh {
+    std::string name;
+    u32 firstPrimitive;
+    u32 primitiveCount;
+  };
+
+  // decoded pixels
+  struct Image {
+    s32 width;
+    s32 height;
+    s32 component;
+    s32 bits;
+    const uchar *pixels;
+    size_t size;
+  };
+
+  // pbr metallic roughness, images are NONE if the factor is used instead
+  struct Material {
+    std::string name;
+    float baseColorFactor[4];
+    float emissiveFactor[3];
+    float metallicFactor;
+    float roughnessFactor;
+    s32 baseColorImage;
+    s32 normalImage;
+    s32 emissiveImage;
+    s32 metallicRoughnessImage;
+    s32 occlusionImage;
+  };
+
+  std::string name;
+  std::vector<View> views;
+  std::vector<Attribute> attributes;
+  std::vector<Primitive> primitives;
+  std::vector<Mesh> meshes;
+  std::vector<Image> images;
+  std::vector<Material> materials;
+
+  // bytes of a GL_BYTE..GL_FLOAT component or index, 0 if unknown
+  static u32 componentSize(u32 componentType) {
+    switch (componentType) {
+    case 0x1400: // GL_BYTE
+    case 0x1401: // GL_UNSIGNED_BYTE
+      return 1;
+    case 0x1402: // GL_SHORT
+    case 0x1403: // GL_UNSIGNED_SHORT
+      return 2;
+    case 0x1404: // GL_INT
+    case 0x1405: // GL_UNSIGNED_INT
+    case 0x1406: // GL_FLOAT
+      return 4;
+    default:
+      return 0;
+    }
+  }
+
+  // all indices are in range, blobs are non null & large enough for what
+  // refers to them
+  bool isValid() const {
+    auto isIndex = [](s32 index, size_t size) {
+      return index == NONE || (index >= 0 && size_t(index) < size);
+    };
+    for (const View &view : views) {
+      if (!view.data) return false;
+    }
+    for (const Attribute &attribute : attributes) {
+      if (attribute.view >= views.size() || attribute.size <= 0) return false;
+      // first element must be in the view, stride isn't checked
+      u64 elementSize = u64(attribute.size) * componentSize(attribute.componentType);
+      if (!elementSize || attribute.byteOffset > views[attribute.view].size ||
+          elementSize > views[attribute.view].size - attribute.byteOffset)
+        return false;
+    }
+    for (const Primitive &primitive : primitives) {
+      if (u64(primitive.firstAttribute) + primitive.attributeCount > attributes.size() ||
+          primitive.indexView >= views.size() || !isIndex(primitive.material, materials.size()))
+        return false;
+      u64 indexSize = componentSize(primitive.indexType);
+      const View &indexView = views[primitive.indexView];
+      if (!indexSize || primitive.indexCount < 0 || primitive.indexOffset > indexView.size ||
+          u64(primitive.indexCount) * indexSize > indexView.size - primitive.indexOffset)
+        return false;
+    }
+    for (const Mesh &mesh : meshes) {
+      if (u64(mesh.firstPrimitive) + mesh.primitiveCount > primitives.size()) return false;
+    }
+    for (const Image &image : images) {
+      if (!image.pixels || image.width < 0 || image.height < 0 || image.component < 0 ||
+          image.bits < 0 ||
+          u64(image.width) * u64(image.height) * u64(image.component) * u64(image.bits) / 8 >
+              image.size)
+        return false;
+    }
+    for (const Material &material : materials) {
+      for (s32 image : {material.baseColorImage, material.normalImage, material.emissiveImage,
+                        material.metallicRoughnessImage, material.occlusionImage}) {
+        if (!isIndex(image, images.size())) return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief fromGltf - resolves accessors, textures & default scene of modelData,
+   * blobs point into modelData
+   */
+  static ModelData fromGltf(const tinygltf::Model &modelData);
+};
+} // namespace render_system
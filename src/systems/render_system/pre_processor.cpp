@@ -1,4 +1,5 @@
 #include "pre_processor.h"
+#include "core/trace.h"
 #include "default_primitives_renderer.h"
 #include "frame_buffer.h"
 #include "render_defaults.h"
@@ -87,6 +88,7 @@ Texture PreProcessor::renderToCubeMap(int width, int height, uint maxMipLevels,
 }
 
 Texture PreProcessor::equirectangularToCubemap(const Texture &equirectangular) {
+  TRACE_ZONE("PreProcessor::equirectangularToCubemap");
   return renderToCubeMap(1024, 1024, 1, true, &equirectangularShader,
                          [&shader = equirectangularShader, &texture = equirectangular](uint) {
                            /* pre draw call */
@@ -95,6 +97,7 @@ Texture PreProcessor::equirectangularToCubemap(const Texture &equirectangular) {
 }
 
 Texture PreProcessor::generateIrradianceMap(const Texture &envmap) {
+  TRACE_ZONE("PreProcessor::generateIrradianceMap");
   return renderToCubeMap(64, 64, 1, false, &iblDiffuseConvolutionShader,
                          [&shader = iblDiffuseConvolutionShader, &texture = envmap](uint) {
                            /* pre draw call */
@@ -103,6 +106,7 @@ Texture PreProcessor::generateIrradianceMap(const Texture &envmap) {
 }
 
 Texture PreProcessor::generatePreFilteredMap(const Texture &envmap) {
+  TRACE_ZONE("PreProcessor::generatePreFilteredMap");
   uint prevMipLevel = std::numeric_limits<uint>::max();
   constexpr uint maxMipLevels = 5;
   return renderToCubeMap(
@@ -123,6 +127,7 @@ Texture PreProcessor::generatePreFilteredMap(const Texture &envmap) {
 }
 
 Texture PreProcessor::generateBRDFIntegrationMap() {
+  TRACE_ZONE("PreProcessor::generateBRDFIntegrationMap");
   FrameBuffer framebuffer(512, 512);
   framebuffer.use();
   framebuffer.setColorAttachmentTB(GL_TEXTURE_2D, GL_RG16F, GL_RG, GL_FLOAT);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/radix_sort.h"
+#include "types.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace render_system {
+
+// program, material & vao binds of a pass
+struct RenderStateChanges {
+  uint programs = 0;
+  uint materials = 0;
+  uint vaos = 0;
+};
+
+/**
+ * @brief The RenderQueue class
+ * Draws of a pass ordered by a 64-bit sort key, so draws sharing a program,
+ * material & vao are adjacent and their binds can be skipped.
+ *
+ * Key, high to low bits:
+ *   program  4 - shader program (ShaderType)
+ *   material 20 - MaterialId
+ *   vao      16 - primitive vao
+ *   depth    24 - squared distance to the camera, front to back
+ * Fields wider than their bits are truncated, which only costs extra binds.
+ */
+class RenderQueue {
+public:
+  static constexpr uint PROGRAM_BITS = 4;
+  static constexpr uint MATERIAL_BITS = 20;
+  static constexpr uint VAO_BITS = 16;
+  static constexpr uint DEPTH_BITS = 24;
+  // smaller queues are sorted with std::stable_sort, see radix-sort-bench
+  static constexpr size_t RADIX_SORT_MIN_ITEMS = 1536;
+
+  struct Item {
+    u64 key;
+    u32 index; // submission index, ie into the caller's draw list
+  };
+
+  static u64 makeKey(uint program, uint material, uint vao, float depth) {
+    // bits of a positive float increase with its value, the top ones are enough
+    u32 depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+    depthBits = depth > 0.0f ? depthBits >> (31 - DEPTH_BITS) : 0;
+    return field(program, PROGRAM_BITS) << (MATERIAL_BITS + VAO_BITS + DEPTH_BITS) |
+           field(material, MATERIAL_BITS) << (VAO_BITS + DEPTH_BITS) |
+           field(vao, VAO_BITS) << DEPTH_BITS | field(depthBits, DEPTH_BITS);
+  }
+
+  void clear() { items.clear(); }
+  // index is the submission order
+  void push(u64 key) { items.push_back({key, u32(items.size())}); }
+  // stable, draws with equal keys keep their submission order
+  void sort() {
+    if (items.size() < RADIX_SORT_MIN_ITEMS) {
+      std::stable_sort(items.begin(), items.end(),
+                       [](const Item &a, const Item &b) { return a.key < b.key; });
+    } else {
+      radixSort(items, scratch, [](const Item &item) { return item.key; });
+    }
+  }
+
+  const std::vector<Item> &getItems() const { return items; }
+  size_t size() const { return items.size(); }
+
+private:
+  std::vector<Item> items;
+  std::vector<Item> scratch; // kept between frames
+
+  static u64 field(u64 value, uint bits) { return value & ((u64(1) << bits) - 1); }
+};
+} // namespace render_system
@@ -3,6 +3,7 @@
 #include "components/light.h"
 #include "components/model.h"
 #include "components/transform.h"
+#include "core/trace.h"
 #include "core/image.h"
 #include "default_primitives_renderer.h"
 #include "ecs/coordinator.h"
@@ -64,8 +65,10 @@ RenderSystem::RenderSystem(const RenderSystemConfig &config)
                               config.gridPlaneShader, preProcessor.generateBRDFIntegrationMap()}),
       guiRenderer(config.guiShader), postProcessor(config.visualPrepShader),
       framebufferA(config.width, config.height), framebufferB(config.width, config.height),
-      sceneLoader(), coordinator(ecs::Coordinator::getInstance()), skybox(nullptr),
-      frameCallback(config.frameCallback), showGridPlane(false) {
+      sceneLoader(), frameTimer(toUnderlying(RenderPass::COUNT)), coordinator(ecs::Coordinator::getInstance()), skybox(nullptr),
+      frameCallback(config.frameCallback), showGridPlane(false),
+      readbackMode(FrameBuffer::ReadbackMode::SYNC), readbackDepth(AsyncReadback::DEFAULT_DEPTH),
+      headless(false) {
   /* update projection */
   updateProjectionMatrix(config.ar);
 
@@ -101,7 +104,36 @@ RenderSystem::RenderSystem(const RenderSystemConfig &config)
 
 RenderSystem::~RenderSystem() { delete lightingSystem; }
 
+const char *getRenderPassName(RenderPass pass) {
+  switch (pass) {
+  case RenderPass::PRE_RENDER:
+    return "pre render";
+  case RenderPass::POINT_LIGHTS:
+    return "point lights";
+  case RenderPass::SKYBOX:
+    return "skybox";
+  case RenderPass::GRID_PLANE:
+    return "grid plane";
+  case RenderPass::MESHES:
+    return "meshes";
+  case RenderPass::VISUAL_PREP:
+    return "visual prep";
+  case RenderPass::GUI:
+    return "gui";
+  case RenderPass::READBACK:
+    return "readback";
+  case RenderPass::COUNT:
+    break;
+  }
+  return "unknown";
+}
+
 ModelRegisterReturn RenderSystem::registerGltfModel(tinygltf::Model &modelData) {
+  return registerModel(ModelData::fromGltf(modelData));
+}
+
+ModelRegisterReturn RenderSystem::registerModel(const ModelData &modelData) {
+  TRACE_ZONE("RenderSystem::registerModel");
   auto sceneData = sceneLoader.loadScene(modelData);
   std::vector<MeshId> ids;
   std::vector<uint> numPrimitives;
@@ -122,6 +154,7 @@ ModelRegisterReturn RenderSystem::registerGltfModel(tinygltf::Model &modelData)
 }
 
 bool RenderSystem::setSkyBox(Image *image) {
+  TRACE_ZONE("RenderSystem::setSkyBox");
   auto equiTex = Texture(*image, toUnderlying(TextureFlags::DISABLE_MIPMAP));
   skybox = std::make_unique<Texture>(preProcessor.equirectangularToCubemap(equiTex));
   globalDiffuseIBL = std::make_unique<Texture>(preProcessor.generateIrradianceMap(*skybox));
@@ -129,52 +162,138 @@ bool RenderSystem::setSkyBox(Image *image) {
   return skybox->getId() != 0;
 }
 
-std::shared_ptr<Image> RenderSystem::update(float dt) {
+void RenderSystem::gatherLights() {
+  TRACE_ZONE("RenderSystem::gatherLights");
+  pointLights.clear();
+  coordinator.view<component::Transform, component::Light>().each(
+      [this](ecs::Entity entity, const component::Transform &transform,
+             const component::Light &light) {
+        if (pointLights.size() == shader::forward::fragment::PointLight::MAX) return;
+        pointLights.push_back(PointLight{entity, transform.position(), light.color, light.range,
+                                         light.intensity});
+      });
+}
+
+void RenderSystem::gatherDrawables() {
+  TRACE_ZONE("RenderSystem::gatherDrawables");
+  drawCommands.clear();
+  coordinator.view<component::Transform, component::Model>().each(
+      [this](ecs::Entity, component::Transform &transform, const component::Model &model) {
+        drawCommands.push_back({transform.transformation(), model.meshId, &model.primIdToMatId});
+      });
+}
+
+void RenderSystem::drawScene(FrameBuffer &scene, FrameBuffer &output, bool timed) {
+  auto beginPass = [this, timed](RenderPass pass) {
+    if (timed) frameTimer.beginPass(toUnderlying(pass));
+  };
+
   // load preRender data
-  glViewport(0, 0, framebufferA.getWidth(), framebufferA.getHeight());
-  framebufferA.use();
+  beginPass(RenderPass::PRE_RENDER);
+  glViewport(0, 0, scene.getWidth(), scene.getHeight());
+  scene.use();
   renderer.preRender();
 
   // load lights
-  uint i = 0;
-  for (EntityId entity : lightingSystem->getEntites()) {
-    if (i == shader::forward::fragment::PointLight::MAX) break;
-    const auto &transform = coordinator.getComponent<component::Transform>(entity);
-    const auto &light = coordinator.getComponent<component::Light>(entity);
-    PointLight pointLight{entity, transform.position(), light.color, light.range, light.intensity};
-    renderer.loadPointLight(pointLight, i);
-    ++i;
+  beginPass(RenderPass::POINT_LIGHTS);
+  for (uint i = 0; i < pointLights.size(); ++i) {
+    renderer.loadPointLight(pointLights[i], i);
   }
-  renderer.loadPointLightCount(i);
+  renderer.loadPointLightCount(pointLights.size());
 
   // draw skybox
+  beginPass(RenderPass::SKYBOX);
   if (skybox) {
     renderer.renderSkybox(*skybox);
   }
+  beginPass(RenderPass::GRID_PLANE);
   if (showGridPlane) {
     renderer.renderGridPlane();
   }
 
   // render entites
+  beginPass(RenderPass::MESHES);
   renderer.preRenderMesh(*globalDiffuseIBL, *globalSpecularIBL);
-  for (EntityId entity : this->getEntites()) {
-    auto transform = coordinator.getComponent<component::Transform>(entity).transformation();
-    auto model = coordinator.getComponent<component::Model>(entity);
-    renderer.renderMesh(dt, transform, model.meshId, model.primIdToMatId);
+  for (const DrawCommand &drawCommand : drawCommands) {
+    renderer.submitMesh(drawCommand.transformation, drawCommand.meshId,
+                        *drawCommand.primIdToMatId);
   }
+  renderer.renderMeshQueue();
 
   // post process
-  Texture frameTexture = Texture(framebufferA.getColorAttachmentId(), GL_TEXTURE_2D);
-  framebufferB.use();
+  beginPass(RenderPass::VISUAL_PREP);
+  Texture frameTexture = Texture(scene.getColorAttachmentId(), GL_TEXTURE_2D);
+  output.use();
   postProcessor.applyVisualPrep(frameTexture);
   frameTexture.release(); // To prevent the framebuffer texture from being deleted
+}
+
+std::shared_ptr<Image> RenderSystem::update(float) {
+  TRACE_ZONE("RenderSystem::update");
+  auto beginPass = [this](RenderPass pass) { frameTimer.beginPass(toUnderlying(pass)); };
+  frameTimer.beginFrame();
+  drawScene(framebufferA, framebufferB, true);
 
   frameCallback(framebufferB.getColorAttachmentId(), framebufferB.getWidth(),
                 framebufferB.getHeight());
 
+  // headless frames skip the gui & window, their passes time ~0
+  beginPass(RenderPass::GUI);
+  if (!headless) {
+    FrameBuffer::useDefault();
+    guiRenderer.render();
+  }
+  beginPass(RenderPass::READBACK);
+  std::shared_ptr<Image> frame;
+  if (headless)
+    frame = framebufferB.readback();
+  else if (readbackMode == FrameBuffer::ReadbackMode::ASYNC_PBO)
+    frame = FrameBuffer::readPixelsWindowAsync(*windowReadback);
+  else
+    frame = FrameBuffer::readPixelsWindow(framePool);
+  frameTimer.endFrame();
+  return frame;
+}
+
+std::unique_ptr<ViewTarget> RenderSystem::createViewTarget() {
+  auto target = std::make_unique<ViewTarget>(framebufferA.getWidth(), framebufferA.getHeight());
+  setupFramebuffer(target->scene);
+  setupFramebuffer(target->output);
+  target->output.setReadbackMode(readbackMode, readbackDepth);
+  FrameBuffer::useDefault();
+  return target;
+}
+
+std::shared_ptr<Image> RenderSystem::renderView(const Camera &camera, ViewTarget &target) {
+  TRACE_ZONE("RenderSystem::renderView");
+  const Camera *mainCamera = renderer.getCamera();
+  renderer.setCamera(&camera);
+  drawScene(target.scene, target.output, false);
+  renderer.setCamera(mainCamera);
+  auto frame = target.output.readback();
   FrameBuffer::useDefault();
-  guiRenderer.render();
-  return std::make_shared<Image>(FrameBuffer::readPixelsWindow());
+  return frame;
+}
+
+void RenderSystem::setReadbackMode(FrameBuffer::ReadbackMode mode, uint depth) {
+  readbackMode = mode;
+  readbackDepth = depth;
+  if (headless) {
+    framebufferB.setReadbackMode(mode, depth);
+    windowReadback.reset();
+  } else if (mode == FrameBuffer::ReadbackMode::ASYNC_PBO) {
+    if (!windowReadback || windowReadback->getDepth() != depth)
+      windowReadback = std::make_unique<AsyncReadback>(depth);
+  } else {
+    windowReadback.reset();
+  }
+}
+
+void RenderSystem::setHeadless(bool headless) {
+  this->headless = headless;
+  // moves the readback ring between the window & framebufferB
+  framebufferB.setReadbackMode(FrameBuffer::ReadbackMode::SYNC);
+  setReadbackMode(readbackMode, readbackDepth);
 }
 
 void RenderSystem::setGridPlaneConfig(float scale, bool showPlane) {
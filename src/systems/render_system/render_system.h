@@ -3,6 +3,7 @@
 #include "ecs/common.h"
 #include "ecs/system_manager.h"
 #include "frame_buffer.h"
+#include "frame_timer.h"
 #include "gui_renderer.h"
 #include "point_light.h"
 #include "post_processor.h"
@@ -47,6 +48,30 @@ struct RenderSystemConfig {
   float ar;
 };
 
+// passes of RenderSystem::update in order, timed by its FrameTimer
+enum class RenderPass : uint {
+  PRE_RENDER,
+  POINT_LIGHTS,
+  SKYBOX,
+  GRID_PLANE,
+  MESHES,
+  VISUAL_PREP,
+  GUI,
+  READBACK,
+  COUNT
+};
+const char *getRenderPassName(RenderPass pass);
+
+/**
+ * Offscreen target of an extra view, ie a session with its own camera, see
+ * RenderSystem::renderView. Owns GL objects, destroy on the render thread.
+ */
+struct ViewTarget : NonCopyable {
+  ViewTarget(int width, int height) : scene(width, height), output(width, height) {}
+  FrameBuffer scene;  // hdr, before post processing
+  FrameBuffer output; // post processed, read back
+};
+
 struct ModelRegisterReturn {
   const std::string sceneName;
 
@@ -86,6 +111,7 @@ private:
   FrameBuffer framebufferA;
   FrameBuffer framebufferB;
   SceneLoader sceneLoader;
+  FrameTimer frameTimer;
 
   std::unordered_map<MeshId, Mesh> meshes;
   std::unordered_map<MaterialId, std::unique_ptr<BaseMaterial>> materials;
@@ -100,12 +126,33 @@ private:
   // callbacks
   const FrameCallback frameCallback;
 
+  struct DrawCommand {
+    glm::mat4 transformation;
+    MeshId meshId;
+    const std::map<PrimitiveId, MaterialId> *primIdToMatId;
+  };
+  // filled by gatherLights & gatherDrawables, consumed by update.
+  // drawCommands point into Model components, valid until Models are added/removed.
+  std::vector<PointLight> pointLights;
+  std::vector<DrawCommand> drawCommands;
+
   bool showGridPlane;
 
+  FrameBuffer::ReadbackMode readbackMode;
+  uint readbackDepth;
+  // frames are read from framebufferB, no gui & window, see setHeadless
+  bool headless;
+  // window readback ring used in ASYNC_PBO mode
+  std::unique_ptr<AsyncReadback> windowReadback;
+  // window frames in SYNC mode
+  BufferPool framePool;
+
   void initSubSystems();
   // init render_system related singletons
   bool initSingletons(const Image &gridImage, const Image &checkerImage);
   void setupFramebuffer(FrameBuffer &framebuffer);
+  // scene passes of a frame from the current camera, post processed into output
+  void drawScene(FrameBuffer &scene, FrameBuffer &output, bool timed);
 
 public:
   RenderSystem(const RenderSystemConfig &config);
@@ -113,6 +160,8 @@ public:
 
   // returns map of mesh name to id
   ModelRegisterReturn registerGltfModel(tinygltf::Model &modelData);
+  // uploads a parsed or cached model, see ModelData
+  ModelRegisterReturn registerModel(const ModelData &modelData);
 
   // register a new material of type T
   template <typename T, typename... Args>
@@ -129,7 +178,61 @@ public:
    * @return
    */
   bool setSkyBox(Image *image);
+
+  /**
+   * CPU side of a frame, collects lights (reads Transform, Light) and draw
+   * commands (reads Transform, Model) for the next update.
+   * They make no GL calls so they can run on worker threads, concurrently with
+   * each other but not with update.
+   */
+  void gatherLights();
+  void gatherDrawables();
+  /**
+   * Renders the lights & draw commands collected by the last gather calls.
+   * Must be called from the thread that owns the GL context.
+   * @return rendered window frame (framebufferB if headless), see setReadbackMode
+   */
   std::shared_ptr<Image> update(float dt);
+  // target for renderView, render size & current readback mode
+  std::unique_ptr<ViewTarget> createViewTarget();
+  /**
+   * Renders the lights & draw commands of the last gather calls from camera
+   * into target, after update. No gui, not timed by the FrameTimer.
+   * @return frame of target in its readback mode, nullptr if none is ready
+   */
+  std::shared_ptr<Image> renderView(const Camera &camera, ViewTarget &target);
+
+  /**
+   * SYNC (default) - update returns the frame it rendered.
+   * ASYNC_PBO - update returns a frame from up to depth - 1 frames ago or
+   * nullptr if none is ready. The image refers to mapped GPU memory and must be
+   * released for the slot to be reused.
+   */
+  void setReadbackMode(FrameBuffer::ReadbackMode mode,
+                       uint depth = AsyncReadback::DEFAULT_DEPTH);
+  /**
+   * Headless (no window), update skips gui composition & the default
+   * framebuffer and returns the post processed frame of framebufferB, in the
+   * current readback mode.
+   */
+  void setHeadless(bool headless);
+  // CPU & GPU ms per RenderPass (index with toUnderlying) of the last frames
+  const FrameTimer &getFrameTimer() const { return frameTimer; }
+  void clearFrameTimings() { frameTimer.clear(); }
+  // clears the timings, which then cover the last window frames
+  void setFrameTimingWindow(uint window) { frameTimer.setWindow(window); }
+  // scene draw calls of the last update, gui excluded
+  uint getDrawCallCount() const { return renderer.getDrawCallCount(); }
+  // mesh pass binds of the last update in ECS order, ie without sorting
+  const RenderStateChanges &getUnsortedStateChanges() const {
+    return renderer.getUnsortedStateChanges();
+  }
+  // mesh pass binds of the last update, sorted by RenderQueue
+  const RenderStateChanges &getStateChanges() const { return renderer.getStateChanges(); }
+  // hits, misses & high water of the SYNC readback buffers
+  BufferPool::Stats getFramePoolStats() const {
+    return headless ? framebufferB.getFramePool().getStats() : framePool.getStats();
+  }
 
   void updateProjectionMatrix(float ar, float fov = DEFAULT_FOV, float near = DEFAULT_NEAR,
                               float far = DEFAULT_FAR) {
@@ -19,7 +19,7 @@ Renderer::Renderer(RendererConfig config)
       textureForwardMaterial(config.textureForwardShader),
       skyboxCubeMapShader(config.skyboxCubeMapShader), gridPlaneShader(config.gridPlaneShape),
       brdfIntegrationMap(std::move(config.brdfIntegrationMap)),
-      gridTexture(RenderDefaults::getInstance().createGridTexture()) {
+      gridTexture(RenderDefaults::getInstance().createGridTexture()), drawCallCount(0) {
 
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glEnable(GL_DEPTH_TEST);
@@ -44,6 +44,7 @@ void Renderer::loadPointLightCount(size_t count) {
 
 void Renderer::preRender() {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  drawCallCount = 0;
   // TODO: global / gener ubos handled by render_system (data) ??
   generalVSUBO.setViewMatrix(camera->getViewMatrix());
   generalVSUBO.setCameraPos(camera->position);
@@ -62,29 +63,69 @@ void Renderer::preRenderMesh(const Texture &diffuseIbl, const Texture &specularI
   textureForwardMaterial.unBind();
 }
 
-void Renderer::renderMesh(float, const glm::mat4 &transform, const MeshId &meshId,
-                          std::map<PrimitiveId, MaterialId> primIdToMatId) {
+void Renderer::submitMesh(const glm::mat4 &transform, const MeshId &meshId,
+                          const std::map<PrimitiveId, MaterialId> &primIdToMatId) {
   // fetch mesh
   const auto &mesh = meshes.at(meshId);
-  for (size_t i = 0; i < mesh.primitives.size(); ++i) {
+  glm::vec3 offset = glm::vec3(transform[3]) - camera->position;
+  float depth = glm::dot(offset, offset);
+  for (const Primitive &primitive : mesh.primitives) {
+    auto matId = primIdToMatId.find(primitive.vao);
+    const auto &material = materials.at(matId != primIdToMatId.end() ? matId->second
+                                                                     : DEFAULT_FLAT_MATERIAL_ID);
+    meshQueue.push(RenderQueue::makeKey(toUnderlying(material->shaderType), material->id,
+                                        primitive.vao, depth));
+    meshDraws.push_back({&transform, &primitive, material.get()});
+  }
+}
+
+RenderStateChanges Renderer::countStateChanges(const std::vector<RenderQueue::Item> &items) const {
+  RenderStateChanges changes;
+  const MeshDraw *last = nullptr;
+  for (const RenderQueue::Item &item : items) {
+    const MeshDraw &draw = meshDraws[item.index];
+    if (!last || draw.primitive->vao != last->primitive->vao) ++changes.vaos;
+    if (!last || draw.material->shaderType != last->material->shaderType) ++changes.programs;
+    if (!last || draw.material != last->material) ++changes.materials;
+    last = &draw;
+  }
+  return changes;
+}
+
+void Renderer::renderMeshQueue() {
+  unsortedStateChanges = countStateChanges(meshQueue.getItems());
+  meshQueue.sort();
+  stateChanges = countStateChanges(meshQueue.getItems());
+
+  const MeshDraw *last = nullptr;
+  for (const RenderQueue::Item &item : meshQueue.getItems()) {
+    const MeshDraw &draw = meshDraws[item.index];
     // bind primitive
-    const Primitive &primitive = mesh.primitives[i];
-    glBindVertexArray(primitive.vao);
-    // set entity specific data
-    const auto &material = materials.at(primIdToMatId[primitive.vao]);
+    const Primitive &primitive = *draw.primitive;
+    if (!last || primitive.vao != last->primitive->vao) glBindVertexArray(primitive.vao);
+    // set entity specific data, materials are only reloaded when they change
+    const BaseMaterial *material = draw.material;
+    bool programChanged = !last || material->shaderType != last->material->shaderType;
+    bool materialChanged = !last || material != last->material;
     if (material->shaderType == ShaderType::FLAT_FORWARD_SHADER) {
-      flatForwardMaterial.bind();
-      flatForwardMaterial.loadMaterial(*static_cast<FlatMaterial *>(material.get()));
-      flatForwardMaterial.loadTransformMatrix(transform);
+      if (programChanged) flatForwardMaterial.bind();
+      if (materialChanged)
+        flatForwardMaterial.loadMaterial(*static_cast<const FlatMaterial *>(material));
+      flatForwardMaterial.loadTransformMatrix(*draw.transform);
     } else {
-      textureForwardMaterial.bind();
-      textureForwardMaterial.loadMaterial(*static_cast<TextureMaterial *>(material.get()));
-      textureForwardMaterial.loadTransformMatrix(transform);
+      if (programChanged) textureForwardMaterial.bind();
+      if (materialChanged)
+        textureForwardMaterial.loadMaterial(*static_cast<const TextureMaterial *>(material));
+      textureForwardMaterial.loadTransformMatrix(*draw.transform);
     }
     // draw
     glDrawElements(primitive.mode, primitive.indexCount, primitive.indexType,
                    primitive.indexOffset);
+    ++drawCallCount;
+    last = &draw;
   }
+  meshQueue.clear();
+  meshDraws.clear();
 }
 
 void Renderer::renderSkybox(const Texture &texture) {
@@ -93,6 +134,7 @@ void Renderer::renderSkybox(const Texture &texture) {
   skyboxCubeMapShader.bind();
   skyboxCubeMapShader.bindTexture(texture);
   DefaultPrimitivesRenderer::getInstance().drawCube();
+  ++drawCallCount;
   glDepthFunc(GL_LESS);
 }
 
@@ -107,6 +149,7 @@ void Renderer::renderGridPlane() {
   glActiveTexture(GL_TEXTURE0);
   gridTexture.bind();
   DefaultPrimitivesRenderer::getInstance().drawPlane();
+  ++drawCallCount;
   glEnable(GL_CULL_FACE);
 }
 
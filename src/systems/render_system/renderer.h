@@ -2,6 +2,7 @@
 
 #include "common.h"
 #include "frame_buffer.h"
+#include "render_queue.h"
 #include "shaders/flat_forward_material.h"
 #include "shaders/general_vs_ubo.h"
 #include "shaders/grid_plane.h"
@@ -22,6 +23,7 @@ class Buffer;
 class Image;
 namespace render_system {
 struct Mesh;
+struct Primitive;
 struct RenderableEntity;
 struct PointLight;
 struct BaseMaterial;
@@ -57,6 +59,23 @@ private:
   Texture brdfIntegrationMap;
   Texture gridTexture; // TODO: Added in grid as entity
 
+  // draw calls since the last preRender
+  uint drawCallCount;
+
+  // mesh pass, filled by submitMesh
+  struct MeshDraw {
+    const glm::mat4 *transform;
+    const Primitive *primitive;
+    const BaseMaterial *material;
+  };
+  std::vector<MeshDraw> meshDraws;
+  RenderQueue meshQueue;
+  RenderStateChanges unsortedStateChanges;
+  RenderStateChanges stateChanges;
+
+  // binds needed to draw meshDraws in the order of items
+  RenderStateChanges countStateChanges(const std::vector<RenderQueue::Item> &items) const;
+
 public:
   Renderer(RendererConfig config);
 
@@ -72,14 +91,18 @@ public:
    */
   void preRenderMesh(const Texture &diffuseIbl, const Texture &specularIbl);
   /**
-   * @brief renderMesh
-   * @param dt
-   * @param transform
-   * @param meshId
-   * @param primIdToMatId
+   * @brief submitMesh - queues the primitives of a mesh for renderMeshQueue
+   * @param transform - must stay valid until renderMeshQueue
+   * @param primIdToMatId - primitives without a material use the default flat one
    */
-  void renderMesh(float dt, const glm::mat4 &transform, const MeshId &meshId,
-                  std::map<PrimitiveId, MaterialId> primIdToMatId);
+  void submitMesh(const glm::mat4 &transform, const MeshId &meshId,
+                  const std::map<PrimitiveId, MaterialId> &primIdToMatId);
+  /**
+   * @brief renderMeshQueue - draws the submitted primitives sorted by program,
+   * material, vao & depth (see RenderQueue), skipping redundant binds, and
+   * clears the queue. Call after preRenderMesh.
+   */
+  void renderMeshQueue();
   void renderSkybox(const Texture &texture);
   void renderGridPlane();
 
@@ -87,6 +110,13 @@ public:
     return std::pair(brdfIntegrationMap.getId(), brdfIntegrationMap.getTarget());
   }
 
+  [[nodiscard]] uint getDrawCallCount() const { return drawCallCount; }
+  // binds the last mesh pass would have needed in submission (ECS) order
+  [[nodiscard]] const RenderStateChanges &getUnsortedStateChanges() const {
+    return unsortedStateChanges;
+  }
+  // binds of the last mesh pass
+  [[nodiscard]] const RenderStateChanges &getStateChanges() const { return stateChanges; }
   [[nodiscard]] shader::GridPlane &getGridPlaneShader() { return gridPlaneShader; }
   [[nodiscard]] const Camera *getCamera() { return camera; }
   [[nodiscard]] glm::mat4 getProjectionMatrix() const { return projectionMatrix; }
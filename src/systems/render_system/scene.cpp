@@ -1,10 +1,11 @@
 #include "scene.h"
+#include "core/trace.h"
 #include "render_defaults.h"
 #include "shaders/config.h"
 #include "texture.h"
 #include "utils/slogger.h"
+#include <climits>
 #include <iostream>
-#include <third_party/tinygltf/tiny_gltf.h>
 
 namespace render_system {
 
@@ -38,25 +39,19 @@ uint SceneLoader::loadedMeshCount = 1;
 uint SceneLoader::loadedMaterialCount = DEFAULT_MATERIAL_ID + 1;
 
 Scene SceneLoader::loadScene(tinygltf::Model &modelData) {
-  const tinygltf::Scene &scene = modelData.scenes[modelData.defaultScene];
-  // load all buffer view into vbos
-
-  std::map<int, GLuint> vbos;
-
-  // store all buffer view on vbos
-  for (size_t i = 0; i < modelData.bufferViews.size(); i++) {
-    const tinygltf::BufferView &bufferView = modelData.bufferViews[i];
-    // invalid buffer view (NOT ARRAY_BUFFER or ELEMENT_ARRAY_BUFFER)
-    if (bufferView.target == 0) continue;
-
-    const tinygltf::Buffer &buffer = modelData.buffers[bufferView.buffer];
+  return loadScene(ModelData::fromGltf(modelData));
+}
 
-    GLuint vbo;
-    glGenBuffers(1, &vbo);
-    vbos[i] = vbo;
-    glBindBuffer(bufferView.target, vbo);
-    glBufferData(bufferView.target, bufferView.byteLength, &buffer.data[0] + bufferView.byteOffset,
-                 GL_STATIC_DRAW);
+Scene SceneLoader::loadScene(const ModelData &modelData) {
+  TRACE_ZONE("SceneLoader::loadScene");
+  assert(modelData.isValid() && "Invalid model data.");
+  // load all buffer view into vbos
+  std::vector<GLuint> vbos(modelData.views.size());
+  glGenBuffers(vbos.size(), vbos.data());
+  for (size_t i = 0; i < modelData.views.size(); i++) {
+    const ModelData::View &view = modelData.views[i];
+    glBindBuffer(view.target, vbos[i]);
+    glBufferData(view.target, view.size, view.data, GL_STATIC_DRAW);
   }
 
   // load meshes
@@ -68,7 +63,7 @@ Scene SceneLoader::loadScene(tinygltf::Model &modelData) {
       primIdToMatIdList; // map<Mesh_NAME, map<PRIMITIVE_ID, MATERIAL_ID>>
   std::vector<bool> hasTexCoords;
 
-  for (const tinygltf::Mesh &meshData : modelData.meshes) {
+  for (const ModelData::Mesh &meshData : modelData.meshes) {
     auto ret = processMesh(vbos, meshData, modelData);
     if (!ret.success) {
       SLOG(ret.message);
@@ -84,17 +79,16 @@ Scene SceneLoader::loadScene(tinygltf::Model &modelData) {
                      std::make_move_iterator(ret.materials.end()));
   }
 
-  // cleanup vbos
-  for (size_t i = 0; i < vbos.size(); ++i)
-    glDeleteBuffers(1, &vbos[i]);
+  // cleanup vbos, vaos keep them alive
+  glDeleteBuffers(vbos.size(), vbos.data());
 
-  return {scene.name,          meshes, names, hasTexCoords, primIdToMatIdList, matIdToNameList,
+  return {modelData.name, meshes, names, hasTexCoords, primIdToMatIdList, matIdToNameList,
           std::move(materials)};
 }
 
-SceneLoader::ProcessMeshRet SceneLoader::processMesh(const std::map<int, GLuint> &vbos,
-                                                     const tinygltf::Mesh &meshData,
-                                                     const tinygltf::Model &modelData) {
+SceneLoader::ProcessMeshRet SceneLoader::processMesh(const std::vector<GLuint> &vbos,
+                                                     const ModelData::Mesh &meshData,
+                                                     const ModelData &modelData) {
   std::vector<Primitive> primitives;
   std::vector<std::unique_ptr<BaseMaterial>> materials;
   std::vector<std::string> materialNames;
@@ -106,48 +100,28 @@ SceneLoader::ProcessMeshRet SceneLoader::processMesh(const std::map<int, GLuint>
   std::string message; // contains reason if sucess == false
 
   // loop through mesh primitives
-  for (size_t i = 0; i < meshData.primitives.size(); ++i) {
+  for (u32 i = 0; i < meshData.primitiveCount; ++i) {
     GLuint vao = 0;
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
 
-    const tinygltf::Primitive &primitive = meshData.primitives[i];
+    const ModelData::Primitive &primitive = modelData.primitives[meshData.firstPrimitive + i];
     // primitive attributes (Position, Normal, TexCoords)
-    for (const auto &attrib : primitive.attributes) {
-      // attibe pair<string, int> pair of attribute name and accessor index
-      const tinygltf::Accessor &accessor = modelData.accessors[attrib.second];
+    for (u32 a = 0; a < primitive.attributeCount; ++a) {
+      const ModelData::Attribute &attrib = modelData.attributes[primitive.firstAttribute + a];
       // bind respective accessor buffer view
-      glBindBuffer(GL_ARRAY_BUFFER, vbos.at(accessor.bufferView));
-
-      int size = 1;
-      /*
-       * Accessor type represents bufferView data type (VEC2, VEC3,...)
-       * Except for SCALAR type id is same as type size
-       */
-      if (accessor.type != TINYGLTF_TYPE_SCALAR) size = accessor.type;
-
-      int vaa = -1;
-      if (attrib.first.compare("POSITION") == 0) vaa = shader::vertex::attribute::POSITION_LOC;
-      if (attrib.first.compare("NORMAL") == 0) vaa = shader::vertex::attribute::NORMAL_LOC;
-      if (attrib.first.compare("TEXCOORD_0") == 0) {
-        vaa = shader::vertex::attribute::TEXCOORD0_LOC;
-        hasTexCoords = true;
-      }
-
-      if (vaa > -1) {
-        // calculate stride
-        int byteStride = accessor.ByteStride(modelData.bufferViews[accessor.bufferView]);
-        glEnableVertexAttribArray(vaa);
-        glVertexAttribPointer(vaa, size, accessor.componentType,
-                              accessor.normalized ? GL_TRUE : GL_FALSE, byteStride,
-                              (void *)accessor.byteOffset);
-      }
+      glBindBuffer(GL_ARRAY_BUFFER, vbos[attrib.view]);
+      if (attrib.location == shader::vertex::attribute::TEXCOORD0_LOC) hasTexCoords = true;
+      glEnableVertexAttribArray(attrib.location);
+      glVertexAttribPointer(attrib.location, attrib.size, attrib.componentType,
+                            attrib.normalized ? GL_TRUE : GL_FALSE, attrib.byteStride,
+                            (void *)attrib.byteOffset);
     }
 
     // primitive materials
     int matIndex = primitive.material;
-    if (matIndex != -1) {
-      const tinygltf::Material &materialData = modelData.materials[primitive.material];
+    if (matIndex != ModelData::NONE) {
+      const ModelData::Material &materialData = modelData.materials[primitive.material];
       // process material
       auto processMatRet = processMaterial(materialData, modelData, hasTexCoords);
       materials.emplace_back(std::unique_ptr<BaseMaterial>(processMatRet.material.release()));
@@ -168,26 +142,20 @@ SceneLoader::ProcessMeshRet SceneLoader::processMesh(const std::map<int, GLuint>
     }
 
     // primitive indices
-    const tinygltf::Accessor &indexAccessor = modelData.accessors[primitive.indices];
-
-    assert((indexAccessor.componentType == GL_UNSIGNED_INT ||
-            indexAccessor.componentType == GL_UNSIGNED_SHORT) &&
+    assert((primitive.indexType == GL_UNSIGNED_INT || primitive.indexType == GL_UNSIGNED_SHORT) &&
            "Invalid mesh index type.");
 
-    GLuint ibo = vbos.at(indexAccessor.bufferView);
+    GLuint ibo = vbos[primitive.indexView];
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 
     // make sure we have valid data
     assert(vao && "Invalid index buffer.");
-    assert(primitive.mode >= GL_POINTS && primitive.mode <= GL_TRIANGLE_FAN &&
-           "Invalid primitive mode.");
-    assert(indexAccessor.componentType >= GL_SHORT && indexAccessor.componentType <= GL_FLOAT);
-    assert(indexAccessor.count > 0 && "Count must be greater than 0.");
+    assert(primitive.mode <= GL_TRIANGLE_FAN && "Invalid primitive mode.");
+    assert(primitive.indexCount > 0 && "Count must be greater than 0.");
 
     // register primitives to our mesh
-    primitives.push_back({vao, (const GLenum)primitive.mode,
-                          (const GLenum)indexAccessor.componentType,
-                          (const GLsizei)indexAccessor.count, (void *)indexAccessor.byteOffset});
+    primitives.push_back({vao, (const GLenum)primitive.mode, (const GLenum)primitive.indexType,
+                          (const GLsizei)primitive.indexCount, (void *)primitive.indexOffset});
     glBindVertexArray(0);
   }
   if (loadedMeshCount == UINT_MAX) {
@@ -207,20 +175,12 @@ SceneLoader::ProcessMeshRet SceneLoader::processMesh(const std::map<int, GLuint>
     return {{0, {}}, {}, {}, {}, {}, false, false, message};
 }
 
-SceneLoader::ProcessMaterialRet SceneLoader::processMaterial(const tinygltf::Material &materialData,
-                                                             const tinygltf::Model &modelData,
-                                                             bool hasTexCoord) {
+SceneLoader::ProcessMaterialRet
+SceneLoader::processMaterial(const ModelData::Material &materialData, const ModelData &modelData,
+                             bool hasTexCoord) {
   assert(loadedMeshCount != UINT_MAX && "Out of model ids.");
   RenderDefaults &renderDefault = RenderDefaults::getInstance();
   std::unique_ptr<FlatMaterial> flatMaterial = nullptr;
-  const tinygltf::PbrMetallicRoughness &pbrInfo = materialData.pbrMetallicRoughness;
-
-  // material texture indices
-  int baseColorTextureIndex = pbrInfo.baseColorTexture.index;
-  int normalTextureIndex = materialData.normalTexture.index;
-  int emissionTextureIndex = materialData.emissiveTexture.index;
-  int occlusionTextureIndex = materialData.occlusionTexture.index;
-  int metallicRoughnessTextureIndex = pbrInfo.metallicRoughnessTexture.index;
 
   // material texture id
   Texture albedo(0, GL_TEXTURE_2D);
@@ -233,18 +193,17 @@ SceneLoader::ProcessMaterialRet SceneLoader::processMaterial(const tinygltf::Mat
    * load material texture if they exists, otherwise fallback to color or
    * default texture
    */
-  if (baseColorTextureIndex != -1) {
-    const tinygltf::Image &baseColorImage =
-        modelData.images[modelData.textures[baseColorTextureIndex].source];
-    albedo = Texture(processTexture(baseColorImage, true), GL_TEXTURE_2D);
+  if (materialData.baseColorImage != ModelData::NONE) {
+    albedo = Texture(processTexture(modelData.images[materialData.baseColorImage], true),
+                     GL_TEXTURE_2D);
   } else {
-    const auto albedoF = glm::vec4(pbrInfo.baseColorFactor[0], pbrInfo.baseColorFactor[1],
-                                   pbrInfo.baseColorFactor[2], pbrInfo.baseColorFactor[3]);
-    const auto emissionF = glm::vec3(materialData.emissiveFactor[0], materialData.emissiveFactor[1],
-                                     materialData.emissiveFactor[2]);
+    const float *baseColor = materialData.baseColorFactor;
+    const float *emissive = materialData.emissiveFactor;
+    const auto albedoF = glm::vec4(baseColor[0], baseColor[1], baseColor[2], baseColor[3]);
+    const auto emissionF = glm::vec3(emissive[0], emissive[1], emissive[2]);
     const auto aoF = 1.0f;
-    const auto metallicF = (float)pbrInfo.metallicFactor;
-    const auto roughtnessF = (float)pbrInfo.roughnessFactor;
+    const auto metallicF = materialData.metallicFactor;
+    const auto roughtnessF = materialData.roughnessFactor;
     albedo = renderDefault.createCheckerTexture();
     flatMaterial.reset(new FlatMaterial({{loadedMaterialCount++, ShaderType::FLAT_FORWARD_SHADER},
                                          albedoF,
@@ -253,29 +212,22 @@ SceneLoader::ProcessMaterialRet SceneLoader::processMaterial(const tinygltf::Mat
                                          metallicF,
                                          roughtnessF}));
   }
-  if (normalTextureIndex != -1) {
-    const tinygltf::Image &normalImage =
-        modelData.images[modelData.textures[normalTextureIndex].source];
-    normal = Texture(processTexture(normalImage), GL_TEXTURE_2D);
+  if (materialData.normalImage != ModelData::NONE) {
+    normal = Texture(processTexture(modelData.images[materialData.normalImage]), GL_TEXTURE_2D);
   } else
     normal = renderDefault.createBlackTexture();
-  if (emissionTextureIndex != -1) {
-    const tinygltf::Image &emissionImage =
-        modelData.images[modelData.textures[emissionTextureIndex].source];
-    emission = Texture(processTexture(emissionImage), GL_TEXTURE_2D);
+  if (materialData.emissiveImage != ModelData::NONE) {
+    emission = Texture(processTexture(modelData.images[materialData.emissiveImage]), GL_TEXTURE_2D);
   } else
     emission = renderDefault.createBlackTexture();
-  if (metallicRoughnessTextureIndex != -1) {
-    const tinygltf::Image &metallicRoughnessImage =
-        modelData.images[modelData.textures[metallicRoughnessTextureIndex].source];
+  if (materialData.metallicRoughnessImage != ModelData::NONE) {
     /* Packed metallicRoughness, R - Metallic G - Roughness*/
-    metallicRoughness = Texture(processTexture(metallicRoughnessImage), GL_TEXTURE_2D);
+    metallicRoughness = Texture(
+        processTexture(modelData.images[materialData.metallicRoughnessImage]), GL_TEXTURE_2D);
   } else
     metallicRoughness = renderDefault.createWhiteTexture();
-  if (occlusionTextureIndex != -1) {
-    const tinygltf::Image &occlusionImage =
-        modelData.images[modelData.textures[occlusionTextureIndex].source];
-    ao = Texture(processTexture(occlusionImage), GL_TEXTURE_2D);
+  if (materialData.occlusionImage != ModelData::NONE) {
+    ao = Texture(processTexture(modelData.images[materialData.occlusionImage]), GL_TEXTURE_2D);
   } else
     ao = renderDefault.createWhiteTexture();
 
@@ -294,7 +246,7 @@ SceneLoader::ProcessMaterialRet SceneLoader::processMaterial(const tinygltf::Mat
 /**
  * Using separate texture loader (not using Texture class) for model loader makes things simple??
  */
-GLuint SceneLoader::processTexture(const tinygltf::Image &image, bool srgb) {
+GLuint SceneLoader::processTexture(const ModelData::Image &image, bool srgb) {
   GLuint texId;
   glGenTextures(1, &texId);
   glBindTexture(GL_TEXTURE_2D, texId);
@@ -322,7 +274,7 @@ GLuint SceneLoader::processTexture(const tinygltf::Image &image, bool srgb) {
     type = GL_UNSIGNED_SHORT;
 
   glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, format, type,
-               &image.image.at(0));
+               image.pixels);
   glGenerateMipmap(GL_TEXTURE_2D);
   glBindTexture(GL_TEXTURE_2D, 0);
 
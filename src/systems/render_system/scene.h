@@ -1,14 +1,12 @@
 #pragma once
 #include "mesh.h"
+#include "model_data.h"
 #include <map>
 #include <string>
 #include <vector>
 
 namespace tinygltf {
 struct Model;
-struct Mesh;
-struct Image;
-struct Material;
 } // namespace tinygltf
 
 namespace render_system {
@@ -38,6 +36,7 @@ struct Scene {
  *
  * Loads a glft models with rendereable meshes.
  * (i.e all the data loaded to gpu and ready to be rendered)
+ * Models are loaded from ModelData, parsed glTF or a model cache.
  *
  * Converts regular mesh data to renderable mesh.
  * This class is used as medium to load meshes into render_system.
@@ -64,14 +63,15 @@ private:
   static MeshId loadedMeshCount;
   static MaterialId loadedMaterialCount;
 
-  ProcessMeshRet processMesh(const std::map<int, GLuint> &vbos, const tinygltf::Mesh &meshData,
-                             const tinygltf::Model &modelData);
+  ProcessMeshRet processMesh(const std::vector<GLuint> &vbos, const ModelData::Mesh &meshData,
+                             const ModelData &modelData);
 
-  ProcessMaterialRet processMaterial(const tinygltf::Material &materialData,
-                                     const tinygltf::Model &modelData, bool hasTexCoords);
-  GLuint processTexture(const tinygltf::Image &image, bool srgb = false);
+  ProcessMaterialRet processMaterial(const ModelData::Material &materialData,
+                                     const ModelData &modelData, bool hasTexCoords);
+  GLuint processTexture(const ModelData::Image &image, bool srgb = false);
 
 public:
+  Scene loadScene(const ModelData &modelData);
   Scene loadScene(tinygltf::Model &modelData);
   static MeshId generateMeshId() { return loadedMeshCount++; }
   static MaterialId generateMaterialId() { return loadedMaterialCount++; }
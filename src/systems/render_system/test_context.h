@@ -0,0 +1,6 @@
+#pragma once
+
+namespace render_system {
+// makes a GL 4.5 context without a window current, false if the machine has none
+bool makeTestContextCurrent();
+} // namespace render_system
@@ -0,0 +1,224 @@
+#include "scene_snapshot.h"
+#include "components/light.h"
+#include "components/model.h"
+#include "components/transform.h"
+#include "core/serializer.h"
+#include "utils/slogger.h"
+#include "world_system.h"
+#include <unordered_map>
+#include <vector>
+
+namespace world_system::scene_snapshot {
+
+namespace {
+constexpr size_t TRANSFORM_FLOATS = 10;
+constexpr size_t LIGHT_FLOATS = 5;
+
+// index of id in the reference table, adds it if new
+u32 addReference(std::unordered_map<u32, u32> &references, std::vector<u32> &ids, u32 id) {
+  auto [it, added] = references.emplace(id, ids.size());
+  if (added) ids.push_back(id);
+  return it->second;
+}
+} // namespace
+
+size_t Header::getSnapshotSize() const {
+  return HEADER_SIZE + size_t(entityCount) * (1 + TRANSFORM_FLOATS * 4) +
+         size_t(lightCount) * (LIGHT_FLOATS * 4 + 1) + size_t(modelCount) * 8 +
+         size_t(primitiveCount) * 8 + (size_t(meshCount) + materialCount) * 4;
+}
+
+Buffer save(const WorldSystem &worldSystem) {
+  ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+  std::vector<u8> masks;
+  std::vector<float> transforms;
+  std::vector<float> lights;
+  std::vector<u8> lightTypes;
+  std::vector<u32> models; // mesh reference, primitive count
+  std::vector<u32> primitives; // primitive id, material reference
+  std::vector<u32> meshIds;
+  std::vector<u32> materialIds;
+  std::unordered_map<u32, u32> meshReferences;
+  std::unordered_map<u32, u32> materialReferences;
+
+  worldSystem.forEachWorldObject([&](WorldObject &worldObject) {
+    EntityId entity = worldObject.getEntityId();
+    const component::Transform &transform = worldObject.getTransform();
+    glm::vec3 position = transform.position();
+    glm::quat rotation = transform.rotation();
+    glm::vec3 scale = transform.scale();
+    transforms.insert(transforms.end(), {position.x, position.y, position.z, rotation.x,
+                                         rotation.y, rotation.z, rotation.w, scale.x, scale.y,
+                                         scale.z});
+    u8 mask = 0;
+    if (coordinator.hasComponent<component::Light>(entity)) {
+      const component::Light &light = coordinator.getComponent<component::Light>(entity);
+      lights.insert(lights.end(),
+                    {light.color.r, light.color.g, light.color.b, light.intensity, light.range});
+      lightTypes.push_back(toUnderlying(light.type));
+      mask |= LIGHT;
+    }
+    if (coordinator.hasComponent<component::Model>(entity)) {
+      const component::Model &model = coordinator.getComponent<component::Model>(entity);
+      models.push_back(addReference(meshReferences, meshIds, model.meshId));
+      models.push_back(model.primIdToMatId.size());
+      for (const auto &[primId, matId] : model.primIdToMatId) {
+        primitives.push_back(primId);
+        primitives.push_back(addReference(materialReferences, materialIds, matId));
+      }
+      mask |= MODEL;
+    }
+    masks.push_back(mask);
+  });
+
+  Header header = {VERSION,
+                   u32(masks.size()),
+                   u32(lightTypes.size()),
+                   u32(models.size() / 2),
+                   u32(primitives.size() / 2),
+                   u32(meshIds.size()),
+                   u32(materialIds.size())};
+  Buffer snapshot(header.getSnapshotSize());
+  Serializer &serializer = Serializer::getInstance();
+  serializer.pack(snapshot, 0, MAGIC, header.version, u16(0), header.entityCount,
+                  header.lightCount, header.modelCount, header.primitiveCount, header.meshCount,
+                  header.materialCount);
+  size_t offset = HEADER_SIZE;
+  offset += serializer.packArray(snapshot, offset, masks.data(), masks.size());
+  offset += serializer.packArray(snapshot, offset, transforms.data(), transforms.size());
+  offset += serializer.packArray(snapshot, offset, lights.data(), lights.size());
+  offset += serializer.packArray(snapshot, offset, lightTypes.data(), lightTypes.size());
+  offset += serializer.packArray(snapshot, offset, models.data(), models.size());
+  offset += serializer.packArray(snapshot, offset, primitives.data(), primitives.size());
+  offset += serializer.packArray(snapshot, offset, meshIds.data(), meshIds.size());
+  offset += serializer.packArray(snapshot, offset, materialIds.data(), materialIds.size());
+  assert(offset == snapshot.getSize() && "Snapshot size mismatch.");
+  return snapshot;
+}
+
+bool readHeader(const Buffer &snapshot, Header &header) {
+  if (snapshot.getSize() < HEADER_SIZE) return false;
+  u32 magic;
+  u16 reserved;
+  Serializer::getInstance().unPack(snapshot, 0, magic, header.version, reserved,
+                                   header.entityCount, header.lightCount, header.modelCount,
+                                   header.primitiveCount, header.meshCount, header.materialCount);
+  return magic == MAGIC && header.version == VERSION;
+}
+
+bool parse(const Buffer &snapshot, Scene &scene, const Remap &remap) {
+  Header header;
+  if (!readHeader(snapshot, header)) {
+    SLOG("Not a scene snapshot of version", VERSION);
+    return false;
+  }
+  if (header.getSnapshotSize() != snapshot.getSize()) {
+    SLOG("Scene snapshot size mismatch:", snapshot.getSize(), "expected:",
+         header.getSnapshotSize());
+    return false;
+  }
+
+  Serializer &serializer = Serializer::getInstance();
+  std::vector<u8> &masks = scene.masks;
+  masks.assign(header.entityCount, 0);
+  std::vector<float> transformData(header.entityCount * TRANSFORM_FLOATS);
+  std::vector<float> lightData(header.lightCount * LIGHT_FLOATS);
+  std::vector<u8> lightTypes(header.lightCount);
+  std::vector<u32> modelData(header.modelCount * 2);
+  std::vector<u32> primitiveData(header.primitiveCount * 2);
+  std::vector<u32> meshIds(header.meshCount);
+  std::vector<u32> materialIds(header.materialCount);
+  size_t offset = HEADER_SIZE;
+  offset += serializer.unPackArray(snapshot, offset, masks.data(), masks.size());
+  offset += serializer.unPackArray(snapshot, offset, transformData.data(), transformData.size());
+  offset += serializer.unPackArray(snapshot, offset, lightData.data(), lightData.size());
+  offset += serializer.unPackArray(snapshot, offset, lightTypes.data(), lightTypes.size());
+  offset += serializer.unPackArray(snapshot, offset, modelData.data(), modelData.size());
+  offset += serializer.unPackArray(snapshot, offset, primitiveData.data(), primitiveData.size());
+  offset += serializer.unPackArray(snapshot, offset, meshIds.data(), meshIds.size());
+  serializer.unPackArray(snapshot, offset, materialIds.data(), materialIds.size());
+
+  // validate everything before the world is touched
+  size_t lightCount = 0;
+  size_t modelCount = 0;
+  for (u8 mask : masks) {
+    lightCount += (mask & LIGHT) != 0;
+    modelCount += (mask & MODEL) != 0;
+  }
+  size_t primitiveCount = 0;
+  bool isValid = lightCount == header.lightCount && modelCount == header.modelCount;
+  for (u8 type : lightTypes)
+    isValid &= type <= toUnderlying(LightType::AREA_LIGHT);
+  for (size_t i = 0; i < modelData.size(); i += 2) {
+    isValid &= modelData[i] < header.meshCount;
+    primitiveCount += modelData[i + 1];
+  }
+  isValid &= primitiveCount == header.primitiveCount;
+  for (size_t i = 0; i < primitiveData.size(); i += 2)
+    isValid &= primitiveData[i + 1] < header.materialCount;
+  if (!isValid) {
+    SLOG("Corrupt scene snapshot.");
+    return false;
+  }
+
+  // references are remapped once, not per model
+  if (remap.mesh) {
+    for (u32 &id : meshIds) id = remap.mesh(id);
+  }
+  if (remap.material) {
+    for (u32 &id : materialIds) id = remap.material(id);
+  }
+
+  std::vector<component::Transform> &transforms = scene.transforms;
+  transforms.clear();
+  transforms.reserve(header.entityCount);
+  for (size_t i = 0; i < transformData.size(); i += TRANSFORM_FLOATS) {
+    const float *t = &transformData[i];
+    transforms.emplace_back(glm::vec3(t[0], t[1], t[2]), glm::quat(t[6], t[3], t[4], t[5]),
+                            glm::vec3(t[7], t[8], t[9]));
+  }
+  std::vector<component::Light> &lights = scene.lights;
+  lights.clear();
+  lights.reserve(header.lightCount);
+  for (size_t i = 0; i < header.lightCount; ++i) {
+    const float *l = &lightData[i * LIGHT_FLOATS];
+    lights.emplace_back(glm::vec3(l[0], l[1], l[2]), l[3], l[4], LightType(lightTypes[i]));
+  }
+  std::vector<component::Model> &models = scene.models;
+  models.assign(header.modelCount, {});
+  const u32 *primitive = primitiveData.data();
+  for (size_t i = 0; i < models.size(); ++i) {
+    models[i].meshId = meshIds[modelData[i * 2]];
+    for (u32 p = 0; p < modelData[i * 2 + 1]; ++p, primitive += 2)
+      models[i].primIdToMatId.emplace_hint(models[i].primIdToMatId.end(), primitive[0],
+                                           materialIds[primitive[1]]);
+  }
+
+  return true;
+}
+
+void apply(WorldSystem &worldSystem, Scene &scene) {
+  std::vector<EntityId> entities =
+      worldSystem.createWorldObjects(scene.transforms.data(), scene.transforms.size());
+  std::vector<EntityId> lightEntities;
+  std::vector<EntityId> modelEntities;
+  lightEntities.reserve(scene.lights.size());
+  modelEntities.reserve(scene.models.size());
+  for (size_t i = 0; i < entities.size(); ++i) {
+    if (scene.masks[i] & LIGHT) lightEntities.push_back(entities[i]);
+    if (scene.masks[i] & MODEL) modelEntities.push_back(entities[i]);
+  }
+  ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+  coordinator.addComponents<component::Light>(lightEntities.data(), scene.lights.data(),
+                                              scene.lights.size());
+  coordinator.addComponents<component::Model>(modelEntities.data(), scene.models.data(),
+                                              scene.models.size());
+}
+
+bool load(WorldSystem &worldSystem, const Buffer &snapshot, const Remap &remap) {
+  Scene scene;
+  if (!parse(snapshot, scene, remap)) return false;
+  apply(worldSystem, scene);
+  return true;
+}
+} // namespace world_system::scene_snapshot
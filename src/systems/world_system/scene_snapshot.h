@@ -0,0 +1,87 @@
+#pragma once
+
+#include "components/light.h"
+#include "components/model.h"
+#include "components/transform.h"
+#include "core/buffer.h"
+#include "types.h"
+#include <functional>
+#include <vector>
+
+/**
+ * Binary snapshot of the world objects of a WorldSystem with their Transform,
+ * Light and Model components, so a scene can be restored without rebuilding it
+ * from glTF.
+ *
+ * Components are stored as arrays, packed with Serializer::packArray, and
+ * loaded in bulk with Coordinator::addComponents. Mesh & material ids of
+ * Models are runtime ids, they are stored once in reference tables and are
+ * valid if resources are registered in the same order, or remapped on load.
+ *
+ * Layout (big-endian):
+ *   header     - magic, version, entity/light/model/primitive/reference counts
+ *   masks      - u8 per entity, components it has besides Transform (signature)
+ *   transforms - 10 floats per entity, position xyz, rotation xyzw, scale xyz
+ *   lights     - 5 floats per light (color rgb, intensity, range), u8 type per light
+ *   models     - u32 mesh reference, u32 primitive count per model
+ *   primitives - u32 primitive id, u32 material reference per primitive
+ *   references - u32 mesh ids, u32 material ids
+ * Lights & models are in entity order.
+ */
+namespace world_system {
+class WorldSystem;
+
+namespace scene_snapshot {
+
+constexpr u32 MAGIC = 0x52334453; // R3DS
+// bump on any layout change, other versions are rejected
+constexpr u16 VERSION = 1;
+constexpr size_t HEADER_SIZE = 32;
+
+enum ComponentMask : u8 { LIGHT = 1 << 0, MODEL = 1 << 1 };
+
+struct Header {
+  u16 version;
+  u32 entityCount;
+  u32 lightCount;
+  u32 modelCount;
+  u32 primitiveCount;
+  u32 meshCount;     // mesh reference table
+  u32 materialCount; // material reference table
+
+  // total snapshot size in bytes
+  size_t getSnapshotSize() const;
+};
+
+// maps a saved mesh/material id to the id registered in this run
+struct Remap {
+  std::function<uint(uint)> mesh;
+  std::function<MaterialId(MaterialId)> material;
+};
+
+// components of a parsed snapshot, lights & models in entity order
+struct Scene {
+  std::vector<u8> masks; // ComponentMask per entity
+  std::vector<component::Transform> transforms;
+  std::vector<component::Light> lights;
+  std::vector<component::Model> models;
+};
+
+Buffer save(const WorldSystem &worldSystem);
+// false if snapshot is too small or is not a snapshot of this version
+bool readHeader(const Buffer &snapshot, Header &header);
+/**
+ * @brief parse - decodes & validates snapshot without touching any world, ie
+ * before clearing the world it replaces
+ * @return false if the snapshot is invalid
+ */
+bool parse(const Buffer &snapshot, Scene &scene, const Remap &remap = {});
+// adds the world objects of a parsed scene to worldSystem, moves its components
+void apply(WorldSystem &worldSystem, Scene &scene);
+/**
+ * @brief load - parse & apply
+ * @return false if the snapshot is invalid, nothing is added then
+ */
+bool load(WorldSystem &worldSystem, const Buffer &snapshot, const Remap &remap = {});
+} // namespace scene_snapshot
+} // namespace world_system
@@ -0,0 +1,144 @@
+#include "components/light.h"
+#include "components/model.h"
+#include "core/serializer.h"
+#include "scene_snapshot.h"
+#include "third_party/catch.hpp"
+#include "world_system.h"
+
+namespace system_test {
+void initTest();
+}
+
+namespace scene_snapshot_test {
+using namespace world_system;
+
+// n objects, every 3rd has a light and every 2nd a model
+void buildScene(WorldSystem &system, uint n) {
+  system_test::initTest();
+  for (uint i = 0; i < n; ++i) {
+    auto &object = system.createWorldObject(component::Transform(
+        glm::vec3(i, i + 0.5f, -1.0f * i), glm::vec3(glm::radians(i + 1.0f)), glm::vec3(i + 1.0f)));
+    if (i % 3 == 0)
+      object.addComponent<component::Light>(glm::vec3(i / 10.0f, 0.5f, 1.0f), 100.0f + i, 50.0f,
+                                            LightType(i % 4));
+    if (i % 2 == 0)
+      object.addComponent<component::Model>(
+          component::Model{i % 5, {{0, i % 7}, {1, (i + 1) % 7}, {4, 100}}});
+  }
+}
+
+// world objects of system in id order
+std::vector<WorldObject *> getObjects(const WorldSystem &system) {
+  std::vector<WorldObject *> objects;
+  system.forEachWorldObject([&](WorldObject &object) { objects.push_back(&object); });
+  return objects;
+}
+
+TEST_CASE("Scene snapshot round trip", "[SCENE_SNAPSHOT]") {
+  ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+  WorldSystem saved;
+  buildScene(saved, 100);
+  Buffer snapshot = scene_snapshot::save(saved);
+
+  scene_snapshot::Header header;
+  REQUIRE(scene_snapshot::readHeader(snapshot, header));
+  REQUIRE(header.entityCount == 100);
+  REQUIRE(header.lightCount == 34);
+  REQUIRE(header.modelCount == 50);
+  REQUIRE(header.primitiveCount == 150);
+  REQUIRE(header.meshCount == 5);
+  REQUIRE(header.materialCount == 8);
+  REQUIRE(header.getSnapshotSize() == snapshot.getSize());
+
+  WorldSystem loaded;
+  REQUIRE(scene_snapshot::load(loaded, snapshot));
+  REQUIRE(loaded.numValidWorldObjects() == 100);
+  auto savedObjects = getObjects(saved);
+  auto loadedObjects = getObjects(loaded);
+  for (size_t i = 0; i < savedObjects.size(); ++i) {
+    EntityId a = savedObjects[i]->getEntityId();
+    EntityId b = loadedObjects[i]->getEntityId();
+    REQUIRE(coordinator.entityManager.getSignature(a) == coordinator.entityManager.getSignature(b));
+    const auto &ta = savedObjects[i]->getTransform();
+    const auto &tb = loadedObjects[i]->getTransform();
+    REQUIRE(ta.position() == tb.position());
+    REQUIRE(ta.rotation() == tb.rotation());
+    REQUIRE(ta.scale() == tb.scale());
+    if (coordinator.hasComponent<component::Light>(a)) {
+      const auto &la = coordinator.getComponent<component::Light>(a);
+      const auto &lb = coordinator.getComponent<component::Light>(b);
+      REQUIRE(la.color == lb.color);
+      REQUIRE(la.intensity == lb.intensity);
+      REQUIRE(la.range == lb.range);
+      REQUIRE(la.type == lb.type);
+    }
+    if (coordinator.hasComponent<component::Model>(a)) {
+      const auto &ma = coordinator.getComponent<component::Model>(a);
+      const auto &mb = coordinator.getComponent<component::Model>(b);
+      REQUIRE(ma.meshId == mb.meshId);
+      REQUIRE(ma.primIdToMatId == mb.primIdToMatId);
+    }
+  }
+  // saving the loaded scene gives the same bytes
+  Buffer resaved = scene_snapshot::save(loaded);
+  REQUIRE(resaved.getSize() == snapshot.getSize());
+  REQUIRE(std::memcmp(resaved.data(), snapshot.data(), snapshot.getSize()) == 0);
+}
+
+TEST_CASE("Scene snapshot remaps references", "[SCENE_SNAPSHOT]") {
+  WorldSystem saved;
+  buildScene(saved, 10);
+  Buffer snapshot = scene_snapshot::save(saved);
+  WorldSystem loaded;
+  scene_snapshot::Remap remap = {[](uint meshId) { return meshId + 1000; },
+                                 [](MaterialId matId) { return matId * 2; }};
+  REQUIRE(scene_snapshot::load(loaded, snapshot, remap));
+  auto &model = getObjects(loaded).front()->getComponent<component::Model>();
+  REQUIRE(model.meshId == 1000);
+  REQUIRE(model.primIdToMatId.at(1) == 2);
+  REQUIRE(model.primIdToMatId.at(4) == 200);
+}
+
+TEST_CASE("Scene snapshot rejects invalid data", "[SCENE_SNAPSHOT]") {
+  WorldSystem saved;
+  buildScene(saved, 10);
+  Buffer snapshot = scene_snapshot::save(saved);
+  WorldSystem loaded;
+
+  SECTION("other version") {
+    Serializer::getInstance().pack(snapshot, 4, u16(scene_snapshot::VERSION + 1));
+    REQUIRE_FALSE(scene_snapshot::load(loaded, snapshot));
+  }
+  SECTION("truncated") {
+    Buffer truncated(snapshot.data(), snapshot.getSize() - 1);
+    REQUIRE_FALSE(scene_snapshot::load(loaded, truncated));
+  }
+  SECTION("mesh reference out of range") {
+    scene_snapshot::Header header;
+    REQUIRE(scene_snapshot::readHeader(snapshot, header));
+    size_t models = scene_snapshot::HEADER_SIZE + header.entityCount * 41 + header.lightCount * 21;
+    Serializer::getInstance().pack(snapshot, models, header.meshCount);
+    REQUIRE_FALSE(scene_snapshot::load(loaded, snapshot));
+  }
+  REQUIRE(loaded.numValidWorldObjects() == 0);
+}
+
+TEST_CASE("Scene snapshot parses without touching the world", "[SCENE_SNAPSHOT]") {
+  WorldSystem saved;
+  buildScene(saved, 10);
+  Buffer snapshot = scene_snapshot::save(saved);
+  WorldSystem loaded;
+
+  scene_snapshot::Scene scene;
+  REQUIRE(scene_snapshot::parse(snapshot, scene));
+  REQUIRE(loaded.numValidWorldObjects() == 0);
+  REQUIRE(scene.transforms.size() == 10);
+  REQUIRE(scene.lights.size() == 4);
+  REQUIRE(scene.models.size() == 5);
+  scene_snapshot::apply(loaded, scene);
+  REQUIRE(loaded.numValidWorldObjects() == 10);
+
+  Buffer truncated(snapshot.data(), snapshot.getSize() - 1);
+  REQUIRE_FALSE(scene_snapshot::parse(truncated, scene));
+}
+} // namespace scene_snapshot_test
@@ -6,9 +6,11 @@
 
 namespace system_test {
 
-inline void initTest() {
+void initTest() {
   using namespace ecs;
   Coordinator &coordinator = Coordinator::getInstance();
+  // test files share the coordinator, first one registers
+  if (coordinator.getComponentFamily<component::Transform>()) return;
   coordinator.registerComponent<component::Model>();
   coordinator.registerComponent<component::Transform>();
   coordinator.registerComponent<component::Light>();
@@ -4,6 +4,32 @@ namespace world_system {
 
 WorldSystem::WorldSystem() { worldObjects.reserve(5000); }
 
+std::vector<EntityId> WorldSystem::createWorldObjects(component::Transform *transforms,
+                                                      size_t count) {
+  ecs::Coordinator &coordinator = ecs::Coordinator::getInstance();
+  std::vector<EntityId> entities(count);
+  coordinator.createEntities(entities.data(), count);
+  coordinator.addComponents<component::Transform>(entities.data(), transforms, count);
+
+  for (EntityId entityId : entities) {
+    std::unique_ptr<WorldObject> worldObject = std::make_unique<WorldObject>();
+    size_t worldId = worldObjects.size();
+    if (!nullIndices.empty()) {
+      auto it = nullIndices.begin();
+      worldId = *it;
+      nullIndices.erase(it);
+    }
+    worldObject->id = worldId + 1;
+    worldObject->entityId = entityId;
+    if (worldId == worldObjects.size()) {
+      worldObjects.emplace_back(std::move(worldObject));
+    } else {
+      worldObjects[worldId] = std::move(worldObject);
+    }
+  }
+  return entities;
+}
+
 bool WorldSystem::deleteWorldObject(WorldObjectId id) {
   assert(id > 0 && id <= worldObjects.size());
   int objectId = id - 1;
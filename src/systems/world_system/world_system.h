@@ -50,6 +50,14 @@ public:
     return *worldObjects[worldId].get();
   }
 
+  /**
+   * Constructs count WorldObjects&Entities with given transforms at once,
+   * entities and components are created in bulk (ie loading a SceneSnapshot).
+   *
+   * @return entity ids of the new world objects, in transforms order
+   */
+  std::vector<EntityId> createWorldObjects(component::Transform *transforms, size_t count);
+
   /**
    * @brief isWorldObject
    * @param id
@@ -89,6 +97,13 @@ public:
     }
   }
 
+  // calls f(WorldObject &) for each valid world object, in id order
+  template <typename F> void forEachWorldObject(F &&f) const {
+    for (const auto &worldObject : worldObjects) {
+      if (worldObject) f(*worldObject);
+    }
+  }
+
   uint numValidWorldObjects() const { return worldObjects.size() - nullIndices.size(); }
 
   void clearWorld();